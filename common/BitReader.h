@@ -0,0 +1,250 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BITREADER_H
+#define BITREADER_H
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#include <intrin.h>
+#define BR_BSWAP64(x) _byteswap_uint64(x)
+#else
+#define BR_BSWAP64(x) __builtin_bswap64(x)
+#endif
+
+/**
+ * Sequential msb-first bit reader for psi/si sections, pes headers and
+ * video headers. Up to 64 bits are kept in a register and refilled with a
+ * single 8 byte load, so a field costs a shift and a mask instead of the
+ * byte walk of CBit::getBits. Reads never go past the end of the buffer:
+ * a read that runs off the end returns 0 and sets the overrun flag, which
+ * the caller checks once after parsing a structure.
+ */
+class CBitReader
+{
+public:
+    CBitReader(const unsigned char* buf,size_t size)
+    {
+        Init(buf,size);
+    }
+
+    void Init(const unsigned char* buf,size_t size)
+    {
+        m_pStart = buf;
+        m_pCur = buf;
+        m_pEnd = buf + size;
+        m_cache = 0;
+        m_nBits = 0;
+        m_bOverrun = false;
+    }
+
+    /// read n bits, 0 <= n <= 32
+    unsigned int GetBits(int n)
+    {
+        if (n <= 0)
+        {
+            return 0;
+        }
+        if (m_nBits < n)
+        {
+            Refill();
+            if (m_nBits < n)
+            {
+                SetOverrun();
+                return 0;
+            }
+        }
+        unsigned int v = (unsigned int)(m_cache >> (64 - n));
+        m_cache <<= n;
+        m_nBits -= n;
+        return v;
+    }
+
+    unsigned int GetBit()
+    {
+        return GetBits(1);
+    }
+
+    /// read n bits without consuming them, 0 <= n <= 32
+    unsigned int PeekBits(int n)
+    {
+        if (n <= 0)
+        {
+            return 0;
+        }
+        if (m_nBits < n)
+        {
+            Refill();
+            if (m_nBits < n)
+            {
+                return 0;
+            }
+        }
+        return (unsigned int)(m_cache >> (64 - n));
+    }
+
+    void SkipBits(size_t n)
+    {
+        if (n <= (size_t)m_nBits)
+        {
+            m_cache <<= n;
+            m_nBits -= (int)n;
+            return;
+        }
+        SeekBits(BitPos() + n);
+    }
+
+    void SkipBytes(size_t n)
+    {
+        SkipBits(n * 8);
+    }
+
+    void ByteAlign()
+    {
+        SkipBits(m_nBits & 7);
+    }
+
+    /// unsigned Exp-Golomb code ue(v)
+    unsigned int ReadUE()
+    {
+        if (m_nBits < 32)
+        {
+            Refill();
+        }
+        if (m_nBits == 0)
+        {
+            SetOverrun();
+            return 0;
+        }
+        //only the loaded bits count, the rest of the register may hold the following bytes
+        unsigned long long valid = (m_cache >> (64 - m_nBits)) << (64 - m_nBits);
+        int zeros = valid == 0 ? 64 : Clz64(valid);
+        if (zeros > 31 || zeros >= m_nBits)
+        {
+            SetOverrun();
+            return 0;
+        }
+        m_cache <<= zeros + 1;
+        m_nBits -= zeros + 1;
+        return ((1u << zeros) - 1) + GetBits(zeros);
+    }
+
+    /// signed Exp-Golomb code se(v)
+    int ReadSE()
+    {
+        unsigned int v = ReadUE();
+        return (v & 1) ? (int)((v >> 1) + 1) : -(int)(v >> 1);
+    }
+
+    /// current byte, valid when the reader is byte aligned
+    const unsigned char* Pointer() const
+    {
+        return m_pCur - m_nBits / 8;
+    }
+
+    size_t BitPos() const
+    {
+        return (size_t)(m_pCur - m_pStart) * 8 - m_nBits;
+    }
+
+    size_t BitsLeft() const
+    {
+        return (size_t)(m_pEnd - m_pCur) * 8 + m_nBits;
+    }
+
+    size_t BytesLeft() const
+    {
+        return BitsLeft() / 8;
+    }
+
+    bool Overrun() const
+    {
+        return m_bOverrun;
+    }
+
+private:
+    void Refill()
+    {
+        if (m_pEnd - m_pCur >= 8)
+        {
+            //bits below the valid ones come from the bytes after m_pCur, they are
+            //loaded again unchanged by the next refill so or-ing them in is harmless
+            unsigned long long v;
+            memcpy(&v,m_pCur,8);
+#if !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            v = BR_BSWAP64(v);
+#endif
+            m_cache |= v >> m_nBits;
+            int n = (63 - m_nBits) >> 3;
+            m_pCur += n;
+            m_nBits += n << 3;
+            return;
+        }
+        while (m_nBits <= 55 && m_pCur < m_pEnd)
+        {
+            m_cache |= (unsigned long long)*m_pCur++ << (56 - m_nBits);
+            m_nBits += 8;
+        }
+    }
+
+    void SeekBits(size_t pos)
+    {
+        size_t size = (size_t)(m_pEnd - m_pStart);
+        if (pos > size * 8)
+        {
+            pos = size * 8;
+            m_bOverrun = true;
+        }
+        m_pCur = m_pStart + pos / 8;
+        m_cache = 0;
+        m_nBits = 0;
+        int rest = (int)(pos & 7);
+        if (rest != 0)
+        {
+            Refill();
+            m_cache <<= rest;
+            m_nBits -= rest;
+        }
+    }
+
+    void SetOverrun()
+    {
+        m_bOverrun = true;
+        m_pCur = m_pEnd;
+        m_cache = 0;
+        m_nBits = 0;
+    }
+
+    static int Clz64(unsigned long long v)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanReverse64(&idx,v);
+        return 63 - (int)idx;
+#else
+        return __builtin_clzll(v);
+#endif
+    }
+
+private:
+    const unsigned char* m_pStart;
+    const unsigned char* m_pCur;
+    const unsigned char* m_pEnd;
+    unsigned long long m_cache;
+    int m_nBits;
+    bool m_bOverrun;
+};
+
+#endif
@@ -0,0 +1,241 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CLOCKRECOVERY_H
+#define CLOCKRECOVERY_H
+
+#include <stdlib.h>
+
+//27MHz pcr values wrap at 2^33*300: the 33-bit base times 300 plus the 9-bit
+//extension, so the 42 bits of the field wrap together with the base
+#define CLOCK_PCR_MODULUS       (8589934592LL * 300)
+
+//90kHz pts/dts values wrap at 2^33
+#define CLOCK_PTS_MODULUS       8589934592LL
+
+//pcrs the clock is fitted to
+#define CLOCK_WINDOW            16
+
+//a pcr further than this (10ms) from the fitted clock starts a new segment
+#define CLOCK_MAX_ERROR         270000
+
+//a pcr more than this (1s) after the previous one starts a new segment
+#define CLOCK_MAX_GAP           27000000
+
+//span of the window, keeps the sums of the fit within 64 bits
+#define CLOCK_MAX_POS_SPAN      (1LL << 28)
+#define CLOCK_MAX_TIME_SPAN     (1LL << 30)
+
+/**
+ * Clock recovery of one program: the 27MHz system clock as a function of the
+ * position in the stream, fitted by least squares to the last CLOCK_WINDOW
+ * pcrs. Positions are in any unit that grows linearly with the bytes of the
+ * multiplex, bytes or packet counts, as long as the caller keeps to one.
+ *
+ * The fit is refreshed on each pcr from the samples of the window, relative
+ * to the newest one, with exact integer sums: it depends on nothing but the
+ * pcrs in the window, so two analyses that started at different points of
+ * the stream agree once they have seen the same pcrs. The pcrs are unwrapped
+ * across the 33-bit wrap; a discontinuity_indicator, a pcr going back, a gap
+ * above CLOCK_MAX_GAP or a pcr CLOCK_MAX_ERROR away from the fitted clock
+ * start a new segment and the clock is fitted to that pcr onwards.
+ *
+ * TimeAt is a multiply and an add, cheap enough to call for every packet.
+ */
+class CClockRecovery
+{
+public:
+    CClockRecovery()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        m_nCount = 0;
+        m_nHead = 0;
+        m_llLastPos = 0;
+        m_llLastPcr = -1;
+        m_llLastTime = 0;
+        m_fSlope = 0;
+        m_fIntercept = 0;
+    }
+
+    /// move the positions of the samples by llDelta, when the caller renumbers its positions
+    void Shift(long long llDelta)
+    {
+        for (int i = 0; i < CLOCK_WINDOW; i++)
+        {
+            m_pos[i] += llDelta;
+        }
+        m_llLastPos += llDelta;
+    }
+
+    /// signed difference a - b of two pcrs, across the wrap
+    static long long DiffPcr(long long a,long long b)
+    {
+        long long d = (a - b) % CLOCK_PCR_MODULUS;
+        if (d > CLOCK_PCR_MODULUS / 2)
+        {
+            d -= CLOCK_PCR_MODULUS;
+        }
+        else if (d <= -CLOCK_PCR_MODULUS / 2)
+        {
+            d += CLOCK_PCR_MODULUS;
+        }
+        return d;
+    }
+
+    /// signed difference a - b of two 33-bit pts/dts values, across the wrap
+    static long long DiffPts(long long a,long long b)
+    {
+        long long d = (a - b) % CLOCK_PTS_MODULUS;
+        if (d > CLOCK_PTS_MODULUS / 2)
+        {
+            d -= CLOCK_PTS_MODULUS;
+        }
+        else if (d <= -CLOCK_PTS_MODULUS / 2)
+        {
+            d += CLOCK_PTS_MODULUS;
+        }
+        return d;
+    }
+
+    /// add the pcr of the packet at llPos, false if it started a new segment
+    bool AddPcr(long long llPos,long long pcr,bool bDiscontinuity = false)
+    {
+        bool bContinuous = false;
+        long long time = pcr;
+        if (m_nCount > 0 && !bDiscontinuity)
+        {
+            long long dx = llPos - m_llLastPos;
+            long long dy = DiffPcr(pcr,m_llLastPcr);
+            if (dx > 0 && dy > 0 && dy <= CLOCK_MAX_GAP)
+            {
+                time = m_llLastTime + dy;
+                bContinuous = m_nCount < 2 || llabs(time - Predict(llPos)) <= CLOCK_MAX_ERROR;
+            }
+        }
+        if (!bContinuous)
+        {
+            m_nCount = 0;
+            time = pcr;
+        }
+
+        Push(llPos,time);
+        m_llLastPos = llPos;
+        m_llLastPcr = pcr;
+        m_llLastTime = time;
+        Fit();
+        return bContinuous;
+    }
+
+    /**
+     * system clock at llPos, in [0,CLOCK_PCR_MODULUS). -1 before the first
+     * pcr, the last pcr while the segment has a single one.
+     */
+    long long TimeAt(long long llPos) const
+    {
+        if (m_nCount < 2)
+        {
+            return m_llLastPcr;
+        }
+        long long t = Predict(llPos) % CLOCK_PCR_MODULUS;
+        return t < 0 ? t + CLOCK_PCR_MODULUS : t;
+    }
+
+    /// the segment has at least two pcrs, so the rate is known
+    bool IsLocked() const { return m_nCount >= 2; }
+
+    /// last pcr added, -1 if none
+    long long GetLastPcr() const { return m_llLastPcr; }
+
+    /// position units per second, 0 until locked
+    double GetRate() const { return m_nCount >= 2 && m_fSlope > 0 ? 27000000.0 / m_fSlope : 0; }
+
+private:
+    //unwrapped clock at llPos from the fit around the newest sample
+    long long Predict(long long llPos) const
+    {
+        double v = m_fIntercept + m_fSlope * (double)(llPos - m_llLastPos);
+        return m_llLastTime + (long long)(v < 0 ? v - 0.5 : v + 0.5);
+    }
+
+    void Push(long long llPos,long long time)
+    {
+        //drop the oldest samples beyond the window
+        while (m_nCount > 0)
+        {
+            int oldest = (m_nHead + CLOCK_WINDOW - m_nCount) % CLOCK_WINDOW;
+            if (m_nCount < CLOCK_WINDOW
+                && llPos - m_pos[oldest] <= CLOCK_MAX_POS_SPAN
+                && time - m_time[oldest] <= CLOCK_MAX_TIME_SPAN)
+            {
+                break;
+            }
+            m_nCount--;
+        }
+        m_pos[m_nHead] = llPos;
+        m_time[m_nHead] = time;
+        m_nHead = (m_nHead + 1) % CLOCK_WINDOW;
+        m_nCount++;
+    }
+
+    void Fit()
+    {
+        if (m_nCount < 2)
+        {
+            m_fSlope = 0;
+            m_fIntercept = 0;
+            return;
+        }
+
+        long long sx = 0;
+        long long sy = 0;
+        long long sxx = 0;
+        long long sxy = 0;
+        for (int i = 0; i < m_nCount; i++)
+        {
+            int k = (m_nHead + CLOCK_WINDOW - 1 - i) % CLOCK_WINDOW;
+            long long x = m_pos[k] - m_llLastPos;
+            long long y = m_time[k] - m_llLastTime;
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+        }
+
+        double n = m_nCount;
+        double mx = sx / n;
+        double my = sy / n;
+        double varx = (double)sxx - sx * mx;
+        double cov = (double)sxy - sx * my;
+        m_fSlope = varx > 0 ? cov / varx : 0;
+        m_fIntercept = my - m_fSlope * mx;
+    }
+
+private:
+    long long m_pos[CLOCK_WINDOW];
+    long long m_time[CLOCK_WINDOW];     //unwrapped pcrs of the segment
+    int m_nHead;                        //slot of the next sample
+    int m_nCount;                       //samples of the segment in the window
+
+    long long m_llLastPos;
+    long long m_llLastPcr;
+    long long m_llLastTime;
+
+    //clock = m_llLastTime + m_fIntercept + m_fSlope * (pos - m_llLastPos)
+    double m_fSlope;
+    double m_fIntercept;
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Crc32.h"
+#include <stddef.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CRC32_X86
+#include <immintrin.h>
+#endif
+
+#define CRC32_MPEG_POLY 0x04C11DB7
+
+typedef struct _CRC32_TABLES_T
+{
+    //t[k][b]: crc register of byte b followed by k zero bytes
+    unsigned int t[8][256];
+
+    //x^n mod P, folding a 128 bit block 64 bytes (k4) or 16 bytes (k1) ahead
+    unsigned long long k4_lo;   //x^512
+    unsigned long long k4_hi;   //x^576
+    unsigned long long k1_lo;   //x^128
+    unsigned long long k1_hi;   //x^192
+}CRC32_TABLES_T;
+
+
+static unsigned int XPowMod(int n)
+{
+    unsigned int r = 1;
+    for (int i = 0; i < n; i++)
+        r = (r << 1) ^ ((r & 0x80000000) ? CRC32_MPEG_POLY : 0);
+    return r;
+}
+
+static CRC32_TABLES_T* MakeTables()
+{
+    static CRC32_TABLES_T tab;
+    for (int b = 0; b < 256; b++)
+    {
+        unsigned int r = (unsigned int)b << 24;
+        for (int i = 0; i < 8; i++)
+            r = (r << 1) ^ ((r & 0x80000000) ? CRC32_MPEG_POLY : 0);
+        tab.t[0][b] = r;
+    }
+    for (int k = 1; k < 8; k++)
+    {
+        for (int b = 0; b < 256; b++)
+            tab.t[k][b] = (tab.t[k-1][b] << 8) ^ tab.t[0][tab.t[k-1][b] >> 24];
+    }
+
+    tab.k4_lo = XPowMod(512);
+    tab.k4_hi = XPowMod(576);
+    tab.k1_lo = XPowMod(128);
+    tab.k1_hi = XPowMod(192);
+    return &tab;
+}
+
+static const CRC32_TABLES_T& GetTables()
+{
+    static const CRC32_TABLES_T* pTables = MakeTables();
+    return *pTables;
+}
+
+static unsigned int Crc32Slice8(const CRC32_TABLES_T& tab,const BYTE* p,int n,unsigned int crc)
+{
+    const unsigned int (*t)[256] = tab.t;
+    for (; n >= 8; n -= 8, p += 8)
+    {
+        crc ^= ((unsigned int)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xFF] ^ t[5][(crc >> 8) & 0xFF] ^ t[4][crc & 0xFF]
+            ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; n > 0; n--, p++)
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *p];
+    return crc;
+}
+
+#ifdef CRC32_X86
+
+/*
+ * The bytes of a 16 byte block are reversed so that bit i of the register is
+ * the coefficient of x^i, the first byte on top. A block X is carried over the
+ * next n bits as X_hi * (x^(n+64) mod P) + X_lo * (x^n mod P), products of at
+ * most 95 bits which keep X congruent mod P. What is left at the end goes
+ * through the tables, whose crc of 16 bytes from 0 is exactly X * x^32 mod P.
+ */
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i Crc32Fold(__m128i x,__m128i k,__m128i next)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x,k,0x11),_mm_clmulepi64_si128(x,k,0x00)),next);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static unsigned int Crc32Clmul(const CRC32_TABLES_T& tab,const BYTE* p,int n,unsigned int crc)
+{
+    const __m128i swap = _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+    const __m128i k4 = _mm_set_epi64x((long long)tab.k4_hi,(long long)tab.k4_lo);
+    const __m128i k1 = _mm_set_epi64x((long long)tab.k1_hi,(long long)tab.k1_lo);
+
+    __m128i x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p),swap);
+    __m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+16)),swap);
+    __m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+32)),swap);
+    __m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+48)),swap);
+
+    //the register so far is added to the first 32 bits
+    x0 = _mm_xor_si128(x0,_mm_set_epi32((int)crc,0,0,0));
+    p += 64;
+    n -= 64;
+
+    for (; n >= 64; n -= 64, p += 64)
+    {
+        x0 = Crc32Fold(x0,k4,_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p),swap));
+        x1 = Crc32Fold(x1,k4,_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+16)),swap));
+        x2 = Crc32Fold(x2,k4,_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+32)),swap));
+        x3 = Crc32Fold(x3,k4,_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+48)),swap));
+    }
+
+    __m128i x = Crc32Fold(x0,k1,x1);
+    x = Crc32Fold(x,k1,x2);
+    x = Crc32Fold(x,k1,x3);
+    for (; n >= 16; n -= 16, p += 16)
+    {
+        x = Crc32Fold(x,k1,_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p),swap));
+    }
+
+    BYTE block[16];
+    _mm_storeu_si128((__m128i*)block,_mm_shuffle_epi8(x,swap));
+    crc = Crc32Slice8(tab,block,16,0);
+    return Crc32Slice8(tab,p,n,crc);
+}
+
+static bool HasClmul()
+{
+    static const bool bClmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+    return bClmul;
+}
+
+#endif //CRC32_X86
+
+
+unsigned int Crc32Mpeg(const BYTE* pData,int nLength,unsigned int crc)
+{
+    if (pData == NULL || nLength <= 0)
+        return crc;
+
+    const CRC32_TABLES_T& tab = GetTables();
+#ifdef CRC32_X86
+    if (nLength >= 64 && HasClmul())
+        return Crc32Clmul(tab,pData,nLength,crc);
+#endif
+    return Crc32Slice8(tab,pData,nLength,crc);
+}
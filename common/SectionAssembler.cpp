@@ -0,0 +1,217 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SectionAssembler.h"
+#include "Crc32.h"
+#include <string.h>
+#include <algorithm>
+
+//section_syntax_indicator 0 marks a short section without CRC_32, TOT excepted
+static inline bool IsSectionValid(const BYTE* pData,int nLength)
+{
+    if (!(pData[1] & 0x80) && pData[0] != 0x73)
+    {
+        return true;
+    }
+    return CheckSectionCrc(pData,nLength);
+}
+
+CSectionAssembler::CSectionAssembler()
+{
+    m_pSlots = new SECTION_SLOT_T[SECTION_PID_COUNT];
+    for (int i = 0; i < SECTION_PID_COUNT; i++)
+    {
+        m_pSlots[i].pData = NULL;
+        m_pSlots[i].nSize = 0;
+        m_pSlots[i].last_cc = -1;
+        m_pSlots[i].bEnabled = false;
+    }
+}
+
+CSectionAssembler::~CSectionAssembler()
+{
+    delete [] m_pSlots;
+    for (size_t i = 0; i < m_vecSlab.size(); i++)
+    {
+        delete [] m_vecSlab[i];
+    }
+}
+
+void CSectionAssembler::AddConsumer(ISectionConsumer* pConsumer)
+{
+    if (std::find(m_vecConsumer.begin(),m_vecConsumer.end(),pConsumer) == m_vecConsumer.end())
+    {
+        m_vecConsumer.push_back(pConsumer);
+    }
+}
+
+void CSectionAssembler::Reset()
+{
+    for (int i = 0; i < SECTION_PID_COUNT; i++)
+    {
+        ReleaseSlot(m_pSlots[i]);
+        m_pSlots[i].last_cc = -1;
+    }
+}
+
+BYTE* CSectionAssembler::AcquireSlot()
+{
+    if (m_vecFree.empty())
+    {
+        BYTE* pSlab = new BYTE[SECTION_SLAB_SLOTS * SECTION_MAX_SIZE];
+        m_vecSlab.push_back(pSlab);
+        for (int i = SECTION_SLAB_SLOTS - 1; i >= 0; i--)
+        {
+            m_vecFree.push_back(pSlab + i * SECTION_MAX_SIZE);
+        }
+    }
+    BYTE* pData = m_vecFree.back();
+    m_vecFree.pop_back();
+    return pData;
+}
+
+void CSectionAssembler::ReleaseSlot(SECTION_SLOT_T& slot)
+{
+    if (slot.pData != NULL)
+    {
+        m_vecFree.push_back(slot.pData);
+        slot.pData = NULL;
+    }
+    slot.nSize = 0;
+}
+
+void CSectionAssembler::Push(const BYTE* pPacket)
+{
+    if (pPacket[0] != 0x47 || !(pPacket[3] & 0x10))
+    {
+        return; //sync byte error or no payload
+    }
+
+    int pid = ((pPacket[1] & 0x1F) << 8) | pPacket[2];
+    SECTION_SLOT_T& slot = m_pSlots[pid];
+    if (!slot.bEnabled)
+    {
+        return;
+    }
+
+    int cc = pPacket[3] & 0x0F;
+    if (slot.last_cc >= 0)
+    {
+        if (cc == slot.last_cc)
+        {
+            return; //duplicate packet
+        }
+        if (cc != ((slot.last_cc + 1) & 0x0F))
+        {
+            ReleaseSlot(slot);
+        }
+    }
+    slot.last_cc = cc;
+
+    int pos = 4;
+    if (pPacket[3] & 0x20)
+    {
+        pos += 1 + pPacket[4];
+    }
+    if (pos >= 188)
+    {
+        return;
+    }
+
+    const BYTE* p = pPacket + pos;
+    int n = 188 - pos;
+
+    if (!(pPacket[1] & 0x40))
+    {
+        if (slot.pData != NULL)
+        {
+            Feed(pid,slot,p,n,false);
+        }
+    }
+    else
+    {
+        int pointer = p[0];
+        p++;
+        n--;
+        if (pointer >= n)
+        {
+            ReleaseSlot(slot);
+            return;
+        }
+
+        //the bytes before the pointer end the section in progress
+        if (slot.pData != NULL)
+        {
+            Feed(pid,slot,p,pointer,false);
+            ReleaseSlot(slot);
+        }
+        Feed(pid,slot,p + pointer,n - pointer,true);
+    }
+
+    if (slot.pData != NULL && slot.nSize == 0)
+    {
+        ReleaseSlot(slot);
+    }
+}
+
+void CSectionAssembler::Feed(int pid,SECTION_SLOT_T& slot,const BYTE* p,int n,bool bStart)
+{
+    while (n > 0)
+    {
+        if (slot.nSize == 0)
+        {
+            //stuffing after the last section of the packet
+            if (!bStart || p[0] == 0xFF)
+            {
+                return;
+            }
+            if (slot.pData == NULL)
+            {
+                slot.pData = AcquireSlot();
+            }
+        }
+
+        //the 3 header bytes first, then the rest once section_length is known
+        int total = 3;
+        if (slot.nSize >= 3)
+        {
+            total = (((slot.pData[1] & 0x0F) << 8) | slot.pData[2]) + 3;
+        }
+
+        int copy = total - slot.nSize;
+        if (copy > n)
+        {
+            copy = n;
+        }
+        memcpy(slot.pData + slot.nSize,p,copy);
+        slot.nSize += copy;
+        p += copy;
+        n -= copy;
+
+        if (slot.nSize >= 3 && slot.nSize == (((slot.pData[1] & 0x0F) << 8) | slot.pData[2]) + 3)
+        {
+            if (!m_vecConsumer.empty())
+            {
+                SECTION_SPAN_T section;
+                section.pid = pid;
+                section.pData = slot.pData;
+                section.nLength = slot.nSize;
+                section.bValid = IsSectionValid(slot.pData,slot.nSize);
+                for (size_t i = 0; i < m_vecConsumer.size(); i++)
+                {
+                    m_vecConsumer[i]->OnSection(section);
+                }
+            }
+            slot.nSize = 0;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SECTIONASSEMBLER_H
+#define SECTIONASSEMBLER_H
+
+#include "ztypes.h"
+#include <vector>
+
+#define SECTION_PID_COUNT 8192
+
+//section_length has 12 bits, a section is at most 4095+3 bytes
+#define SECTION_MAX_SIZE 4098
+
+//reassembly slots carved out of one slab allocation
+#define SECTION_SLAB_SLOTS 16
+
+//a complete section, from table_id to the last byte (CRC_32 included)
+typedef struct _SECTION_SPAN_T
+{
+    int pid;
+    const BYTE* pData;
+    int nLength;
+    bool bValid;        //CRC_32 is right, or a short section without one (TOT excepted)
+}SECTION_SPAN_T;
+
+/**
+ * Receives the sections put together by CSectionAssembler. The span points
+ * into the reassembly slot of the pid and is only valid during the call, a
+ * consumer that keeps the section copies it.
+ */
+class ISectionConsumer
+{
+public:
+    virtual ~ISectionConsumer() {}
+
+    virtual void OnSection(const SECTION_SPAN_T& section) = 0;
+};
+
+/**
+ * Per-PID section reassembly into fixed slots, shared by the tr 101 290
+ * checks and the table analyzer: a section is put together and its CRC_32
+ * checked once, then handed to every consumer in the order they were added.
+ *
+ * Only the pids added with AddPid are reassembled. A pid takes a
+ * SECTION_MAX_SIZE slot when a section starts and gives it back once no
+ * section is in progress, so only pids in the middle of a section hold one.
+ * Slots come from slabs of SECTION_SLAB_SLOTS and are kept on a free list:
+ * after the first sections no memory is allocated, however many sections the
+ * stream carries.
+ *
+ * All the sections of a packet are handed over: the end of the previous one
+ * before the pointer_field, then every section starting in the packet up to
+ * the stuffing. A continuity_counter gap drops the section in progress.
+ */
+class CSectionAssembler
+{
+public:
+    CSectionAssembler();
+    ~CSectionAssembler();
+
+    //a consumer is added once, later calls with it are ignored
+    void AddConsumer(ISectionConsumer* pConsumer);
+
+    //reassemble the sections of pid from now on
+    void AddPid(int pid) { m_pSlots[pid & 0x1FFF].bEnabled = true; }
+    bool HasPid(int pid) const { return m_pSlots[pid & 0x1FFF].bEnabled; }
+
+    //pPacket: a ts packet, its first 188 bytes are used. other pids are ignored
+    void Push(const BYTE* pPacket);
+
+    //drop the sections in progress, the slots go back to the free list.
+    //pids and consumers are kept
+    void Reset();
+
+private:
+    typedef struct _SECTION_SLOT_T
+    {
+        BYTE* pData;        //NULL while no section is in progress
+        int nSize;
+        int last_cc;        //-1 until the first packet with payload
+        bool bEnabled;
+    }SECTION_SLOT_T;
+
+    //copy what the section in progress still needs, hand it over when complete.
+    //bStart: new sections may begin, the packet has payload_unit_start_indicator
+    void Feed(int pid,SECTION_SLOT_T& slot,const BYTE* p,int n,bool bStart);
+
+    BYTE* AcquireSlot();
+    void ReleaseSlot(SECTION_SLOT_T& slot);
+
+private:
+    std::vector<ISectionConsumer*> m_vecConsumer;
+    SECTION_SLOT_T* m_pSlots;
+    std::vector<BYTE*> m_vecSlab;
+    std::vector<BYTE*> m_vecFree;
+};
+
+#endif //SECTIONASSEMBLER_H
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SyncScan.h"
+#include <stddef.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SYNCSCAN_X86
+#include <immintrin.h>
+#endif
+
+#define SYNC_BYTE 0x47
+
+static const int s_tsLengths[] = {188,204,192};
+
+
+static int FindSyncLatticeC(const BYTE* pData,int nBegin,int nSearch,int nStride,int nCount)
+{
+    for (int i = nBegin; i < nSearch; i++)
+    {
+        if (pData[i] != SYNC_BYTE)
+            continue;
+
+        int k = 1;
+        while (k < nCount && pData[i+k*nStride] == SYNC_BYTE)
+            k++;
+        if (k == nCount)
+            return i;
+    }
+    return -1;
+}
+
+#ifdef SYNCSCAN_X86
+
+#ifdef __SSE2__
+static int FindSyncLatticeSse2(const BYTE* pData,int nSearch,int nStride,int nCount)
+{
+    const __m128i sync = _mm_set1_epi8(SYNC_BYTE);
+    int i = 0;
+    for (; i + 16 <= nSearch; i += 16)
+    {
+        //bit n of mask: position i+n has a sync byte in all rows checked so far
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pData+i)),sync));
+        for (int k = 1; k < nCount && mask != 0; k++)
+        {
+            mask &= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pData+i+k*nStride)),sync));
+        }
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+    return FindSyncLatticeC(pData,i,nSearch,nStride,nCount);
+}
+#endif
+
+__attribute__((target("avx2")))
+static int FindSyncLatticeAvx2(const BYTE* pData,int nSearch,int nStride,int nCount)
+{
+    const __m256i sync = _mm256_set1_epi8(SYNC_BYTE);
+    int i = 0;
+    for (; i + 32 <= nSearch; i += 32)
+    {
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(pData+i)),sync));
+        for (int k = 1; k < nCount && mask != 0; k++)
+        {
+            mask &= (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(pData+i+k*nStride)),sync));
+        }
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+    return FindSyncLatticeC(pData,i,nSearch,nStride,nCount);
+}
+
+static bool HasAvx2()
+{
+    static const bool bAvx2 = __builtin_cpu_supports("avx2");
+    return bAvx2;
+}
+
+#endif //SYNCSCAN_X86
+
+
+int FindSyncLattice(const BYTE* pData,int nSearch,int nStride,int nCount)
+{
+    if (pData == NULL || nSearch <= 0 || nCount <= 0)
+        return -1;
+
+#ifdef SYNCSCAN_X86
+    if (HasAvx2())
+        return FindSyncLatticeAvx2(pData,nSearch,nStride,nCount);
+#ifdef __SSE2__
+    return FindSyncLatticeSse2(pData,nSearch,nStride,nCount);
+#endif
+#endif
+    return FindSyncLatticeC(pData,0,nSearch,nStride,nCount);
+}
+
+int DetectTsLength(const BYTE* pData,int nLength,int& nSyncByte)
+{
+    nSyncByte = 0;
+    int ret = -1;
+    int nBest = -1;
+    for (size_t n = 0; n < sizeof(s_tsLengths)/sizeof(s_tsLengths[0]); n++)
+    {
+        int nStride = s_tsLengths[n];
+        int nSearch = nLength - nStride*(SYNC_LATTICE_COUNT-1);
+
+        //only a lower offset beats an earlier packet length
+        if (nBest >= 0 && nBest < nSearch)
+            nSearch = nBest;
+
+        int nOffset = FindSyncLattice(pData,nSearch,nStride);
+        if (nOffset >= 0)
+        {
+            nBest = nOffset;
+            ret = nStride;
+        }
+    }
+
+    if (nBest >= 0)
+        nSyncByte = nBest;
+    return ret;
+}
+
+int FindSyncError(const BYTE* pData,int nLength,int nStride)
+{
+    for (int i = 0; i < nLength; i += nStride)
+    {
+        if (pData[i] != SYNC_BYTE)
+            return i;
+    }
+    return -1;
+}
@@ -0,0 +1,44 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SYNCSCAN_H
+#define SYNCSCAN_H
+
+#include "ztypes.h"
+
+//consecutive sync bytes needed to accept a packet lattice
+#define SYNC_LATTICE_COUNT 5
+
+/**
+ * Sync byte scanner shared by the file probe, the tr101290 resync and the
+ * live input check. The lattice search compares 16 or 32 start positions at
+ * once with SSE2/AVX2 when the cpu has them and falls back to a byte loop.
+ */
+
+/**
+ * @brief find the first start position in [0,nSearch) followed by nCount sync
+ *        bytes nStride apart. nSearch-1+nStride*(nCount-1) bytes must be readable
+ * @return offset of the first packet, -1 if none
+ */
+int FindSyncLattice(const BYTE* pData,int nSearch,int nStride,int nCount = SYNC_LATTICE_COUNT);
+
+/**
+ * @brief detect the packet length (188, 204 or 192) and the offset of the first
+ *        packet. the lattice at the lowest offset wins, on a tie 188 before 204 before 192
+ * @return packet length, -1 if no lattice found
+ */
+int DetectTsLength(const BYTE* pData,int nLength,int& nSyncByte);
+
+//offset of the first packet in pData whose sync byte is wrong, -1 if all are right
+int FindSyncError(const BYTE* pData,int nLength,int nStride);
+
+#endif
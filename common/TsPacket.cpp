@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "TsPacket.h"
 #include "zbitop.h"
 #include "jmdec.h"
+#include "BitReader.h"
 #include <assert.h>
 
 
@@ -69,58 +70,16 @@ void CTsPacket::RemoveAfField()
 		{
 			*(m_pPacket +5) =0;
 			memset(m_pPacket +6,0xff,(*(m_pPacket +4))-1);
+			ParseTsPacketInfo(m_pPacket,m_info);
 		}
 	}
 }
 
 
-bool CTsPacket::SetPacket(BYTE *pPacket)
-{
-	if((*pPacket) != 0x47)
-		return false;
-
-	m_pPacket =pPacket;
-	return true;
-}
-
-bool CTsPacket::Get_transport_error_indicator()
-{
-	return (*(m_pPacket +1))&0x80;
-}
-
-bool CTsPacket::Get_payload_unit_start_indicator()
-{
-	return (*(m_pPacket +1))&0x40;
-}
-
-bool CTsPacket::Get_transport_priority()
-{
-	return (*(m_pPacket +1))&0x20;
-}
-
-
-WORD CTsPacket::Get_PID()
-{
- 	return (((*(m_pPacket +1))&0x1f)<<8)|(*(m_pPacket +2));
-}
-
-BYTE CTsPacket::Get_transport_scrambling_control()
-{
-	return (*(m_pPacket +3))>>6;
-}
-
-BYTE CTsPacket::Get_adaptation_field_control()
-{
-	return (*(m_pPacket +3) & 0x30)>>4;
-}
-BYTE CTsPacket::Get_continuity_counter()
-{
-	return (*(m_pPacket +3) & 0x0f);
-}
-
 void CTsPacket::Set_continuity_counter(BYTE Counter)
 {
 	(*(m_pPacket + 3)) = ((*(m_pPacket + 3)) & 0xf0 ) | (Counter & 0x0f);
+	m_info.cc = Counter & 0x0f;
 }
 
 
@@ -163,17 +122,6 @@ bool CTsPacket::Get_PCR_flag(BYTE *pAF_Data)
 	return ((*(pAF_Data+1))>>4) & 0x01;
 }
 
-bool CTsPacket::Get_PCR_flag()
-{
-	BYTE *af;
-	BYTE size;
-	if((af = Get_adaptation_field(size)) == NULL)
-		return false;
-	else
-		return ((*(af+1))>>4) & 0x01;
-}
-
-
 bool CTsPacket::Get_OPCR_flag(BYTE *pAF_Data)
 {
 	return ((*(pAF_Data+1))>>3) & 0x01;
@@ -234,18 +182,6 @@ PCR CTsPacket::Get_PCR(BYTE *pAF_Data)
 		return INVALID_PCR;
 }
 
-PCR CTsPacket::Get_PCR()
-{
-	BYTE size;
-	BYTE *af;
-	if((af = Get_adaptation_field(size)) != NULL)
-	{
-		if(size != 0)
-			return Get_PCR(af);
-	}
-	return INVALID_PCR;
-}
-
 //δʵ
 __int64 CTsPacket::Get_original_program_clock_reference_base(BYTE *pAF_Data)
 {
@@ -358,8 +294,7 @@ BYTE * CTsPacket::Get_Data(BYTE &Size)
 	}
 	else if(afc == 0x03)
 	{
-		BYTE af_length;
-		Get_adaptation_field(af_length);
+		BYTE af_length = *(m_pPacket +4) +1;//˳ֶ
 		Size = TS_PACKET_LENGTH_STANDARD - 4 - af_length;
 		return m_pPacket +4 +af_length;
 	}
@@ -375,6 +310,7 @@ void CTsPacket::Set_PID(PID pid)
 {
 	(*(m_pPacket +1)) = (pid>>8) | ((*(m_pPacket +1)) & 0xe0);
 	(*(m_pPacket +2)) = (BYTE)pid ;
+	m_info.pid = pid & 0x1FFF;
 }
 
 bool CTsPacket::Set_PCR(PCR pcr)
@@ -403,37 +339,11 @@ bool CTsPacket::Set_PCR(PCR pcr)
 			*(af+5) = (BYTE)((base>>1) & 0xff);
 			*(af+6) = (BYTE)(((base & 0x01)<<7) | 0x7e | (ext>>8));
 			*(af+7) = (BYTE)(ext & 0xff );
+			m_info.pcr = pcr;
 		}
 	}
 	return false;
 }
-bool CTsPacket::Get_PES_stream_id(BYTE &stream_id)
-{
-	if(!Get_payload_unit_start_indicator())
-	{
-		return false;
-	}
-
-	BYTE size;
-	BYTE *p_data;
-	if((p_data = Get_Data(size)) == NULL)
-	{
-		return false;
-	}
-
-	if(size <4)
-	{
-		return false;
-	}
-	if((p_data[0] == 0) &&
-			(p_data[1] == 0) &&
-			(p_data[2] == 1))
-	{
-		stream_id = p_data[3];
-		return true;
-	}
-	return false;
-}
 bool	CTsPacket::Get_PES_GOP_INFO(DWORD &TimeCode/*ʱϢ*/)
 {
 	BYTE stream_id;
@@ -544,100 +454,6 @@ bool CTsPacket::Get_SectionInfo(WORD& section_length, BYTE& section_number,BYTE&
 	return true;
 }
 
-BYTE CTsPacket::Get_PTS_DTS_flag()
-{
-	if(!Get_payload_unit_start_indicator())
-	{
-		return false;
-	}
-	BYTE size;
-	BYTE flag;
-	BYTE *p_data;
-	if((p_data = Get_Data(size)) == NULL)
-	{
-		return false;
-	}
-
-	if(size <4)
-	{
-		return false;
-	}
-	if((p_data[0] == 0) &&
-		   (p_data[1] == 0) &&
-		   (p_data[2] == 1))
-	{
-		flag = p_data[7]; //from pts_dts_flags to pes_exteasion_flag
-		//return flag & 0xC0;
-		return flag >> 6;
-	}
-	return 0;
-}
-
-bool CTsPacket::Get_PTS(LONGLONG &pts)
-{
-    bool retval = false;
-    //ȼPES_FLAG
-    if(!Get_payload_unit_start_indicator())
-    {
-        return false;
-    }
-	BYTE* pData = m_pPacket;
-	BYTE adaptation_field_control = Get_adaptation_field_control();
-	if (adaptation_field_control == 2 || adaptation_field_control == 3)	//ֶ
-	{
-		int adaptation_field_length = *(m_pPacket + 4);
-		pData = pData + adaptation_field_length + 1; //ֶ
-	}
-    
-    //PESͷ
-    if((*(pData + 4) == 0x00) 
-          && (*(pData + 5) == 0x00) 
-          && (*(pData + 6) == 0x01))
-    {
-        //PESPTS־
-        if(ZBit::PointTest(pData + 11,0))
-        {
-            //ȡPTS
-            ZBIT_VAR_FROM_POINT(pts,pData + 13,-4,3,-1,15,-1,15);
-            retval = true;
-        }
-    }
-    return retval;
-}
-
-bool CTsPacket::Get_DTS(LONGLONG &dts)
-{
-    bool retval = false;
-    //ȼPES_FLAG
-    if(!Get_payload_unit_start_indicator())
-    {
-        return false;
-    }
-    
-	BYTE* pData = m_pPacket;
-	BYTE adaptation_field_control = Get_adaptation_field_control();
-	if (adaptation_field_control == 2 || adaptation_field_control == 3)	//ֶ
-	{
-		int adaptation_field_length = *(m_pPacket + 4);
-		pData = pData + adaptation_field_length + 1; //ֶ
-	}
-
-    //PESͷ
-    if((*(pData + 4) == 0x00) 
-          && (*(pData + 5) == 0x00) 
-          && (*(pData + 6) == 0x01))
-    {
-        //PESPTS־
-        if(ZBit::PointTest(pData + 11,1))
-        {
-            //ȡDTS
-            ZBIT_VAR_FROM_POINT(dts,pData + 13 + 5 ,-4,3,-1,15,-1,15);
-            retval = true;
-        }
-    }
-    return retval;
-}
-
 bool CTsPacket::H264_Get_slice_type(BYTE &SliceType/*10:IDR */)
 {
 	BYTE slice_type = -1;
@@ -675,13 +491,10 @@ bool CTsPacket::H264_Get_slice_type(BYTE &SliceType/*10:IDR */)
 			{
 				//slice_type = p_data[i+2+1+1];
 				
-				Bitstream currStream;
-				currStream.frame_bitoffset = 0;
-				currStream.streamBuffer = &p_data[i+2+1+1];
-				currStream.bitstream_length = 188 - (i+2+1+1) -1;
+				CBitReader bs(&p_data[i+2+1+1],188 - (i+2+1+1));
 				
-				ue_v ("SH: first_mb_in_slice", &currStream);
-				int tmp = ue_v ("SH: slice_type", &currStream);
+				bs.ReadUE();	//first_mb_in_slice
+				int tmp = bs.ReadUE();	//slice_type
 				if (tmp>4) tmp -=5;
 				
 				SliceType = tmp;
@@ -782,9 +595,6 @@ bool CTsPacket::H264_is_new_frame(int frame_mbs_only_flag,int log2_max_frame_num
 	{
 		return true;
 	}
-	Bitstream currStream;
-	currStream.frame_bitoffset = 0;
-	
 	BYTE nal_unit_type = 0;
 	BYTE *p_data=m_pPacket;
 	BYTE size=188-4;
@@ -815,25 +625,21 @@ bool CTsPacket::H264_is_new_frame(int frame_mbs_only_flag,int log2_max_frame_num
 			if (nal_unit_type >= 1 && nal_unit_type <= 5)
 			{
 				//slice_type = p_data[i+2+1+1];
-				Bitstream currStream;
-
-				currStream.frame_bitoffset = 0;
-				currStream.streamBuffer = &p_data[i+2+1+1];
-				currStream.bitstream_length = 188 - (i+2+1+1) -1;
+				CBitReader bs(&p_data[i+2+1+1],188 - (i+2+1+1));
 				
-				ue_v ("SH: first_mb_in_slice", &currStream);
-				ue_v ("SH: slice_type", &currStream);
-				ue_v ("SH: pic_parameter_set_id", &currStream);
+				bs.ReadUE();	//first_mb_in_slice
+				bs.ReadUE();	//slice_type
+				bs.ReadUE();	//pic_parameter_set_id
 
-				int frame_num = u_v (log2_max_frame_num_minus4 + 4, "SH: frame_num", &currStream);				
+				int frame_num = bs.GetBits(log2_max_frame_num_minus4 + 4);
 				
-				int field_pic_flag = u_1("SH: field_pic_flag", &currStream);
+				int field_pic_flag = bs.GetBit();
 				if (field_pic_flag == 0)
 				{
 					return true;
 				}
 
-				int bottom_field_flag = (byte) u_1("SH: bottom_field_flag", &currStream);
+				int bottom_field_flag = bs.GetBit();
 				if (bottom_field_flag)
 				{
 					return false;
@@ -851,9 +657,6 @@ bool CTsPacket::H264_is_new_frame(int frame_mbs_only_flag,int log2_max_frame_num
 
 int CTsPacket::H264_Get_NON_I_Frame_Num(int log2_max_frame_num_minus4)
 {
-	Bitstream currStream;
-	currStream.frame_bitoffset = 0;
-	
 	BYTE nal_unit_type = 0;
 	BYTE *p_data=m_pPacket;
 	BYTE size=188-4;
@@ -884,17 +687,13 @@ int CTsPacket::H264_Get_NON_I_Frame_Num(int log2_max_frame_num_minus4)
 			if (nal_unit_type >= 1 && nal_unit_type <= 5)
 			{
 				//slice_type = p_data[i+2+1+1];
-				Bitstream currStream;
-
-				currStream.frame_bitoffset = 0;
-				currStream.streamBuffer = &p_data[i+2+1+1];
-				currStream.bitstream_length = 188 - (i+2+1+1) -1;
+				CBitReader bs(&p_data[i+2+1+1],188 - (i+2+1+1));
 				
-				ue_v ("SH: first_mb_in_slice", &currStream);
-				ue_v ("SH: slice_type", &currStream);
-				ue_v ("SH: pic_parameter_set_id", &currStream);
+				bs.ReadUE();	//first_mb_in_slice
+				bs.ReadUE();	//slice_type
+				bs.ReadUE();	//pic_parameter_set_id
 
-				int frame_num = u_v (log2_max_frame_num_minus4 + 4, "SH: frame_num", &currStream);				
+				int frame_num = bs.GetBits(log2_max_frame_num_minus4 + 4);
 				
 				return frame_num;
 			}
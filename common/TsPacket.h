@@ -12,8 +12,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #pragma once
 #include "Dvb.h"
+//H264DecDll ʹ JM Լͷļ jmdec.h ͻ˺
+#ifndef TSPACKET_WITHOUT_JMDEC
 #include "jmdec.h"
+#endif
 #include "ztypes.h"
+#include "TsPacketInfo.h"
 #pragma warning (disable:4800)
 
 #define MPEG_FRAME_TYPE_I	1
@@ -27,7 +31,26 @@ public:
 	CTsPacket(void);
 	~CTsPacket(void);
 
-	 bool SetPacket(BYTE *pPacket);
+	//ͷֶΡPESͷһνãȡֱֵӶȡ
+	 bool SetPacket(BYTE *pPacket)
+	 {
+		 if (!ParseTsPacketInfo(pPacket,m_info))
+			 return false;
+		 m_pPacket = pPacket;
+		 return true;
+	 }
+
+	//Ѿİֱʹظ
+	 bool SetPacket(const TS_PACKET_INFO& info)
+	 {
+		 if (!info.sync)
+			 return false;
+		 m_info = info;
+		 m_pPacket = info.pPacket;
+		 return true;
+	 }
+
+	 const TS_PACKET_INFO& GetInfo() const { return m_info; }
 
 //Ϣ
 	 void Set_PID(PID pid);
@@ -35,13 +58,13 @@ public:
 	 void Set_continuity_counter(BYTE Counter);
 	 void RemoveAfField();
 //Ϣ
-	 bool Get_transport_error_indicator();
-	 bool Get_payload_unit_start_indicator();
-	 bool Get_transport_priority();
-	 WORD Get_PID();
-	 BYTE Get_transport_scrambling_control();
-	 BYTE Get_adaptation_field_control();
-	 BYTE Get_continuity_counter();
+	 bool Get_transport_error_indicator() { return m_info.tei; }
+	 bool Get_payload_unit_start_indicator() { return m_info.pusi; }
+	 bool Get_transport_priority() { return (*(m_pPacket +1))&0x20; }
+	 WORD Get_PID() { return m_info.pid; }
+	 BYTE Get_transport_scrambling_control() { return m_info.scrambling_control; }
+	 BYTE Get_adaptation_field_control() { return m_info.afc; }
+	 BYTE Get_continuity_counter() { return m_info.cc; }
 
 //ֶϢ
 	 BYTE * Get_adaptation_field(BYTE &Size);
@@ -50,7 +73,7 @@ public:
 	 bool Get_random_access_indicator(BYTE *pAF_Data);
 	 bool Get_elementary_stream_priority_indicator(BYTE *pAF_Data);
 	 bool Get_PCR_flag(BYTE *pAF_Data);
-	 bool Get_PCR_flag();
+	 bool Get_PCR_flag() { return m_info.pcr_flag; }
 	 bool Get_OPCR_flag(BYTE *pAF_Data);
 	 bool Get_splicing_point_flag(BYTE *pAF_Data);
 	 bool Get_transport_private_data_flag(BYTE *pAF_Data);
@@ -58,7 +81,8 @@ public:
 	 __int64 Get_program_clock_reference_base(BYTE *pAF_Data);
 	 WORD Get_program_clock_reference_extension(BYTE *pAF_Data);
 	 PCR  Get_PCR(BYTE *pAF_Data);
-	 PCR  Get_PCR();
+	 PCR  Get_PCR() { return m_info.pcr; }
+	 PCR  Get_OPCR() { return m_info.opcr; }
 
 	 __int64 Get_original_program_clock_reference_base(BYTE *pAF_Data);
 	 WORD Get_original_program_clock_reference_extension(BYTE *pAF_Data);
@@ -77,14 +101,32 @@ public:
 	 BYTE *Get_stuffing_byte(BYTE *pAF_Data,BYTE &Size);
 
 //ȡPES GOPϢ
-	 bool Get_PES_stream_id(BYTE &stream_id);
+	 bool Get_PES_stream_id(BYTE &stream_id)
+	 {
+		 if (m_info.pes_offset < 0)
+			 return false;
+		 stream_id = m_info.stream_id;
+		 return true;
+	 }
 	 bool Get_PES_GOP_INFO(DWORD &TimeCode/*ʱϢ*/);
 	 bool Get_PES_PIC_INFO(BYTE &PictureType/*ʱϢ*/);
-	 BYTE Get_PTS_DTS_flag();
+	 BYTE Get_PTS_DTS_flag() { return m_info.pts_dts_flags; }
 //ȡƵϢ
 	 bool Get_VIDEO_TYPE(BYTE &VideoType/*1-PAL,2-NTSC*/);
-	 bool Get_PTS(LONGLONG &pts);
-	 bool Get_DTS(LONGLONG &dts);
+	 bool Get_PTS(LONGLONG &pts)
+	 {
+		 if (m_info.pts < 0)
+			 return false;
+		 pts = m_info.pts;
+		 return true;
+	 }
+	 bool Get_DTS(LONGLONG &dts)
+	 {
+		 if (m_info.dts < 0)
+			 return false;
+		 dts = m_info.dts;
+		 return true;
+	 }
 //ȡЧ
 	 BYTE * Get_Data(BYTE &Size);
 //Section information
@@ -98,11 +140,16 @@ public:
 
 	 bool H264_is_new_frame(int frame_mbs_only_flag,int log2_max_frame_num_minus4);
 	 int H264_Get_NON_I_Frame_Num(int log2_max_frame_num_minus4);
+#ifndef TSPACKET_WITHOUT_JMDEC
 	 bool H264_Parse_sps(seq_parameter_set_rbsp_t* sps);
+#endif
 
 	 int Get_ES_pos();
 //ȡ
 	BYTE *m_pPacket;
+private:
+	//SetPacket ʱõİͷϢ޸İݵ Set_ ½
+	TS_PACKET_INFO m_info;
 };
 
 /*	======================================================
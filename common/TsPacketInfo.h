@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TSPACKETINFO_H
+#define TSPACKETINFO_H
+
+#include "Dvb.h"
+#include "ztypes.h"
+#include <string.h>
+
+//big endian loads of the packet fields, one load and a byte swap instead of
+//shifting the bytes in one by one
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#define TS_BSWAP16(x) _byteswap_ushort(x)
+#define TS_BSWAP32(x) _byteswap_ulong(x)
+#else
+#define TS_BSWAP16(x) __builtin_bswap16(x)
+#define TS_BSWAP32(x) __builtin_bswap32(x)
+#endif
+
+//hint the cache about the per-pid state of a packet a few packets ahead of
+//the one being processed, used by the batch entry points of the engines. The
+//packet bytes themselves are not prefetched, most packets are handled from
+//the decoded TS_PACKET_INFO alone
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define TS_PREFETCH(p) _mm_prefetch((const char*)(p),_MM_HINT_T0)
+#else
+#define TS_PREFETCH(p) __builtin_prefetch(p)
+#endif
+
+//how many packets ahead the batch loops prefetch
+#define TS_PREFETCH_DISTANCE 4
+
+inline WORD TsReadBE16(const BYTE* p)
+{
+    unsigned short v;
+    memcpy(&v,p,2);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return TS_BSWAP16(v);
+#endif
+}
+
+inline DWORD TsReadBE32(const BYTE* p)
+{
+    unsigned int v;
+    memcpy(&v,p,4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return TS_BSWAP32(v);
+#endif
+}
+
+//program_clock_reference_base(33) reserved(6) program_clock_reference_extension(9)
+inline PCR TsReadPCR(const BYTE* p)
+{
+    long long base = ((long long)TsReadBE32(p) << 1) | (p[4] >> 7);
+    return base * 300 + (TsReadBE16(p+4) & 0x1FF);
+}
+
+//pts/dts: 4 bits prefix, 3 bits, marker, 15 bits, marker, 15 bits, marker
+inline long long TsReadPTS(const BYTE* p)
+{
+    return ((long long)(p[0] & 0x0E) << 29) | ((long long)(TsReadBE16(p+1) >> 1) << 15) | (TsReadBE16(p+3) >> 1);
+}
+
+/**
+ * Header fields of one ts packet, decoded once and handed to every engine
+ * that looks at the packet (demux, program parser, tr101290, live pcr), so
+ * the hot path does not walk the header and the adaptation field again in
+ * each of them. The values follow the CTsPacket getters of the same name.
+ */
+typedef struct _TS_PACKET_INFO
+{
+    BYTE* pPacket;
+
+    bool sync;  //sync byte is 0x47, the other fields are valid only if true
+    WORD pid;
+    bool tei;
+    bool pusi;
+    BYTE scrambling_control;
+    BYTE afc;
+    BYTE cc;
+
+    //adaptation field
+    bool discontinuity;
+    bool pcr_flag;
+    PCR pcr;            //INVALID_PCR if no pcr
+    int pcr_offset;     //offset of program_clock_reference_base, -1 if no pcr
+    bool opcr_flag;
+    PCR opcr;           //INVALID_PCR if no opcr
+
+    int payload_offset; //-1 if no payload
+    int pes_offset;     //offset of the pes header in a pusi packet, -1 if none
+    BYTE stream_id;
+    BYTE pts_dts_flags;
+    long long pts;      //-1 if the pes header has no pts
+    long long dts;      //-1 if the pes header has no dts
+}TS_PACKET_INFO;
+
+
+inline bool ParseTsPacketInfo(BYTE* p,TS_PACKET_INFO& info)
+{
+    info.pPacket = p;
+    info.sync = (p[0] == 0x47);
+    if (!info.sync)
+    {
+        return false;
+    }
+
+    DWORD header = TsReadBE32(p);
+    info.tei = (header & 0x800000) != 0;
+    info.pusi = (header & 0x400000) != 0;
+    info.pid = (header >> 8) & 0x1FFF;
+    info.scrambling_control = (header >> 6) & 0x03;
+    info.afc = (header >> 4) & 0x03;
+    info.cc = header & 0x0F;
+
+    info.discontinuity = false;
+    info.pcr_flag = false;
+    info.pcr = INVALID_PCR;
+    info.pcr_offset = -1;
+    info.opcr_flag = false;
+    info.opcr = INVALID_PCR;
+
+    int payload = 4;
+    if (info.afc & 0x02)
+    {
+        int af_len = p[4];
+        if (af_len != 0)
+        {
+            info.discontinuity = (p[5] & 0x80) != 0;
+            int pos = 6;
+            if (p[5] & 0x10)
+            {
+                info.pcr_flag = true;
+                info.pcr_offset = 6;
+                info.pcr = TsReadPCR(p+6);
+                pos += 6;
+            }
+            if ((p[5] & 0x08) && pos + 6 <= 5 + af_len)
+            {
+                info.opcr_flag = true;
+                info.opcr = TsReadPCR(p+pos);
+            }
+        }
+        payload += af_len + 1;
+    }
+
+    info.payload_offset = (info.afc & 0x01) && payload < TS_PACKET_LENGTH_STANDARD ? payload : -1;
+    info.pes_offset = -1;
+    info.stream_id = 0;
+    info.pts_dts_flags = 0;
+    info.pts = -1;
+    info.dts = -1;
+    if (info.pusi && info.payload_offset >= 0 && TS_PACKET_LENGTH_STANDARD - info.payload_offset >= 4)
+    {
+        BYTE* pes = p + info.payload_offset;
+        if (pes[0] == 0 && pes[1] == 0 && pes[2] == 1)
+        {
+            info.pes_offset = info.payload_offset;
+            info.stream_id = pes[3];
+            //stream ids without the optional pes header, 13818-1 table 2-21, as in CPesAssembler
+            switch (info.stream_id)
+            {
+            case 0xBC: case 0xBE: case 0xBF:
+            case 0xF0: case 0xF1: case 0xF2:
+            case 0xF8: case 0xFF:
+                break;
+            default:
+                if (info.pes_offset + 9 <= TS_PACKET_LENGTH_STANDARD && (pes[6] & 0xC0) == 0x80)
+                {
+                    info.pts_dts_flags = pes[7] >> 6;
+                    if ((info.pts_dts_flags & 0x02) && info.pes_offset + 14 <= TS_PACKET_LENGTH_STANDARD)
+                    {
+                        info.pts = TsReadPTS(pes+9);
+                    }
+                    if (info.pts_dts_flags == 0x03 && info.pes_offset + 19 <= TS_PACKET_LENGTH_STANDARD)
+                    {
+                        info.dts = TsReadPTS(pes+14);
+                    }
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,276 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * Packet throughput of the analysis engines, each driven one packet at a
+ * time and through its batch entry point:
+ *
+ *   tr101290   Clibtr101290::AddPacket    / AddPackets
+ *   mpegdec    CMpegDec::ProcessBuffer    / ProcessPackets
+ *   demux      CDemuxTs::AddTsPacket      / AddTsPackets
+ *   livepcr    CLivePcrProc::ProcessBuffer, one packet / one datagram
+ *
+ * The packet headers are decoded once up front, as FileAnalysis and the udp
+ * live source do, so only the engines are timed.
+ *
+ * usage: test_app_bench file.ts [loops] [batch packets]
+ */
+
+#include "libtr101290.h"
+#include "MpegDec.h"
+#include "DemuxTs.h"
+#include "LivePcrProc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <set>
+
+//the same amount of data FileAnalysis probes before setting up the demux
+const int PROBE_SIZE = 188*204*128;
+
+static double Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void OnReport(REPORT_PARAM_T param)
+{
+}
+
+static BYTE* ReadFile(const char* path,int& nLen)
+{
+    FILE* fp = fopen(path,"rb");
+    if (fp == NULL)
+    {
+        return NULL;
+    }
+    fseek(fp,0,SEEK_END);
+    nLen = (int)ftell(fp);
+    fseek(fp,0,SEEK_SET);
+    BYTE* pData = new BYTE[nLen];
+    nLen = (int)fread(pData,1,nLen,fp);
+    fclose(fp);
+    return pData;
+}
+
+static int GetTsLength(const BYTE* pData,int nLen)
+{
+    int lens[] = {188,204,192};
+    for (int i = 0; i < 3; i++)
+    {
+        if (nLen >= lens[i] * 3 && pData[lens[i]] == 0x47 && pData[lens[i]*2] == 0x47)
+        {
+            return lens[i];
+        }
+    }
+    return 188;
+}
+
+static void FreePrograms(ALL_PROGRAM_INFO& programs)
+{
+    ALL_PROGRAM_INFO::iterator it = programs.begin();
+    for (; it != programs.end(); ++it)
+    {
+        delete it->second;
+    }
+    programs.clear();
+}
+
+struct BENCH_T
+{
+    BYTE* pData;
+    int nLen;
+    int nTsLength;
+    int nPackets;
+    int nBatch;
+    std::vector<TS_PACKET_INFO> vecInfo;
+};
+
+static double RunTr(BENCH_T& b,bool bBatch)
+{
+    Clibtr101290 tr;
+    tr.SetReportCB(OnReport,NULL);
+    tr.SetStartOffset(0);
+    tr.SetTsLen(b.nTsLength);
+
+    double t = Now();
+    if (bBatch)
+    {
+        for (int k = 0; k < b.nPackets; k += b.nBatch)
+        {
+            int n = b.nPackets - k < b.nBatch ? b.nPackets - k : b.nBatch;
+            tr.AddPackets(&b.vecInfo[k],n);
+        }
+    }
+    else
+    {
+        for (int k = 0; k < b.nPackets; k++)
+        {
+            tr.AddPacket(b.vecInfo[k].pPacket,&b.vecInfo[k]);
+        }
+    }
+    return Now() - t;
+}
+
+static double RunMpegDec(BENCH_T& b,bool bBatch)
+{
+    CMpegDec dec;
+    dec.Init(b.nTsLength,b.nPackets);
+    dec.ProbeMediaInfo(b.pData,b.nLen < PROBE_SIZE ? b.nLen : PROBE_SIZE);
+
+    double t = Now();
+    if (bBatch)
+    {
+        for (int k = 0; k < b.nPackets; k += b.nBatch)
+        {
+            int n = b.nPackets - k < b.nBatch ? b.nPackets - k : b.nBatch;
+            dec.ProcessPackets(&b.vecInfo[k],n);
+        }
+    }
+    else
+    {
+        for (int k = 0; k < b.nPackets; k++)
+        {
+            dec.ProcessBuffer(b.vecInfo[k].pPacket,b.nTsLength,&b.vecInfo[k]);
+        }
+    }
+    return Now() - t;
+}
+
+static double RunDemux(BENCH_T& b,bool bBatch)
+{
+    ALL_PROGRAM_INFO programs;
+    double t;
+    {
+        CDemuxTs demux;
+        demux.SetOutputBuffer(&programs);
+        demux.SetupDemux(b.pData,b.nLen < PROBE_SIZE ? b.nLen : PROBE_SIZE,b.nTsLength);
+
+        t = Now();
+        if (bBatch)
+        {
+            for (int k = 0; k < b.nPackets; k += b.nBatch)
+            {
+                int n = b.nPackets - k < b.nBatch ? b.nPackets - k : b.nBatch;
+                demux.AddTsPackets(&b.vecInfo[k],n);
+            }
+        }
+        else
+        {
+            CTsPacket tsPacket;
+            for (int k = 0; k < b.nPackets; k++)
+            {
+                if (!b.vecInfo[k].sync)
+                {
+                    continue;
+                }
+                tsPacket.SetPacket(b.vecInfo[k]);
+                demux.AddTsPacket(&tsPacket,b.vecInfo[k]);
+            }
+        }
+        t = Now() - t;
+    }
+    FreePrograms(programs);
+    return t;
+}
+
+static double RunLivePcr(BENCH_T& b,bool bBatch)
+{
+    //one udp datagram carries 7 packets
+    const int DATAGRAM_PACKETS = 7;
+    int nInterval = 1000;
+
+    CLivePcrProc proc;
+    proc.SetTsLength(b.nTsLength);
+    proc.SetCalcTsRateIntervalTime(&nInterval);
+
+    std::set<int> pcrPids;
+    for (int k = 0; k < b.nPackets; k++)
+    {
+        if (b.vecInfo[k].sync && b.vecInfo[k].pcr_flag)
+        {
+            pcrPids.insert(b.vecInfo[k].pid);
+        }
+    }
+    std::set<int>::iterator it = pcrPids.begin();
+    for (; it != pcrPids.end(); ++it)
+    {
+        proc.AddPcrPid(*it);
+    }
+
+    int nStep = bBatch ? DATAGRAM_PACKETS : 1;
+    double t = Now();
+    for (int k = 0; k < b.nPackets; k += nStep)
+    {
+        int n = b.nPackets - k < nStep ? b.nPackets - k : nStep;
+        proc.ProcessBuffer(b.vecInfo[k].pPacket,n * b.nTsLength,(long long)k * 1000,&b.vecInfo[k]);
+    }
+    return Now() - t;
+}
+
+static void Report(const char* name,BENCH_T& b,int nLoops,double (*pfRun)(BENCH_T&,bool))
+{
+    double single = 0;
+    double batch = 0;
+    for (int i = 0; i < nLoops; i++)
+    {
+        single += pfRun(b,false);
+        batch += pfRun(b,true);
+    }
+
+    double total = (double)b.nPackets * nLoops;
+    printf("%-10s %14.0f %14.0f %8.2fx\n",name,total / single,total / batch,single / batch);
+}
+
+int main(int argc,char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: %s file.ts [loops] [batch packets]\n",argv[0]);
+        return 1;
+    }
+
+    BENCH_T b;
+    b.pData = ReadFile(argv[1],b.nLen);
+    if (b.pData == NULL)
+    {
+        printf("can not read %s\n",argv[1]);
+        return 1;
+    }
+    int nLoops = argc > 2 ? atoi(argv[2]) : 5;
+    b.nBatch = argc > 3 ? atoi(argv[3]) : 4096;
+    b.nTsLength = GetTsLength(b.pData,b.nLen);
+    b.nPackets = b.nLen / b.nTsLength;
+    if (nLoops <= 0 || b.nBatch <= 0 || b.nPackets == 0)
+    {
+        printf("nothing to do\n");
+        return 1;
+    }
+
+    b.vecInfo.resize(b.nPackets);
+    for (int k = 0; k < b.nPackets; k++)
+    {
+        ParseTsPacketInfo(b.pData + k * b.nTsLength,b.vecInfo[k]);
+    }
+
+    printf("%s: %d packets of %d bytes, %d loops, batch %d\n",argv[1],b.nPackets,b.nTsLength,nLoops,b.nBatch);
+    printf("%-10s %14s %14s %9s\n","engine","per-packet/s","batch/s","speedup");
+    Report("tr101290",b,nLoops,RunTr);
+    Report("mpegdec",b,nLoops,RunMpegDec);
+    Report("demux",b,nLoops,RunDemux);
+    Report("livepcr",b,nLoops,RunLivePcr);
+
+    delete [] b.pData;
+    return 0;
+}
@@ -3,3 +3,4 @@ export LD_LIBRARY_PATH=../sdk/lib:/usr/local/lib
 g++ -g file.cpp -o test_app_file -I../sdk/include -L../sdk/lib -L/usr/local/lib -leasyice -ltr101290 -ldvbpsi
 g++ -g udplive.cpp -o test_app_udplive -I../sdk/include -L../sdk/lib -leasyice -ltr101290 -ldvbpsi
 g++ -g hls.cpp -o test_app_hls -I../sdk/include -L../sdk/lib  -lhlsanalysis -ldvbpsi -ltr101290 -lcurl -leasyice
+g++ -O2 bench.cpp -o test_app_bench -I../libeasyice/src -I../common -I../sdk/include -I../libeasyice/src/EasyICEDLL -I../libeasyice/src/H264DecDll -L../sdk/lib -L/usr/local/lib -leasyice -ltr101290 -ldvbpsi -lpthread
@@ -0,0 +1,174 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BatchAnalysis.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include "FileAnalysis.h"
+#include "EiLog.h"
+
+using namespace std;
+
+
+CBatchAnalysis::CBatchAnalysis()
+{
+    m_pHandle = NULL;
+    m_mrls = NULL;
+    m_nCount = 0;
+    m_nNext = 0;
+    m_bStop = false;
+    memset(&m_total,0,sizeof(m_total));
+    pthread_mutex_init(&m_mutex,NULL);
+}
+
+CBatchAnalysis::~CBatchAnalysis()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+int CBatchAnalysis::Run(const EASYICE* handle,const char** mrls,int count,EASYICE_BATCH_RESULT& total)
+{
+    m_pHandle = handle;
+    m_mrls = mrls;
+    m_nCount = count;
+    m_nNext = 0;
+    m_bStop = false;
+    memset(&m_total,0,sizeof(m_total));
+    m_total.index = -1;
+    m_total.files_total = count;
+    gettimeofday(&m_tvStart,NULL);
+
+    int nThreads = handle->batch_threads > 0 ? handle->batch_threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nThreads > count)
+    {
+        nThreads = count;
+    }
+    if (nThreads < 1)
+    {
+        nThreads = 1;
+    }
+
+    vector<pthread_t> vecThreads;
+    for (int i = 0; i < nThreads; i++)
+    {
+        pthread_t tid;
+        if (pthread_create(&tid,NULL,WorkThread,this) != 0)
+        {
+            ei_log(LV_ERROR,"libeasyice","create thread failed");
+            continue;
+        }
+        vecThreads.push_back(tid);
+    }
+    //without any worker the files are analyzed here
+    if (vecThreads.empty())
+    {
+        WorkThread(this);
+    }
+    for (size_t i = 0; i < vecThreads.size(); i++)
+    {
+        pthread_join(vecThreads[i],NULL);
+    }
+
+    m_total.elapsed = Elapsed(m_tvStart);
+    m_total.mbps = m_total.elapsed > 0 ? m_total.bytes_done / m_total.elapsed / (1024*1024) : 0;
+    total = m_total;
+    return m_total.files_failed > 0 || m_total.files_done < count ? -1 : 0;
+}
+
+void* CBatchAnalysis::WorkThread(void* arg)
+{
+    CBatchAnalysis* lpthis = (CBatchAnalysis*)arg;
+    while (1)
+    {
+        pthread_mutex_lock(&lpthis->m_mutex);
+        int index = lpthis->m_nNext;
+        if (!lpthis->m_bStop && index < lpthis->m_nCount)
+        {
+            lpthis->m_nNext++;
+        }
+        else
+        {
+            index = -1;
+        }
+        pthread_mutex_unlock(&lpthis->m_mutex);
+
+        if (index < 0)
+        {
+            break;
+        }
+        lpthis->AnalyzeFile(index);
+    }
+    return NULL;
+}
+
+void CBatchAnalysis::AnalyzeFile(int index)
+{
+    //the options of the caller, only the mrl differs. the progress of
+    //one file is meaningless in a batch, it is not reported
+    EASYICE* handle = new EASYICE(*m_pHandle);
+    strncpy(handle->mrl,m_mrls[index],sizeof(handle->mrl) - 1);
+    handle->mrl[sizeof(handle->mrl) - 1] = 0;
+    if (strncasecmp(handle->mrl,support_protocals[PROTOCAL_FILE].ptr,support_protocals[PROTOCAL_FILE].len) == 0)
+    {
+        memmove(handle->mrl,handle->mrl+support_protocals[PROTOCAL_FILE].len,strlen(handle->mrl)+1-support_protocals[PROTOCAL_FILE].len);
+    }
+    handle->progress_cb_func = NULL;
+    handle->progress_cb_data = NULL;
+    handle->udplive_handle = NULL;
+    handle->hls_handle = NULL;
+
+    struct stat filestat;
+    long long llBytes = stat(handle->mrl,&filestat) == 0 ? filestat.st_size : 0;
+
+    struct timeval tvStart;
+    gettimeofday(&tvStart,NULL);
+    FileAnalysis* p = new FileAnalysis();
+    p->SetStopFlag(&m_bStop);
+    int ret = p->OpenMRL(handle);
+    delete p;
+    double seconds = Elapsed(tvStart);
+
+    pthread_mutex_lock(&m_mutex);
+    m_total.files_done++;
+    if (ret < 0)
+    {
+        m_total.files_failed++;
+    }
+    m_total.bytes_done += llBytes;
+    m_total.elapsed = Elapsed(m_tvStart);
+    m_total.mbps = m_total.elapsed > 0 ? m_total.bytes_done / m_total.elapsed / (1024*1024) : 0;
+
+    EASYICE_BATCH_RESULT result = m_total;
+    result.mrl = m_mrls[index];
+    result.index = index;
+    result.ret = ret < 0 ? -1 : 0;
+    result.bytes = llBytes;
+    result.seconds = seconds;
+
+    easyice_batch_callback pfCb = (easyice_batch_callback)m_pHandle->batch_cb_func;
+    if (pfCb != NULL && pfCb(&result,m_pHandle->batch_cb_data) != 0)
+    {
+        m_bStop = true;
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    delete handle;
+}
+
+double CBatchAnalysis::Elapsed(const struct timeval& tvStart)
+{
+    struct timeval tvNow;
+    gettimeofday(&tvNow,NULL);
+    return (tvNow.tv_sec - tvStart.tv_sec) + (tvNow.tv_usec - tvStart.tv_usec) / 1000000.0;
+}
@@ -0,0 +1,55 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BATCHANALYSIS_H
+#define BATCHANALYSIS_H
+
+#include <pthread.h>
+#include <sys/time.h>
+#include "../sdkdefs.h"
+
+/**
+ * Analyzes a list of files on a bounded pool of threads, each file by its
+ * own FileAnalysis with a copy of the caller's options. Workers take the
+ * next file from a shared index, so a long file does not hold back the
+ * others. Results are passed to the batch callback one at a time.
+ */
+class CBatchAnalysis
+{
+public:
+    CBatchAnalysis();
+    ~CBatchAnalysis();
+
+    //blocks until all files are analyzed or the callback asks to stop,
+    //the aggregate of the batch is returned in total
+    int Run(const EASYICE* handle,const char** mrls,int count,EASYICE_BATCH_RESULT& total);
+
+private:
+    static void* WorkThread(void* arg);
+    void AnalyzeFile(int index);
+    static double Elapsed(const struct timeval& tvStart);
+
+private:
+    const EASYICE* m_pHandle;
+    const char** m_mrls;
+    int m_nCount;
+
+    //next file to analyze, m_total and the callback are guarded by m_mutex
+    int m_nNext;
+    pthread_mutex_t m_mutex;
+    EASYICE_BATCH_RESULT m_total;
+    struct timeval m_tvStart;
+
+    volatile bool m_bStop;
+};
+
+#endif
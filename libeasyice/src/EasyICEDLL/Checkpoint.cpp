@@ -0,0 +1,503 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Checkpoint.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "EiLog.h"
+
+using namespace std;
+using namespace tables;
+
+#define CHECKPOINT_MAGIC    0x5450434B43494545ULL   //"EEICKCPT"
+#define CHECKPOINT_VERSION  5
+
+//bytes hashed at the start of the file and before the offset
+#define CHECKPOINT_HASH_SIZE (64*1024)
+
+#define FNV_OFFSET  14695981039346656037ULL
+#define FNV_PRIME   1099511628211ULL
+
+
+//plain binary stream, native byte order: a checkpoint is read back by the
+//same build on the same machine
+class CCheckpointFile
+{
+public:
+    CCheckpointFile(FILE* fp)
+    {
+        struct stat st;
+        m_fp = fp;
+        m_bOk = (fp != NULL);
+        m_llSize = (fp != NULL && fstat(fileno(fp),&st) == 0) ? (long long)st.st_size : 0;
+    }
+
+    bool IsOk() const { return m_bOk; }
+    void Fail() { m_bOk = false; }
+
+    void Write(const void* p,size_t n)
+    {
+        if (m_bOk && n > 0 && fwrite(p,1,n,m_fp) != n)
+            m_bOk = false;
+    }
+    void Read(void* p,size_t n)
+    {
+        if (m_bOk && n > 0 && fread(p,1,n,m_fp) != n)
+            m_bOk = false;
+    }
+
+    template <class T> void Put(const T& v) { Write(&v,sizeof(T)); }
+    template <class T> void Get(T& v) { Read(&v,sizeof(T)); }
+
+    //a count read back, rejected if the bytes left in the file cannot hold
+    //that many items of at least nItemSize bytes, so a corrupt count never
+    //reaches resize()
+    bool GetCount(size_t& n,size_t nItemSize = 1)
+    {
+        unsigned long long v = 0;
+        Get(v);
+        n = 0;
+        if (!m_bOk)
+            return false;
+        long long llPos = ftello(m_fp);
+        unsigned long long ullLeft = (llPos >= 0 && llPos <= m_llSize) ? (unsigned long long)(m_llSize - llPos) : 0;
+        if (v > ullLeft / nItemSize)
+        {
+            m_bOk = false;
+            return false;
+        }
+        n = (size_t)v;
+        return true;
+    }
+    void PutCount(size_t n) { Put((unsigned long long)n); }
+
+    void PutString(const string& s)
+    {
+        PutCount(s.size());
+        Write(s.data(),s.size());
+    }
+    void GetString(string& s)
+    {
+        size_t n = 0;
+        if (!GetCount(n))
+            return;
+        s.resize(n);
+        if (n > 0)
+            Read(&s[0],n);
+    }
+
+private:
+    FILE* m_fp;
+    bool m_bOk;
+    long long m_llSize;
+};
+
+
+template <class S>
+static void PutSeries(CCheckpointFile& f,const S& series)
+{
+    f.PutCount(series.size());
+    for (size_t i = 0; i < series.size(); i++)
+    {
+        typename S::value_type item = series[i];
+        f.Put(item);
+    }
+}
+
+template <class S>
+static void GetSeries(CCheckpointFile& f,S& series)
+{
+    size_t n = 0;
+    if (!f.GetCount(n,sizeof(typename S::value_type)))
+        return;
+    for (size_t i = 0; i < n && f.IsOk(); i++)
+    {
+        typename S::value_type item;
+        f.Get(item);
+        series.push_back(item);
+    }
+}
+
+static void PutRuns(CCheckpointFile& f,const GOP_RUNS& runs)
+{
+    f.PutCount(runs.size());
+    if (!runs.empty())
+        f.Write(&runs[0],runs.size());
+}
+
+static void GetRuns(CCheckpointFile& f,GOP_RUNS& runs)
+{
+    size_t n = 0;
+    if (!f.GetCount(n))
+        return;
+    runs.resize(n);
+    if (n > 0)
+        f.Read(&runs[0],n);
+}
+
+static void PutGop(CCheckpointFile& f,const GOP_STATE& gs)
+{
+    f.Put(gs.gl);
+    PutRuns(f,gs.runs);
+}
+
+static void GetGop(CCheckpointFile& f,GOP_STATE& gs)
+{
+    f.Get(gs.gl);
+    GetRuns(f,gs.runs);
+    if (gs.gl.run_offset != 0 || gs.gl.run_count != gs.runs.size())
+        f.Fail();
+}
+
+static void PutProgram(CCheckpointFile& f,const PROGRAM_INFO& pi)
+{
+    PutSeries(f,pi.tts.vecVpts);
+    PutSeries(f,pi.tts.vecApts);
+    PutSeries(f,pi.tts.vecDts);
+    PutSeries(f,pi.tts.vecPcr);
+    PutSeries(f,pi.tts.vecPtsSub);
+    PutSeries(f,pi.tts.vecDtsSub);
+    PutSeries(f,pi.tts.vecAPtsSub);
+    f.PutCount(pi.tts.mapEs.size());
+    map<int,ES_TIMESTAMPS>::const_iterator it = pi.tts.mapEs.begin();
+    for (; it != pi.tts.mapEs.end(); ++it)
+    {
+        f.Put(it->second.pid);
+        f.Put(it->second.stream_type);
+        PutSeries(f,it->second.vecPts);
+        PutSeries(f,it->second.vecPtsSub);
+    }
+    PutSeries(f,pi.rateList);
+    f.Put(pi.frameStats);
+
+    f.PutCount(pi.gopList.size());
+    for (size_t i = 0; i < pi.gopList.size(); i++)
+    {
+        f.Put(pi.gopList[i]);
+    }
+    PutRuns(f,pi.gopRuns);
+}
+
+static void GetProgram(CCheckpointFile& f,PROGRAM_INFO& pi)
+{
+    GetSeries(f,pi.tts.vecVpts);
+    GetSeries(f,pi.tts.vecApts);
+    GetSeries(f,pi.tts.vecDts);
+    GetSeries(f,pi.tts.vecPcr);
+    GetSeries(f,pi.tts.vecPtsSub);
+    GetSeries(f,pi.tts.vecDtsSub);
+    GetSeries(f,pi.tts.vecAPtsSub);
+    size_t n = 0;
+    if (!f.GetCount(n,2 * sizeof(int)))
+        return;
+    for (size_t i = 0; i < n && f.IsOk(); i++)
+    {
+        int pid = 0;
+        int stream_type = 0;
+        f.Get(pid);
+        f.Get(stream_type);
+        ES_TIMESTAMPS& es = pi.tts.AddEs(pid,stream_type);
+        GetSeries(f,es.vecPts);
+        GetSeries(f,es.vecPtsSub);
+    }
+    GetSeries(f,pi.rateList);
+    f.Get(pi.frameStats);
+
+    if (!f.GetCount(n,sizeof(GOP_LIST)))
+        return;
+    pi.gopList.resize(n);
+    for (size_t i = 0; i < n && f.IsOk(); i++)
+    {
+        f.Get(pi.gopList[i]);
+    }
+    GetRuns(f,pi.gopRuns);
+
+    //the runs of every gop must lie in gopRuns
+    for (size_t i = 0; i < n && f.IsOk(); i++)
+    {
+        const GOP_LIST& gl = pi.gopList[i];
+        if ((unsigned long long)gl.run_offset + gl.run_count > pi.gopRuns.size())
+            f.Fail();
+    }
+}
+
+static void PutReport(CCheckpointFile& f,const REPORT_PARAM_T& param)
+{
+    f.Put(param.level);
+    f.Put((int)param.errName);
+    f.Put(param.llOffset);
+    f.Put(param.pid);
+    f.Put(param.llVal);
+    f.Put(param.fVal);
+}
+
+static void GetReport(CCheckpointFile& f,REPORT_PARAM_T& param)
+{
+    int errName = 0;
+    f.Get(param.level);
+    f.Get(errName);
+    f.Get(param.llOffset);
+    f.Get(param.pid);
+    f.Get(param.llVal);
+    f.Get(param.fVal);
+    param.errName = (ERROR_NAME_T)errName;
+    param.pApp = NULL;
+}
+
+static void PutTable(CCheckpointFile& f,int table_id,const TABLE_SECTIONS& sections)
+{
+    f.Put(table_id);
+    f.PutCount(sections.size());
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        f.Put(sections[i].section_length);
+        f.PutCount(sections[i].vecData.size());
+        if (!sections[i].vecData.empty())
+            f.Write(&sections[i].vecData[0],sections[i].vecData.size());
+    }
+}
+
+static void GetTable(CCheckpointFile& f,int& table_id,TABLE_SECTIONS& sections)
+{
+    size_t n = 0;
+    f.Get(table_id);
+    if (!f.GetCount(n,sizeof(sections[0].section_length) + sizeof(unsigned long long)))
+        return;
+    sections.resize(n);
+    for (size_t i = 0; i < n && f.IsOk(); i++)
+    {
+        size_t len = 0;
+        f.Get(sections[i].section_length);
+        if (!f.GetCount(len))
+            return;
+        sections[i].vecData.resize(len);
+        if (len > 0)
+            f.Read(&sections[i].vecData[0],len);
+    }
+}
+
+static unsigned long long HashRange(int fd,long long llStart,long long llEnd,bool& bOk)
+{
+    unsigned long long hash = FNV_OFFSET;
+    BYTE buf[4096];
+    while (llStart < llEnd)
+    {
+        int n = llEnd - llStart < (long long)sizeof(buf) ? (int)(llEnd - llStart) : (int)sizeof(buf);
+        if (pread(fd,buf,n,llStart) != n)
+        {
+            bOk = false;
+            return 0;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            hash = (hash ^ buf[i]) * FNV_PRIME;
+        }
+        llStart += n;
+    }
+    return hash;
+}
+
+
+string GetCheckpointPath(const char* mrl)
+{
+    return (string)mrl + ".checkpoint";
+}
+
+bool HashCheckpointFile(const char* mrl,int nSyncByte,long long llOffset,unsigned long long& ullHead,unsigned long long& ullTail)
+{
+    int fd = open(mrl,O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool bOk = true;
+    long long llHeadEnd = nSyncByte + CHECKPOINT_HASH_SIZE < llOffset ? nSyncByte + CHECKPOINT_HASH_SIZE : llOffset;
+    long long llTailStart = llOffset - CHECKPOINT_HASH_SIZE > nSyncByte ? llOffset - CHECKPOINT_HASH_SIZE : nSyncByte;
+    ullHead = HashRange(fd,nSyncByte,llHeadEnd,bOk);
+    ullTail = HashRange(fd,llTailStart,llOffset,bOk);
+    close(fd);
+    return bOk;
+}
+
+bool SaveCheckpoint(const string& path,const CHECKPOINT_T& ckpt,const ALL_PROGRAM_INFO* pInfo)
+{
+    //written aside and renamed, a reader never sees half a checkpoint
+    string tmp = path + ".tmp";
+    FILE* fp = fopen(tmp.c_str(),"wb");
+    if (fp == NULL)
+    {
+        ei_log(LV_ERROR,"libeasyice","open file for write error:%s",tmp.c_str());
+        return false;
+    }
+
+    CCheckpointFile f(fp);
+    f.Put(CHECKPOINT_MAGIC);
+    f.Put((int)CHECKPOINT_VERSION);
+    f.Put(ckpt.nTsLength);
+    f.Put(ckpt.nSyncByte);
+    f.Put(ckpt.llOffset);
+    f.Put(ckpt.llInvalidPkts);
+    f.Put(ckpt.nTsMaxSamples);
+    f.Put(ckpt.nTsDecimation);
+    f.Put(ckpt.ullHeadHash);
+    f.Put(ckpt.ullTailHash);
+
+    f.PutCount(ckpt.vecPids.size());
+    for (size_t i = 0; i < ckpt.vecPids.size(); i++)
+    {
+        f.Put(ckpt.vecPids[i]);
+        f.Put(ckpt.vecPidStats[i]);
+    }
+
+    f.PutCount(pInfo->size());
+    ALL_PROGRAM_INFO::const_iterator it = pInfo->begin();
+    for (; it != pInfo->end(); ++it)
+    {
+        f.Put(it->first);
+        PutProgram(f,*it->second);
+    }
+
+    f.PutCount(ckpt.mapGopCarry.size());
+    map<int,GOP_STATE>::const_iterator it_gop = ckpt.mapGopCarry.begin();
+    for (; it_gop != ckpt.mapGopCarry.end(); ++it_gop)
+    {
+        f.Put(it_gop->first);
+        PutGop(f,it_gop->second);
+    }
+
+    const vector<pair<int,TABLE_SECTIONS> >& vecTables = ckpt.sectionLog.vecTables;
+    f.PutCount(vecTables.size());
+    for (size_t i = 0; i < vecTables.size(); i++)
+    {
+        PutTable(f,vecTables[i].first,vecTables[i].second);
+    }
+
+    f.PutCount(ckpt.vecReports.size());
+    for (size_t i = 0; i < ckpt.vecReports.size(); i++)
+    {
+        PutReport(f,ckpt.vecReports[i]);
+    }
+
+    bool bOk = f.IsOk();
+    if (fclose(fp) != 0)
+    {
+        bOk = false;
+    }
+    if (!bOk || rename(tmp.c_str(),path.c_str()) != 0)
+    {
+        ei_log(LV_ERROR,"libeasyice","write checkpoint error:%s",path.c_str());
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LoadCheckpoint(const string& path,CHECKPOINT_T& ckpt,ALL_PROGRAM_INFO* pInfo)
+{
+    FILE* fp = fopen(path.c_str(),"rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    CCheckpointFile f(fp);
+    unsigned long long magic = 0;
+    int version = 0;
+    f.Get(magic);
+    f.Get(version);
+    if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    f.Get(ckpt.nTsLength);
+    f.Get(ckpt.nSyncByte);
+    f.Get(ckpt.llOffset);
+    f.Get(ckpt.llInvalidPkts);
+    f.Get(ckpt.nTsMaxSamples);
+    f.Get(ckpt.nTsDecimation);
+    f.Get(ckpt.ullHeadHash);
+    f.Get(ckpt.ullTailHash);
+
+    size_t n = 0;
+    if (f.GetCount(n,sizeof(int) + sizeof(ckpt.vecPidStats[0])))
+    {
+        ckpt.vecPids.resize(n);
+        ckpt.vecPidStats.resize(n);
+        for (size_t i = 0; i < n && f.IsOk(); i++)
+        {
+            f.Get(ckpt.vecPids[i]);
+            f.Get(ckpt.vecPidStats[i]);
+            if (ckpt.vecPids[i] < 0 || ckpt.vecPids[i] >= PID_STATS_SIZE)
+            {
+                ckpt.vecPids[i] = 0;
+                f.Fail();
+            }
+        }
+    }
+
+    if (f.GetCount(n))
+    {
+        for (size_t i = 0; i < n && f.IsOk(); i++)
+        {
+            int prog = 0;
+            f.Get(prog);
+            PROGRAM_INFO* pi = new PROGRAM_INFO;
+            GetProgram(f,*pi);
+            if (!pInfo->insert(ALL_PROGRAM_INFO::value_type(prog,pi)).second)
+            {
+                delete pi;
+            }
+        }
+    }
+
+    if (f.GetCount(n))
+    {
+        for (size_t i = 0; i < n && f.IsOk(); i++)
+        {
+            int prog = 0;
+            f.Get(prog);
+            GetGop(f,ckpt.mapGopCarry[prog]);
+        }
+    }
+
+    if (f.GetCount(n,sizeof(int) + sizeof(unsigned long long)))
+    {
+        ckpt.sectionLog.vecTables.resize(n);
+        for (size_t i = 0; i < n && f.IsOk(); i++)
+        {
+            GetTable(f,ckpt.sectionLog.vecTables[i].first,ckpt.sectionLog.vecTables[i].second);
+        }
+    }
+
+    if (f.GetCount(n,sizeof(int) * 2))
+    {
+        ckpt.vecReports.resize(n);
+        for (size_t i = 0; i < n && f.IsOk(); i++)
+        {
+            GetReport(f,ckpt.vecReports[i]);
+        }
+    }
+
+    bool bOk = f.IsOk();
+    fclose(fp);
+    if (!bOk)
+    {
+        ei_log(LV_ERROR,"libeasyice","bad checkpoint, ignored:%s",path.c_str());
+    }
+    return bOk;
+}
@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "../commondefs.h"
+#include "libtr101290.h"
+#include "PidStats.h"
+#include "tables/CAnalyzeTable.h"
+
+/**
+ * Results of a file analysis up to an offset, saved next to the file so a
+ * later run on the same, grown, file only analyzes the appended bytes.
+ *
+ * Only results are kept: pid statistics, program timestamps/rates/gops, the
+ * unfinished gop of each program, the distinct psi/si tables and the
+ * tr101290 reports. The demux, program parser and tr101290 state at the
+ * offset is rebuilt by re-reading a preroll before it, the same way the
+ * parallel ranges start, so nothing depends on the layout of those classes.
+ * Decimated timestamp/rate lists are restored sample by sample and folded
+ * again from there, so they only approximate a single pass over the file.
+ */
+typedef struct _CHECKPOINT_T
+{
+    _CHECKPOINT_T()
+    {
+        nTsLength = 0;
+        nSyncByte = 0;
+        llOffset = 0;
+        llInvalidPkts = 0;
+        nTsMaxSamples = 0;
+        nTsDecimation = 0;
+        ullHeadHash = 0;
+        ullTailHash = 0;
+    }
+
+    //the analyzed part of the file, [nSyncByte,llOffset)
+    int nTsLength;
+    int nSyncByte;
+    long long llOffset;
+
+    //packets without sync byte before llOffset, they take no packet id
+    long long llInvalidPkts;
+
+    //options that change the results, a checkpoint is used only if they match
+    int nTsMaxSamples;
+    int nTsDecimation;
+
+    //hashes of the first and of the last bytes before llOffset
+    unsigned long long ullHeadHash;
+    unsigned long long ullTailHash;
+
+    std::vector<int> vecPids;
+    std::vector<PID_STAT_T> vecPidStats;
+
+    //program number, unfinished gop at llOffset
+    std::map<int,GOP_STATE> mapGopCarry;
+
+    tables::SECTION_LOG sectionLog;
+
+    std::vector<REPORT_PARAM_T> vecReports;
+}CHECKPOINT_T;
+
+//path of the checkpoint of mrl
+std::string GetCheckpointPath(const char* mrl);
+
+//hash the bytes of the file that a checkpoint at llOffset must find again
+bool HashCheckpointFile(const char* mrl,int nSyncByte,long long llOffset,unsigned long long& ullHead,unsigned long long& ullTail);
+
+//programs are read into and written from pInfo, the rest from/to ckpt
+bool SaveCheckpoint(const std::string& path,const CHECKPOINT_T& ckpt,const ALL_PROGRAM_INFO* pInfo);
+bool LoadCheckpoint(const std::string& path,CHECKPOINT_T& ckpt,ALL_PROGRAM_INFO* pInfo);
+
+#endif
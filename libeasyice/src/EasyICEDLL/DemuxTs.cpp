@@ -27,6 +27,10 @@ static int TypeOfStreamType(int stream_type)
 	{
 		return 2;
 	}
+	else if (stream_type == 0x06 || stream_type == 0x11 || stream_type == 0x87 || stream_type == 0x90) //PTSPES˽(Ļͼĵӵ)LATME-AC3PGSĻ
+	{
+		return 3;
+	}
 
 	return 0;
 }
@@ -36,11 +40,17 @@ CDemuxTs::CDemuxTs(void)
 {
 	m_allProgramInfo = NULL;
 	m_bSingleMode = false;
+	m_pSingleParser = NULL;
 	m_llPacketID = 0;
+	m_tsDecimateMode = SERIES_DECIMATE_AVG;
+	m_nTsMaxSamples = 0;
+	m_pPidDispatch = new vector<int>[DEMUX_PID_COUNT];
 }
 
 CDemuxTs::~CDemuxTs(void)
 {
+	delete [] m_pPidDispatch;
+
 	map<int,CProgramParser*>::iterator it = m_mapProgParser.begin();
 	for (; it != m_mapProgParser.end(); it++)
 	{
@@ -116,6 +126,7 @@ int CDemuxTs::SetupDemux(BYTE* pData, int nLength,int nTsLen)
 	for( ; itpid != m_mapProgPids.end(); itpid++)
 	{
 		m_allProgramInfo->insert(ALL_PROGRAM_INFO::value_type(itpid->first,new PROGRAM_INFO));
+		(*m_allProgramInfo)[itpid->first]->SetDecimation(m_tsDecimateMode,m_nTsMaxSamples);
 
 		m_mapProgParser.insert(map<int,CProgramParser*>::value_type(itpid->first,new CProgramParser(nTsLen)) );
 
@@ -132,6 +143,12 @@ int CDemuxTs::SetupDemux(BYTE* pData, int nLength,int nTsLen)
 			{
 				m_mapProgParser[itpid->first]->SetAudioPid(itpid->second.pids[i].pid);
 			}
+
+			//ƵĻÿ·ʱ
+			if (TypeOfStreamType(itpid->second.pids[i].stream_type) >= 2)
+			{
+				m_mapProgParser[itpid->first]->AddEsPid(itpid->second.pids[i]);
+			}
 			//if (itpid->second.pids[i].stream_type == 0x2 ||	//MPEGV
 			//	itpid->second.pids[i].stream_type == 0x1B || //H.264
 			//	itpid->second.pids[i].stream_type == 0x24) //HEVC
@@ -142,6 +159,8 @@ int CDemuxTs::SetupDemux(BYTE* pData, int nLength,int nTsLen)
 		}
 		
 	}
+
+	BuildDispatch();
 	
 	return 1;
 }
@@ -200,6 +219,7 @@ int CDemuxTs::SetupDemux(TABLES* tables,int nTsLen)
 	for( ; itpid != m_mapProgPids.end(); itpid++)
 	{
 		m_allProgramInfo->insert(ALL_PROGRAM_INFO::value_type(itpid->first,new PROGRAM_INFO));
+		(*m_allProgramInfo)[itpid->first]->SetDecimation(m_tsDecimateMode,m_nTsMaxSamples);
 
 		m_mapProgParser.insert(map<int,CProgramParser*>::value_type(itpid->first,new CProgramParser(nTsLen)) );
 
@@ -216,6 +236,12 @@ int CDemuxTs::SetupDemux(TABLES* tables,int nTsLen)
 			{
 				m_mapProgParser[itpid->first]->SetAudioPid(itpid->second.pids[i].pid);
 			}
+
+			//ƵĻÿ·ʱ
+			if (TypeOfStreamType(itpid->second.pids[i].stream_type) >= 2)
+			{
+				m_mapProgParser[itpid->first]->AddEsPid(itpid->second.pids[i]);
+			}
 			//if (itpid->second.pids[i].stream_type == 0x2 ||	//MPEGV
 			//	itpid->second.pids[i].stream_type == 0x1B || //H.264
 			//	itpid->second.pids[i].stream_type == 0x24) //HEVC	
@@ -226,22 +252,41 @@ int CDemuxTs::SetupDemux(TABLES* tables,int nTsLen)
 		}
 		
 	}
+
+	BuildDispatch();
 	
 	return 1;
 }
 
-void CDemuxTs::SetupDemux(int VideoPID,int VideoStreamType,int nTsLen)
+void CDemuxTs::SetupDemux(const PID_STREAM_TYPE& video,const vector<PID_STREAM_TYPE>& vecEs,int nTsLen)
 {
 	m_allProgramInfo->insert(ALL_PROGRAM_INFO::value_type(SINGLE_MODE_PROG_NUM,new PROGRAM_INFO));
+	(*m_allProgramInfo)[SINGLE_MODE_PROG_NUM]->SetDecimation(m_tsDecimateMode,m_nTsMaxSamples);
 	m_mapProgParser.insert(map<int,CProgramParser*>::value_type(SINGLE_MODE_PROG_NUM,new CProgramParser(nTsLen)) );
 	m_mapProgParser[SINGLE_MODE_PROG_NUM]->SetOutputBuffer( (*m_allProgramInfo)[SINGLE_MODE_PROG_NUM] );
 
-	PID_STREAM_TYPE pid_type;
-	pid_type.pid = VideoPID;
-	pid_type.stream_type = VideoStreamType;
-	m_mapProgParser[SINGLE_MODE_PROG_NUM]->SetVideoStreamInfo(pid_type);	
+	m_pSingleParser = m_mapProgParser[SINGLE_MODE_PROG_NUM];
+	m_pSingleParser->SetVideoStreamInfo(video);
+
+	//һ·ƵĿƵͳƣ·ʱͳ
+	bool bAudio = false;
+	for (int i = 0; i < (int)vecEs.size(); i++)
+	{
+		int type = TypeOfStreamType(vecEs[i].stream_type);
+		if (type == 2 && !bAudio)
+		{
+			m_pSingleParser->SetAudioPid(vecEs[i].pid);
+			bAudio = true;
+		}
+		if (type >= 2)
+		{
+			m_pSingleParser->AddEsPid(vecEs[i]);
+		}
+	}
 
 	m_bSingleMode = true;
+
+	m_pesAssembler.AddConsumer(video.pid,m_pSingleParser->GetFrameStats());
 }
 
 void CDemuxTs::SetOutputBuffer(ALL_PROGRAM_INFO* p)
@@ -249,43 +294,112 @@ void CDemuxTs::SetOutputBuffer(ALL_PROGRAM_INFO* p)
 	m_allProgramInfo = p;
 }
 
-PARSED_FRAME_INFO CDemuxTs::AddTsPacket(CTsPacket* tsPacket)
+PARSED_FRAME_INFO CDemuxTs::AddTsPacket(CTsPacket* tsPacket,const TS_PACKET_INFO& info)
 {
 	PARSED_FRAME_INFO rst;
 	if (m_bSingleMode)
 	{
-		rst = m_mapProgParser[SINGLE_MODE_PROG_NUM]->PushBackTsPacket(tsPacket,m_llPacketID);
+		rst = m_pSingleParser->PushBackTsPacket(tsPacket,info,m_llPacketID);
 	}
 	else
 	{
-		int pid = tsPacket->Get_PID();
-		map<int,PROGRAM_PIDS>::iterator it = m_mapProgPids.begin();
-		for (; it != m_mapProgPids.end(); it++)
+		//Ŀİ֪ͨĿʱ԰IDΪλ
+		vector<int>& targets = m_pPidDispatch[info.pid];
+		for (int i = 0; i < (int)targets.size(); i++)
+		{
+			rst = m_vecDispatch[targets[i]].pParser->PushBackTsPacket(tsPacket,info,m_llPacketID);
+		}
+	}
+
+	//δעߵpidֻһα
+	m_pesAssembler.Push(info,m_llPacketID);
+
+	m_llPacketID++;
+
+	return rst;
+}
+
+void CDemuxTs::AddTsPackets(const TS_PACKET_INFO* pInfo,int nCount)
+{
+	CTsPacket tsPacket;
+	for (int i = 0; i < nCount; i++)
+	{
+		if (i + TS_PREFETCH_DISTANCE < nCount)
 		{
-			PROGRAM_PIDS& pids = it->second;
-			bool bFinded = false;
-			for (int i = 0; i < (int)pids.pids.size(); i++)
+			TS_PREFETCH(&m_pPidDispatch[pInfo[i+TS_PREFETCH_DISTANCE].pid & (DEMUX_PID_COUNT-1)]);
+		}
+
+		const TS_PACKET_INFO& info = pInfo[i];
+		if (!info.sync)
+		{
+			continue;
+		}
+		tsPacket.SetPacket(info);
+		AddTsPacket(&tsPacket,info);
+	}
+}
+
+
+void CDemuxTs::BuildDispatch()
+{
+	m_vecDispatch.clear();
+	for (int i = 0; i < DEMUX_PID_COUNT; i++)
+	{
+		m_pPidDispatch[i].clear();
+	}
+
+	map<int,PROGRAM_PIDS>::iterator it = m_mapProgPids.begin();
+	for (; it != m_mapProgPids.end(); it++)
+	{
+		PROG_DISPATCH_T target;
+		target.pParser = m_mapProgParser[it->first];
+		int index = (int)m_vecDispatch.size();
+		m_vecDispatch.push_back(target);
+
+		//ͬһpidһ·Ŀпֶܳ(pcrƵ)ַֻһ
+		PROGRAM_PIDS& pids = it->second;
+		for (int i = 0; i < (int)pids.pids.size(); i++)
+		{
+			int pid = pids.pids[i].pid;
+			if (pid < 0 || pid >= DEMUX_PID_COUNT)
 			{
-				if(pid == pids.pids[i].pid)
-				{
-					rst = m_mapProgParser[it->first]->PushBackTsPacket(tsPacket,m_llPacketID);
-					bFinded = true;
-					break;
-				}
+				continue;
 			}
-			if (!bFinded)	//2012/7/1  Ŀ
+			vector<int>& targets = m_pPidDispatch[pid];
+			if (targets.empty() || targets.back() != index)
 			{
-				m_mapProgParser[it->first]->AddOtherPacket();
+				targets.push_back(index);
 			}
+		}
 
+		//ƵpidPESԪ֡ͳ
+		if (target.pParser->GetVideoPid() >= 0)
+		{
+			m_pesAssembler.AddConsumer(target.pParser->GetVideoPid(),target.pParser->GetFrameStats());
 		}
 	}
+}
 
-	m_llPacketID++;
-
-	return rst;
+void CDemuxTs::SetPacketID(long long llPacketID)
+{
+	//ĿʱӼ¼İID֮ƽƣ֮ǰPCRİ
+	map<int,CProgramParser*>::iterator it = m_mapProgParser.begin();
+	for (; it != m_mapProgParser.end(); ++it)
+	{
+		it->second->ShiftPacketID(llPacketID - m_llPacketID);
+	}
+	m_llPacketID = llPacketID;
 }
 
+void CDemuxTs::GetGopState(map<int,GOP_STATE>& mapGop)
+{
+	mapGop.clear();
+	map<int,CProgramParser*>::iterator it = m_mapProgParser.begin();
+	for (; it != m_mapProgParser.end(); it++)
+	{
+		it->second->GetGopState(mapGop[it->first]);
+	}
+}
 
 int CDemuxTs::DecodePacket(BYTE *pPacket, int nLen)
 {
@@ -301,19 +415,10 @@ int CDemuxTs::DecodePacket(BYTE *pPacket, int nLen)
 	}
 	else
 	{
-		int pid = tsPacket.Get_PID();
-		map<int,PROGRAM_PIDS>::iterator it = m_mapProgPids.begin();
-		for (; it != m_mapProgPids.end(); it++)
+		vector<int>& targets = m_pPidDispatch[tsPacket.Get_PID()];
+		for (int i = 0; i < (int)targets.size(); i++)
 		{
-			PROGRAM_PIDS& pids = it->second;
-			for (int i = 0; i < (int)pids.pids.size(); i++)
-			{
-				if(pid == pids.pids[i].pid)
-				{
-					m_mapProgParser[it->first]->DecodePacket(&tsPacket);
-					break;
-				}
-			}
+			m_vecDispatch[targets[i]].pParser->DecodePacket(&tsPacket);
 		}
 	}
 	return 0;
@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "TsPacket.h"
 #include "ProgramParser.h"
 #include "tables/CAnalyzeTable.h"
+#include "PesAssembler.h"
 #include <map>
 
 using namespace std;
@@ -22,6 +23,14 @@ using namespace tables;
 //·ģʽµprogram_idֵ
 #define SINGLE_MODE_PROG_NUM	-1
 
+#define DEMUX_PID_COUNT	8192
+
+//һ·ĿķַĿ
+typedef struct _PROG_DISPATCH_T
+{
+	CProgramParser* pParser;
+}PROG_DISPATCH_T;
+
 class CDemuxTs
 {
 public:
@@ -37,17 +46,35 @@ public:
 
 	int SetupDemux(TABLES* tables,int nTsLen);
 
-	//·ģʽ
-	void SetupDemux(int VideoPID,int VideoStreamType,int nTsLen);
+	//·ģʽûpsiʱʹãvecEsΪ⵽ƵĻȻ
+	void SetupDemux(const PID_STREAM_TYPE& video,const vector<PID_STREAM_TYPE>& vecEs,int nTsLen);
 
 	//ýϢ洢
 	void SetOutputBuffer(ALL_PROGRAM_INFO* p);
 
-	//յtsд
-	PARSED_FRAME_INFO AddTsPacket(CTsPacket* tsPacket);
+	//յtsдinfoΪԤȽõİͷϢ
+	PARSED_FRAME_INFO AddTsPacket(CTsPacket* tsPacket,const TS_PACKET_INFO& info);
+
+	//nCountԤİһζȡݿ飬ֽͬڴİAddTsPacketͬ
+	void AddTsPackets(const TS_PACKET_INFO* pInfo,int nCount);
 
 	//һTS
 	int DecodePacket(BYTE *pPacket, int nLen);
+
+	//һİIDֶβзʱʹֶεposļһ
+	void SetPacketID(long long llPacketID);
+
+	//½ĽĿϢʱе
+	void SetTimestampDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples) { m_tsDecimateMode = mode; m_nTsMaxSamples = nMaxSamples; }
+
+	//ȡĿǰδGOPĿţGOP
+	void GetGopState(map<int,GOP_STATE>& mapGop);
+
+	//PESעpidÿյһPESԪ֪ͨ
+	CPesAssembler& GetPesAssembler() { return m_pesAssembler; }
+private:
+	//m_mapProgPidspidĿķַֻSetupDemuxе
+	void BuildDispatch();
 private:
 	//·ĿpidϢ ĿţĿϢ
 	map<int,PROGRAM_PIDS> m_mapProgPids;
@@ -56,11 +83,25 @@ private:
 	//Ŀ=-1 ʾ·ģʽ
 	map<int,CProgramParser*> m_mapProgParser;
 
+	//ĿķַĿ꣬˳m_mapProgPidsһ
+	vector<PROG_DISPATCH_T> m_vecDispatch;
+
+	//pidΪ±ֵ꣬Ϊm_vecDispatch±бÿֻһα
+	vector<int>* m_pPidDispatch;
+
 	//нĿϢ
 	ALL_PROGRAM_INFO *m_allProgramInfo;
 
+	SERIES_DECIMATE_MODE m_tsDecimateMode;
+	size_t m_nTsMaxSamples;
+
 	bool m_bSingleMode;
 
+	//·ģʽĽÿٲm_mapProgParser
+	CProgramParser* m_pSingleParser;
+
 	//ID¼ݵĵڼ264﷨ʱõ
 	long long m_llPacketID;
+
+	CPesAssembler m_pesAssembler;
 };
@@ -19,7 +19,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 using namespace std;
 
 // ľ̬ԱҪж
-CEiLog* CEiLog::m_pStatic = NULL;
+// ڼʱ߳ͬʱʱظ
+CEiLog* CEiLog::m_pStatic = new CEiLog();
 
 
 
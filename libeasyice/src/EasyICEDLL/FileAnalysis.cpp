@@ -20,38 +20,330 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "EiLog.h"
 #include "json/json.h"
 #include "TrView.h"
+#include "MmapReader.h"
+#include "DemuxTs.h"
+#include "TsPacketInfo.h"
+#include "SyncScan.h"
+#include "Checkpoint.h"
+#include <fcntl.h>
+#include <pthread.h>
 
 using namespace std;
 
-//about 4.9MB, support probe,and pkt len as 188,204,192
+//about 4.9MB, the probe size. support pkt len as 188,204,192
 const int READ_BUF_SIZE = 188*204*128;
 
+//parallel analysis: each range starts this many bytes early to rebuild the
+//demux, gop, pcr and tr101290 state before its first byte, results of the
+//preroll are dropped
+const long long RANGE_PREROLL_SIZE = 64*1024*1024;
 
+//parallel analysis is used only when every range gets at least this many bytes
+const long long RANGE_MIN_SIZE = 256*1024*1024;
 
-int FileAnalysis::TryToReSync(BYTE* pData,int nLength,int& nSycByte)
+//packets whose headers are decoded at a time, small enough to stay in cache
+//until both engines have seen them
+const int PACKET_INFO_SLICE = 4096;
+
+
+//the psi/si sections of a range for the table analyzer of range 0: each is
+//kept once when it is new or changed, in the order they were completed.
+//sections completed before the table start only fill the cache, so that a
+//section range 0 already has the same way is not kept again. the pmt pids of
+//every pat seen are reassembled as well
+class CRangeSections : public ISectionConsumer
 {
-	nSycByte = 0;
-	int maxLength = nLength - 204*3;
-	if (maxLength < 204*3)
-		return -1;
+public:
+    CRangeSections() { m_bKeep = false; m_assembler.AddConsumer(this); }
 
-	for (int i = 0; i < maxLength; i++)
-	{
-		if(pData[i]==0x47&&pData[i+188]==0x47&&pData[i+188*2]==0x47&&pData[i+188*3]==0x47&&pData[i+188*4]==0x47)
-		{	
-			nSycByte = i;
-			return 188;
-		}
-		else if(pData[i]==0x47&&pData[i+204]==0x47&&pData[i+204*2]==0x47&&pData[i+204*3]==0x47&&pData[i+204*4]==0x47)
-		{
-			nSycByte = i;
-			return 204;
-		}
-	}
-	return -1;
+    CSectionAssembler& Assembler() { return m_assembler; }
+
+    void Push(const BYTE* pPacket,bool bKeep)
+    {
+        m_bKeep = bKeep;
+        m_assembler.Push(pPacket);
+    }
+
+    virtual void OnSection(const SECTION_SPAN_T& section)
+    {
+        if (!section.bValid || m_cache.Update(section.pid,section.pData,section.nLength) == tables::CSectionCache::SECTION_SAME)
+        {
+            return;
+        }
+        if (section.pid == 0 && section.pData[0] == 0x00)
+        {
+            //program_number(16) reserved(3) pid(13), after the 8 byte header, before the crc
+            for (int i = 8; i + 4 <= section.nLength - 4; i += 4)
+            {
+                if (((section.pData[i] << 8) | section.pData[i+1]) != 0)
+                {
+                    m_assembler.AddPid(((section.pData[i+2] & 0x1F) << 8) | section.pData[i+3]);
+                }
+            }
+        }
+        if (!m_bKeep)
+        {
+            return;
+        }
+        SECTION_SPAN_T span = section;
+        span.pData = NULL;
+        m_vecSpan.push_back(span);
+        m_vecData.insert(m_vecData.end(),section.pData,section.pData + section.nLength);
+    }
+
+    //hand the sections kept to pConsumer, in order
+    void Replay(ISectionConsumer* pConsumer) const
+    {
+        size_t pos = 0;
+        for (size_t i = 0; i < m_vecSpan.size(); i++)
+        {
+            SECTION_SPAN_T span = m_vecSpan[i];
+            span.pData = &m_vecData[pos];
+            pos += span.nLength;
+            pConsumer->OnSection(span);
+        }
+    }
+
+private:
+    CSectionAssembler m_assembler;
+    tables::CSectionCache m_cache;
+    vector<SECTION_SPAN_T> m_vecSpan;
+    vector<BYTE> m_vecData;
+    bool m_bKeep;
+};
+
+
+//one range of the file, analyzed by its own thread
+typedef struct _FILE_RANGE_T
+{
+    int nIndex;
+    const char* mrl;
+    int nTsLength;
+    long long llSyncByte;
+    int nReadDepth;
+    int nReadBlockSize;
+    bool bDropCache;
+
+    //the same probe data as the single thread mode, so that all ranges set up the same demux
+    BYTE* pProbe;
+    int nProbeLen;
+
+    long long llPrerollStart;
+    long long llStart;
+    long long llEnd;
+
+    //psi/si packets are collected from here on, preroll included
+    long long llTableStart;
+
+    CMpegDec* pMpegDec;
+    Clibtr101290* pTrcore;
+
+    //tr101290 reports at or after llStart, replayed in order after join
+    vector<REPORT_PARAM_T> vecReports;
+
+    //psi/si sections from llTableStart on, the tables are parsed by range 0 after join
+    bool bCollectTables;
+    CRangeSections sections;
+
+    //unfinished gop of each program at llStart
+    map<int,GOP_STATE> mapGopSeam;
+
+    //packets without sync byte in [llStart,llEnd), they take no packet id
+    long long llInvalidPkts;
+
+    vector<TS_PACKET_INFO> vecInfo;
+
+    volatile bool* pbStop;
+
+    //bytes done, written by the range thread and read by the progress loop,
+    //only through GetRangeDone/SetRangeDone
+    long long llDone;
+    int ret;
+}FILE_RANGE_T;
+
+static long long GetRangeDone(FILE_RANGE_T* range)
+{
+    return __sync_add_and_fetch(&range->llDone,0);
+}
+
+//only the thread of the range writes llDone, so the delta to the old value is exact
+static void SetRangeDone(FILE_RANGE_T* range,long long llDone)
+{
+    __sync_fetch_and_add(&range->llDone,llDone - GetRangeDone(range));
+}
+
+//append src to dst and move the packet ids back by llShift
+template <class S>
+static void AppendShifted(S& dst,const S& src,long long llShift)
+{
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        typename S::value_type item = src[i];
+        item.pos -= llShift;
+        dst.push_back(item);
+    }
+}
+
+//append the timestamps of every elementary stream of src, adding the streams
+//dst doesn't have yet
+static void AppendEsShifted(PROGRAM_TIMESTAMPS& dst,const PROGRAM_TIMESTAMPS& src,long long llShift)
+{
+    map<int,ES_TIMESTAMPS>::const_iterator it = src.mapEs.begin();
+    for (; it != src.mapEs.end(); ++it)
+    {
+        ES_TIMESTAMPS& es = dst.AddEs(it->first,it->second.stream_type);
+        AppendShifted(es.vecPts,it->second.vecPts,llShift);
+        AppendShifted(es.vecPtsSub,it->second.vecPtsSub,llShift);
+    }
+}
+
+//the part of gl built before the seam comes from the preroll, replace it with
+//the gop carried over from the previous range. gl is in the packet ids of the
+//range, carry in those of the merged result, llShift apart
+static void StitchGop(GOP_LIST& gl,GOP_RUNS& runs,const GOP_STATE& seam,const GOP_STATE& carry,long long llShift)
+{
+    GopRunsDropFront(runs,seam.gl.gop_size);
+    runs.insert(runs.begin(),carry.runs.begin(),carry.runs.end());
+    gl.gop_size = carry.gl.gop_size + gl.gop_size - seam.gl.gop_size;
+    gl.gop_bytes = carry.gl.gop_bytes + gl.gop_bytes - seam.gl.gop_bytes;
+    if (!carry.runs.empty())
+    {
+        gl.start_pos = carry.gl.start_pos + llShift;
+        gl.pts = carry.gl.pts;
+    }
+    gl.idr = !runs.empty() && GOP_RUN_TYPE(runs[0]) == FRAME_IDR;
+    gl.run_offset = 0;
+    gl.run_count = (unsigned int)runs.size();
+}
+
+//append the gops of src from nFirst on to dst and move their packet ids back by llShift
+static void AppendGops(PROGRAM_INFO* dst,const PROGRAM_INFO* src,size_t nFirst,long long llShift)
+{
+    for (size_t i = nFirst; i < src->gopList.size(); i++)
+    {
+        const GOP_LIST& gl = src->gopList[i];
+        dst->AddGop(gl,gl.run_count > 0 ? &src->gopRuns[gl.run_offset] : NULL,gl.run_count,llShift);
+    }
+}
+
+//decode every packet header once and hand the result to both the demux and
+//the tr101290 engine
+static void ProcessPackets(CMpegDec* pMpegDec,Clibtr101290* pTrcore,BYTE* pData,int nLen,int nTsLength,vector<TS_PACKET_INFO>& vecInfo)
+{
+    int nSliceLen = PACKET_INFO_SLICE * nTsLength;
+    vecInfo.resize(PACKET_INFO_SLICE);
+    for (int pos = 0; pos < nLen; pos += nSliceLen)
+    {
+        int len = nLen - pos < nSliceLen ? nLen - pos : nSliceLen;
+        int n = 0;
+        for (int i = 0; i < len; i+= nTsLength)
+        {
+            ParseTsPacketInfo(pData+pos+i,vecInfo[n++]);
+        }
+
+        pMpegDec->ProcessPackets(&vecInfo[0],n);
+        pTrcore->AddPackets(&vecInfo[0],n);
+    }
+}
+
+static void ProcessRangeData(FILE_RANGE_T* range,BYTE* pData,int nLen,long long llOffset,bool bPreroll)
+{
+    ProcessPackets(range->pMpegDec,range->pTrcore,pData,nLen,range->nTsLength,range->vecInfo);
+
+    //the preroll only feeds the sections, sections split by the table start are
+    //completed from it
+    if (bPreroll && !range->bCollectTables)
+    {
+        return;
+    }
+
+    for (int i = 0; i < nLen; i+= range->nTsLength)
+    {
+        if (pData[i] != 0x47)
+        {
+            if (!bPreroll)
+            {
+                range->llInvalidPkts++;
+            }
+            continue;
+        }
+        if (range->bCollectTables)
+        {
+            range->sections.Push(pData+i,llOffset + i >= range->llTableStart);
+        }
+    }
+}
+
+//the first READ_BUF_SIZE bytes, whole packets only. NULL if nothing could be read
+static BYTE* ReadProbe(int fd,int nTsLength,int nSyncByte,int& nProbeLen)
+{
+    BYTE* pProbe = new BYTE[READ_BUF_SIZE];
+    nProbeLen = (int)pread(fd,pProbe,READ_BUF_SIZE,nSyncByte);
+    if (nProbeLen <= 0)
+    {
+        delete [] pProbe;
+        return NULL;
+    }
+    nProbeLen -= nProbeLen % nTsLength;
+    return pProbe;
+}
+
+//a range of [llStart,llEnd). all but range 0 get their own decoders, whose
+//reports go to pfCB, and start RANGE_PREROLL_SIZE bytes early
+static FILE_RANGE_T* NewRange(const EASYICE* handle,int nTsLength,int nSyncByte,BYTE* pProbe,int nProbeLen,
+                              int nIndex,long long llStart,long long llEnd,pfReportCB pfCB)
+{
+    FILE_RANGE_T* range = new FILE_RANGE_T();
+    range->nIndex = nIndex;
+    range->mrl = handle->mrl;
+    range->nTsLength = nTsLength;
+    range->llSyncByte = nSyncByte;
+    range->nReadDepth = handle->file_read_depth;
+    range->nReadBlockSize = handle->file_read_block_size;
+    range->bDropCache = handle->file_drop_cache != 0;
+    range->pProbe = pProbe;
+    range->nProbeLen = nProbeLen;
+    range->llStart = llStart;
+    range->llEnd = llEnd;
+    range->llPrerollStart = llStart;
+    range->llTableStart = llStart;
+    range->bCollectTables = false;
+    range->llInvalidPkts = 0;
+    range->llDone = 0;
+    range->ret = 0;
+    range->pMpegDec = NULL;
+    range->pTrcore = NULL;
+    range->pbStop = NULL;
+
+    if (nIndex > 0)
+    {
+        long long llPreroll = RANGE_PREROLL_SIZE - RANGE_PREROLL_SIZE % nTsLength;
+        range->llPrerollStart = llStart - llPreroll > nSyncByte ? llStart - llPreroll : nSyncByte;
+
+        range->pMpegDec = new CMpegDec();
+        range->pMpegDec->Init(nTsLength,(range->llEnd - range->llPrerollStart) / nTsLength);
+        range->pMpegDec->SetTimestampDecimation((SERIES_DECIMATE_MODE)handle->file_ts_decimation,handle->file_ts_max_samples > 0 ? handle->file_ts_max_samples : 0);
+
+        range->pTrcore = new Clibtr101290();
+        range->pTrcore->SetReportCB(pfCB,range);
+        range->pTrcore->SetStartOffset(range->llPrerollStart);
+        range->pTrcore->SetTsLen(nTsLength);
+    }
+    return range;
+}
+
+static void DeleteRange(FILE_RANGE_T* range)
+{
+    if (range->nIndex > 0)
+    {
+        delete range->pMpegDec;
+        delete range->pTrcore;
+    }
+    delete range;
 }
 
 
+
 int FileAnalysis::GetTsLength(const char* PathName,int& nSyncByte)
 {
 	nSyncByte = 0;
@@ -75,15 +367,8 @@ int FileAnalysis::GetTsLength(const char* PathName,int& nSyncByte)
 	//	delete [] pBuffer;
 	//	return ERROR_FILE_NOT_DATA;
 	//}
-	if(pBuffer[0]==0x47&&pBuffer[188]==0x47&&pBuffer[188*2]==0x47&&pBuffer[188*3]==0x47&&pBuffer[188*4]==0x47)
-			ret=188;
-	else if(pBuffer[0]==0x47&&pBuffer[204]==0x47&&pBuffer[204*2]==0x47&&pBuffer[204*3]==0x47&&pBuffer[204*4]==0x47)
-			ret=204;
-	else
-	{
-		//尝试重新同步
-			ret = TryToReSync(pBuffer,bufferLength,nSyncByte);
-	}
+	//offset 0 first, otherwise the first position where the packets line up
+	ret = DetectTsLength(pBuffer,(int)numread,nSyncByte);
 	delete [] pBuffer;
 	fclose(fp);
 	return ret;
@@ -101,9 +386,11 @@ FileAnalysis::FileAnalysis()
     nlibtr101290 = CALL_PASSWD;
 
     m_pTrView = new CTrView();
-    m_pTrcore->SetReportCB(CTrView::OnTrReport,m_pTrView);
+    m_pTrcore->SetReportCB(OnTrReport,this);
 
     m_pEiMediaInfo = new CEiMediaInfo();
+    m_bCheckpoint = false;
+    m_pbStop = NULL;
 }
 
 
@@ -139,66 +426,589 @@ int FileAnalysis::OpenMRL(const EASYICE* handle)
 	}
 
 
-	FILE* fp = fopen(handle->mrl,"rb");
-	if (fp == NULL)
+	//easyice checking
+	m_pMpegDec->Init(nTsLength,filestat.st_size/nTsLength);
+    m_pMpegDec->SetTimestampDecimation((SERIES_DECIMATE_MODE)handle->file_ts_decimation,handle->file_ts_max_samples > 0 ? handle->file_ts_max_samples : 0);
+    //the eit schedule goes to the store of the handle, range 0 gets the sections of all ranges
+    m_pMpegDec->m_TableAnalyzer.SetEpgStore((tables::CEpgStore*)handle->epg_handle);
+
+    m_pTrcore->SetStartOffset(nSyncByte);
+    m_pTrcore->SetTsLen(nTsLength);
+
+    //a checkpoint covers whole packets only, the tail is analyzed once it is complete
+    long long llEnd = nSyncByte + (filestat.st_size - nSyncByte) / nTsLength * nTsLength;
+    m_bCheckpoint = handle->file_checkpoint != 0 && !handle->b_file_check_park;
+    if (m_bCheckpoint)
+    {
+        m_pMpegDec->m_TableAnalyzer.EnableSectionLog();
+    }
+
+    int ret = 0;
+    if (m_bCheckpoint)
+    {
+        ret = ResumeFile(handle,nTsLength,nSyncByte,llEnd);
+    }
+    if (ret != 0)
+    {
+        //resumed or failed
+    }
+    else if (handle->file_threads > 1 && !handle->b_file_check_park &&
+        filestat.st_size - nSyncByte >= handle->file_threads * RANGE_MIN_SIZE)
+    {
+        ret = AnalyzeFileParallel(handle,nTsLength,nSyncByte,filestat.st_size);
+    }
+    else
+    {
+        ret = AnalyzeFile(handle,nTsLength,nSyncByte,m_bCheckpoint ? llEnd : -1);
+    }
+    if (ret < 0 || IsStopped())
+    {
+        return -1;
+    }
+
+    if (m_bCheckpoint)
+    {
+        SaveFileCheckpoint(handle,nTsLength,nSyncByte,llEnd);
+    }
+
+    m_pMpegDec->Finish();
+
+    //mediainfo check
+    string mi = m_pEiMediaInfo->CheckMediaInfo(handle->mrl);
+    string ffprobe = m_pEiMediaInfo->ffprobe_all(handle->mrl);
+
+    //dump output
+    WriteOutputFiles(handle->mrl,mi,ffprobe);
+    
+    return 0;
+}
+
+void FileAnalysis::SetStopFlag(volatile bool* pbStop)
+{
+    m_pbStop = pbStop;
+    m_pMpegDec->SetStopFlag(pbStop);
+}
+
+int FileAnalysis::AnalyzeFile(const EASYICE* handle,int nTsLength,int nSyncByte,long long llEnd)
+{
+	CMmapReader reader;
+    //the probe runs on the first window, it must hold READ_BUF_SIZE bytes
+    if (handle->file_read_block_size > 0)
+    {
+        reader.SetWindowSize(handle->file_read_block_size > READ_BUF_SIZE ? handle->file_read_block_size : READ_BUF_SIZE);
+    }
+    reader.SetReadAhead(handle->file_read_depth);
+    reader.SetDropCache(handle->file_drop_cache != 0);
+	if (!reader.Open(handle->mrl,nSyncByte,llEnd))
 	{
         ei_log(LV_ERROR,"libeasyice","open file faild:%s",handle->mrl);
 		return -1;
 	}
 
-	if (nSyncByte != 0)
-	{
-		fseek(fp,nSyncByte,SEEK_SET);
-	}
-    
-	//easyice checking
-	BYTE* buf = new BYTE[READ_BUF_SIZE];
-	m_pMpegDec->Init(nTsLength,filestat.st_size/nTsLength);
     m_pMpegDec->SetProgressFunCb((easyice_progress_callback)handle->progress_cb_func,handle->progress_cb_data);
 
-    m_pTrcore->SetStartOffset(nSyncByte);
-    m_pTrcore->SetTsLen(nTsLength);
-
 	long long total_size = 0;
     bool bfirst = true;
     int size = 0;
+    BYTE* buf = NULL;
+    vector<TS_PACKET_INFO> vecInfo;
 	while(1)
 	{
 		if (handle->b_file_check_park && total_size > 50000000)//50M
 		{
 			break;
 		}
-		if ((size = fread(buf,1,READ_BUF_SIZE,fp)) <= 0)
+        if (IsStopped())
+        {
+            break;
+        }
+        //buf points into the mapped file, no copy is made
+		if ((size = reader.Next(buf,nTsLength)) <= 0)
         {
             break;
         }
         if (bfirst)
         {
-            m_pMpegDec->ProbeMediaInfo(buf,size);
+            m_pMpegDec->ProbeMediaInfo(buf,size < READ_BUF_SIZE ? size : READ_BUF_SIZE);
+            //both see the same packets here, so the table analyzer takes the sections
+            //put together by the tr101290 engine. in the parallel mode range 0 keeps its
+            //own reassembly and takes the sections kept by the other ranges after join
+            if (m_pMpegDec->IsTableAnaEnable())
+            {
+                m_pTrcore->AddSectionConsumer(m_pMpegDec->m_TableAnalyzer.UseSharedSections());
+            }
             bfirst = false;
         }
-		m_pMpegDec->ProcessBuffer(buf,size);
+        ProcessPackets(m_pMpegDec,m_pTrcore,buf,size,nTsLength,vecInfo);
+        total_size += size;
+    }
+    if (size < 0)
+    {
+        ei_log(LV_ERROR,"libeasyice","read file faild:%s",handle->mrl);
+        return -1;
+    }
+
+    if (m_bCheckpoint)
+    {
+        m_pMpegDec->m_pDemuxTs->GetGopState(m_mapGopCarry);
+    }
+    return 0;
+}
 
-        for (int i = 0; i < size; i+= nTsLength)
+/**
+ * Every range is analyzed by its own CMpegDec and Clibtr101290. Range 0 uses
+ * m_pMpegDec and m_pTrcore, so it behaves exactly like the single thread mode
+ * for its part of the file; the results of the other ranges are merged into
+ * them in file order after all threads have finished:
+ *  - pid counts are added up
+ *  - timestamps, rates and gops are appended, the first gop of a range is
+ *    stitched with the unfinished gop at the end of the previous one
+ *  - psi/si packets are fed to the table analyzer of range 0
+ *  - tr101290 reports are replayed into m_pTrView
+ * A range starts RANGE_PREROLL_SIZE bytes before its first byte, so continuity
+ * counters, pes/pcr state and the psi/pcr intervals are rebuilt from the real
+ * data before the seam and no false errors are reported there.
+ */
+int FileAnalysis::AnalyzeFileParallel(const EASYICE* handle,int nTsLength,int nSyncByte,long long llFileSize)
+{
+    int nRanges = handle->file_threads;
+    long long llPackets = (llFileSize - nSyncByte) / nTsLength;
+    long long llRangePackets = llPackets / nRanges;
+
+    int fd = open(handle->mrl,O_RDONLY);
+    if (fd < 0)
+    {
+        ei_log(LV_ERROR,"libeasyice","open file faild:%s",handle->mrl);
+        return -1;
+    }
+
+    int nProbeLen = 0;
+    BYTE* pProbe = ReadProbe(fd,nTsLength,nSyncByte,nProbeLen);
+    if (pProbe == NULL)
+    {
+        ei_log(LV_ERROR,"libeasyice","read file faild:%s",handle->mrl);
+        close(fd);
+        return -1;
+    }
+
+    vector<FILE_RANGE_T*> vecRanges;
+    for (int i = 0; i < nRanges; i++)
+    {
+        long long llStart = nSyncByte + i * llRangePackets * nTsLength;
+        long long llEnd = (i == nRanges - 1) ? nSyncByte + llPackets * nTsLength : llStart + llRangePackets * nTsLength;
+        FILE_RANGE_T* range = NULL;
+        if (i == 0)
         {
-            m_pTrcore->AddPacket(buf+i);
+            range = NewRange(handle,nTsLength,nSyncByte,pProbe,nProbeLen,i,llStart,llEnd,NULL);
+            range->pMpegDec = m_pMpegDec;
+            range->pTrcore = m_pTrcore;
         }
-        total_size += size;
+        else
+        {
+            range = NewRange(handle,nTsLength,nSyncByte,pProbe,nProbeLen,i,llStart,llEnd,OnRangeTrReport);
+        }
+        vecRanges.push_back(range);
     }
 
-    m_pMpegDec->Finish();
+    int ret = RunRanges(handle,vecRanges);
 
-    //mediainfo check
-    string mi = m_pEiMediaInfo->CheckMediaInfo(handle->mrl);
-    string ffprobe = m_pEiMediaInfo->ffprobe_all(handle->mrl);
+    //merge in file order
+    if (ret == 0)
+    {
+        map<int,GOP_STATE> mapGopCarry;
+        m_pMpegDec->m_pDemuxTs->GetGopState(mapGopCarry);
 
-    //dump output
-    WriteOutputFiles(handle->mrl,mi,ffprobe);
-    
-    fclose(fp);
-	delete [] buf;
-	
-    return 0;
+        long long llIdShift = vecRanges[0]->llInvalidPkts;
+        for (int i = 1; i < nRanges; i++)
+        {
+            FILE_RANGE_T* range = vecRanges[i];
+            MergeRange(range,mapGopCarry,llIdShift);
+            llIdShift += range->llInvalidPkts;
+            MergeTables(range);
+        }
+        m_mapGopCarry.swap(mapGopCarry);
+    }
+
+    for (int i = 0; i < nRanges; i++)
+    {
+        DeleteRange(vecRanges[i]);
+    }
+    delete [] pProbe;
+    close(fd);
+    return ret;
+}
+
+int FileAnalysis::RunRanges(const EASYICE* handle,vector<FILE_RANGE_T*>& vecRanges)
+{
+    int nRanges = (int)vecRanges.size();
+    long long llTotal = 0;
+    for (int i = 0; i < nRanges; i++)
+    {
+        llTotal += vecRanges[i]->llEnd - vecRanges[i]->llPrerollStart;
+    }
+
+    vector<pthread_t> vecThreads(nRanges);
+    for (int i = 0; i < nRanges; i++)
+    {
+        vecRanges[i]->pbStop = m_pbStop;
+        vecRanges[i]->pMpegDec->SetStopFlag(m_pbStop);
+        if (pthread_create(&vecThreads[i],NULL,RangeThread,vecRanges[i]) != 0)
+        {
+            ei_log(LV_ERROR,"libeasyice","create thread failed");
+            vecRanges[i]->ret = -1;
+            SetRangeDone(vecRanges[i],vecRanges[i]->llEnd - vecRanges[i]->llPrerollStart);
+            vecThreads[i] = 0;
+        }
+    }
+
+    //progress is reported here, the ranges have no callback
+    easyice_progress_callback pfProgressCb = (easyice_progress_callback)handle->progress_cb_func;
+    int nPct = -1;
+    while (1)
+    {
+        long long llDone = 0;
+        for (int i = 0; i < nRanges; i++)
+        {
+            llDone += GetRangeDone(vecRanges[i]);
+        }
+        int pct = (int)(llDone * PROGRESS_RANGE / llTotal);
+        if (pct != nPct)
+        {
+            nPct = pct;
+            if (pfProgressCb != NULL) pfProgressCb(pct,handle->progress_cb_data);
+        }
+        if (llDone >= llTotal)
+        {
+            break;
+        }
+        usleep(100000);
+    }
+
+    int ret = 0;
+    for (int i = 0; i < nRanges; i++)
+    {
+        if (vecThreads[i] != 0)
+        {
+            pthread_join(vecThreads[i],NULL);
+        }
+        if (vecRanges[i]->ret < 0)
+        {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+//feed the psi/si sections kept by a range to the table analyzer of range 0
+void FileAnalysis::MergeTables(FILE_RANGE_T* range)
+{
+    range->sections.Replay(&m_pMpegDec->m_TableAnalyzer);
+}
+
+void FileAnalysis::MergeRange(FILE_RANGE_T* range,map<int,GOP_STATE>& mapGopCarry,long long llIdShift)
+{
+    m_pMpegDec->MergePidCount(range->pMpegDec,llIdShift);
+
+    map<int,GOP_STATE> mapGopEnd;
+    range->pMpegDec->m_pDemuxTs->GetGopState(mapGopEnd);
+
+    ALL_PROGRAM_INFO* dst = m_pMpegDec->GetAllProgramInfo();
+    ALL_PROGRAM_INFO* src = range->pMpegDec->GetAllProgramInfo();
+    ALL_PROGRAM_INFO::iterator it = src->begin();
+    for (; it != src->end(); ++it)
+    {
+        ALL_PROGRAM_INFO::iterator it_dst = dst->find(it->first);
+        if (it_dst == dst->end())
+        {
+            continue;
+        }
+        PROGRAM_INFO* pi = it->second;
+        PROGRAM_INFO* pdst = it_dst->second;
+        PROGRAM_TIMESTAMPS& tts = pi->tts;
+
+        AppendShifted(pdst->tts.vecVpts,tts.vecVpts,llIdShift);
+        AppendShifted(pdst->tts.vecApts,tts.vecApts,llIdShift);
+        AppendShifted(pdst->tts.vecDts,tts.vecDts,llIdShift);
+        AppendShifted(pdst->tts.vecPcr,tts.vecPcr,llIdShift);
+        AppendShifted(pdst->tts.vecPtsSub,tts.vecPtsSub,llIdShift);
+        AppendShifted(pdst->tts.vecDtsSub,tts.vecDtsSub,llIdShift);
+        AppendShifted(pdst->tts.vecAPtsSub,tts.vecAPtsSub,llIdShift);
+        AppendEsShifted(pdst->tts,tts,llIdShift);
+        AppendShifted(pdst->rateList,pi->rateList,llIdShift);
+        pdst->frameStats.Merge(pi->frameStats,llIdShift);
+
+        GOP_STATE& carry = mapGopCarry[it->first];
+        const GOP_STATE& seam = range->mapGopSeam[it->first];
+        GOP_STATE& end = mapGopEnd[it->first];
+        if (pi->gopList.empty())
+        {
+            StitchGop(end.gl,end.runs,seam,carry,llIdShift);
+        }
+        else
+        {
+            GOP_LIST gl = pi->gopList[0];
+            GOP_RUNS runs(pi->gopRuns.begin() + gl.run_offset,pi->gopRuns.begin() + gl.run_offset + gl.run_count);
+            StitchGop(gl,runs,seam,carry,llIdShift);
+            pdst->AddGop(gl,runs.empty() ? NULL : &runs[0],runs.size(),llIdShift);
+            AppendGops(pdst,pi,1,llIdShift);
+        }
+        carry = end;
+        carry.gl.pos -= llIdShift;
+        carry.gl.start_pos -= llIdShift;
+    }
+
+    for (size_t i = 0; i < range->vecReports.size(); i++)
+    {
+        ReportTr(range->vecReports[i]);
+    }
+}
+
+void* FileAnalysis::RangeThread(void* arg)
+{
+    FILE_RANGE_T* range = (FILE_RANGE_T*)arg;
+    long long llLen = range->llEnd - range->llPrerollStart;
+
+    range->pMpegDec->ProbeMediaInfo(range->pProbe,range->nProbeLen);
+    if (range->nIndex > 0)
+    {
+        range->bCollectTables = range->pMpegDec->IsTableAnaEnable();
+        range->pMpegDec->DisableTableAna();
+        for (int pid = 0; range->bCollectTables && pid < SECTION_PID_COUNT; pid++)
+        {
+            if (range->pMpegDec->m_TableAnalyzer.IsTablePid(pid))
+            {
+                range->sections.Assembler().AddPid(pid);
+            }
+        }
+        range->pMpegDec->SetPreroll(true);
+    }
+
+    CMmapReader reader;
+    if (range->nReadBlockSize > 0)
+    {
+        reader.SetWindowSize(range->nReadBlockSize);
+    }
+    reader.SetReadAhead(range->nReadDepth);
+    reader.SetDropCache(range->bDropCache);
+    if (!reader.Open(range->mrl,range->llPrerollStart,range->llEnd))
+    {
+        ei_log(LV_ERROR,"libeasyice","open file faild:%s",range->mrl);
+        range->ret = -1;
+        SetRangeDone(range,llLen);
+        return NULL;
+    }
+
+    long long llOffset = range->llPrerollStart;
+    bool bPreroll = llOffset < range->llStart;
+    int size = 0;
+    BYTE* buf = NULL;
+    while (llOffset < range->llEnd && (size = reader.Next(buf,range->nTsLength)) > 0)
+    {
+        if (range->pbStop != NULL && *range->pbStop)
+        {
+            break;
+        }
+        if (size > range->llEnd - llOffset)
+        {
+            size = (int)(range->llEnd - llOffset);
+        }
+
+        int pos = 0;
+        if (bPreroll)
+        {
+            pos = llOffset + size <= range->llStart ? size : (int)(range->llStart - llOffset);
+            ProcessRangeData(range,buf,pos,llOffset,true);
+            if (llOffset + pos == range->llStart)
+            {
+                //the seam: drop what the preroll produced, keep the state
+                bPreroll = false;
+                range->pMpegDec->SetPreroll(false);
+                range->pMpegDec->m_pDemuxTs->SetPacketID((range->llStart - range->llSyncByte) / range->nTsLength);
+                range->pMpegDec->SetPacketID((range->llStart - range->llSyncByte) / range->nTsLength);
+                range->pMpegDec->m_pDemuxTs->GetGopState(range->mapGopSeam);
+
+                ALL_PROGRAM_INFO* info = range->pMpegDec->GetAllProgramInfo();
+                ALL_PROGRAM_INFO::iterator it = info->begin();
+                for (; it != info->end(); ++it)
+                {
+                    it->second->clear();
+                }
+            }
+        }
+        if (pos < size)
+        {
+            ProcessRangeData(range,buf+pos,size-pos,llOffset+pos,false);
+        }
+
+        llOffset += size;
+        SetRangeDone(range,llOffset - range->llPrerollStart);
+    }
+    if (size < 0)
+    {
+        ei_log(LV_ERROR,"libeasyice","read file faild:%s",range->mrl);
+        range->ret = -1;
+    }
+
+    SetRangeDone(range,llLen);
+    return NULL;
+}
+
+void FileAnalysis::OnRangeTrReport(REPORT_PARAM_T param)
+{
+    FILE_RANGE_T* range = (FILE_RANGE_T*)param.pApp;
+    if (param.llOffset < range->llStart)
+    {
+        return;
+    }
+    range->vecReports.push_back(param);
+}
+
+/**
+ * The checkpoint holds the results for [nSyncByte,ckpt.llOffset). They are
+ * restored into m_pMpegDec, m_pTrView and the table analyzer, then the bytes
+ * after the offset are analyzed as one more range of the parallel mode and
+ * merged the same way, its preroll rebuilding the state at the offset.
+ */
+int FileAnalysis::ResumeFile(const EASYICE* handle,int nTsLength,int nSyncByte,long long llEnd)
+{
+    CHECKPOINT_T ckpt;
+    ALL_PROGRAM_INFO mapSaved;
+    bool bOk = LoadCheckpoint(GetCheckpointPath(handle->mrl),ckpt,&mapSaved);
+    if (bOk)
+    {
+        //same file, grown or not, analyzed with the same options
+        unsigned long long ullHead = 0;
+        unsigned long long ullTail = 0;
+        bOk = ckpt.nTsLength == nTsLength && ckpt.nSyncByte == nSyncByte &&
+              ckpt.nTsMaxSamples == handle->file_ts_max_samples && ckpt.nTsDecimation == handle->file_ts_decimation &&
+              ckpt.llOffset > nSyncByte && ckpt.llOffset <= llEnd && (ckpt.llOffset - nSyncByte) % nTsLength == 0 &&
+              HashCheckpointFile(handle->mrl,nSyncByte,ckpt.llOffset,ullHead,ullTail) &&
+              ullHead == ckpt.ullHeadHash && ullTail == ckpt.ullTailHash;
+    }
+
+    int ret = 0;
+    int fd = -1;
+    BYTE* pProbe = NULL;
+    int nProbeLen = 0;
+    if (bOk)
+    {
+        fd = open(handle->mrl,O_RDONLY);
+        if (fd < 0 || (pProbe = ReadProbe(fd,nTsLength,nSyncByte,nProbeLen)) == NULL)
+        {
+            ei_log(LV_ERROR,"libeasyice","read file faild:%s",handle->mrl);
+            bOk = false;
+            ret = -1;
+        }
+    }
+
+    if (bOk)
+    {
+        ei_log(LV_DEBUG,"libeasyice","resume %s at %lld",handle->mrl,ckpt.llOffset);
+        m_pMpegDec->ProbeMediaInfo(pProbe,nProbeLen);
+        m_pMpegDec->m_TableAnalyzer.ReplaySectionLog(ckpt.sectionLog);
+
+        CPidStats& stats = m_pMpegDec->GetPidStats();
+        for (size_t i = 0; i < ckpt.vecPids.size(); i++)
+        {
+            stats.Set(ckpt.vecPids[i],ckpt.vecPidStats[i]);
+        }
+
+        ALL_PROGRAM_INFO* dst = m_pMpegDec->GetAllProgramInfo();
+        ALL_PROGRAM_INFO::iterator it = mapSaved.begin();
+        for (; it != mapSaved.end(); ++it)
+        {
+            ALL_PROGRAM_INFO::iterator it_dst = dst->find(it->first);
+            if (it_dst == dst->end())
+            {
+                continue;
+            }
+            PROGRAM_INFO* pi = it->second;
+            PROGRAM_INFO* pdst = it_dst->second;
+            AppendShifted(pdst->tts.vecVpts,pi->tts.vecVpts,0);
+            AppendShifted(pdst->tts.vecApts,pi->tts.vecApts,0);
+            AppendShifted(pdst->tts.vecDts,pi->tts.vecDts,0);
+            AppendShifted(pdst->tts.vecPcr,pi->tts.vecPcr,0);
+            AppendShifted(pdst->tts.vecPtsSub,pi->tts.vecPtsSub,0);
+            AppendShifted(pdst->tts.vecDtsSub,pi->tts.vecDtsSub,0);
+            AppendShifted(pdst->tts.vecAPtsSub,pi->tts.vecAPtsSub,0);
+            AppendEsShifted(pdst->tts,pi->tts,0);
+            AppendShifted(pdst->rateList,pi->rateList,0);
+            AppendGops(pdst,pi,0,0);
+            pdst->frameStats.Merge(pi->frameStats,0);
+        }
+
+        for (size_t i = 0; i < ckpt.vecReports.size(); i++)
+        {
+            ReportTr(ckpt.vecReports[i]);
+        }
+        m_mapGopCarry.swap(ckpt.mapGopCarry);
+
+        if (ckpt.llOffset < llEnd)
+        {
+            vector<FILE_RANGE_T*> vecRanges;
+            FILE_RANGE_T* range = NewRange(handle,nTsLength,nSyncByte,pProbe,nProbeLen,1,ckpt.llOffset,llEnd,OnRangeTrReport);
+            //sections split by the offset are completed from the preroll
+            range->llTableStart = range->llPrerollStart;
+            vecRanges.push_back(range);
+
+            ret = RunRanges(handle,vecRanges);
+            if (ret == 0)
+            {
+                MergeRange(range,m_mapGopCarry,ckpt.llInvalidPkts);
+                MergeTables(range);
+            }
+            DeleteRange(range);
+        }
+        else
+        {
+            easyice_progress_callback pfProgressCb = (easyice_progress_callback)handle->progress_cb_func;
+            if (pfProgressCb != NULL) pfProgressCb(PROGRESS_RANGE,handle->progress_cb_data);
+        }
+        if (ret == 0)
+        {
+            ret = 1;
+        }
+    }
+
+    ALL_PROGRAM_INFO::iterator it = mapSaved.begin();
+    for (; it != mapSaved.end(); ++it)
+    {
+        delete it->second;
+    }
+    delete [] pProbe;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return ret;
+}
+
+void FileAnalysis::SaveFileCheckpoint(const EASYICE* handle,int nTsLength,int nSyncByte,long long llEnd)
+{
+    CHECKPOINT_T ckpt;
+    ckpt.nTsLength = nTsLength;
+    ckpt.nSyncByte = nSyncByte;
+    ckpt.llOffset = llEnd;
+    ckpt.nTsMaxSamples = handle->file_ts_max_samples;
+    ckpt.nTsDecimation = handle->file_ts_decimation;
+    if (llEnd <= nSyncByte || !HashCheckpointFile(handle->mrl,nSyncByte,llEnd,ckpt.ullHeadHash,ckpt.ullTailHash))
+    {
+        return;
+    }
+
+    const CPidStats& stats = m_pMpegDec->GetPidStats();
+    ckpt.llInvalidPkts = (llEnd - nSyncByte) / nTsLength - stats.GetTotal();
+    ckpt.vecPids = stats.GetPids();
+    for (size_t i = 0; i < ckpt.vecPids.size(); i++)
+    {
+        ckpt.vecPidStats.push_back(stats.Get(ckpt.vecPids[i]));
+    }
+
+    ckpt.mapGopCarry = m_mapGopCarry;
+    ckpt.sectionLog = m_pMpegDec->m_TableAnalyzer.GetSectionLog();
+    ckpt.vecReports.swap(m_vecTrReports);
+
+    SaveCheckpoint(GetCheckpointPath(handle->mrl),ckpt,m_pMpegDec->GetAllProgramInfo());
 }
 
 void FileAnalysis::WriteFile(const string& filename,const string& data)
@@ -265,14 +1075,6 @@ void FileAnalysis::WriteOutputFiles(const char* mrl,const string& mi,const strin
     for (;it_all != allprograminfo->end();++it_all)
     {
         int prgmram_num = it_all->first;
-        PROGRAM_INFO* pi = it_all->second;
-	    std::vector<GOP_LIST>::iterator it_gop = pi->gopList.begin();
-        std::vector<RATE_LIST>::iterator it_rate = pi->rateList.begin();
-        
-        // the all timestamps
-        PROGRAM_TIMESTAMPS tts = pi->tts;
-
-
         char key[32];
         sprintf(key, "%d", prgmram_num);
         rootProg[key] = it_all->second->to_json();
@@ -288,7 +1090,17 @@ void FileAnalysis::WriteOutputFiles(const char* mrl,const string& mi,const strin
 
 void FileAnalysis::OnTrReport(REPORT_PARAM_T param)
 {
-//    m_pTrView->OnTrReport(param);
+    ((FileAnalysis*)param.pApp)->ReportTr(param);
+}
+
+void FileAnalysis::ReportTr(REPORT_PARAM_T param)
+{
+    if (m_bCheckpoint)
+    {
+        m_vecTrReports.push_back(param);
+    }
+    param.pApp = m_pTrView;
+    CTrView::OnTrReport(param);
 }
 
 
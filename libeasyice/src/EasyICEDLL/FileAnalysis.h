@@ -21,6 +21,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 class CMpegDec;
 class CTrView;
 class CEiMediaInfo;
+struct _FILE_RANGE_T;
 
 class FileAnalysis
 {
@@ -29,18 +30,46 @@ public:
     ~FileAnalysis();
         
     int OpenMRL(const EASYICE* handle);
+
+    //the analysis stops, without output, once *pbStop is true. NULL never stops
+    void SetStopFlag(volatile bool* pbStop);
 private: 
+    bool IsStopped() const { return m_pbStop != NULL && *m_pbStop; }
+
     int GetTsLength(const char* PathName,int& nSyncByte);
-    int TryToReSync(BYTE* pData,int nLength,int& nSycByte);
+
+    //single thread, the whole file in one pass, up to llEnd if it is not -1
+    int AnalyzeFile(const EASYICE* handle,int nTsLength,int nSyncByte,long long llEnd);
+
+    //split the file into handle->file_threads ranges and analyze them in parallel
+    int AnalyzeFileParallel(const EASYICE* handle,int nTsLength,int nSyncByte,long long llFileSize);
+    int RunRanges(const EASYICE* handle,std::vector<_FILE_RANGE_T*>& vecRanges);
+    void MergeRange(_FILE_RANGE_T* range,std::map<int,GOP_STATE>& mapGopCarry,long long llIdShift);
+    void MergeTables(_FILE_RANGE_T* range);
+    static void* RangeThread(void* arg);
+    static void OnRangeTrReport(REPORT_PARAM_T param);
+
+    //restore the results saved for the file and analyze only the bytes after
+    //them. 1 if resumed, 0 if there is no usable checkpoint, -1 on error
+    int ResumeFile(const EASYICE* handle,int nTsLength,int nSyncByte,long long llEnd);
+    void SaveFileCheckpoint(const EASYICE* handle,int nTsLength,int nSyncByte,long long llEnd);
 
     void WriteOutputFiles(const char* mrl,const string& mi,const string& ffprobe);
     void WriteFile(const string& filename,const string& data);
     static void OnTrReport(REPORT_PARAM_T param);
+    void ReportTr(REPORT_PARAM_T param);
 private:
     Clibtr101290* m_pTrcore;
     CMpegDec* m_pMpegDec;
     CTrView* m_pTrView;
     CEiMediaInfo* m_pEiMediaInfo;
+
+    //handle->file_checkpoint, the reports and the unfinished gops are kept for it
+    bool m_bCheckpoint;
+    std::vector<REPORT_PARAM_T> m_vecTrReports;
+    std::map<int,GOP_STATE> m_mapGopCarry;
+
+    volatile bool* m_pbStop;
 };
 
 
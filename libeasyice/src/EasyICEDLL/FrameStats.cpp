@@ -0,0 +1,156 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "FrameStats.h"
+
+#define PTS_MASK 0x1FFFFFFFFLL
+
+
+CFrameStats::CFrameStats()
+{
+    m_pOut = NULL;
+    m_nQueueHead = 0;
+    m_nQueueCount = 0;
+    m_llLastDts = -1;
+    m_llLastPos = 0;
+    ResetWindows(0);
+}
+
+void CFrameStats::ResetWindows(long long dts)
+{
+    memset(m_buckets,0,sizeof(m_buckets));
+    m_llBucket = dts / FRAME_RATE_BUCKET;
+    m_nClosedBuckets = 0;
+    m_llSum1s = 0;
+    m_llSum10s = 0;
+}
+
+void CFrameStats::AddFrameType(FRAME_TYPE FrameType,long long llPacketID)
+{
+    if (m_nQueueCount == FRAME_TYPE_QUEUE_SIZE)
+    {
+        m_nQueueHead = (m_nQueueHead + 1) % FRAME_TYPE_QUEUE_SIZE;
+        m_nQueueCount--;
+    }
+    int i = (m_nQueueHead + m_nQueueCount) % FRAME_TYPE_QUEUE_SIZE;
+    m_queuePos[i] = llPacketID;
+    m_queueType[i] = FrameType;
+    m_nQueueCount++;
+}
+
+FRAME_TYPE CFrameStats::TakeFrameType(const PES_UNIT_T& unit)
+{
+    //types found before the unit belong to units that were lost, those
+    //inside it are its pictures (or fields), the first one is taken
+    FRAME_TYPE FrameType = FRAME_UNKNOWN;
+    bool bFound = false;
+    while (m_nQueueCount > 0 && m_queuePos[m_nQueueHead] <= unit.llEndPacketID)
+    {
+        if (!bFound && m_queuePos[m_nQueueHead] >= unit.llPacketID)
+        {
+            FrameType = m_queueType[m_nQueueHead];
+            bFound = true;
+        }
+        m_nQueueHead = (m_nQueueHead + 1) % FRAME_TYPE_QUEUE_SIZE;
+        m_nQueueCount--;
+    }
+    return FrameType;
+}
+
+void CFrameStats::Advance(long long dts)
+{
+    long long llBucket = dts / FRAME_RATE_BUCKET;
+    while (m_llBucket < llBucket)
+    {
+        //close the bucket, the windows ending with it are full once enough buckets were seen
+        m_nClosedBuckets++;
+        if (m_nClosedBuckets >= FRAME_RATE_BUCKETS_1S && m_llSum1s * 8.0 > m_pOut->peak_rate_1s)
+        {
+            m_pOut->peak_rate_1s = m_llSum1s * 8.0;
+            m_pOut->peak_pos_1s = m_llLastPos;
+        }
+        if (m_nClosedBuckets >= FRAME_RATE_BUCKETS_10S && m_llSum10s * 0.8 > m_pOut->peak_rate_10s)
+        {
+            m_pOut->peak_rate_10s = m_llSum10s * 0.8;
+            m_pOut->peak_pos_10s = m_llLastPos;
+        }
+
+        //open the next one, dropping the buckets that leave the windows
+        m_llBucket++;
+        m_llSum1s -= m_buckets[(m_llBucket + FRAME_RATE_BUCKETS_10S - FRAME_RATE_BUCKETS_1S) % FRAME_RATE_BUCKETS_10S];
+        m_llSum10s -= m_buckets[m_llBucket % FRAME_RATE_BUCKETS_10S];
+        m_buckets[m_llBucket % FRAME_RATE_BUCKETS_10S] = 0;
+    }
+}
+
+void CFrameStats::OnPesUnit(const PES_UNIT_T& unit)
+{
+    if (m_pOut == NULL)
+    {
+        return;
+    }
+
+    FRAME_TYPE FrameType = TakeFrameType(unit);
+    FRAME_STATS& out = *m_pOut;
+    out.pid = unit.pid;
+    out.frames++;
+    out.bytes += unit.nPayloadSize;
+    if (!unit.bComplete)
+    {
+        out.incomplete++;
+    }
+
+    FRAME_TYPE_STATS& ts = out.types[FRAME_STATS::TypeIndex(FrameType)];
+    if (ts.count == 0 || unit.nPayloadSize < ts.min_size)
+    {
+        ts.min_size = unit.nPayloadSize;
+    }
+    if (unit.nPayloadSize > ts.max_size)
+    {
+        ts.max_size = unit.nPayloadSize;
+    }
+    ts.count++;
+    ts.bytes += unit.nPayloadSize;
+    int bin = 0;
+    for (int size = unit.nPayloadSize; size > 1 && bin < FRAME_SIZE_HIST_BINS - 1; size >>= 1)
+    {
+        bin++;
+    }
+    ts.hist[bin]++;
+
+    //frames without a timestamp stay at the time of the previous one
+    long long dts = unit.dts >= 0 ? unit.dts : unit.pts;
+    if (dts >= 0)
+    {
+        long long step = (dts - m_llLastDts) & PTS_MASK;
+        if (m_llLastDts >= 0 && step <= FRAME_MAX_DTS_STEP)
+        {
+            out.duration += step;
+        }
+        if (m_llLastDts >= 0 && step <= FRAME_MAX_DTS_STEP && dts >= m_llLastDts)
+        {
+            Advance(dts);
+        }
+        else
+        {
+            //first frame, time jump or the 33 bit wrap
+            ResetWindows(dts);
+        }
+        m_llLastDts = dts;
+    }
+
+    m_buckets[m_llBucket % FRAME_RATE_BUCKETS_10S] += unit.nPayloadSize;
+    m_llSum1s += unit.nPayloadSize;
+    m_llSum10s += unit.nPayloadSize;
+    m_llLastPos = unit.llPacketID;
+}
@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "commondefs.h"
+#include "PesAssembler.h"
+
+//the rate windows are summed from buckets of this many 90kHz ticks (100ms)
+#define FRAME_RATE_BUCKET       9000
+
+//buckets of the 1s and 10s windows
+#define FRAME_RATE_BUCKETS_1S   10
+#define FRAME_RATE_BUCKETS_10S  100
+
+//a dts step above this (10s) or backwards restarts the rate windows
+#define FRAME_MAX_DTS_STEP      (10*90000)
+
+//frame types seen but not yet matched with their pes unit
+#define FRAME_TYPE_QUEUE_SIZE   8
+
+/**
+ * Per-frame size and peak bitrate statistics of one video pid, fed with the
+ * pes units of the pid by CPesAssembler and with the frame types found by
+ * CProgramParser. One pes unit is taken as one frame, its size is the pes
+ * payload size and its type the first picture detected inside the unit.
+ *
+ * The 1s and 10s windows are sums over a fixed ring of 100ms buckets of the
+ * dts, so memory does not depend on the frame rate or the length of the
+ * input. The buckets are aligned on the dts itself rather than on the first
+ * frame, so that the windows are the same wherever the analysis started.
+ * A unit still being collected at the end of the input has no
+ * known size and is not counted, so that single thread, parallel and resumed
+ * analysis count the same frames.
+ */
+class CFrameStats : public IPesConsumer
+{
+public:
+    CFrameStats();
+
+    //results are accumulated into p, which may be cleared at any time
+    void SetOutput(FRAME_STATS* p) { m_pOut = p; }
+
+    //the picture found in packet llPacketID is of type FrameType
+    void AddFrameType(FRAME_TYPE FrameType,long long llPacketID);
+
+    virtual void OnPesUnit(const PES_UNIT_T& unit);
+
+private:
+    FRAME_TYPE TakeFrameType(const PES_UNIT_T& unit);
+
+    //move the windows forward to the bucket of dts
+    void Advance(long long dts);
+
+    //empty the windows and open the bucket of dts
+    void ResetWindows(long long dts);
+
+private:
+    FRAME_STATS* m_pOut;
+
+    long long m_queuePos[FRAME_TYPE_QUEUE_SIZE];
+    FRAME_TYPE m_queueType[FRAME_TYPE_QUEUE_SIZE];
+    int m_nQueueHead;
+    int m_nQueueCount;
+
+    //-1 before the first frame
+    long long m_llLastDts;
+
+    long long m_buckets[FRAME_RATE_BUCKETS_10S];
+    long long m_llBucket;       //dts / FRAME_RATE_BUCKET of the open bucket
+    int m_nClosedBuckets;       //closed since the windows were reset
+    long long m_llSum1s;
+    long long m_llSum10s;
+    long long m_llLastPos;
+};
@@ -0,0 +1,383 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "HevcParser.h"
+#include "BitReader.h"
+
+CHevcParser::CHevcParser()
+{
+    Reset();
+}
+
+void CHevcParser::Reset()
+{
+    m_result = PARSED_FRAME_INFO();
+    m_bParamSets = false;
+    m_nZeros = 0;
+    m_bCollecting = false;
+    m_nBuf = 0;
+    m_nNeed = 0;
+    memset(m_vps,0,sizeof(m_vps));
+    memset(m_sps,0,sizeof(m_sps));
+    memset(m_pps,0,sizeof(m_pps));
+}
+
+PARSED_FRAME_INFO CHevcParser::ParseTsContinue(const TS_PACKET_INFO& info)
+{
+    m_result = PARSED_FRAME_INFO();
+    m_bParamSets = false;
+
+    if (!info.sync || info.payload_offset < 0 || info.scrambling_control != 0)
+    {
+        return m_result;
+    }
+
+    const BYTE* p = info.pPacket + info.payload_offset;
+    int nLen = TS_PACKET_LENGTH_STANDARD - info.payload_offset;
+    if (info.pusi)
+    {
+        //a nal unit never spans two pes packets
+        if (m_bCollecting)
+        {
+            EndNal();
+        }
+        m_nZeros = 0;
+
+        if (info.pes_offset < 0 || nLen < 9)
+        {
+            return m_result;
+        }
+        int nHeader = 9 + p[8];
+        if (nLen <= nHeader)
+        {
+            return m_result;
+        }
+        p += nHeader;
+        nLen -= nHeader;
+    }
+
+    ParsePayload(p,nLen);
+    return m_result;
+}
+
+void CHevcParser::ParsePayload(const BYTE* p,int nLen)
+{
+    const BYTE* end = p + nLen;
+    while (p < end)
+    {
+        if (m_bCollecting)
+        {
+            BYTE b = *p++;
+            if (m_nZeros >= 2 && b == 0x01)
+            {
+                //the next start code, its zero bytes are not part of the nal unit
+                m_nBuf -= m_nZeros < m_nBuf ? m_nZeros : m_nBuf;
+                EndNal();
+                StartNal();
+                continue;
+            }
+            if (m_nZeros >= 2 && b == 0x03)
+            {
+                //emulation_prevention_three_byte
+                m_nZeros = 0;
+                continue;
+            }
+            m_nZeros = (b == 0) ? m_nZeros + 1 : 0;
+            m_buf[m_nBuf++] = b;
+
+            if (m_nBuf == 2)
+            {
+                int nal_unit_type = (m_buf[0] >> 1) & 0x3F;
+                int nuh_layer_id = ((m_buf[0] & 0x01) << 5) | (m_buf[1] >> 3);
+                if (nuh_layer_id != 0)
+                {
+                    //pictures of the enhancement layers are not counted
+                    m_bCollecting = false;
+                }
+                else if (nal_unit_type <= 9 || (nal_unit_type >= HEVC_NAL_BLA_W_LP && nal_unit_type <= HEVC_NAL_CRA_NUT))
+                {
+                    m_nNeed = 2 + HEVC_NAL_HEAD_SHORT;
+                }
+                else if (nal_unit_type == HEVC_NAL_VPS || nal_unit_type == HEVC_NAL_PPS)
+                {
+                    m_nNeed = 2 + HEVC_NAL_HEAD_SHORT;
+                    m_bParamSets = m_bParamSets || nal_unit_type == HEVC_NAL_VPS;
+                }
+                else if (nal_unit_type == HEVC_NAL_SPS)
+                {
+                    m_nNeed = HEVC_NAL_HEAD_LONG;
+                    m_bParamSets = true;
+                }
+                else
+                {
+                    m_bCollecting = false;
+                }
+            }
+            else if (m_nBuf >= m_nNeed)
+            {
+                EndNal();
+            }
+            continue;
+        }
+
+        //outside the collected heads only the start codes are looked for
+        const BYTE* one = (const BYTE*)memchr(p,0x01,end - p);
+        if (one == NULL)
+        {
+            int k = 0;
+            while (end - k > p && end[-k-1] == 0)
+            {
+                k++;
+            }
+            m_nZeros = (end - k == p) ? m_nZeros + k : k;
+            if (m_nZeros > 2)
+            {
+                m_nZeros = 2;
+            }
+            break;
+        }
+
+        const BYTE* q = one;
+        while (q > p && one - q < 2 && q[-1] == 0)
+        {
+            q--;
+        }
+        int nZeros = (q == p) ? m_nZeros + (int)(one - q) : (int)(one - q);
+        p = one + 1;
+        if (nZeros >= 2)
+        {
+            StartNal();
+        }
+        else
+        {
+            m_nZeros = 0;
+        }
+    }
+}
+
+void CHevcParser::StartNal()
+{
+    m_bCollecting = true;
+    m_nBuf = 0;
+    m_nNeed = 2;
+    m_nZeros = 0;
+}
+
+void CHevcParser::EndNal()
+{
+    m_bCollecting = false;
+    if (m_nBuf < 2)
+    {
+        return;
+    }
+
+    int nal_unit_type = (m_buf[0] >> 1) & 0x3F;
+    int temporal_id = (m_buf[1] & 0x07) - 1;
+    const BYTE* p = m_buf + 2;
+    int nLen = m_nBuf - 2;
+    switch (nal_unit_type)
+    {
+    case HEVC_NAL_VPS:
+        ParseVps(p,nLen);
+        break;
+    case HEVC_NAL_SPS:
+        ParseSps(p,nLen);
+        break;
+    case HEVC_NAL_PPS:
+        ParsePps(p,nLen);
+        break;
+    default:
+        ParseSliceHeader(p,nLen,nal_unit_type,temporal_id);
+        break;
+    }
+}
+
+void CHevcParser::ParseVps(const BYTE* p,int nLen)
+{
+    CBitReader br(p,nLen);
+    int vps_id = br.GetBits(4);
+    br.SkipBits(2);    //vps_base_layer_internal_flag, vps_base_layer_available_flag
+    int max_layers = br.GetBits(6) + 1;
+    int max_sub_layers = br.GetBits(3) + 1;
+    if (br.Overrun())
+    {
+        return;
+    }
+
+    HEVC_VPS_INFO& vps = m_vps[vps_id];
+    vps.max_layers = max_layers;
+    vps.max_sub_layers = max_sub_layers;
+    vps.valid = true;
+}
+
+void CHevcParser::ParseSps(const BYTE* p,int nLen)
+{
+    CBitReader br(p,nLen);
+    int vps_id = br.GetBits(4);
+    int max_sub_layers_minus1 = br.GetBits(3);
+    br.SkipBits(1);    //sps_temporal_id_nesting_flag
+    if (max_sub_layers_minus1 > 6)
+    {
+        return;
+    }
+
+    //profile_tier_level(1,sps_max_sub_layers_minus1)
+    br.SkipBits(2);    //general_profile_space
+    int tier_flag = br.GetBits(1);
+    int profile_idc = br.GetBits(5);
+    br.SkipBits(32 + 4 + 43 + 1);  //compatibility flags, source flags, constraint flags
+    int level_idc = br.GetBits(8);
+    int sub_layer_flags = 0;
+    for (int i = 0; i < max_sub_layers_minus1; i++)
+    {
+        sub_layer_flags = (sub_layer_flags << 2) | br.GetBits(2);
+    }
+    if (max_sub_layers_minus1 > 0)
+    {
+        br.SkipBits(2 * (8 - max_sub_layers_minus1));  //reserved_zero_2bits
+    }
+    for (int i = max_sub_layers_minus1 - 1; i >= 0; i--)
+    {
+        int flags = sub_layer_flags >> (2 * i);
+        if (flags & 0x02)
+        {
+            br.SkipBits(88);   //sub_layer profile
+        }
+        if (flags & 0x01)
+        {
+            br.SkipBits(8);    //sub_layer_level_idc
+        }
+    }
+
+    unsigned int sps_id = br.ReadUE();
+    if (sps_id >= HEVC_MAX_SPS_COUNT)
+    {
+        return;
+    }
+    int chroma_format_idc = br.ReadUE();
+    bool separate_colour_plane = false;
+    if (chroma_format_idc == 3)
+    {
+        separate_colour_plane = br.GetBit() != 0;
+    }
+    int width = br.ReadUE();
+    int height = br.ReadUE();
+    if (br.GetBit())   //conformance_window_flag
+    {
+        int left = br.ReadUE();
+        int right = br.ReadUE();
+        int top = br.ReadUE();
+        int bottom = br.ReadUE();
+        int sub_width = (!separate_colour_plane && (chroma_format_idc == 1 || chroma_format_idc == 2)) ? 2 : 1;
+        int sub_height = (!separate_colour_plane && chroma_format_idc == 1) ? 2 : 1;
+        width -= sub_width * (left + right);
+        height -= sub_height * (top + bottom);
+    }
+    int bit_depth_luma = br.ReadUE() + 8;
+    int bit_depth_chroma = br.ReadUE() + 8;
+    if (br.Overrun())
+    {
+        return;
+    }
+
+    HEVC_SPS_INFO& sps = m_sps[sps_id];
+    sps.vps_id = vps_id;
+    sps.max_sub_layers = max_sub_layers_minus1 + 1;
+    sps.profile_idc = profile_idc;
+    sps.tier_flag = tier_flag;
+    sps.level_idc = level_idc;
+    sps.chroma_format_idc = chroma_format_idc;
+    sps.width = width;
+    sps.height = height;
+    sps.bit_depth_luma = bit_depth_luma;
+    sps.bit_depth_chroma = bit_depth_chroma;
+    sps.valid = true;
+}
+
+void CHevcParser::ParsePps(const BYTE* p,int nLen)
+{
+    CBitReader br(p,nLen);
+    unsigned int pps_id = br.ReadUE();
+    unsigned int sps_id = br.ReadUE();
+    bool dependent_slice_segments_enabled = br.GetBit() != 0;
+    bool output_flag_present = br.GetBit() != 0;
+    int num_extra_slice_header_bits = br.GetBits(3);
+    if (br.Overrun() || pps_id >= HEVC_MAX_PPS_COUNT || sps_id >= HEVC_MAX_SPS_COUNT)
+    {
+        return;
+    }
+
+    HEVC_PPS_INFO& pps = m_pps[pps_id];
+    pps.sps_id = sps_id;
+    pps.dependent_slice_segments_enabled = dependent_slice_segments_enabled;
+    pps.output_flag_present = output_flag_present;
+    pps.num_extra_slice_header_bits = num_extra_slice_header_bits;
+    pps.valid = true;
+}
+
+void CHevcParser::ParseSliceHeader(const BYTE* p,int nLen,int nal_unit_type,int temporal_id)
+{
+    CBitReader br(p,nLen);
+    if (!br.GetBit())  //first_slice_segment_in_pic_flag
+    {
+        return;
+    }
+    if (nal_unit_type >= HEVC_NAL_BLA_W_LP && nal_unit_type <= HEVC_NAL_RSV_IRAP_23)
+    {
+        br.SkipBits(1);    //no_output_of_prior_pics_flag
+    }
+    unsigned int pps_id = br.ReadUE();
+
+    //before the first pps the extra bits are taken as absent, as in most streams
+    int extra_bits = 0;
+    if (pps_id < HEVC_MAX_PPS_COUNT && m_pps[pps_id].valid)
+    {
+        extra_bits = m_pps[pps_id].num_extra_slice_header_bits;
+    }
+    br.SkipBits(extra_bits);   //slice_reserved_flag
+    unsigned int slice_type = br.ReadUE();
+
+    FRAME_TYPE FrameType = FRAME_UNKNOWN;
+    if (nal_unit_type == HEVC_NAL_IDR_W_RADL || nal_unit_type == HEVC_NAL_IDR_N_LP)
+    {
+        FrameType = FRAME_IDR;
+    }
+    else if (nal_unit_type == HEVC_NAL_CRA_NUT)
+    {
+        FrameType = FRAME_CRA;
+    }
+    else if (nal_unit_type >= HEVC_NAL_BLA_W_LP && nal_unit_type <= HEVC_NAL_BLA_N_LP)
+    {
+        FrameType = FRAME_BLA;
+    }
+    else if (!br.Overrun())
+    {
+        switch (slice_type)
+        {
+        case 0: FrameType = FRAME_B; break;
+        case 1: FrameType = FRAME_P; break;
+        case 2: FrameType = FRAME_I; break;
+        default: break;
+        }
+    }
+
+    if (m_result.bNewPicture)
+    {
+        return;
+    }
+    m_result.bNewSlice = true;
+    m_result.bNewPicture = true;
+    m_result.FrameType = FrameType;
+    m_result.structure = STRUCTURE_FRAME;
+    m_result.temporal_id = temporal_id;
+}
@@ -0,0 +1,130 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "commondefs.h"
+#include "TsPacketInfo.h"
+
+//nal_unit_type values of ITU-T H.265 table 7-1 used by the parser
+#define HEVC_NAL_BLA_W_LP       16
+#define HEVC_NAL_BLA_N_LP       18
+#define HEVC_NAL_IDR_W_RADL     19
+#define HEVC_NAL_IDR_N_LP       20
+#define HEVC_NAL_CRA_NUT        21
+#define HEVC_NAL_RSV_IRAP_23    23
+#define HEVC_NAL_VPS            32
+#define HEVC_NAL_SPS            33
+#define HEVC_NAL_PPS            34
+
+#define HEVC_MAX_VPS_COUNT      16
+#define HEVC_MAX_SPS_COUNT      16
+#define HEVC_MAX_PPS_COUNT      64
+
+//escaped bytes of a nal unit collected for parsing, the slice segment header
+//fields we need and the pps lie well within the short size, the sps subset
+//after a profile_tier_level with all sub-layers present within the long one
+#define HEVC_NAL_HEAD_SHORT     16
+#define HEVC_NAL_HEAD_LONG      128
+
+typedef struct _HEVC_VPS_INFO
+{
+    bool valid;
+    int max_layers;
+    int max_sub_layers;
+}HEVC_VPS_INFO;
+
+typedef struct _HEVC_SPS_INFO
+{
+    bool valid;
+    int vps_id;
+    int max_sub_layers;
+    int profile_idc;
+    int tier_flag;
+    int level_idc;
+    int chroma_format_idc;
+    int width;              //after the conformance window
+    int height;
+    int bit_depth_luma;
+    int bit_depth_chroma;
+}HEVC_SPS_INFO;
+
+typedef struct _HEVC_PPS_INFO
+{
+    bool valid;
+    int sps_id;
+    bool dependent_slice_segments_enabled;
+    bool output_flag_present;
+    int num_extra_slice_header_bits;
+}HEVC_PPS_INFO;
+
+/**
+ * Streaming HEVC parser for the video pid of a program. It follows the
+ * elementary stream packet by packet and never buffers an access unit: the
+ * start codes are found with memchr, and only the first bytes of the nal
+ * units it cares about (parameter sets and slice segments) are un-escaped
+ * into a small buffer and parsed there, the rest of the payload is skipped.
+ *
+ * A picture starts at a slice segment with first_slice_segment_in_pic_flag
+ * set. Its type comes from the nal unit type for IDR, CRA and BLA pictures
+ * and from slice_type otherwise. The first picture starting in a packet is
+ * reported; a second one in the same 184 bytes would need a picture of less
+ * than a packet, which only happens in streams with no motion at all.
+ */
+class CHevcParser
+{
+public:
+    CHevcParser();
+
+    void Reset();
+
+    //feed the next packet of the pid, bNewPicture is set if a picture starts in it
+    PARSED_FRAME_INFO ParseTsContinue(const TS_PACKET_INFO& info);
+
+    //a vps or sps started in the last packet fed
+    bool HasParameterSets() const { return m_bParamSets; }
+
+    const HEVC_VPS_INFO& GetVps(int id) const { return m_vps[id & (HEVC_MAX_VPS_COUNT-1)]; }
+    const HEVC_SPS_INFO& GetSps(int id) const { return m_sps[id & (HEVC_MAX_SPS_COUNT-1)]; }
+    const HEVC_PPS_INFO& GetPps(int id) const { return m_pps[id & (HEVC_MAX_PPS_COUNT-1)]; }
+
+private:
+    void ParsePayload(const BYTE* p,int nLen);
+
+    //a start code was found, the following bytes are the nal unit header
+    void StartNal();
+
+    //the collected bytes are complete or the nal unit ended, parse them
+    void EndNal();
+
+    void ParseVps(const BYTE* p,int nLen);
+    void ParseSps(const BYTE* p,int nLen);
+    void ParsePps(const BYTE* p,int nLen);
+    void ParseSliceHeader(const BYTE* p,int nLen,int nal_unit_type,int temporal_id);
+
+private:
+    PARSED_FRAME_INFO m_result;
+    bool m_bParamSets;
+
+    //consecutive zero bytes just before the current position
+    int m_nZeros;
+
+    //collecting the escaped head of a nal unit
+    bool m_bCollecting;
+    BYTE m_buf[HEVC_NAL_HEAD_LONG];
+    int m_nBuf;
+    int m_nNeed;
+
+    HEVC_VPS_INFO m_vps[HEVC_MAX_VPS_COUNT];
+    HEVC_SPS_INFO m_sps[HEVC_MAX_SPS_COUNT];
+    HEVC_PPS_INFO m_pps[HEVC_MAX_PPS_COUNT];
+};
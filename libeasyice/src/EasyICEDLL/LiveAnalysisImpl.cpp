@@ -17,6 +17,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "CheckMediaInfo.h"
 #include "MpegDec.h"
 #include "LivePcrProc.h"
+#include "LiveFrameStats.h"
 //#include "cudpsend.h"
 #include "EiLog.h"
 #include "libtr101290.h"
@@ -25,6 +26,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <algorithm>
 #include "CheckMediaInfo.h"
 #include "TrView.h"
+#include "SyncScan.h"
 #include <unistd.h>
 
 using namespace std;
@@ -38,6 +40,17 @@ using namespace std;
 #define WAIT_FOR_ALL_PMT_TIMEOUT	3000000
 
 
+//ͳPTSĻƵĻ˽PES(DVBĻͼĵӵ)
+static bool IsEsPtsType(PACKET_TYPE type)
+{
+	if (type == PACKET_MPEG2_PES_PRIVATE)
+	{
+		return true;
+	}
+	AVMEDIATYPE media_type = GetMediaTypeByPacketType(type);
+	return media_type == AVMEDIA_TYPE_AUDIO || media_type == AVMEDIA_TYPE_SUBTITLE;
+}
+
 
 
 CLiveAnalysisImpl::CLiveAnalysisImpl(void) : m_event("LiveAnalysis")
@@ -62,6 +75,7 @@ CLiveAnalysisImpl::CLiveAnalysisImpl(void) : m_event("LiveAnalysis")
 
 	m_mpegdec = new CMpegDec();
 	m_pLiveProc = new CLivePcrProc();
+	m_pFrameStats = new CLiveFrameStats();
     m_pEiMediaInfo = new CEiMediaInfo();
 	//m_pUdpSend = new CUdpSend();
 
@@ -74,6 +88,8 @@ CLiveAnalysisImpl::CLiveAnalysisImpl(void) : m_event("LiveAnalysis")
     m_event.Reset();
     m_pTrView = new CTrView();
     m_pTrcore->SetReportCB(CTrView::OnTrReport,m_pTrView);
+    //ʹTR 101 290òУsection
+    m_pTrcore->AddSectionConsumer(m_mpegdec->m_TableAnalyzer.UseSharedSections());
     m_bWorkThreadValid = false;;
     m_bMiThreadValid = false;
     m_bRecordThreadValid = false;
@@ -91,6 +107,7 @@ CLiveAnalysisImpl::~CLiveAnalysisImpl(void)
 	delete m_pTrcore;
 	delete m_mpegdec;
 	delete m_pLiveProc;
+	delete m_pFrameStats;
     delete m_pTrView;
     delete m_pEiMediaInfo;
 	//delete m_pUdpSend;
@@ -124,6 +141,9 @@ int CLiveAnalysisImpl::OpenMRL(EASYICE* handle)
 	//ת
 	//m_pUdpSend->InitSend("127.0.0.1",7789);
 	
+	//EIT schedulehandleEPG洢ڷвѯ
+	m_mpegdec->m_TableAnalyzer.SetEpgStore((tables::CEpgStore*)handle->epg_handle);
+
 	m_pSource->SetRecvDataCB(OnRecvData,this);
 	int ret = m_pSource->Run();
 	if (ret < 0)
@@ -243,13 +263,10 @@ void CLiveAnalysisImpl::WorkFun()
 void CLiveAnalysisImpl::ProcessItem(BYTE* pItem,int nSize,long long llTime)
 {
 	//Ͻͬ
-	for (int i = 0; i < nSize; i+=m_nTsLength)
+	if (FindSyncError(pItem,nSize,m_nTsLength) >= 0)
 	{
-		if (pItem[i] != 0x47)
-		{
-            ei_log(LV_WARNING,"libeasyice","skiping error bytes packet...");
-			return;
-		}
+        ei_log(LV_WARNING,"libeasyice","skiping error bytes packet...");
+		return;
 	}
 
 	if (m_llFirstByteRecvTime < 0)
@@ -281,10 +298,17 @@ void CLiveAnalysisImpl::ProcessItem(BYTE* pItem,int nSize,long long llTime)
 	}
 
 
-	for (int i = 0; i < nSize; i+= m_nTsLength)
+	//ݱİͷһΣģ
+	int nPackets = nSize / m_nTsLength;
+	m_vecPacketInfo.resize(nPackets);
+	for (int k = 0; k < nPackets; k++)
 	{
-		m_pTrcore->AddPacket(pItem+i);
-		m_mpegdec->LiveProcessPacket(pItem+i);
+		ParseTsPacketInfo(pItem+k*m_nTsLength,m_vecPacketInfo[k]);
+	}
+	if (nPackets > 0)
+	{
+		m_pTrcore->AddPackets(&m_vecPacketInfo[0],nPackets);
+		m_mpegdec->LiveProcessPackets(&m_vecPacketInfo[0],nPackets);
 	}
 
 	// ص
@@ -294,8 +318,23 @@ void CLiveAnalysisImpl::ProcessItem(BYTE* pItem,int nSize,long long llTime)
 
         LiveCallBackPidList();
         LiveCallBackPcr();
+        LiveCallBackEsPts();
+        LiveCallBackFrameStats();
         LiveCallBackRate();
         LiveCallBackTr101290();
+
+		//汾и£·PSI
+		m_mpegdec->m_TableAnalyzer.TakeSectionChanges(m_vecSectionChange);
+		for (size_t i = 0; i < m_vecSectionChange.size(); i++)
+		{
+			const tables::SECTION_CHANGE_T& change = m_vecSectionChange[i];
+			ei_log(LV_INFO,"libeasyice","table changed: pid %d table_id 0x%02X extension %d section %d version %d -> %d",
+				change.pid,change.table_id,change.extension,change.section_number,change.old_version,change.new_version);
+		}
+		if (!m_vecSectionChange.empty() && m_bMediaInfoChecked)
+		{
+			LiveCallBackPsi();
+		}
 	}
 
 	if (!m_bInited)
@@ -311,14 +350,34 @@ void CLiveAnalysisImpl::ProcessItem(BYTE* pItem,int nSize,long long llTime)
 			for (; it != pBrif->end(); it++)
 			{
 				vector<PID_TYPE>& pids = it->second;
+				int pcr_pid = -1;
 				for (size_t i = 0; i < pids.size(); i++)
 				{
 					if (pids[i].type == PACKET_PCR)
 					{
+						pcr_pid = pids[i].pid;
 						m_pLiveProc->AddPcrPid(pids[i].pid);//ظӵpidڻж
 						break;
 					}
 				}
+
+				//ƵĻȻPTS
+				for (size_t i = 0; i < pids.size(); i++)
+				{
+					if (IsEsPtsType(pids[i].type))
+					{
+						m_pLiveProc->AddEsPid(pids[i].pid,pcr_pid);
+					}
+				}
+
+				//Ƶ֡ͳ
+				for (size_t i = 0; i < pids.size(); i++)
+				{
+					if (GetMediaTypeByPacketType(pids[i].type) == AVMEDIA_TYPE_VIDEO)
+					{
+						m_pFrameStats->AddVideoPid(pids[i].pid,pids[i].type);
+					}
+				}
 			}
 
 			// init ok
@@ -331,7 +390,11 @@ void CLiveAnalysisImpl::ProcessItem(BYTE* pItem,int nSize,long long llTime)
 		return;
 	}
 
-	m_pLiveProc->ProcessBuffer(pItem,nSize,llTime);
+	m_pLiveProc->ProcessBuffer(pItem,nSize,llTime,m_vecPacketInfo.empty() ? NULL : &m_vecPacketInfo[0]);
+	if (nPackets > 0)
+	{
+		m_pFrameStats->ProcessPackets(&m_vecPacketInfo[0],nPackets);
+	}
 
 
 }
@@ -542,6 +605,81 @@ void CLiveAnalysisImpl::LiveCallBackPcr()
     ((easyice_udplive_callback)m_pHandle->udplive_cb_func)(UDPLIVE_CALLBACK_PCR,root.toStyledString().c_str(),m_pHandle->udplive_cb_data);
 }
 
+void CLiveAnalysisImpl::LiveCallBackEsPts()
+{
+    ALL_PROGRAM_BRIEF* pBrif = GetAllProgramBrief();
+
+    ALL_PROGRAM_BRIEF::iterator it = pBrif->begin();
+
+    Json::Value root;
+    for(;it != pBrif->end();++it)
+    {
+        vector<PID_TYPE>& pids = it->second;
+        Json::Value esRoot;
+        for (size_t i = 0; i < pids.size(); i++)
+        {
+            if (!IsEsPtsType(pids[i].type))
+            {
+                continue;
+            }
+            LST_ES_PTS_INFO_T* pPtsInfo = m_pLiveProc->LockGetEsPtsInfo(pids[i].pid);
+            if (pPtsInfo == NULL)
+            {
+                continue;
+            }
+            Json::Value ptsArray;
+            LST_ES_PTS_INFO_T::iterator itPts = pPtsInfo->begin();
+            for (; itPts != pPtsInfo->end(); ++itPts)
+            {
+                ptsArray.append(itPts->to_json());
+            }
+            m_pLiveProc->UnlockEsPtsInfo(pids[i].pid);
+
+            char key[32];
+            sprintf(key, "%d", pids[i].pid);
+            esRoot[key] = ptsArray;
+        }
+        char buf[32];
+        sprintf(buf, "%d", it->first);
+        root[buf] = esRoot;
+    }
+    ((easyice_udplive_callback)m_pHandle->udplive_cb_func)(UDPLIVE_CALLBACK_ES_PTS,root.toStyledString().c_str(),m_pHandle->udplive_cb_data);
+}
+
+void CLiveAnalysisImpl::LiveCallBackFrameStats()
+{
+    ALL_PROGRAM_BRIEF* pBrif = GetAllProgramBrief();
+
+    ALL_PROGRAM_BRIEF::iterator it = pBrif->begin();
+
+    Json::Value root;
+    for(;it != pBrif->end();++it)
+    {
+        vector<PID_TYPE>& pids = it->second;
+        Json::Value videoRoot;
+        for (size_t i = 0; i < pids.size(); i++)
+        {
+            if (GetMediaTypeByPacketType(pids[i].type) != AVMEDIA_TYPE_VIDEO)
+            {
+                continue;
+            }
+            //Կʼۼֵ
+            FRAME_STATS* pStats = m_pFrameStats->GetFrameStats(pids[i].pid);
+            if (pStats == NULL)
+            {
+                continue;
+            }
+            char key[32];
+            sprintf(key, "%d", pids[i].pid);
+            videoRoot[key] = pStats->to_json();
+        }
+        char buf[32];
+        sprintf(buf, "%d", it->first);
+        root[buf] = videoRoot;
+    }
+    ((easyice_udplive_callback)m_pHandle->udplive_cb_func)(UDPLIVE_CALLBACK_FRAME_STATS,root.toStyledString().c_str(),m_pHandle->udplive_cb_data);
+}
+
 void CLiveAnalysisImpl::LiveCallBackRate()
 {
     LST_RATE_INFO_T* pRateInfo = LockGetRate();
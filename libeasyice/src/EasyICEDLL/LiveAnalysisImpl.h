@@ -16,12 +16,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdio.h>
 #include "zevent.h"
 #include "commondefs.h"
+#include "TsPacketInfo.h"
+#include "tables/CSectionCache.h"
+#include <vector>
 
 
 class CMpegDec;
 class CLiveSourceBase;
 class CCircularBuffer;
 class CLivePcrProc;
+class CLiveFrameStats;
 class CUdpSend;
 class Clibtr101290;
 class CEiMediaInfo;
@@ -70,6 +74,8 @@ private:
     void LiveCallBackPidList();
     void LiveCallBackPsi();
     void LiveCallBackPcr();
+    void LiveCallBackEsPts();
+    void LiveCallBackFrameStats();
     void LiveCallBackRate();
     void LiveCallBackProgramInfoBrief();
     void LiveCallBackTr101290();
@@ -97,9 +103,15 @@ private:
 	//һεûصʱ
 	long long m_llCbUpdateTime;
 
+	//ϴλصı汾仯
+	vector<tables::SECTION_CHANGE_T> m_vecSectionChange;
+
 	CMpegDec *m_mpegdec;
 	CLivePcrProc *m_pLiveProc;
 
+	//Ƶ֡Сֵ
+	CLiveFrameStats *m_pFrameStats;
+
 	//͵Թvlc
 	//CUdpSend* m_pUdpSend;
 
@@ -125,6 +137,9 @@ private:
     CEiMediaInfo* m_pEiMediaInfo;
     CTrView* m_pTrView;
 
+    //ǰݿиԤİͷϢTR101290PIDͳƺPCR⹲
+    vector<TS_PACKET_INFO> m_vecPacketInfo;
+
     bool m_bWorkThreadValid;
     bool m_bMiThreadValid;
     bool m_bRecordThreadValid;
@@ -0,0 +1,106 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <string.h>
+#include "LiveFrameStats.h"
+
+
+CLiveFrameStats::CLiveFrameStats()
+{
+    m_pVideo = new VIDEO_STATE_T*[PES_PID_COUNT];
+    memset(m_pVideo,0,sizeof(VIDEO_STATE_T*) * PES_PID_COUNT);
+    m_llPacketID = 0;
+}
+
+CLiveFrameStats::~CLiveFrameStats()
+{
+    for (int i = 0; i < PES_PID_COUNT; i++)
+    {
+        delete m_pVideo[i];
+    }
+    delete [] m_pVideo;
+}
+
+void CLiveFrameStats::AddVideoPid(int pid,PACKET_TYPE type)
+{
+    if (pid < 0 || pid >= PES_PID_COUNT || m_pVideo[pid] != NULL)
+    {
+        return;
+    }
+
+    VIDEO_STATE_T* pState = new VIDEO_STATE_T;
+    pState->type = type;
+    pState->out.pid = pid;
+    pState->frameStats.SetOutput(&pState->out);
+    m_pVideo[pid] = pState;
+    m_pesAssembler.AddConsumer(pid,&pState->frameStats);
+}
+
+void CLiveFrameStats::DetectFrameType(VIDEO_STATE_T* pState,const TS_PACKET_INFO& info)
+{
+    if (pState->type == PACKET_MPEG2_VIDEO)
+    {
+        BYTE bPic = 0;
+        m_tsPacket.SetPacket(info);
+        if (m_tsPacket.Get_PES_PIC_INFO(bPic))
+        {
+            pState->frameStats.AddFrameType((FRAME_TYPE)bPic,m_llPacketID);
+        }
+    }
+    else if (pState->type == PACKET_VIDEO_H264)
+    {
+        PARSED_FRAME_INFO parsed_frame_info = pState->avcParser.ParseTsContinue(info.pPacket,188);
+        if (parsed_frame_info.bNewPicture && parsed_frame_info.structure != STRUCTURE_BOTTOM_FIELD)
+        {
+            pState->frameStats.AddFrameType(parsed_frame_info.FrameType,m_llPacketID);
+        }
+    }
+    else if (pState->type == PACKET_VIDEO_HEVC)
+    {
+        PARSED_FRAME_INFO parsed_frame_info = pState->hevcParser.ParseTsContinue(info);
+        if (parsed_frame_info.bNewPicture)
+        {
+            pState->frameStats.AddFrameType(parsed_frame_info.FrameType,m_llPacketID);
+        }
+    }
+}
+
+void CLiveFrameStats::ProcessPackets(const TS_PACKET_INFO* pInfo,int nCount)
+{
+    for (int i = 0; i < nCount; i++)
+    {
+        const TS_PACKET_INFO& info = pInfo[i];
+        if (!info.sync)
+        {
+            continue;
+        }
+
+        //the type is queued before the unit it belongs to is handed over
+        VIDEO_STATE_T* pState = m_pVideo[info.pid & (PES_PID_COUNT - 1)];
+        if (pState != NULL)
+        {
+            DetectFrameType(pState,info);
+        }
+        m_pesAssembler.Push(info,m_llPacketID);
+        m_llPacketID++;
+    }
+}
+
+FRAME_STATS* CLiveFrameStats::GetFrameStats(int pid)
+{
+    if (pid < 0 || pid >= PES_PID_COUNT || m_pVideo[pid] == NULL)
+    {
+        return NULL;
+    }
+    return &m_pVideo[pid]->out;
+}
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+#pragma once
+#include "commondefs.h"
+#include "TsPacket.h"
+#include "TsPacketInfo.h"
+#include "H264Dec.h"
+#include "HevcParser.h"
+#include "FrameStats.h"
+#include "PesAssembler.h"
+
+/**
+ * Frame statistics of the video pids in live analysis. The video packets
+ * are reassembled into pes units and their picture types detected the same
+ * way as CProgramParser does for a file, so that the results read the same
+ * as the frame_stats of a file analysis. Types are detected for MPEG-2
+ * video, H.264 and HEVC, the frames of other video streams are counted as
+ * "other".
+ *
+ * The statistics accumulate from the first packet given, packet ids count
+ * the packets given since then.
+ */
+class CLiveFrameStats
+{
+public:
+    CLiveFrameStats();
+    ~CLiveFrameStats();
+
+    //collect the frames of a video pid, adding it twice is harmless
+    void AddVideoPid(int pid,PACKET_TYPE type);
+
+    void ProcessPackets(const TS_PACKET_INFO* pInfo,int nCount);
+
+    //NULL for a pid that was not added
+    FRAME_STATS* GetFrameStats(int pid);
+
+private:
+    typedef struct _VIDEO_STATE_T
+    {
+        PACKET_TYPE type;
+        CH264Dec avcParser;
+        CHevcParser hevcParser;
+        CFrameStats frameStats;
+        FRAME_STATS out;
+    }VIDEO_STATE_T;
+
+    //the type of the picture starting in the packet, if any
+    void DetectFrameType(VIDEO_STATE_T* pState,const TS_PACKET_INFO& info);
+
+private:
+    //indexed by pid, one lookup per packet whatever the number of pids
+    VIDEO_STATE_T** m_pVideo;
+
+    CPesAssembler m_pesAssembler;
+    CTsPacket m_tsPacket;
+    long long m_llPacketID;
+};
@@ -25,8 +25,12 @@ CLivePcrProc::CLivePcrProc(void)
 	m_nRecvedBytes = 0;
 	m_llPrevSysClock = 0;
 	m_nTsLength = 188;
+	m_llPacketPos = 0;
 
 	m_pCalcTsRateIt = NULL; //default to 1s
+
+	m_pEsPts = new ES_PTS_STATE_T*[MAX_PID];
+	memset(m_pEsPts,0,sizeof(ES_PTS_STATE_T*)*MAX_PID);
 }
 
 CLivePcrProc::~CLivePcrProc(void)
@@ -37,10 +41,16 @@ CLivePcrProc::~CLivePcrProc(void)
 		delete it->second;
 	}
 
+	for (int i = 0; i < MAX_PID; i++)
+	{
+		delete m_pEsPts[i];
+	}
+	delete [] m_pEsPts;
+
 	pthread_mutex_destroy(&m_mutexRate);
 }
 
-void CLivePcrProc::ProcessBuffer(BYTE* pData,int nLen,long long llTime)
+void CLivePcrProc::ProcessBuffer(BYTE* pData,int nLen,long long llTime,const TS_PACKET_INFO* pInfo)
 {
 	//ts rate
 	m_nRecvedBytes += nLen;
@@ -75,70 +85,81 @@ void CLivePcrProc::ProcessBuffer(BYTE* pData,int nLen,long long llTime)
 	}
 	
 	//pcr...
-	for (int i = 0; i < nLen; i+= m_nTsLength)
+	//ĿʱͬİΪλãǱĿPCRİֻÿнĿ
+	TS_PACKET_INFO info;
+	for (int i = 0, k = 0; i + m_nTsLength <= nLen; i+= m_nTsLength, k++)
 	{
-		CTsPacket tsPacket;
-		if (!tsPacket.SetPacket(pData+i))
+		const TS_PACKET_INFO& pkt = pInfo != NULL ? pInfo[k] : info;
+		if (pInfo == NULL)
+		{
+			ParseTsPacketInfo(pData+i,info);
+		}
+		if (!pkt.sync)
 		{
 			continue;
 		}
+		long long llPos = m_llPacketPos++;
 
-		int pid = tsPacket.Get_PID();
-		map<int,PROGRAM_PCR_INFO_T*>::iterator it = m_mapProgramPcrInfo.begin();
-		for (; it != m_mapProgramPcrInfo.end(); ++it)
+		if (pkt.pts >= 0 && m_pEsPts[pkt.pid] != NULL)
 		{
-			if (pid == it->first && tsPacket.Get_PCR_flag())
-			{
-				long long pcr = tsPacket.Get_PCR();
-
-				//pcr oj
-				PCR_INFO_T pi;
-				pi.llPcr_Oj = it->second->pcrOj.RecvPcr(pcr,llTime) / 1000;
-
-				//pcr ac
-				long long pcr_calc = it->second->pcrAc.GetPcr();
-				if (pcr_calc > 0)
-					pi.llPcr_Ac = (pcr_calc - pcr) / 27;
-				else
-					pi.llPcr_Ac = -1;
-
-
-				//pcr it
-				if (it->second->llpcrPrev < 0)
-				{
-					pi.llPcr_interval = -1;
-				}
-				else
-				{
-					pi.llPcr_interval = (pcr - it->second->llpcrPrev) / 27000;
-				}
-
-				//recv time
-				pi.llTime = llTime;
-
-
-				//update
-				it->second->llpcrPrev = pcr;
-				it->second->pcrAc.AddPcrPacket(pcr);
-
-				//add to buffer
-				pthread_mutex_lock(&it->second->mutex);
-				if (it->second->lstPcrInfo.size() > MAX_BUFFER_SIZE)
-				{
-					it->second->lstPcrInfo.clear();
-				}
-				it->second->lstPcrInfo.push_back(pi);
-				pthread_mutex_unlock(&it->second->mutex);
-
-			} // !if Get_PCR_flag
-			else
-			{
-				it->second->pcrAc.AddPayloadPacket();
-			}
-		}// !for it
+			RecvEsPts(m_pEsPts[pkt.pid],pkt.pts,llTime,llPos);
+		}
+
+		if (!pkt.pcr_flag)
+		{
+			continue;
+		}
+
+		map<int,PROGRAM_PCR_INFO_T*>::iterator it = m_mapProgramPcrInfo.find(pkt.pid);
+		if (it == m_mapProgramPcrInfo.end())
+		{
+			continue;
+		}
+
+		PROGRAM_PCR_INFO_T* prog = it->second;
+		long long pcr = pkt.pcr;
+
+		//pcr oj
+		PCR_INFO_T pi;
+		pi.llPcr_Oj = prog->pcrOj.RecvPcr(pcr,llTime) / 1000;
+
+		//pcr ac
+		if (prog->clock.IsLocked())
+			pi.llPcr_Ac = CClockRecovery::DiffPcr(prog->clock.TimeAt(llPos),pcr) / 27;
+		else
+			pi.llPcr_Ac = -1;
+
+
+		//pcr it
+		long long pcr_prev = prog->clock.GetLastPcr();
+		if (pcr_prev < 0)
+		{
+			pi.llPcr_interval = -1;
+		}
+		else
+		{
+			pi.llPcr_interval = CClockRecovery::DiffPcr(pcr,pcr_prev) / 27000;
+		}
+
+		//recv time
+		pi.llTime = llTime;
+
+
+		//update
+		prog->clock.AddPcr(llPos,pcr,pkt.discontinuity);
+
+		//add to buffer
+		pthread_mutex_lock(&prog->mutex);
+		if (prog->lstPcrInfo.size() > MAX_BUFFER_SIZE)
+		{
+			prog->lstPcrInfo.clear();
+		}
+		prog->lstPcrInfo.push_back(pi);
+		pthread_mutex_unlock(&prog->mutex);
 
 	}// !for i
 
+
 	
 }
 
@@ -168,6 +189,81 @@ void CLivePcrProc::AddPcrPid(int pid)
 	}
 }
 
+void CLivePcrProc::AddEsPid(int pid,int pcr_pid)
+{
+	if (pid < 0 || pid >= MAX_PID)
+	{
+		return;
+	}
+
+	if (m_pEsPts[pid] == NULL)
+	{
+		m_pEsPts[pid] = new ES_PTS_STATE_T();
+	}
+	map<int,PROGRAM_PCR_INFO_T*>::iterator it = m_mapProgramPcrInfo.find(pcr_pid);
+	m_pEsPts[pid]->pProgram = (it == m_mapProgramPcrInfo.end()) ? NULL : it->second;
+}
+
+void CLivePcrProc::RecvEsPts(ES_PTS_STATE_T* es,long long pts,long long llTime,long long llPos)
+{
+	ES_PTS_INFO_T pi;
+	pi.llPts = pts;
+
+	//pts - ϵͳʱ
+	if (es->pProgram != NULL && es->pProgram->clock.GetLastPcr() >= 0)
+	{
+		pi.llPts_Sub = CClockRecovery::DiffPcr(pts*300,es->pProgram->clock.TimeAt(llPos)) / 27000;
+	}
+	else
+	{
+		pi.llPts_Sub = -1;
+	}
+
+	//pts it
+	if (es->llPtsPrev < 0)
+	{
+		pi.llPts_interval = -1;
+	}
+	else
+	{
+		pi.llPts_interval = CClockRecovery::DiffPts(pts,es->llPtsPrev) / 90;
+	}
+
+	pi.llTime = llTime;
+	es->llPtsPrev = pts;
+
+	//add to buffer
+	pthread_mutex_lock(&es->mutex);
+	if (es->lstPtsInfo.size() > MAX_BUFFER_SIZE)
+	{
+		es->lstPtsInfo.clear();
+	}
+	es->lstPtsInfo.push_back(pi);
+	pthread_mutex_unlock(&es->mutex);
+}
+
+LST_ES_PTS_INFO_T* CLivePcrProc::LockGetEsPtsInfo(int pid)
+{
+	if (pid < 0 || pid >= MAX_PID || m_pEsPts[pid] == NULL)
+	{
+		return NULL;
+	}
+
+	pthread_mutex_lock(&m_pEsPts[pid]->mutex);
+	return &m_pEsPts[pid]->lstPtsInfo;
+}
+
+void CLivePcrProc::UnlockEsPtsInfo(int pid)
+{
+	if (pid < 0 || pid >= MAX_PID || m_pEsPts[pid] == NULL)
+	{
+		return;
+	}
+
+	m_pEsPts[pid]->lstPtsInfo.clear();
+	pthread_mutex_unlock(&m_pEsPts[pid]->mutex);
+}
+
 LST_RATE_INFO_T* CLivePcrProc::LockGetRate()
 {
 	pthread_mutex_lock(&m_mutexRate);
@@ -11,11 +11,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #pragma once
-#include "ccalcpcrn1.h"
+#include "ClockRecovery.h"
 #include "PcrOj.h"
 #include <list>
 #include <map>
 #include "commondefs.h"
+#include "TsPacketInfo.h"
 
 using namespace std;
 
@@ -28,7 +29,6 @@ public:
 	{
 		_PROGRAM_PCR_INFO_T()
 		{
-			llpcrPrev = -1;
 			pthread_mutex_init(&mutex,NULL);
 		}
 		~_PROGRAM_PCR_INFO_T()
@@ -39,10 +39,32 @@ public:
 		pthread_mutex_t mutex;
 
 		CPcrOj pcrOj;
-		CCalcPcrN1 pcrAc;
-		long long llpcrPrev;
+
+		//ĿϵͳʱӣͬİΪλ
+		CClockRecovery clock;
 	}PROGRAM_PCR_INFO_T;
 
+	//һ·ƵĻȻPTS
+	typedef struct _ES_PTS_STATE_T
+	{
+		_ES_PTS_STATE_T()
+		{
+			pProgram = NULL;
+			llPtsPrev = -1;
+			pthread_mutex_init(&mutex,NULL);
+		}
+		~_ES_PTS_STATE_T()
+		{
+			pthread_mutex_destroy(&mutex);
+		}
+		list<ES_PTS_INFO_T> lstPtsInfo;
+		pthread_mutex_t mutex;
+
+		//ĿPCRûʱΪNULL
+		PROGRAM_PCR_INFO_T* pProgram;
+		long long llPtsPrev;
+	}ES_PTS_STATE_T;
+
 public:
 	CLivePcrProc(void);
 	~CLivePcrProc(void);
@@ -56,7 +78,11 @@ public:
 	//PCR PIDжö
 	void AddPcrPid(int pid);
 
-	void ProcessBuffer(BYTE* pData,int nLen,long long llTime);
+	//ҪͳPTSĻpcr_pidΪĿPCR PIDAddPcrPid
+	void AddEsPid(int pid,int pcr_pid);
+
+	//pInfoǿʱΪpDataиԤİͷϢ
+	void ProcessBuffer(BYTE* pData,int nLen,long long llTime,const TS_PACKET_INFO* pInfo = NULL);
 
 	//ȡ,unlock ʱ
 	LST_RATE_INFO_T* LockGetRate();
@@ -65,6 +91,10 @@ public:
 	//ȡPCRϢ,unlock ʱ
 	LST_PCR_INFO_T* LockGetPcrInfo(int pcr_pid);
 	void UnlockPcrInfo(int pcr_pid);
+
+	//ȡPTSϢ,unlock ʱաδpidNULL
+	LST_ES_PTS_INFO_T* LockGetEsPtsInfo(int pid);
+	void UnlockEsPtsInfo(int pid);
 //	const map<int,CLivePcrProc::PROGRAM_PCR_INFO_T*>& LockGetPcrInfoAll();
 //	void UnlockPcrInfoAll();
 
@@ -73,11 +103,20 @@ public:
 	//list<PCR_INFO_T>* LockGetPcrInfo();
 	//void UnlockPcrInfo();
 
+private:
+	void RecvEsPts(ES_PTS_STATE_T* es,long long pts,long long llTime,long long llPos);
+
 private:
 	map<int,PROGRAM_PCR_INFO_T*> m_mapProgramPcrInfo;
 
+	//pidΪ±꣬ÿPTSİֻһα޹
+	ES_PTS_STATE_T** m_pEsPts;
+
 	int m_nTsLength;
 
+	//ͬİĿʱӵλ
+	long long m_llPacketPos;
+
 	//ڼ
 	list<RATE_INFO_T> m_lstRate;
 	pthread_mutex_t m_mutexRate;
@@ -0,0 +1,410 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MmapReader.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "EiLog.h"
+
+//default window, a multiple of the page size
+#define MMAP_WINDOW_SIZE (32*1024*1024)
+
+
+CMmapReader::CMmapReader()
+{
+    m_fd = -1;
+    m_llFileSize = 0;
+    m_llEndOffset = -1;
+    m_llOffset = 0;
+    m_llPageSize = sysconf(_SC_PAGESIZE);
+    if (m_llPageSize <= 0)
+        m_llPageSize = 4096;
+    m_nWindowSize = MMAP_WINDOW_SIZE;
+    m_bDropCache = false;
+
+    memset(&m_curBlock,0,sizeof(m_curBlock));
+
+    m_bUseRead = false;
+
+    m_nReadAhead = 0;
+    m_nAlign = 0;
+    m_bThreadValid = false;
+    m_bStop = false;
+    m_bEof = false;
+    m_nError = 0;
+    pthread_mutex_init(&m_mutex,NULL);
+    pthread_cond_init(&m_condReady,NULL);
+    pthread_cond_init(&m_condSpace,NULL);
+}
+
+CMmapReader::~CMmapReader()
+{
+    Close();
+
+    pthread_cond_destroy(&m_condSpace);
+    pthread_cond_destroy(&m_condReady);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void CMmapReader::SetWindowSize(int nSize)
+{
+    if (nSize < m_llPageSize)
+        nSize = (int)m_llPageSize;
+    m_nWindowSize = nSize;
+}
+
+void CMmapReader::SetReadAhead(int nDepth)
+{
+    m_nReadAhead = nDepth > 0 ? nDepth : 0;
+}
+
+bool CMmapReader::Open(const char* path,long long llStartOffset,long long llEndOffset)
+{
+    Close();
+
+    m_fd = open(path,O_RDONLY);
+    if (m_fd < 0)
+    {
+        ei_log(LV_ERROR,"libeasyice","open file faild:%s",path);
+        return false;
+    }
+
+    struct stat filestat;
+    if (fstat(m_fd,&filestat) < 0)
+    {
+        ei_log(LV_ERROR,"libeasyice","stat file faild:%s",path);
+        Close();
+        return false;
+    }
+    m_llFileSize = filestat.st_size;
+    m_llOffset = llStartOffset;
+    m_llEndOffset = llEndOffset;
+    m_bStop = false;
+    m_bEof = false;
+    m_nError = 0;
+
+    //pipes and special files can't be mapped
+    m_bUseRead = !S_ISREG(filestat.st_mode);
+    if (m_bUseRead)
+    {
+        if (llStartOffset > 0)
+            lseek(m_fd,llStartOffset,SEEK_SET);
+    }
+    else
+    {
+        posix_fadvise(m_fd,0,0,POSIX_FADV_SEQUENTIAL);
+        posix_fadvise(m_fd,m_llOffset,m_nWindowSize,POSIX_FADV_WILLNEED);
+    }
+
+    return true;
+}
+
+void CMmapReader::Close()
+{
+    StopReadAhead();
+    ReleaseBlock(m_curBlock);
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    for (size_t i = 0; i < m_vecFreeBufs.size(); i++)
+    {
+        delete [] m_vecFreeBufs[i];
+    }
+    m_vecFreeBufs.clear();
+    m_llFileSize = 0;
+    m_llEndOffset = -1;
+    m_llOffset = 0;
+}
+
+void CMmapReader::ReleaseBlock(READ_BLOCK_T& block)
+{
+    if (block.pMap != NULL)
+    {
+        munmap(block.pMap,block.nMapLen);
+
+        //drop the consumed pages so that a scan of a huge file doesn't evict the whole page cache.
+        //the page holding the end of the block is shared with the next window and is kept
+        long long llDropEnd = (block.llOffset + block.nLen) & ~(m_llPageSize-1);
+        if (m_bDropCache && llDropEnd > block.llMapStart)
+        {
+            posix_fadvise(m_fd,block.llMapStart,llDropEnd-block.llMapStart,POSIX_FADV_DONTNEED);
+        }
+    }
+
+    if (block.pBuf != NULL)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_vecFreeBufs.push_back(block.pBuf);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    memset(&block,0,sizeof(block));
+}
+
+int CMmapReader::Next(BYTE*& pData,int nAlign)
+{
+    pData = NULL;
+    if (m_fd < 0 || nAlign <= 0)
+        return -1;
+
+    ReleaseBlock(m_curBlock);
+
+    if (m_nReadAhead <= 0)
+    {
+        int ret = LoadBlock(m_curBlock,m_llOffset,nAlign);
+        if (ret > 0)
+        {
+            pData = m_curBlock.pData;
+            m_llOffset += ret;
+        }
+        return ret;
+    }
+
+    if (!m_bThreadValid && !m_bEof && !StartReadAhead(nAlign))
+    {
+        ei_log(LV_WARNING,"libeasyice","create read ahead thread failed, read in place");
+        m_nReadAhead = 0;
+        return Next(pData,nAlign);
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_queBlocks.empty() && !m_bEof)
+    {
+        pthread_cond_wait(&m_condReady,&m_mutex);
+    }
+    if (m_queBlocks.empty())
+    {
+        //the blocks read before an error are returned first, then the error as the in place path does
+        int ret = m_nError;
+        pthread_mutex_unlock(&m_mutex);
+        return ret;
+    }
+    m_curBlock = m_queBlocks.front();
+    m_queBlocks.pop_front();
+    pthread_cond_signal(&m_condSpace);
+    pthread_mutex_unlock(&m_mutex);
+
+    pData = m_curBlock.pData;
+    m_llOffset += m_curBlock.nLen;
+    return m_curBlock.nLen;
+}
+
+int CMmapReader::LoadBlock(READ_BLOCK_T& block,long long llOffset,int nAlign)
+{
+    memset(&block,0,sizeof(block));
+    block.llOffset = llOffset;
+
+    if (m_bUseRead)
+        return ReadBlock(block,llOffset,nAlign);
+
+    //the file may have been truncated since Open, pages past its end can't be touched
+    long long llEnd = m_llFileSize;
+    struct stat filestat;
+    if (fstat(m_fd,&filestat) == 0 && filestat.st_size < llEnd)
+        llEnd = filestat.st_size;
+    if (m_llEndOffset >= 0 && m_llEndOffset < llEnd)
+        llEnd = m_llEndOffset;
+
+    long long llRemain = llEnd - llOffset;
+    if (llRemain < nAlign)
+        return 0;
+
+    long long llLen = llRemain < m_nWindowSize ? llRemain : m_nWindowSize;
+    llLen -= llLen % nAlign;
+    if (llLen <= 0)
+        llLen = nAlign;
+
+    block.llMapStart = llOffset & ~(m_llPageSize-1);
+    block.nMapLen = (size_t)(llOffset - block.llMapStart + llLen);
+
+    void* p = mmap(NULL,block.nMapLen,PROT_READ,MAP_SHARED,m_fd,block.llMapStart);
+    if (p == MAP_FAILED)
+    {
+        ei_log(LV_WARNING,"libeasyice","mmap failed at offset %lld, fallback to read",llOffset);
+        block.nMapLen = 0;
+        m_bUseRead = true;
+        lseek(m_fd,llOffset,SEEK_SET);
+        return ReadBlock(block,llOffset,nAlign);
+    }
+    block.pMap = p;
+
+    madvise(block.pMap,block.nMapLen,MADV_SEQUENTIAL);
+    madvise(block.pMap,block.nMapLen,MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(block.pMap,block.nMapLen,MADV_HUGEPAGE);
+#endif
+
+    //start the readahead of the following window while this one is analyzed
+    if (llOffset + llLen < llEnd)
+    {
+        posix_fadvise(m_fd,llOffset+llLen,m_nWindowSize,POSIX_FADV_WILLNEED);
+    }
+
+    block.pData = (BYTE*)block.pMap + (llOffset - block.llMapStart);
+    block.nLen = (int)llLen;
+    return block.nLen;
+}
+
+int CMmapReader::ReadBlock(READ_BLOCK_T& block,long long llOffset,int nAlign)
+{
+    int nBufLen = m_nWindowSize - m_nWindowSize % nAlign;
+    if (nBufLen <= 0)
+        nBufLen = nAlign;
+    if (m_llEndOffset >= 0 && m_llEndOffset - llOffset < nBufLen)
+    {
+        nBufLen = m_llEndOffset > llOffset ? (int)(m_llEndOffset - llOffset) : 0;
+        nBufLen -= nBufLen % nAlign;
+        if (nBufLen <= 0)
+            return 0;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    if (!m_vecFreeBufs.empty())
+    {
+        block.pBuf = m_vecFreeBufs.back();
+        m_vecFreeBufs.pop_back();
+    }
+    pthread_mutex_unlock(&m_mutex);
+    if (block.pBuf == NULL)
+        block.pBuf = new BYTE[m_nWindowSize > nAlign ? m_nWindowSize : nAlign];
+
+    int nRead = 0;
+    while (nRead < nBufLen)
+    {
+        ssize_t ret = read(m_fd,block.pBuf+nRead,nBufLen-nRead);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0 && nRead == 0)
+        {
+            //nothing read: an error, not the end of the file. after a partial read it
+            //is reported by the next call
+            ei_log(LV_ERROR,"libeasyice","read failed at offset %lld",llOffset);
+            block.pData = block.pBuf;
+            block.nLen = -1;
+            return -1;
+        }
+        if (ret <= 0)
+            break;
+        nRead += (int)ret;
+    }
+
+    nRead -= nRead % nAlign;
+    block.pData = block.pBuf;
+    block.nLen = nRead;
+    return nRead;
+}
+
+void CMmapReader::PopulateBlock(const READ_BLOCK_T& block)
+{
+    if (block.pMap == NULL)
+        return;
+
+#ifdef MADV_POPULATE_READ
+    if (madvise(block.pMap,block.nMapLen,MADV_POPULATE_READ) == 0)
+        return;
+#endif
+
+    //touch every page, the page faults are taken here and not in the analysis thread
+    volatile BYTE sum = 0;
+    for (size_t i = 0; i < block.nMapLen; i += m_llPageSize)
+    {
+        sum += ((BYTE*)block.pMap)[i];
+    }
+}
+
+bool CMmapReader::StartReadAhead(int nAlign)
+{
+    m_nAlign = nAlign;
+    m_bStop = false;
+    m_bThreadValid = (pthread_create(&m_hThread,NULL,ReadAheadThread,this) == 0);
+    return m_bThreadValid;
+}
+
+void CMmapReader::StopReadAhead()
+{
+    if (!m_bThreadValid)
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    m_bStop = true;
+    pthread_cond_broadcast(&m_condSpace);
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_join(m_hThread,NULL);
+    m_bThreadValid = false;
+
+    while (!m_queBlocks.empty())
+    {
+        READ_BLOCK_T block = m_queBlocks.front();
+        m_queBlocks.pop_front();
+        ReleaseBlock(block);
+    }
+}
+
+void* CMmapReader::ReadAheadThread(void* arg)
+{
+    CMmapReader* lpThis = (CMmapReader*)arg;
+    lpThis->ReadAheadFun();
+    return NULL;
+}
+
+void CMmapReader::ReadAheadFun()
+{
+    long long llOffset = m_llOffset;
+    while (1)
+    {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_bStop && (int)m_queBlocks.size() >= m_nReadAhead)
+        {
+            pthread_cond_wait(&m_condSpace,&m_mutex);
+        }
+        bool bStop = m_bStop;
+        pthread_mutex_unlock(&m_mutex);
+        if (bStop)
+            break;
+
+        READ_BLOCK_T block;
+        int ret = LoadBlock(block,llOffset,m_nAlign);
+        if (ret <= 0)
+        {
+            ReleaseBlock(block);
+            if (ret < 0)
+            {
+                pthread_mutex_lock(&m_mutex);
+                m_nError = ret;
+                pthread_mutex_unlock(&m_mutex);
+            }
+            break;
+        }
+        PopulateBlock(block);
+        llOffset += ret;
+
+        pthread_mutex_lock(&m_mutex);
+        m_queBlocks.push_back(block);
+        pthread_cond_signal(&m_condReady);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    m_bEof = true;
+    pthread_cond_broadcast(&m_condReady);
+    pthread_mutex_unlock(&m_mutex);
+}
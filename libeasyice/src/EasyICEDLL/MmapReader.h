@@ -0,0 +1,131 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MMAPREADER_H
+#define MMAPREADER_H
+
+#include "ztypes.h"
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+/**
+ * Sequential file reader backed by a sliding mmap window.
+ *
+ * Each Next() maps the following window read-only and returns a pointer into
+ * the mapped pages, so the analyzers work on the page cache directly instead
+ * of on an fread copy. The previous window is unmapped; with SetDropCache its
+ * pages are also dropped from the page cache, which keeps memory flat for files
+ * larger than RAM but evicts them for every other reader of the file too.
+ * Falls back to read() into an owned buffer when the file can't be mapped.
+ *
+ * The file size is checked again before each window is mapped, so a file
+ * truncated while it is read ends early instead of faulting on pages past
+ * its end.
+ *
+ * With SetReadAhead(n), a reader thread keeps up to n windows mapped and
+ * faulted in ahead of the caller, so Next() normally returns resident pages
+ * and the analysis thread doesn't wait on storage.
+ */
+class CMmapReader
+{
+public:
+    CMmapReader();
+    ~CMmapReader();
+
+    /**
+     * @param llStartOffset file offset of the first byte returned by Next()
+     * @param llEndOffset no data at or after it is returned, -1 for end of file
+     */
+    bool Open(const char* path,long long llStartOffset = 0,long long llEndOffset = -1);
+    void Close();
+
+    //window size in bytes, must be set before Open
+    void SetWindowSize(int nSize);
+
+    //number of windows read ahead by a reader thread, 0 reads in the caller. must be set before Open
+    void SetReadAhead(int nDepth);
+
+    //drop the pages of a window from the page cache once it is released, off by default. must be set before Open
+    void SetDropCache(bool bDrop) { m_bDropCache = bDrop; }
+
+    /**
+     * @brief map the next window, the previous pointer becomes invalid
+     * @param nAlign the returned length is a multiple of it (ts packet length),
+     *        a trailing partial packet at end of file is never returned.
+     *        must be the same for every call
+     * @return bytes available at pData, 0 at end of file, -1 on error
+     */
+    int Next(BYTE*& pData,int nAlign);
+
+    long long GetFileSize() const { return m_llFileSize; }
+
+    //file offset of the byte following the last returned window
+    long long GetOffset() const { return m_llOffset; }
+
+private:
+    typedef struct _READ_BLOCK_T
+    {
+        //mapped window, NULL in read() mode
+        void* pMap;
+        size_t nMapLen;
+        long long llMapStart;
+
+        //owned buffer in read() mode
+        BYTE* pBuf;
+
+        BYTE* pData;
+        int nLen;           //0 at end of file, -1 on error
+        long long llOffset; //file offset of pData
+    }READ_BLOCK_T;
+
+    int LoadBlock(READ_BLOCK_T& block,long long llOffset,int nAlign);
+    void ReleaseBlock(READ_BLOCK_T& block);
+    int ReadBlock(READ_BLOCK_T& block,long long llOffset,int nAlign);
+    void PopulateBlock(const READ_BLOCK_T& block);
+
+    bool StartReadAhead(int nAlign);
+    void StopReadAhead();
+    static void* ReadAheadThread(void* arg);
+    void ReadAheadFun();
+
+private:
+    int m_fd;
+    long long m_llFileSize;
+    long long m_llEndOffset;
+    long long m_llOffset;
+    long long m_llPageSize;
+    int m_nWindowSize;
+    bool m_bDropCache;
+
+    //window returned by the last Next()
+    READ_BLOCK_T m_curBlock;
+
+    //read() fallback when mmap is not possible
+    bool m_bUseRead;
+    std::vector<BYTE*> m_vecFreeBufs;
+
+    //read ahead
+    int m_nReadAhead;
+    int m_nAlign;
+    bool m_bThreadValid;
+    pthread_t m_hThread;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condReady;   //a block was queued
+    pthread_cond_t m_condSpace;   //a block was taken
+    std::deque<READ_BLOCK_T> m_queBlocks;
+    bool m_bStop;
+    bool m_bEof;
+    int m_nError;       //-1 once the reader thread failed to load a block, 0 otherwise
+};
+
+#endif
@@ -12,14 +12,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 
 #include "MpegDec.h"
-#include "DetectStreamType.h"
+#include "StreamProbe.h"
 #include "EiLog.h"
 #include "DemuxTs.h"
 
 
 
-bool g_bExitWork;
-
 
 
 CMpegDec::CMpegDec(void)
@@ -28,6 +26,7 @@ CMpegDec::CMpegDec(void)
 	m_pDemuxTs->SetOutputBuffer(&m_allProgramInfo);
     m_pProgressApp = NULL;
     m_pfProgressCb = NULL;
+    m_pbStop = NULL;
 }
 
 CMpegDec::~CMpegDec(void)
@@ -63,14 +62,15 @@ void CMpegDec::Init(int nTsLength,long long nPacket_Total)
 
 	m_nVideoPID = -1;
 	m_nAudioPID = -1;
+	m_nAudioStream_type = -1;
 	m_nPcrPID = -1;
 	
 	m_bDemuxAnaEnable = true;
 	m_bTableAnaEnable = true;
 	m_bPidAnaEnable = true;
+	m_bPreroll = false;
 
-	for(int i = 0; i < 1000; i++)
-		m_pPidInfo[i].pid = -1;
+	m_PidStats.Reset();
 
 
 	
@@ -95,14 +95,15 @@ void CMpegDec::LiveInit(int nTsLength)
 
 	m_nVideoPID = -1;
 	m_nAudioPID = -1;
+	m_nAudioStream_type = -1;
 	m_nPcrPID = -1;
 	
 	m_bDemuxAnaEnable = true;
 	m_bTableAnaEnable = true;
 	m_bPidAnaEnable = true;
+	m_bPreroll = false;
 
-	for(int i = 0; i < 1000; i++)
-		m_pPidInfo[i].pid = -1;
+	m_PidStats.Reset();
 
 	//m_nFrameNum = -1;
 	//m_pktLst = NULL;
@@ -112,7 +113,39 @@ int CMpegDec::ProbeMediaInfo(BYTE * pData,int length)
 {
     if (m_TableAnalyzer.ParseFindPAT(pData,(int)length) == -1)	//没有找到PAT，按单路模式解析
     {
-        if (!ParsePidNoPsi(pData,length,m_nVideoPID,m_nAudioPID,m_nPcrPID) )//能检测到视频和pcr就可以
+        //无表方式检测各pid的流类型
+        CStreamProbe probe;
+        int nProbed = probe.Probe(pData,length,m_nTsLength);
+        m_nVideoPID = probe.GetVideoPid(m_nVideoStream_type);
+        m_nPcrPID = probe.GetPcrPid();
+        m_nAudioPID = -1;
+        m_nAudioStream_type = -1;
+
+        //音频，字幕等基本流，置信度过低的不统计
+        vector<PID_STREAM_TYPE> vecEs;
+        const vector<PROBE_RESULT_T>& results = probe.GetResults();
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const PROBE_RESULT_T& r = results[i];
+            ei_log(LV_DEBUG,"libeasyice","probe pid %d stream_id 0x%02X stream_type 0x%02X confidence %d pcr %d",
+                r.pid,r.stream_id,r.stream_type,r.confidence,r.has_pcr ? 1 : 0);
+            if (r.pid == m_nVideoPID || r.stream_type < 0 || r.confidence < PROBE_CONFIDENT / 2)
+            {
+                continue;
+            }
+            PID_STREAM_TYPE es;
+            es.pid = r.pid;
+            es.stream_type = r.stream_type;
+            vecEs.push_back(es);
+            if (m_nAudioPID < 0 && r.stream_type != 0x06)
+            {
+                m_nAudioPID = r.pid;
+                m_nAudioStream_type = r.stream_type;
+            }
+        }
+        ei_log(LV_DEBUG,"libeasyice","probe looked at %d bytes",nProbed);
+
+        if (m_nVideoPID < 0 || m_nPcrPID < 0)//能检测到视频和pcr就可以
         {
             ei_log(LV_WARNING,"libeasyice","not found psi,program analysis is disabled");
             m_bDemuxAnaEnable = false;
@@ -122,11 +155,10 @@ int CMpegDec::ProbeMediaInfo(BYTE * pData,int length)
 
         if (m_bDemuxAnaEnable)
         {
-            //无表方式检测视频流类型
-            CDetectStreamType dt;
-            dt.Init(pData,(int)length,m_nVideoPID);
-            m_nVideoStream_type = dt.GetVideoType();
-            m_pDemuxTs->SetupDemux(m_nVideoPID,m_nVideoStream_type,m_nTsLength);
+            PID_STREAM_TYPE video;
+            video.pid = m_nVideoPID;
+            video.stream_type = m_nVideoStream_type;
+            m_pDemuxTs->SetupDemux(video,vecEs,m_nTsLength);
         }
     }
     else
@@ -162,114 +194,91 @@ int CMpegDec::ProbeMediaInfo(BYTE * pData,int length)
     return 0;
 }
 
-int CMpegDec::ProcessBuffer(BYTE * pData,int length)
+int CMpegDec::ProcessBuffer(BYTE * pData,int length,const TS_PACKET_INFO* pInfo)
 {
-
-	DWORD inPos = 0;
-
-	while (inPos < length)
+	int nCount = (length + m_nTsLength - 1) / m_nTsLength;
+	if (pInfo != NULL)
 	{
-		if (g_bExitWork)		//是否强制结束处理
-		{
-			break;
-		}
+		return ProcessPackets(pInfo,nCount);
+	}
 
-		ProcessPacket(&pData[inPos]);
-		
-		//--------------------------
-		//计算进度
-		inPos += m_nTsLength;
-		m_Packet_Counter++;
-		int pct = (int)(m_Packet_Counter*PROGRESS_RANGE / m_Packet_Total );
-		if (m_nPct != pct)
+	//调用者没有预解析包头时，按组解析后批量处理
+	TS_PACKET_INFO info[MPEGDEC_GROUP_SIZE];
+	for (int k = 0; k < nCount; k += MPEGDEC_GROUP_SIZE)
+	{
+		int n = nCount - k < MPEGDEC_GROUP_SIZE ? nCount - k : MPEGDEC_GROUP_SIZE;
+		for (int i = 0; i < n; i++)
 		{
-			m_nPct = pct;
-            if (m_pfProgressCb != NULL) m_pfProgressCb(pct,m_pProgressApp);
-			//SendMessage(g_msgWnd,MESSAGE_GUI_PROGRESS, (WPARAM)&m_nPct,0);
+			ParseTsPacketInfo(&pData[(k+i)*m_nTsLength],info[i]);
 		}
-		
+		ProcessPackets(info,n);
 	}
 	
 	return 0;
 }
 
-int CMpegDec::ProcessPacket(BYTE * pData)
+int CMpegDec::ProcessPackets(const TS_PACKET_INFO* pInfo,int nCount)
 {
 	CTsPacket tsPacket;
-	PARSED_FRAME_INFO frame_rst;
+	bool bTableAna = m_bTableAnaEnable && !m_bPreroll;
 
-	if ( !tsPacket.SetPacket(pData) )
+	for (int k = 0; k < nCount; k += MPEGDEC_GROUP_SIZE)
 	{
-		return -1;
-	}
-
-	//-----------处理部分-------
-	//解析PSI/SI
-	if (m_bTableAnaEnable)
-		m_TableAnalyzer.PushBackTsPacket(&tsPacket);
+		if (m_pbStop != NULL && *m_pbStop)		//是否强制结束处理
+		{
+			break;
+		}
 
-	//统计PID信息
-	if (m_bPidAnaEnable)
-		CalcPidList(tsPacket.Get_PID());
+		const TS_PACKET_INFO* group = pInfo + k;
+		int n = nCount - k < MPEGDEC_GROUP_SIZE ? nCount - k : MPEGDEC_GROUP_SIZE;
 
-	//解复用，并分析每路节目的信息
-	if (m_bDemuxAnaEnable)
-		frame_rst = m_pDemuxTs->AddTsPacket(&tsPacket);
+		//解析PSI/SI，统计PID信息，预滚动阶段只跟踪CC
+		for (int i = 0; i < n; i++)
+		{
+			if (k + i + TS_PREFETCH_DISTANCE < nCount)
+			{
+				m_PidStats.Prefetch(group[i+TS_PREFETCH_DISTANCE].pid);
+			}
 
+			const TS_PACKET_INFO& info = group[i];
+			if ( !info.sync )
+			{
+				continue;
+			}
 
+			if (bTableAna)
+			{
+				tsPacket.SetPacket(info);
+				m_TableAnalyzer.PushBackTsPacket(&tsPacket);
+			}
 
-	return 0;
-}
+			if (m_bPidAnaEnable)
+			{
+				if (m_bPreroll)
+					m_PidStats.Track(info);
+				else
+					m_PidStats.Add(info);
+			}
+		}
 
-bool CMpegDec::ParsePidNoPsi(BYTE * pData, __int64 length,int& nVideoPID,int& nAudioPID,int& nPcrPID)
-{
-	nVideoPID = -1;
-	nAudioPID = -1;
-	nPcrPID = -1;
+		//解复用，并分析每路节目的信息
+		if (m_bDemuxAnaEnable)
+			m_pDemuxTs->AddTsPackets(group,n);
 
-	DWORD inPos = 0;
-	CTsPacket tsPacket;
-	while (inPos < length)
-	{
-		if ( !tsPacket.SetPacket(&pData[inPos]))
-		{
-			//TS packet error
-			inPos += m_nTsLength;
-			continue;
-		}
-		WORD pid = tsPacket.Get_PID();
-		if (pid == 0x1FFF)
-		{
-			inPos += m_nTsLength;
-			continue;
-		}
-		if (tsPacket.Get_PCR_flag())
-		{
-			nPcrPID = pid;
-		}
-		BYTE streamID;
-		bool bRet=tsPacket.Get_PES_stream_id(streamID);
-		if(bRet&&streamID>=0xe0&&streamID<=0xef)
-		{
-			nVideoPID = pid;
-		}
-		else if(bRet&&streamID>=0xc0&&streamID<=0xdf)
+		//--------------------------
+		//计算进度
+		m_Packet_Counter += n;
+		int pct = (int)(m_Packet_Counter*PROGRESS_RANGE / m_Packet_Total );
+		if (m_nPct != pct)
 		{
-			nAudioPID = pid;
+			m_nPct = pct;
+            if (m_pfProgressCb != NULL) m_pfProgressCb(pct,m_pProgressApp);
 		}
-		
-		inPos += m_nTsLength;
-
 	}
 
-	if (nVideoPID >0 && nPcrPID > 0)
-	{
-		return true;
-	}
-	return false;
+	return 0;
 }
 
-
 void CMpegDec::FillPacketType(TABLES* tables)
 {
 
@@ -287,11 +296,11 @@ void CMpegDec::FillPacketType(TABLES* tables)
 		{
 			if (it_list->program_number == 0)
 			{
-				m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(it_list->network_pmt_PID,PACKET_NIT_ST));
+				SetPacketType(it_list->network_pmt_PID,PACKET_NIT_ST);
 			}
 			else
 			{
-				m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(it_list->network_pmt_PID,PACKET_PMT));
+				SetPacketType(it_list->network_pmt_PID,PACKET_PMT);
 			}
 		}//!for it_list
 	}
@@ -322,7 +331,7 @@ void CMpegDec::FillPacketType(TABLES* tables)
 				}
 
 				
-				m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(it_list->elementary_PID,packet_type));
+				SetPacketType(it_list->elementary_PID,packet_type);
 
 				PID_TYPE pid_type;
 				pid_type.pid = it_list->elementary_PID;
@@ -332,7 +341,7 @@ void CMpegDec::FillPacketType(TABLES* tables)
 			}//!for it_list
 
 			//add pcr.如果pcr在视频中，此包认为是取视频类型，这样后添加pcrpid，会插入失败，不覆盖原视频类型。
-			m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(pmt.pcr_pid,PACKET_PCR));
+			SetPacketType(pmt.pcr_pid,PACKET_PCR);
 
 			PID_TYPE pid_type;
 			pid_type.pid = pmt.pcr_pid;
@@ -348,26 +357,14 @@ void CMpegDec::FillPacketType(TABLES* tables)
 
 
 
-void CMpegDec::CalcPidList(int pid)
+void CMpegDec::SetTimestampDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples)
 {
+	m_pDemuxTs->SetTimestampDecimation(mode,nMaxSamples);
+}
 
-	//PART 4
-	PIDINFO* p = m_pPidInfo;
-	while (p->pid != -1)
-	{
-		if (p->pid == pid)
-		{
-			p->count++;
-			return;
-		}
-		p++;
-		if (p - m_pPidInfo > 1000)
-		{
-			return;
-		}
-	}
-	p->pid = pid;
-	p->count = 1;
+void CMpegDec::MergePidCount(CMpegDec* pOther,long long llIdShift)
+{
+	m_PidStats.Merge(pOther->m_PidStats,llIdShift);
 }
 
 
@@ -435,22 +432,29 @@ bool CMpegDec::GetPacketHeadInfo(BYTE* pData,int nLength,MSG_FLAG_LIST* headInfo
 		if (headInfo->pes_head.PTS_DTS_flags == 0x2)
 		{
 			char buf[50] = ("");
-			LONGLONG pts;
-			tsPacket.Get_PTS(pts);
-			snprintf(buf,sizeof(buf)/sizeof(char),("PTS:%I64u\r\n"),pts);
-			strncat(strDescriptor,buf,descriptorLen);
+			LONGLONG pts = 0;
+			if (tsPacket.Get_PTS(pts))
+			{
+				snprintf(buf,sizeof(buf)/sizeof(char),("PTS:%I64u\r\n"),pts);
+				strncat(strDescriptor,buf,descriptorLen);
+			}
 		}
 		else if (headInfo->pes_head.PTS_DTS_flags == 0x3)
 		{
 			char buf[50] = ("");
 			char buf1[50] = ("");
-			LONGLONG pts,dts;
-			tsPacket.Get_PTS(pts);
-			tsPacket.Get_DTS(dts);
-			snprintf(buf,sizeof(buf)/sizeof(char),("PTS:%I64u\r\n"),pts);
-			snprintf(buf1,sizeof(buf1)/sizeof(char),("DTS:%I64u\r\n"),dts);
-			strncat(strDescriptor,buf,descriptorLen);
-			strncat(strDescriptor,buf1,descriptorLen);
+			LONGLONG pts = 0;
+			LONGLONG dts = 0;
+			if (tsPacket.Get_PTS(pts))
+			{
+				snprintf(buf,sizeof(buf)/sizeof(char),("PTS:%I64u\r\n"),pts);
+				strncat(strDescriptor,buf,descriptorLen);
+			}
+			if (tsPacket.Get_DTS(dts))
+			{
+				snprintf(buf1,sizeof(buf1)/sizeof(char),("DTS:%I64u\r\n"),dts);
+				strncat(strDescriptor,buf1,descriptorLen);
+			}
 		}
 	}
 	return true;
@@ -458,37 +462,49 @@ bool CMpegDec::GetPacketHeadInfo(BYTE* pData,int nLength,MSG_FLAG_LIST* headInfo
 
 
 
+void CMpegDec::SetPacketType(int pid,PACKET_TYPE type)
+{
+	if (pid < 0 || pid >= PID_STATS_SIZE || m_pPacketType[pid] >= 0)
+	{
+		return;
+	}
+	m_pPacketType[pid] = type;
+}
+
 void CMpegDec::InitPacketType()
 {
-	m_mapPacketType.clear();
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x0,PACKET_PAT));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x1,PACKET_CAT));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x2,PACKET_TSDT));
+	for (int i = 0; i < PID_STATS_SIZE; i++)
+	{
+		m_pPacketType[i] = -1;
+	}
+	SetPacketType(0x0,PACKET_PAT);
+	SetPacketType(0x1,PACKET_CAT);
+	SetPacketType(0x2,PACKET_TSDT);
 
 	for (int i = 0x3; i <= 0xF; i++)
 	{
-		m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(i,PACKET_RESERVED));	//预留
+		SetPacketType(i,PACKET_RESERVED);	//预留
 	}
 
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x10,PACKET_NIT_ST));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x11,PACKET_SDT_BAT_ST));
+	SetPacketType(0x10,PACKET_NIT_ST);
+	SetPacketType(0x11,PACKET_SDT_BAT_ST);
 
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x12,PACKET_EIT_ST));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x13,PACKET_RST_ST));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x14,PACKET_TDT_TOT_ST));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x15,PACKET_NETSYNC));
+	SetPacketType(0x12,PACKET_EIT_ST);
+	SetPacketType(0x13,PACKET_RST_ST);
+	SetPacketType(0x14,PACKET_TDT_TOT_ST);
+	SetPacketType(0x15,PACKET_NETSYNC);
 
 	for (int i = 0x16; i <= 0x1B; i++)
 	{
-		m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(i,PACKET_RESERVED));	//预留
+		SetPacketType(i,PACKET_RESERVED);	//预留
 	}
 
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x1C,PACKET_SIGN));	//带内信令
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x1D,PACKET_SURVEY));	//测量
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x1E,PACKET_DIT));
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x1F,PACKET_SIT));
+	SetPacketType(0x1C,PACKET_SIGN);	//带内信令
+	SetPacketType(0x1D,PACKET_SURVEY);	//测量
+	SetPacketType(0x1E,PACKET_DIT);
+	SetPacketType(0x1F,PACKET_SIT);
 
-	m_mapPacketType.insert(map<int,PACKET_TYPE>::value_type(0x1FFF,PACKET_NULL));
+	SetPacketType(0x1FFF,PACKET_NULL);
 
 }
 
@@ -496,27 +512,19 @@ void CMpegDec::InitPacketType()
 void CMpegDec::UpdatePidListResult()
 {
 	//计算总包数
-	__int64 nAllPacketCount = 0;
-	PIDINFO* p = m_pPidInfo;
-	while (p->pid != -1)
+	__int64 nAllPacketCount = m_PidStats.GetTotal();
+	const vector<int>& pids = m_PidStats.GetPids();
+	vector<int>::const_iterator it_pid = pids.begin();
+	for (; it_pid != pids.end(); it_pid++)
 	{
-		nAllPacketCount += p->count;
-		
-		if (m_mapPidList.find(p->pid) == m_mapPidList.end())
-		{
-			MSG_PID_LIST msg_pid_list;
-			msg_pid_list.PID = p->pid;
-			msg_pid_list.total = p->count;
-			msg_pid_list.type = m_mapPacketType[p->pid];
-			m_mapPidList.insert(map<int,MSG_PID_LIST>::value_type(p->pid,msg_pid_list));
-		}
-		else
-		{
-			m_mapPidList[p->pid].total = p->count;
-			m_mapPidList[p->pid].type = m_mapPacketType[p->pid];
-		}
-
-		p++;
+		int pid = *it_pid;
+		//未设置类型的pid按0处理，与原先map下标访问的结果一致
+		PACKET_TYPE type = m_pPacketType[pid] < 0 ? (PACKET_TYPE)0 : (PACKET_TYPE)m_pPacketType[pid];
+
+		MSG_PID_LIST& msg_pid_list = m_mapPidList[pid];
+		msg_pid_list.PID = pid;
+		msg_pid_list.total = m_PidStats.Get(pid).count;
+		msg_pid_list.type = type;
 	}
 
 	//SendMessage(g_msgWnd,MESSAGE_DATA_PID_LIST_BEFOR,0,0);
@@ -553,10 +561,8 @@ std::vector<PID_TYPE>* CMpegDec::GetProgPidNoPsi()
 	{
 		pt.pid = m_nVideoPID;
 
-		if (m_nVideoStream_type ==0x2)
-			pt.type = PACKET_MPEG2_VIDEO;
-		else if (m_nVideoStream_type == 0x1B)
-			pt.type = PACKET_VIDEO_H264;
+		const STREAMTYPE* p_streamtype = GetStreamInfoByStreamType(m_nVideoStream_type);
+		pt.type = p_streamtype != NULL ? p_streamtype->packet_type : PACKET_UNKNOWN;
 
 		m_vecPids.push_back(pt);
 	}
@@ -564,7 +570,10 @@ std::vector<PID_TYPE>* CMpegDec::GetProgPidNoPsi()
 	if (m_nAudioPID > 0)
 	{
 		pt.pid = m_nAudioPID;
-		pt.type = PACKET_MPEG1_AUDIO;
+
+		const STREAMTYPE* p_streamtype = GetStreamInfoByStreamType(m_nAudioStream_type);
+		pt.type = p_streamtype != NULL ? p_streamtype->packet_type : PACKET_MPEG1_AUDIO;
+
 		m_vecPids.push_back(pt);
 	}
 	
@@ -578,14 +587,37 @@ void CMpegDec::FillPacketType()
 
 void CMpegDec::LiveProcessPacket(BYTE* pPacket)
 {
-	CTsPacket tsPacket;
-	if ( !tsPacket.SetPacket(pPacket) )
+	TS_PACKET_INFO info;
+	if ( !ParseTsPacketInfo(pPacket,info) )
 	{
 		return;
 	}
 
 	m_TableAnalyzer.PushBackTsPacket2(pPacket);
-	CalcPidList(tsPacket.Get_PID());
+	m_PidStats.Add(info);
+}
+
+void CMpegDec::LiveProcessPacket(const TS_PACKET_INFO& info)
+{
+	if ( !info.sync )
+	{
+		return;
+	}
+
+	m_TableAnalyzer.PushBackTsPacket2(info.pPacket);
+	m_PidStats.Add(info);
+}
+
+void CMpegDec::LiveProcessPackets(const TS_PACKET_INFO* pInfo,int nCount)
+{
+	for (int i = 0; i < nCount; i++)
+	{
+		if (i + TS_PREFETCH_DISTANCE < nCount)
+		{
+			m_PidStats.Prefetch(pInfo[i+TS_PREFETCH_DISTANCE].pid);
+		}
+		LiveProcessPacket(pInfo[i]);
+	}
 }
 
 void CMpegDec::Finish()
@@ -15,21 +15,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdio.h>
 #include <map>
 #include "TsPacket.h"
+#include "TsPacketInfo.h"
+#include "PidStats.h"
 #include "tables/CAnalyzeTable.h"
 #include "../sdkdefs.h"
 
 using namespace std;
 using namespace tables;
 
-typedef struct _PIDINFO
-{
-	_PIDINFO()
-	{
-		pid = -1;
-	}
-	int pid;
-	__int64 count;
-}PIDINFO;
+//ProcessPackets每组的包数，一组包及各模块用到的状态能同时留在缓存中
+#define MPEGDEC_GROUP_SIZE 64
 
 
 class CDemuxTs;
@@ -44,9 +39,17 @@ public:
 
     void SetProgressFunCb(easyice_progress_callback pFun,void *pApp);
 
+    //*pbStop 为 true 时 ProcessBuffer 立即返回，NULL 不检查
+    void SetStopFlag(volatile bool* pbStop) { m_pbStop = pbStop; }
+
     // must do probe befor processbuffer
     int ProbeMediaInfo(BYTE * pData,int length);
-	int ProcessBuffer(BYTE * pData, int length);
+	//pInfo非空时为与pData中各包一一对应的预解析包头信息，由调用者解析一次后与TR101290共用
+	int ProcessBuffer(BYTE * pData, int length,const TS_PACKET_INFO* pInfo = NULL);
+
+	//批量处理nCount个预解析的包，如一次读取的数据块。按小组依次交给表分析、PID统计与解复用，
+	//各模块的状态在一组内保持在缓存中；停止标志与进度每组/每批检查一次
+	int ProcessPackets(const TS_PACKET_INFO* pInfo,int nCount);
 
 
 	//必须保证能够读到数据
@@ -57,6 +60,8 @@ public:
 
 
 	void LiveProcessPacket(BYTE* pPacket);
+	void LiveProcessPacket(const TS_PACKET_INFO& info);
+	void LiveProcessPackets(const TS_PACKET_INFO* pInfo,int nCount);
 
 	//只统计PID
 	void LiveProcessPacket2(BYTE* pPacket);
@@ -82,10 +87,28 @@ public:
     //更新计算一下 PID 列表
 	void UpdatePidListResult();
 
-private:
+	//分段并行分析用：预滚动阶段只做解复用以恢复节目解析器状态，不统计PID，不解析表
+	void SetPreroll(bool bPreroll) { m_bPreroll = bPreroll; }
+
+	//分段并行分析用：表由第一个分段统一解析
+	void DisableTableAna() { m_bTableAnaEnable = false; }
+	bool IsTableAnaEnable() const { return m_bTableAnaEnable; }
+
+	//分段并行分析用：把另一分段的PID计数累加进来，在Finish之前调用
+	void MergePidCount(CMpegDec* pOther,long long llIdShift = 0);
+
+	//分段并行分析用：分段起点的包序号，与解复用器的包序号一致
+	void SetPacketID(long long llID) { m_PidStats.SetPacketID(llID); }
+
+	//限制每路节目各时间戳、码率序列的样本数，在ProbeMediaInfo之前调用
+	void SetTimestampDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples);
 
+	//每个PID的包计数、CC错误、加扰、PCR、PES及首末包位置
+	const CPidStats& GetPidStats() const { return m_PidStats; }
+	CPidStats& GetPidStats() { return m_PidStats; }
+
+private:
 
-	int ProcessPacket(BYTE * pData);
 
 	//pid类型中，加入动态解析出的pmtpid以及从pmt解析出的其他流pid
 	//m_allProgramBrief也在这里填充了
@@ -101,6 +124,9 @@ private:
     easyice_progress_callback m_pfProgressCb;
     void* m_pProgressApp;
 
+    //强制结束处理，每个实例各自的，多个文件同时分析时互不影响
+    volatile bool* m_pbStop;
+
 	int m_nPct; //当前进度指示
 	int m_nVideoPID;//只当psi表明只有1路节目或没有psi信息时使用
 	int m_nAudioPID;//只当psi表明只有1路节目或没有psi信息时使用
@@ -109,6 +135,9 @@ private:
 	//视频流类型
 	int m_nVideoStream_type;
 
+	//音频流类型，只在没有psi信息时由无表检测得到
+	int m_nAudioStream_type;
+
 
 
 	//没有找到PAT将在对包类型判断时采用包解析模式
@@ -132,12 +161,12 @@ public:
 	* 存储区域
 */
 private:
-	//用于保存pid类型.pid,type
-	std::map<int,PACKET_TYPE> m_mapPacketType;
+	//用于保存pid类型，以pid为下标，-1表示未设置
+	int m_pPacketType[PID_STATS_SIZE];
 
 
-	//由于效率的关系没有用map直接存储，下面的方式最快。支持到1000个pid
-	PIDINFO m_pPidInfo[1000];
+	//以pid为下标的统计表，每包只需一次数组访问，不限pid个数
+	CPidStats m_PidStats;
 	
 
 	//所有节目的信息
@@ -151,6 +180,9 @@ private:
 	bool m_bTableAnaEnable;
 	bool m_bPidAnaEnable;
 
+	//是否处于预滚动阶段
+	bool m_bPreroll;
+
 
 
 /**
@@ -159,17 +191,14 @@ private:
 private:
 	void InitPacketType();
 
+	//已设置过类型的pid不覆盖
+	void SetPacketType(int pid,PACKET_TYPE type);
+
 	//以下是工作者线程需要调用的函数
 	
-	//统计pid信息
-	void CalcPidList(int pid);
-
 	//在没有PAT、PMT信息的情况下，检测包类型
 	void GetPESType(CTsPacket *tsPacket,FRAME_TYPE& FrameType);
 
-	//没有psi信息时使用
-	bool ParsePidNoPsi(BYTE * pData, __int64 length,int& nVideoPID,int& nAudioPID,int& nPcrPID);
-
 	void CheckFrameType(CTsPacket *tsPacket,FRAME_TYPE& FrameType,int VideoStreamType);
 
 };
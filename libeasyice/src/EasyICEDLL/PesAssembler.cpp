@@ -0,0 +1,289 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "PesAssembler.h"
+
+using namespace std;
+
+#define PES_INITIAL_CAPACITY (64*1024)
+
+
+CPesBufferPool::CPesBufferPool()
+{
+}
+
+CPesBufferPool::~CPesBufferPool()
+{
+    for (size_t i = 0; i < m_vecFree.size(); i++)
+    {
+        free(m_vecFree[i]->pData);
+        delete m_vecFree[i];
+    }
+}
+
+PES_BUFFER_T* CPesBufferPool::Acquire()
+{
+    PES_BUFFER_T* pBuffer;
+    if (!m_vecFree.empty())
+    {
+        pBuffer = m_vecFree.back();
+        m_vecFree.pop_back();
+    }
+    else
+    {
+        pBuffer = new PES_BUFFER_T;
+        pBuffer->pData = (BYTE*)malloc(PES_INITIAL_CAPACITY);
+        pBuffer->nCapacity = PES_INITIAL_CAPACITY;
+    }
+    pBuffer->nSize = 0;
+    return pBuffer;
+}
+
+void CPesBufferPool::Release(PES_BUFFER_T* pBuffer)
+{
+    m_vecFree.push_back(pBuffer);
+}
+
+void CPesBufferPool::Append(PES_BUFFER_T* pBuffer,const BYTE* pData,int nLen)
+{
+    if (pBuffer->nSize + nLen > pBuffer->nCapacity)
+    {
+        int nCapacity = pBuffer->nCapacity;
+        while (nCapacity < pBuffer->nSize + nLen)
+        {
+            nCapacity *= 2;
+        }
+        pBuffer->pData = (BYTE*)realloc(pBuffer->pData,nCapacity);
+        pBuffer->nCapacity = nCapacity;
+    }
+    memcpy(pBuffer->pData + pBuffer->nSize,pData,nLen);
+    pBuffer->nSize += nLen;
+}
+
+
+CPesAssembler::CPesAssembler()
+{
+    m_pPids = new PES_PID_T*[PES_PID_COUNT];
+    memset(m_pPids,0,sizeof(PES_PID_T*) * PES_PID_COUNT);
+}
+
+CPesAssembler::~CPesAssembler()
+{
+    for (int i = 0; i < PES_PID_COUNT; i++)
+    {
+        if (m_pPids[i] == NULL)
+        {
+            continue;
+        }
+        if (m_pPids[i]->pBuffer != NULL)
+        {
+            m_pool.Release(m_pPids[i]->pBuffer);
+        }
+        delete m_pPids[i];
+    }
+    delete [] m_pPids;
+}
+
+void CPesAssembler::AddConsumer(int pid,IPesConsumer* pConsumer)
+{
+    pid &= PES_PID_COUNT - 1;
+    PES_PID_T* pState = m_pPids[pid];
+    if (pState == NULL)
+    {
+        pState = new PES_PID_T;
+        pState->pBuffer = NULL;
+        pState->llPacketID = -1;
+        pState->llEndPacketID = -1;
+        pState->nPackets = 0;
+        pState->last_cc = -1;
+        pState->bLost = false;
+        pState->bCut = false;
+        m_pPids[pid] = pState;
+    }
+    if (find(pState->consumers.begin(),pState->consumers.end(),pConsumer) == pState->consumers.end())
+    {
+        pState->consumers.push_back(pConsumer);
+    }
+}
+
+void CPesAssembler::RemoveConsumer(int pid,IPesConsumer* pConsumer)
+{
+    pid &= PES_PID_COUNT - 1;
+    PES_PID_T* pState = m_pPids[pid];
+    if (pState == NULL)
+    {
+        return;
+    }
+    vector<IPesConsumer*>::iterator it = find(pState->consumers.begin(),pState->consumers.end(),pConsumer);
+    if (it != pState->consumers.end())
+    {
+        pState->consumers.erase(it);
+    }
+    if (pState->consumers.empty())
+    {
+        if (pState->pBuffer != NULL)
+        {
+            m_pool.Release(pState->pBuffer);
+        }
+        delete pState;
+        m_pPids[pid] = NULL;
+    }
+}
+
+void CPesAssembler::Push(const TS_PACKET_INFO& info,long long llPacketID)
+{
+    PES_PID_T* pState = m_pPids[info.pid & (PES_PID_COUNT - 1)];
+    if (pState == NULL || !info.sync || info.tei)
+    {
+        return;
+    }
+
+    //same rules as the cc check of CPidStats, a repeated packet is dropped
+    if (info.afc & 0x01)
+    {
+        if (pState->last_cc >= 0 && !info.discontinuity)
+        {
+            if (info.cc == pState->last_cc)
+            {
+                return;
+            }
+            if (info.cc != ((pState->last_cc + 1) & 0x0F))
+            {
+                pState->bLost = true;
+            }
+        }
+        pState->last_cc = info.cc;
+    }
+    if (info.payload_offset < 0)
+    {
+        return;
+    }
+
+    if (info.pusi)
+    {
+        if (pState->pBuffer != NULL)
+        {
+            Emit(info.pid,*pState);
+        }
+        //scrambled or broken start, wait for the next pusi
+        if (info.pes_offset < 0)
+        {
+            return;
+        }
+        pState->pBuffer = m_pool.Acquire();
+        pState->llPacketID = llPacketID;
+        pState->nPackets = 0;
+        pState->bLost = false;
+        pState->bCut = false;
+    }
+    else if (pState->pBuffer == NULL)
+    {
+        return;
+    }
+
+    PES_BUFFER_T* pBuffer = pState->pBuffer;
+    const BYTE* pPayload = info.pPacket + info.payload_offset;
+    int nLen = TS_PACKET_LENGTH_STANDARD - info.payload_offset;
+    if (pBuffer->nSize + nLen > PES_MAX_UNIT_SIZE)
+    {
+        nLen = PES_MAX_UNIT_SIZE - pBuffer->nSize;
+        pState->bCut = true;
+    }
+    CPesBufferPool::Append(pBuffer,pPayload,nLen);
+    pState->llEndPacketID = llPacketID;
+    pState->nPackets++;
+
+    //a bounded unit is complete as soon as all its bytes are in
+    if (pBuffer->nSize >= 6)
+    {
+        int pes_packet_length = (pBuffer->pData[4] << 8) | pBuffer->pData[5];
+        if (pes_packet_length > 0 && pBuffer->nSize >= 6 + pes_packet_length)
+        {
+            Emit(info.pid,*pState);
+        }
+    }
+}
+
+void CPesAssembler::Emit(int pid,PES_PID_T& state)
+{
+    PES_BUFFER_T* pBuffer = state.pBuffer;
+    state.pBuffer = NULL;
+
+    const BYTE* p = pBuffer->pData;
+    PES_UNIT_T unit;
+    unit.pid = pid;
+    unit.stream_id = p[3];
+    unit.pes_packet_length = pBuffer->nSize >= 6 ? (p[4] << 8) | p[5] : 0;
+    unit.data_alignment = false;
+    unit.pts = -1;
+    unit.dts = -1;
+    unit.pData = p;
+    unit.nSize = pBuffer->nSize;
+    unit.llPacketID = state.llPacketID;
+    unit.llEndPacketID = state.llEndPacketID;
+    unit.nPackets = state.nPackets;
+    unit.bComplete = !state.bLost && !state.bCut && pBuffer->nSize >= 6;
+
+    if (unit.pes_packet_length > 0)
+    {
+        if (unit.nSize > 6 + unit.pes_packet_length)
+        {
+            unit.nSize = 6 + unit.pes_packet_length;
+        }
+        else if (unit.nSize < 6 + unit.pes_packet_length)
+        {
+            unit.bComplete = false;
+        }
+    }
+
+    //stream ids without the optional pes header, 13818-1 table 2-21
+    int header_length = min(6,unit.nSize);
+    switch (unit.stream_id)
+    {
+    case 0xBC: case 0xBE: case 0xBF:
+    case 0xF0: case 0xF1: case 0xF2:
+    case 0xF8: case 0xFF:
+        break;
+    default:
+        if (unit.nSize >= 9 && (p[6] & 0xC0) == 0x80)
+        {
+            unit.data_alignment = (p[6] & 0x04) != 0;
+            header_length = 9 + p[8];
+            int pts_dts_flags = p[7] >> 6;
+            if ((pts_dts_flags & 0x02) && unit.nSize >= 14)
+            {
+                unit.pts = TsReadPTS(p + 9);
+            }
+            if (pts_dts_flags == 0x03 && unit.nSize >= 19)
+            {
+                unit.dts = TsReadPTS(p + 14);
+            }
+        }
+        break;
+    }
+    if (header_length > unit.nSize)
+    {
+        header_length = unit.nSize;
+        unit.bComplete = false;
+    }
+    unit.pPayload = p + header_length;
+    unit.nPayloadSize = unit.nSize - header_length;
+
+    for (size_t i = 0; i < state.consumers.size(); i++)
+    {
+        state.consumers[i]->OnPesUnit(unit);
+    }
+    m_pool.Release(pBuffer);
+}
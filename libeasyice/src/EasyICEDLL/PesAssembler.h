@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include "TsPacketInfo.h"
+
+#define PES_PID_COUNT 8192
+
+//a pes unit is cut at this size and handed over flagged as incomplete
+#define PES_MAX_UNIT_SIZE (8*1024*1024)
+
+//one reassembled pes packet
+typedef struct _PES_UNIT_T
+{
+    int pid;
+    BYTE stream_id;
+    int pes_packet_length;  //the header field, 0 for unbounded video pes
+    bool data_alignment;
+    long long pts;          //-1 if the header has no pts
+    long long dts;          //-1 if the header has no dts
+
+    const BYTE* pData;      //the whole pes packet, from the start code
+    int nSize;
+    const BYTE* pPayload;   //PES_packet_data_bytes, after the pes header
+    int nPayloadSize;
+
+    long long llPacketID;   //packet id of the ts packet carrying the pes header
+    long long llEndPacketID;//packet id of the last ts packet of the unit
+    int nPackets;           //ts packets carrying the unit
+
+    //false if packets of the pid were lost, the unit is shorter than its
+    //pes_packet_length or it was cut at PES_MAX_UNIT_SIZE
+    bool bComplete;
+}PES_UNIT_T;
+
+/**
+ * Receives the pes units of the pids it was registered for. The unit and
+ * the memory it points to belong to the assembler and are only valid
+ * during the call, a consumer that needs the data later copies it.
+ */
+class IPesConsumer
+{
+public:
+    virtual ~IPesConsumer() {}
+
+    virtual void OnPesUnit(const PES_UNIT_T& unit) = 0;
+};
+
+typedef struct _PES_BUFFER_T
+{
+    BYTE* pData;
+    int nSize;
+    int nCapacity;
+}PES_BUFFER_T;
+
+/**
+ * Free list of the unit buffers. A buffer keeps its capacity when it is
+ * released, so once every assembled pid has seen its largest unit no more
+ * memory is allocated.
+ */
+class CPesBufferPool
+{
+public:
+    CPesBufferPool();
+    ~CPesBufferPool();
+
+    //an empty buffer
+    PES_BUFFER_T* Acquire();
+    void Release(PES_BUFFER_T* pBuffer);
+
+    //append nLen bytes, growing the buffer if needed
+    static void Append(PES_BUFFER_T* pBuffer,const BYTE* pData,int nLen);
+
+private:
+    std::vector<PES_BUFFER_T*> m_vecFree;
+};
+
+/**
+ * Per-PID pes reassembly. The payload of each ts packet of a registered pid
+ * is copied once into a pooled buffer; when the unit is complete (next
+ * pusi, or pes_packet_length bytes collected) its header is decoded and
+ * the unit is handed to the consumers of the pid, which parse it in place.
+ * A unit still being collected at the end of the input is never handed
+ * over, see CFrameStats.
+ *
+ * Pids without a consumer cost one table lookup per packet.
+ */
+class CPesAssembler
+{
+public:
+    CPesAssembler();
+    ~CPesAssembler();
+
+    //start assembling the pid if needed and hand its units to pConsumer too
+    void AddConsumer(int pid,IPesConsumer* pConsumer);
+
+    //stop handing units to pConsumer, the pid is dropped with its last consumer
+    void RemoveConsumer(int pid,IPesConsumer* pConsumer);
+
+    bool IsAssembling(int pid) const { return m_pPids[pid & (PES_PID_COUNT - 1)] != NULL; }
+
+    //llPacketID numbers the packet the same way as TIMESTAMP.pos
+    void Push(const TS_PACKET_INFO& info,long long llPacketID);
+
+private:
+    typedef struct _PES_PID_T
+    {
+        std::vector<IPesConsumer*> consumers;
+        PES_BUFFER_T* pBuffer;  //NULL while waiting for a pusi
+        long long llPacketID;
+        long long llEndPacketID;
+        int nPackets;
+        int last_cc;            //-1 until the first packet with payload
+        bool bLost;
+        bool bCut;
+    }PES_PID_T;
+
+    void Emit(int pid,PES_PID_T& state);
+
+private:
+    PES_PID_T** m_pPids;
+    CPesBufferPool m_pool;
+};
@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "PidStats.h"
+
+#define NULL_PID 0x1FFF
+
+
+CPidStats::CPidStats()
+{
+    m_pStats = new PID_STAT_T[PID_STATS_SIZE];
+    Reset();
+}
+
+CPidStats::~CPidStats()
+{
+    delete [] m_pStats;
+}
+
+void CPidStats::Reset()
+{
+    for (int i = 0; i < PID_STATS_SIZE; i++)
+    {
+        PID_STAT_T& stat = m_pStats[i];
+        stat.count = 0;
+        stat.cc_errors = 0;
+        stat.scrambled = 0;
+        stat.pcr_count = 0;
+        stat.pes_count = 0;
+        stat.first_pos = -1;
+        stat.last_pos = -1;
+        stat.last_cc = -1;
+    }
+    m_vecPids.clear();
+    m_llTotal = 0;
+    m_llPacketID = 0;
+}
+
+void CPidStats::CheckCC(PID_STAT_T& stat,const TS_PACKET_INFO& info)
+{
+    int last = stat.last_cc;
+    stat.last_cc = info.cc;
+    if (last < 0 || info.pid == NULL_PID || info.discontinuity)
+    {
+        return;
+    }
+
+    if (info.afc & 0x01)
+    {
+        //one duplicate packet is allowed
+        if (info.cc != ((last + 1) & 0x0F) && info.cc != last)
+        {
+            stat.cc_errors++;
+        }
+    }
+    else if (info.cc != last)
+    {
+        //no payload, the counter must not change
+        stat.cc_errors++;
+    }
+}
+
+void CPidStats::Add(const TS_PACKET_INFO& info)
+{
+    PID_STAT_T& stat = m_pStats[info.pid];
+    if (stat.count == 0)
+    {
+        m_vecPids.push_back(info.pid);
+        stat.first_pos = m_llPacketID;
+    }
+    stat.count++;
+    stat.last_pos = m_llPacketID;
+    CheckCC(stat,info);
+
+    if (info.scrambling_control != 0)
+        stat.scrambled++;
+    if (info.pcr_flag)
+        stat.pcr_count++;
+    if (info.pes_offset >= 0)
+        stat.pes_count++;
+
+    m_llTotal++;
+    m_llPacketID++;
+}
+
+void CPidStats::Track(const TS_PACKET_INFO& info)
+{
+    CheckCC(m_pStats[info.pid],info);
+    m_llPacketID++;
+}
+
+void CPidStats::Merge(const CPidStats& other,long long llIdShift)
+{
+    std::vector<int>::const_iterator it = other.m_vecPids.begin();
+    for (; it != other.m_vecPids.end(); ++it)
+    {
+        const PID_STAT_T& src = other.m_pStats[*it];
+        PID_STAT_T& dst = m_pStats[*it];
+        if (dst.count == 0)
+        {
+            m_vecPids.push_back(*it);
+            dst.first_pos = src.first_pos - llIdShift;
+        }
+        dst.count += src.count;
+        dst.cc_errors += src.cc_errors;
+        dst.scrambled += src.scrambled;
+        dst.pcr_count += src.pcr_count;
+        dst.pes_count += src.pes_count;
+        dst.last_pos = src.last_pos - llIdShift;
+        dst.last_cc = src.last_cc;
+    }
+    m_llTotal += other.m_llTotal;
+}
+
+void CPidStats::Set(int pid,const PID_STAT_T& stat)
+{
+    PID_STAT_T& dst = m_pStats[pid & (PID_STATS_SIZE - 1)];
+    if (dst.count == 0 && stat.count > 0)
+    {
+        m_vecPids.push_back(pid & (PID_STATS_SIZE - 1));
+    }
+    m_llTotal += stat.count - dst.count;
+    dst = stat;
+}
@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include "TsPacketInfo.h"
+
+#define PID_STATS_SIZE 8192
+
+typedef struct _PID_STAT_T
+{
+    long long count;        //packets
+    long long cc_errors;    //continuity counter errors
+    long long scrambled;    //packets with transport_scrambling_control != 0
+    long long pcr_count;    //packets carrying a pcr
+    long long pes_count;    //packets starting a pes header
+    long long first_pos;    //packet id of the first packet, -1 if none
+    long long last_pos;     //packet id of the last packet, -1 if none
+    int last_cc;            //-1 until the first packet
+}PID_STAT_T;
+
+/**
+ * Per-PID packet statistics, kept in a table indexed by the 13-bit PID so
+ * the per-packet update is a single array access, whatever the number of
+ * PIDs in the stream.
+ *
+ * Packet ids count the synced packets passed to Add/Track, the same way
+ * CDemuxTs numbers packets for the TIMESTAMP positions.
+ */
+class CPidStats
+{
+public:
+    CPidStats();
+    ~CPidStats();
+
+    void Reset();
+
+    //count the packet
+    void Add(const TS_PACKET_INFO& info);
+
+    //only follow the continuity counter and the packet id, used while
+    //prerolling a range so the first counted packet is checked correctly
+    void Track(const TS_PACKET_INFO& info);
+
+    //add the counters of another table, whose packet ids are shifted by llIdShift
+    void Merge(const CPidStats& other,long long llIdShift = 0);
+
+    //restore the counters of a pid, e.g. from a checkpoint
+    void Set(int pid,const PID_STAT_T& stat);
+
+    void SetPacketID(long long llID) { m_llPacketID = llID; }
+
+    //load the entry of a pid a few packets ahead into the cache
+    void Prefetch(int pid) const { TS_PREFETCH(&m_pStats[pid & (PID_STATS_SIZE - 1)]); }
+
+    const PID_STAT_T& Get(int pid) const { return m_pStats[pid & (PID_STATS_SIZE - 1)]; }
+
+    //counted pids, in the order they were first seen
+    const std::vector<int>& GetPids() const { return m_vecPids; }
+
+    long long GetTotal() const { return m_llTotal; }
+
+private:
+    void CheckCC(PID_STAT_T& stat,const TS_PACKET_INFO& info);
+
+private:
+    PID_STAT_T* m_pStats;
+    std::vector<int> m_vecPids;
+    long long m_llTotal;
+    long long m_llPacketID;
+};
@@ -13,40 +13,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "StdAfx.h"
 #include "ProgramParser.h"
 
-
-
-bool hm_hevc_check_rap(CTsPacket* tspacket)
-{        
-        BYTE nal_unit_type = 0;
-        BYTE *p_data=tspacket->m_pPacket;
-        BYTE size=188-4;
-
-        int start_pos = 0;
-        BYTE stream_id;
-        BYTE adaptation_field_control = tspacket->Get_adaptation_field_control();
-        if (adaptation_field_control == 2 || adaptation_field_control == 3)     //ֶ
-        {
-                int adaptation_field_length = *(tspacket->m_pPacket + 4);
-                start_pos = adaptation_field_length + 1; //ֶ
-        }
-        if (tspacket->Get_PES_stream_id(stream_id))
-        {
-                start_pos = start_pos + 3 + 1 + 2;//packet_start_code_prefix + stream_id + PES_packet_length
-        }
-        
-        
-        for(int i=start_pos;i<size;i++)
-        {
-                if((p_data[i] == 0) &&
-                        (p_data[i+1] == 0) &&
-                        (p_data[i+2] == 1) )
-                {
-                        nal_unit_type = ((p_data[i+2+1]) >> 1) & 0x3f;
-                         //nal_unit_type = ((p_data[i+3+1])&0x7E) >> 1;
-                        return nal_unit_type == 32 ? true : false;
-                }
-        }
-        return false;
+//13818-1 2-21Щstream_idPESûPTSȿѡͷ
+static inline bool PesHasOptionalHeader(BYTE stream_id)
+{
+	return stream_id != 0xBC && stream_id != 0xBE && stream_id != 0xBF
+		&& stream_id != 0xF0 && stream_id != 0xF1 && stream_id != 0xF2
+		&& stream_id != 0xF8 && stream_id != 0xFF;
 }
 
 
@@ -58,13 +30,17 @@ CProgramParser::CProgramParser(int nTsLength)
 	m_Apts = -1;
 	m_dts = -1;
 	m_pcrBefor = -1;
+	m_llPcrBeforPos = 0;
 	m_nAudioPid = -1;
 
 	m_pProgInfo = NULL;
-	m_nPacketCountOfPcr = 0;
-	m_fTransportRate = 0;
 	m_nGopsizeTmp = 0;
 	m_nGopBytesTmp = 0;
+	m_llGopStartPos = 0;
+	m_llGopPts = -1;
+	m_llLastVideoPts = -1;
+	m_video_pid_type.pid = -1;
+	m_video_pid_type.stream_type = 0;
 
 	m_nTsLength = nTsLength;
 }
@@ -73,7 +49,7 @@ CProgramParser::~CProgramParser(void)
 {
 }
 
-PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long packetID)
+PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,const TS_PACKET_INFO& info,long long packetID)
 {
 	PARSED_FRAME_INFO parsed_frame_info;
 	m_nGopBytesTmp+=m_nTsLength;
@@ -87,12 +63,18 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 
 	PROGRAM_TIMESTAMPS& pTts = m_pProgInfo->tts;
 	bool bIFrame = false;
-	BYTE stream_id;
+	bool bPesHead = (info.pes_offset >= 0);
+	BYTE stream_id = info.stream_id;
 	
 	//check for gop
-	int pid = tsPacket->Get_PID();
+	int pid = info.pid;
 	if (pid == m_video_pid_type.pid)
 	{
+		if (info.pts >= 0)
+		{
+			m_llLastVideoPts = info.pts * 300;
+		}
+
 		if (m_video_pid_type.stream_type == 0x02)	//MPEGV
 		{
 			BYTE bPic = 0;
@@ -105,9 +87,10 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 					bIFrame = true;
 				}
 				MPEG2_AssembleGop(bPic);
+				m_frameStats.AddFrameType((FRAME_TYPE)bPic,packetID);
 			}
 
-			if (tsPacket->Get_PES_stream_id(stream_id))
+			if (bPesHead)
 			{
 				if (stream_id >= 0xE0 && stream_id <= 0xEF)
 				{
@@ -126,6 +109,7 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 			if (parsed_frame_info.bNewPicture && parsed_frame_info.structure != STRUCTURE_BOTTOM_FIELD)
 			{
 				H264_AssembleGop(parsed_frame_info.FrameType);
+				m_frameStats.AddFrameType(parsed_frame_info.FrameType,packetID);
 			}
 			//else if (m_pProgInfo->gopList.empty()) //2017/6/28 else ifֵ֧һI֡ǰİGOP
 			//{
@@ -140,7 +124,7 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 				}
 			}
 			//spstsΪI֡ʼӦsliceͷPESһTSе
-			if (tsPacket->Get_PES_stream_id(stream_id))
+			if (bPesHead)
 			{
 				if (stream_id >= 0xE0 && stream_id <= 0xEF)
 				{
@@ -153,11 +137,31 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 		}
 		else if (m_video_pid_type.stream_type == 0x24)	//HEVC
 		{
-			if (tsPacket->Get_PES_stream_id(stream_id))
+			parsed_frame_info = m_hevcParser.ParseTsContinue(info);
+
+			if (parsed_frame_info.bNewPicture)
+			{
+				HEVC_AssembleGop(parsed_frame_info.FrameType);
+				m_frameStats.AddFrameType(parsed_frame_info.FrameType,packetID);
+
+				switch (parsed_frame_info.FrameType)
+				{
+				case FRAME_I:
+				case FRAME_IDR:
+				case FRAME_CRA:
+				case FRAME_BLA:
+					bIFrame = true;
+					break;
+				default:
+					break;
+				}
+			}
+			//vpsspstsΪI֡ʼӦsliceͷPESһTSе
+			if (bPesHead)
 			{
 				if (stream_id >= 0xE0 && stream_id <= 0xEF)
 				{
-					if (hm_hevc_check_rap(tsPacket))
+					if (m_hevcParser.HasParameterSets())
 					{
 						bIFrame = true;
 					}
@@ -168,34 +172,27 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 
 	/*Get times====================================================================*/
 
-	if (tsPacket->Get_PCR_flag())
+	if (info.pcr_flag)
 	{	
-		tp.timestamp = tsPacket->Get_PCR();
+		tp.timestamp = info.pcr;
 		m_pcr = tp.timestamp;
 		pTts.vecPcr.push_back(tp);
 
-		MakeRate(m_pcr);
-	}
-	else if (m_pcrBefor != -1)
-	{
-		m_nPacketCountOfPcr++;
+		MakeRate(m_pcr,packetID);
+		m_clock.AddPcr(packetID,m_pcr,info.discontinuity);
 	}
 
 	//PES head
-	if ( tsPacket->Get_PES_stream_id(stream_id) )
+	if ( bPesHead )
 	{
 		//BYTE bPic = 0;
 		//tsPacket->Get_PES_PIC_INFO(bPic);
-		// 13818-2 p22
-		long long curpcr = m_pcr;
-		if (m_fTransportRate != 0)
-		{
-			long long curpcr = m_pcr + (m_nPacketCountOfPcr*188+188-11) * 27000000 / m_fTransportRate;
-		}
+		// 13818-2 p22 ϵͳʱ
+		long long curpcr = m_clock.TimeAt(packetID);
 
 		if (stream_id >= 0xE0 && stream_id <= 0xEF && bIFrame)	//video
 		{
-			BYTE flag = tsPacket->Get_PTS_DTS_flag();
+			BYTE flag = info.pts_dts_flags;
 			if (flag == 0x2)	//pts only
 			{
 				//ptsֵ
@@ -251,6 +248,24 @@ PARSED_FRAME_INFO CProgramParser::PushBackTsPacket(CTsPacket* tsPacket,long long
 			tp.timestamp = m_Apts/300 - curpcr/300;
 			pTts.vecAPtsSub.push_back(tp);
 		}
+
+		//ƵĻȸ·ÿ·ͳ
+		if (info.pts >= 0 && !m_mapEsTrack.empty() && PesHasOptionalHeader(stream_id))
+		{
+			map<int,ES_TIMESTAMPS*>::iterator it = m_mapEsTrack.find(pid);
+			if (it != m_mapEsTrack.end())
+			{
+				ES_TIMESTAMPS* es = it->second;
+				tp.timestamp = info.pts * 300;
+				es->vecPts.push_back(tp);
+
+				if (curpcr > 0)
+				{
+					tp.timestamp = info.pts - curpcr/300;
+					es->vecPtsSub.push_back(tp);
+				}
+			}
+		}
 	}
 
 	return parsed_frame_info;
@@ -261,97 +276,95 @@ inline void CProgramParser::MPEG2_AssembleGop(BYTE bPic)
 	switch(bPic)
 	{
 	case 0x01:	//I
-		if ( !m_gopTmp.empty() )	//,µĿʼ
-		{
-			GOP_LIST gl;
-			gl.gop = m_gopTmp;
-			//gl.time = m_pcr;
-			gl.pos = m_llTotalPacketCounter;
-			gl.gop_size = m_nGopsizeTmp;
-			gl.gop_bytes = m_nGopBytesTmp;
-			m_pProgInfo->gopList.push_back(gl);
-		}
-		m_gopTmp = ("I");
-		m_nGopsizeTmp = 1;
-		m_nGopBytesTmp = m_nTsLength;
+		StartGop(FRAME_I);
 		break;
 
 	case 0x02:	//P
-		m_gopTmp += ("P");
-		m_nGopsizeTmp++;
+		AppendGopFrame(FRAME_P);
 		break;
 
 	case 0x03:	//B
-		m_gopTmp += ("B");
-		m_nGopsizeTmp++;
+		AppendGopFrame(FRAME_B);
 		break;
 	}
 }
 
 inline void CProgramParser::H264_AssembleGop(FRAME_TYPE frame_type)
 {
-
-
 	switch(frame_type)
 	{
 	case FRAME_I:	//I
-		if ( !m_gopTmp.empty() )	//,µĿʼ
-		{
-			GOP_LIST gl;
-			gl.gop = m_gopTmp;
-			//gl.time = m_pcr;
-			gl.pos = m_llTotalPacketCounter;
-			gl.gop_size = m_nGopsizeTmp;
-			gl.gop_bytes = m_nGopBytesTmp;
-			m_pProgInfo->gopList.push_back(gl);
-		}
-		m_gopTmp = ("I");
-		m_nGopsizeTmp = 1;
-		m_nGopBytesTmp = m_nTsLength;
-		break;
 	case FRAME_IDR:	//IDR
-		if ( !m_gopTmp.empty() )	//,µĿʼ
-		{
-			GOP_LIST gl;
-			gl.gop = m_gopTmp;
-			//gl.time = m_pcr;
-			gl.pos = m_llTotalPacketCounter;
-			gl.gop_size = m_nGopsizeTmp;
-			gl.gop_bytes = m_nGopBytesTmp;
-			m_pProgInfo->gopList.push_back(gl);
-		}
-		m_gopTmp = ("IDR-");//IDR-
-		m_nGopsizeTmp = 1;
-		m_nGopBytesTmp = m_nTsLength;
+		StartGop(frame_type);
 		break;
 
 	case FRAME_P:
-		m_gopTmp += ("P");
-		m_nGopsizeTmp++;
-		break;
-
 	case FRAME_B:
-		m_gopTmp += ("B");
-		m_nGopsizeTmp++;
-		break;
 	case FRAME_SP:
-		m_gopTmp += ("-SP-");//-SP-
-		m_nGopsizeTmp++;
-		break;
 	case FRAME_SI:
-		m_gopTmp += ("-SI-");//-SI-
-		m_nGopsizeTmp++;
+		AppendGopFrame(frame_type);
+		break;
+	default:
+		break;
+	}
+}
+
+inline void CProgramParser::HEVC_AssembleGop(FRAME_TYPE frame_type)
+{
+	switch(frame_type)
+	{
+	case FRAME_I:
+	case FRAME_IDR:
+	case FRAME_CRA:
+	case FRAME_BLA:
+		StartGop(frame_type);
+		break;
+
+	case FRAME_P:
+	case FRAME_B:
+		AppendGopFrame(frame_type);
 		break;
 	default:
 		break;
 	}
 }
 
-void CProgramParser::MakeRate(long long pcr)
+inline void CProgramParser::StartGop(FRAME_TYPE frame_type)
+{
+	if ( !m_gopRunsTmp.empty() )	//,µĿʼ
+	{
+		GOP_LIST gl;
+		gl.pos = m_llTotalPacketCounter;
+		gl.start_pos = m_llGopStartPos;
+		gl.gop_size = m_nGopsizeTmp;
+		gl.gop_bytes = m_nGopBytesTmp;
+		gl.pts = m_llGopPts;
+		gl.idr = GOP_RUN_TYPE(m_gopRunsTmp[0]) == FRAME_IDR;
+		m_pProgInfo->AddGop(gl,&m_gopRunsTmp[0],m_gopRunsTmp.size(),0);
+	}
+	m_gopRunsTmp.clear();
+	m_nGopsizeTmp = 0;
+	m_nGopBytesTmp = m_nTsLength;
+	AppendGopFrame(frame_type);
+}
+
+inline void CProgramParser::AppendGopFrame(FRAME_TYPE frame_type)
+{
+	if (m_gopRunsTmp.empty())
+	{
+		m_llGopStartPos = m_llTotalPacketCounter;
+		m_llGopPts = m_llLastVideoPts;
+	}
+	GopRunsAppend(m_gopRunsTmp,frame_type);
+	m_nGopsizeTmp++;
+}
+
+void CProgramParser::MakeRate(long long pcr,long long llPos)
 {
 	if (m_pcrBefor == -1)
 	{
 		m_pcrBefor = pcr;
+		m_llPcrBeforPos = llPos;
 		return;
 	}
 
@@ -363,20 +376,17 @@ void CProgramParser::MakeRate(long long pcr)
 		return;
 
 
+	//PCRİ
+	long long nPacketCountOfPcr = llPos - m_llPcrBeforPos - 1;
 	double Duration = (pcr - m_pcrBefor)/27;
-	rl.rate = ((long long)m_nPacketCountOfPcr*188 + 188-11 + 11)*8*1000000/Duration / 1000000;
+	rl.rate = (nPacketCountOfPcr*188 + 188-11 + 11)*8*1000000/Duration / 1000000;
 	
 	//rl.rate = ((int)(rl.rate*100)) / 100.0;
-	//long long nn = ((long long)m_nPacketCountOfPcr*188 + 188-11 + 11)*27000000*8;
-
-//	rl.rate = ( (double)nn )/(double)((pcr - m_pcrBefor)*1048576);
-	//rl.rate = ( (double)nn )/(double)((pcr - m_pcrBefor)*1000000);
-	m_fTransportRate = ( (double)(m_nPacketCountOfPcr*188 + 188-11 + 11)*27000000 )/(double)(pcr - m_pcrBefor);
 	rl.pos = m_llTotalPacketCounter;
 	m_pProgInfo->rateList.push_back(rl);
 
 	m_pcrBefor = pcr;
-	m_nPacketCountOfPcr = 0;
+	m_llPcrBeforPos = llPos;
 }
 
 void CProgramParser::SetVideoStreamInfo(PID_STREAM_TYPE video_pid_type)
@@ -400,10 +410,10 @@ int CProgramParser::DecodePacket(CTsPacket* tsPacket)
 	return 0;
 }
 
-void CProgramParser::AddOtherPacket()
+void CProgramParser::ShiftPacketID(long long llDelta)
 {
-	//m_llTotalPacketCounter++;
-	m_nPacketCountOfPcr++;
+	m_llPcrBeforPos += llDelta;
+	m_clock.Shift(llDelta);
 }
 
 void CProgramParser::SetAudioPid(int pid)
@@ -411,3 +421,21 @@ void CProgramParser::SetAudioPid(int pid)
 	m_nAudioPid = pid;
 }
 
+void CProgramParser::AddEsPid(const PID_STREAM_TYPE& pid_type)
+{
+	m_mapEsTrack[pid_type.pid] = &m_pProgInfo->tts.AddEs(pid_type.pid,pid_type.stream_type);
+}
+
+void CProgramParser::GetGopState(GOP_STATE& gs)
+{
+	gs.runs = m_gopRunsTmp;
+	gs.gl.pos = m_llTotalPacketCounter;
+	gs.gl.start_pos = m_llGopStartPos;
+	gs.gl.gop_size = m_nGopsizeTmp;
+	gs.gl.gop_bytes = m_nGopBytesTmp;
+	gs.gl.pts = m_llGopPts;
+	gs.gl.idr = !m_gopRunsTmp.empty() && GOP_RUN_TYPE(m_gopRunsTmp[0]) == FRAME_IDR;
+	gs.gl.run_offset = 0;
+	gs.gl.run_count = (unsigned int)m_gopRunsTmp.size();
+}
+
@@ -12,9 +12,13 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #pragma once
 #include "TsPacket.h"
+#include "TsPacketInfo.h"
 #include "H264Dec.h"
 #include <iostream>
 #include "jmdec.h"
+#include "FrameStats.h"
+#include "HevcParser.h"
+#include "ClockRecovery.h"
 
 using namespace std;
 
@@ -31,11 +35,12 @@ public:
 public:
 	/**
 	* Ҫ֤TSǱ·Ŀġ
+	* infoΪðԤȽõİͷϢpidpcrpesͷֱӴȡظ
 	*/
-	PARSED_FRAME_INFO PushBackTsPacket(CTsPacket* tsPacket,long long packetID);
+	PARSED_FRAME_INFO PushBackTsPacket(CTsPacket* tsPacket,const TS_PACKET_INFO& info,long long packetID);
 
 	//ýϢ洢
-	void SetOutputBuffer(PROGRAM_INFO* p) { m_pProgInfo = p; }
+	void SetOutputBuffer(PROGRAM_INFO* p) { m_pProgInfo = p; m_frameStats.SetOutput(&p->frameStats); }
 
 	//ƵpidͣĿǰֽ֧ģ
 	void SetVideoStreamInfo(PID_STREAM_TYPE video_pid_type);
@@ -43,19 +48,39 @@ public:
 	//ӰƵPID֧1
 	void SetAudioPid(int pid);
 
+	//ͳһ·ƵĻȻʱÿ·һΣSetOutputBuffer֮
+	void AddEsPid(const PID_STREAM_TYPE& pid_type);
+
 	//һTS
 	int DecodePacket(CTsPacket* tsPacket);
 
-	//һǱĿPIDİ
-	void AddOtherPacket();
+	//֮İIDƽllDeltaʱѼ¼İID֮ƽ
+	void ShiftPacketID(long long llDelta);
+
+	//ȡǰδGOPֶβзʱƴӷֶα߽紦GOP
+	void GetGopState(GOP_STATE& gs);
+
+	//ƵpidûƵʱΪ-1
+	int GetVideoPid() const { return m_video_pid_type.pid; }
+
+	//֡ͳƣעᵽƵpidPES
+	IPesConsumer* GetFrameStats() { return &m_frameStats; }
 private:
 	//GOP
 	void MPEG2_AssembleGop(BYTE bPic);
 
 	void H264_AssembleGop(FRAME_TYPE frame_type);
 
-	//
-	inline void MakeRate(long long pcr);
+	void HEVC_AssembleGop(FRAME_TYPE frame_type);
+
+	//ǰGOPframe_type֡ʼµGOP
+	inline void StartGop(FRAME_TYPE frame_type);
+
+	//ǰGOPмһ֡
+	inline void AppendGopFrame(FRAME_TYPE frame_type);
+
+	//ʣllPosΪpcrڰİID
+	inline void MakeRate(long long pcr,long long llPos);
 private:
 	//ĿTS
 	unsigned long long m_llTotalPacketCounter;
@@ -72,35 +97,46 @@ private:
 	//һpcrֵ
 	//TIMESTAMP m_lastPcrtp;
 
-	//GOPʱַ
-	string m_gopTmp;
+	//GOPʱ֡γ
+	GOP_RUNS m_gopRunsTmp;
 	int m_nGopsizeTmp;
 	int m_nGopBytesTmp;
+	long long m_llGopStartPos;
+	long long m_llGopPts;
+
+	//ƵһPESpts27MHz
+	long long m_llLastVideoPts;
 
 	//洢ĽĿϢ
 	PROGRAM_INFO* m_pProgInfo;
 
 
-	//PCR
-	int m_nPacketCountOfPcr;
-
-	//һPCR
+	//һPCRID
 	long long m_pcrBefor;
+	long long m_llPcrBeforPos;
+
+	//Ŀϵͳʱӣ԰IDΪλ
+	CClockRecovery m_clock;
 
 	//Ƶpid
 	PID_STREAM_TYPE m_video_pid_type;
 
 	int m_nAudioPid;
 
+	//·ʱָm_pProgInfo->tts.mapEs
+	map<int,ES_TIMESTAMPS*> m_mapEsTrack;
+
 	//H264﷨
 	CH264Dec m_avcParser;
+
+	//HEVC﷨
+	CHevcParser m_hevcParser;
+
+	//Ƶ֡Сͳ
+	CFrameStats m_frameStats;
 	
 
 	int m_nTsLength;
-private:
-	//13818-2 p22 (ֽ)
-	double m_fTransportRate;
-
 private:
 
 };
@@ -0,0 +1,577 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "StreamProbe.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define PROBE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+//how often the decided pids are looked for
+#define PROBE_CHECK_PACKETS     256
+
+//the audio frame chain must start within this many bytes of the first pes
+#define PROBE_AUDIO_SEARCH      2048
+
+static const int s_mpa_bitrate[5][14] =
+{
+    {32,64,96,128,160,192,224,256,288,320,352,384,416,448},    //MPEG-1 layer I
+    {32,48,56,64,80,96,112,128,160,192,224,256,320,384},       //MPEG-1 layer II
+    {32,40,48,56,64,80,96,112,128,160,192,224,256,320},        //MPEG-1 layer III
+    {32,48,56,64,80,96,112,128,144,160,176,192,224,256},       //MPEG-2 layer I
+    {8,16,24,32,40,48,56,64,80,96,112,128,144,160}             //MPEG-2 layer II and III
+};
+
+static const int s_mpa_samplerate[3] = {44100,48000,32000};
+
+static const int s_ac3_bitrate[19] = {32,40,48,56,64,80,96,112,128,160,192,224,256,320,384,448,512,576,640};
+
+//pes without the optional header, ISO/IEC 13818-1 table 2-21
+static bool PesHasOptionalHeader(BYTE stream_id)
+{
+    return stream_id != 0xBC && stream_id != 0xBE && stream_id != 0xBF
+        && stream_id != 0xF0 && stream_id != 0xF1 && stream_id != 0xF2
+        && stream_id != 0xF8 && stream_id != 0xFF;
+}
+
+static bool IsAvcProfile(BYTE profile_idc)
+{
+    switch (profile_idc)
+    {
+    case 66: case 77: case 88: case 100: case 110: case 122: case 244: case 44:
+    case 83: case 86: case 118: case 128: case 138: case 139: case 134: case 135:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsVideoStreamType(int stream_type)
+{
+    return stream_type == 0x02 || stream_type == 0x1B || stream_type == 0x24;
+}
+
+
+CStreamProbe::CStreamProbe()
+{
+    m_vecIndex.assign(PROBE_PID_COUNT,-1);
+}
+
+int CStreamProbe::Probe(const BYTE* pData,int nLen,int nTsLen)
+{
+    TS_PACKET_INFO info;
+    int nPackets = 0;
+    int pos = 0;
+    while (pos + nTsLen <= nLen)
+    {
+        ParseTsPacketInfo((BYTE*)pData + pos,info);
+        AddPacket(info);
+        pos += nTsLen;
+        nPackets++;
+
+        if (nPackets % PROBE_CHECK_PACKETS != 0)
+        {
+            continue;
+        }
+
+        //decided pids are no longer scanned. the probe ends when all are, or when only
+        //pids without video start codes are left: audio and data are judged by the es
+        //bytes kept so far, more packets matter only for video waiting for its headers
+        bool bAll = true;
+        for (size_t i = 0; i < m_vecState.size(); i++)
+        {
+            PID_STATE_T& st = m_vecState[i];
+            if (!st.bPes || st.bDecided)
+            {
+                continue;
+            }
+            PROBE_RESULT_T r;
+            Classify(st,r);
+            st.bDecided = r.confidence >= PROBE_CONFIDENT;
+            bAll = bAll && (st.bDecided || !HasVideoStartCodes(st));
+        }
+        if (bAll && nPackets >= PROBE_MIN_PACKETS && !m_vecState.empty())
+        {
+            break;
+        }
+    }
+
+    m_vecResult.clear();
+    for (int pid = 0; pid < PROBE_PID_COUNT; pid++)
+    {
+        if (m_vecIndex[pid] >= 0)
+        {
+            PROBE_RESULT_T r;
+            Classify(m_vecState[m_vecIndex[pid]],r);
+            m_vecResult.push_back(r);
+        }
+    }
+
+    return pos;
+}
+
+int CStreamProbe::GetVideoPid(int& stream_type) const
+{
+    int pid = -1;
+    int confidence = -1;
+    stream_type = -1;
+    for (size_t i = 0; i < m_vecResult.size(); i++)
+    {
+        const PROBE_RESULT_T& r = m_vecResult[i];
+        if (IsVideoStreamType(r.stream_type) && r.confidence > confidence)
+        {
+            pid = r.pid;
+            confidence = r.confidence;
+            stream_type = r.stream_type;
+        }
+    }
+    if (pid >= 0)
+    {
+        return pid;
+    }
+
+    //video of an unknown codec
+    for (size_t i = 0; i < m_vecResult.size(); i++)
+    {
+        if (m_vecResult[i].stream_id >= 0xE0 && m_vecResult[i].stream_id <= 0xEF)
+        {
+            return m_vecResult[i].pid;
+        }
+    }
+    return -1;
+}
+
+int CStreamProbe::GetPcrPid() const
+{
+    int stream_type;
+    int video = GetVideoPid(stream_type);
+    int pid = -1;
+    for (size_t i = 0; i < m_vecResult.size(); i++)
+    {
+        if (!m_vecResult[i].has_pcr)
+        {
+            continue;
+        }
+        if (m_vecResult[i].pid == video)
+        {
+            return video;
+        }
+        if (pid < 0)
+        {
+            pid = m_vecResult[i].pid;
+        }
+    }
+    return pid;
+}
+
+void CStreamProbe::AddPacket(const TS_PACKET_INFO& info)
+{
+    if (!info.sync || info.tei || info.pid == 0x1FFF)
+    {
+        return;
+    }
+
+    bool bPesHead = info.pusi && info.pes_offset >= 0 && info.stream_id != 0xBE;
+    int index = m_vecIndex[info.pid];
+    if (index < 0)
+    {
+        if (!bPesHead && !info.pcr_flag)
+        {
+            return;
+        }
+        PID_STATE_T st;
+        st.pid = info.pid;
+        index = (int)m_vecState.size();
+        m_vecIndex[info.pid] = index;
+        m_vecState.push_back(st);
+    }
+
+    PID_STATE_T& st = m_vecState[index];
+    if (info.pcr_flag)
+    {
+        st.bPcr = true;
+    }
+    if (info.payload_offset < 0 || info.scrambling_control != 0)
+    {
+        return;
+    }
+
+    const BYTE* p = info.pPacket + info.payload_offset;
+    const BYTE* end = info.pPacket + TS_PACKET_LENGTH_STANDARD;
+    if (bPesHead)
+    {
+        if (!st.bPes)
+        {
+            st.bPes = true;
+            st.stream_id = info.stream_id;
+        }
+        const BYTE* pes = info.pPacket + info.pes_offset;
+        if (!PesHasOptionalHeader(info.stream_id))
+            p = pes + 6;
+        else
+            p = pes + 9 < end ? pes + 9 + pes[8] : end;
+        st.nTail = 0;
+    }
+    else if (!st.bPes)
+    {
+        return;
+    }
+
+    if (st.bDecided || p >= end)
+    {
+        return;
+    }
+
+    if (st.es.size() < PROBE_ES_BYTES)
+    {
+        size_t n = min((size_t)(end - p),PROBE_ES_BYTES - st.es.size());
+        st.es.insert(st.es.end(),p,p + n);
+    }
+    ScanStartCodes(st,p,(int)(end - p));
+}
+
+void CStreamProbe::ScanStartCodes(PID_STATE_T& st,const BYTE* p,int nLen)
+{
+    //the tail of the previous payload in front, so start codes crossing packets are found;
+    //a start code counts once its two header bytes are there, the last 4 bytes wait for the next packet
+    BYTE buf[sizeof(st.tail) + TS_PACKET_LENGTH_STANDARD + 16];
+    memcpy(buf,st.tail,st.nTail);
+    memcpy(buf + st.nTail,p,nLen);
+    int n = st.nTail + nLen;
+    int i = 0;
+
+#ifdef PROBE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    for (; i + 18 <= n; i += 16)
+    {
+        __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buf + i)),zero);
+        __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buf + i + 1)),zero);
+        __m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(buf + i + 2)),one);
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(a,b),c));
+        while (mask != 0)
+        {
+            int k = i + __builtin_ctz(mask);
+            if (k + 4 < n)
+            {
+                CountStartCode(st,buf + k + 3);
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i + 4 < n; i++)
+    {
+        if (buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 1)
+        {
+            CountStartCode(st,buf + i + 3);
+        }
+    }
+
+    st.nTail = n < (int)sizeof(st.tail) ? n : (int)sizeof(st.tail);
+    memcpy(st.tail,buf + n - st.nTail,st.nTail);
+}
+
+void CStreamProbe::CountStartCode(PID_STATE_T& st,const BYTE* nal)
+{
+    BYTE b0 = nal[0];
+    BYTE b1 = nal[1];
+
+    //MPEG-2 video, these codes have the forbidden bit of H.264 and HEVC set
+    if (b0 == 0xB3)
+    {
+        st.mpeg2_seq++;
+        return;
+    }
+    if (b0 == 0xB5)
+    {
+        st.mpeg2_ext++;
+        return;
+    }
+    if (b0 == 0x00)
+    {
+        st.mpeg2_pic++;
+    }
+
+    if (b0 & 0x80)
+    {
+        return;
+    }
+
+    //H.264
+    switch (b0 & 0x1F)
+    {
+    case 7:
+        if (IsAvcProfile(b1))
+            st.avc_sps++;
+        break;
+    case 8:
+        st.avc_pps++;
+        break;
+    case 1:
+    case 5:
+        st.avc_slice++;
+        break;
+    case 9:
+        st.avc_aud++;
+        break;
+    default:
+        break;
+    }
+
+    //HEVC, nuh_layer_id 0 and a valid nuh_temporal_id_plus1
+    if ((b0 & 0x01) != 0 || (b1 & 0xF8) != 0 || (b1 & 0x07) == 0)
+    {
+        return;
+    }
+    int nal_unit_type = b0 >> 1;
+    if (nal_unit_type == 32)
+        st.hevc_vps++;
+    else if (nal_unit_type == 33)
+        st.hevc_sps++;
+    else if (nal_unit_type == 34)
+        st.hevc_pps++;
+    else if (nal_unit_type <= 9 || (nal_unit_type >= 16 && nal_unit_type <= 21))
+        st.hevc_slice++;
+}
+
+bool CStreamProbe::HasVideoStartCodes(const PID_STATE_T& st)
+{
+    return st.mpeg2_seq + st.mpeg2_ext + st.mpeg2_pic
+        + st.avc_sps + st.avc_pps + st.avc_slice + st.avc_aud
+        + st.hevc_vps + st.hevc_sps + st.hevc_pps + st.hevc_slice > 0;
+}
+
+void CStreamProbe::Classify(const PID_STATE_T& st,PROBE_RESULT_T& r) const
+{
+    r.pid = st.pid;
+    r.stream_type = -1;
+    r.confidence = 0;
+    r.stream_id = st.stream_id;
+    r.has_pcr = st.bPcr;
+    if (!st.bPes)
+    {
+        return;
+    }
+
+    int type = -1;
+    int confidence = 0;
+    ClassifyVideo(st,r.stream_type,r.confidence);
+    ClassifyAudio(st.es,type,confidence);
+    if (confidence > r.confidence)
+    {
+        r.stream_type = type;
+        r.confidence = confidence;
+    }
+    if (r.confidence < PROBE_CONFIDENT / 2)
+    {
+        ClassifyPrivate(st,type,confidence);
+        if (confidence > r.confidence)
+        {
+            r.stream_type = type;
+            r.confidence = confidence;
+        }
+    }
+}
+
+void CStreamProbe::ClassifyVideo(const PID_STATE_T& st,int& stream_type,int& confidence)
+{
+    stream_type = -1;
+    confidence = 0;
+
+    //a sequence header cannot start a H.264 or HEVC nal unit
+    if (st.mpeg2_seq > 0)
+    {
+        stream_type = 0x02;
+        confidence = 60 + (st.mpeg2_pic > 0 ? 30 : 0) + (st.mpeg2_ext > 0 ? 10 : 0);
+        return;
+    }
+
+    int hevc = (st.hevc_vps > 0 ? 30 : 0) + (st.hevc_sps > 0 ? 30 : 0) + (st.hevc_pps > 0 ? 30 : 0);
+    if (hevc > 0 && st.hevc_slice > 0)
+    {
+        hevc += 10;
+    }
+    int avc = (st.avc_sps > 0 ? 40 : 0) + (st.avc_pps > 0 ? 30 : 0);
+    if (avc > 0)
+    {
+        avc += (st.avc_slice > 0 ? 20 : 0) + (st.avc_aud > 0 ? 10 : 0);
+    }
+
+    if (hevc >= avc && hevc > 0)
+    {
+        stream_type = 0x24;
+        confidence = hevc;
+    }
+    else if (avc > 0)
+    {
+        stream_type = 0x1B;
+        confidence = avc;
+    }
+}
+
+void CStreamProbe::ClassifyAudio(const vector<BYTE>& es,int& stream_type,int& confidence)
+{
+    stream_type = -1;
+    confidence = 0;
+
+    int nLen = (int)es.size();
+    int nSearch = nLen < PROBE_AUDIO_SEARCH ? nLen : PROBE_AUDIO_SEARCH;
+    for (int i = 0; i < nSearch && confidence < 100; i++)
+    {
+        int type = -1;
+        int len = AudioFrameLength(&es[i],nLen - i,type);
+        if (len <= 0)
+        {
+            continue;
+        }
+
+        //follow the frames while the next sync word is where the length says
+        int frames = 1;
+        int pos = i + len;
+        while (pos < nLen)
+        {
+            int next_type = -1;
+            int next = AudioFrameLength(&es[pos],nLen - pos,next_type);
+            if (next <= 0 || next_type != type)
+            {
+                break;
+            }
+            frames++;
+            pos += next;
+        }
+        if (pos < nLen && frames < 3)
+        {
+            //the chain broke inside the buffer
+            continue;
+        }
+
+        int c = frames >= 3 ? 100 : (frames == 2 ? 80 : 40);
+        if (c > confidence)
+        {
+            stream_type = type;
+            confidence = c;
+        }
+    }
+}
+
+void CStreamProbe::ClassifyPrivate(const PID_STATE_T& st,int& stream_type,int& confidence)
+{
+    stream_type = -1;
+    confidence = 0;
+    if (st.stream_id >= 0xC0 && st.stream_id <= 0xDF)
+    {
+        //an audio stream_id but no frame found
+        stream_type = 0x03;
+        confidence = 20;
+        return;
+    }
+    if (st.stream_id != 0xBD && st.stream_id != 0xBF)
+    {
+        return;
+    }
+
+    stream_type = 0x06;
+    confidence = 40;
+    const vector<BYTE>& es = st.es;
+    if (es.size() >= 3 && es[0] == 0x20 && es[1] == 0x00 && es[2] == 0x0F)
+    {
+        //DVB subtitles: data_identifier, subtitle_stream_id, sync_byte
+        confidence = 80;
+    }
+    else if (es.size() >= 2 && es[0] >= 0x10 && es[0] <= 0x1F && (es[1] == 0x02 || es[1] == 0x03 || es[1] == 0xFF))
+    {
+        //EBU teletext: data_identifier, data_unit_id
+        confidence = 80;
+    }
+}
+
+int CStreamProbe::AudioFrameLength(const BYTE* p,int nLen,int& stream_type)
+{
+    if (nLen < 7)
+    {
+        return 0;
+    }
+
+    //ADTS AAC
+    if (p[0] == 0xFF && (p[1] & 0xF6) == 0xF0 && ((p[2] >> 2) & 0x0F) < 13)
+    {
+        int len = ((p[3] & 0x03) << 11) | (p[4] << 3) | (p[5] >> 5);
+        stream_type = 0x0F;
+        return len >= 7 ? len : 0;
+    }
+
+    //LOAS AudioSyncStream of LATM AAC
+    if (p[0] == 0x56 && (p[1] & 0xE0) == 0xE0)
+    {
+        int len = (((p[1] & 0x1F) << 8) | p[2]) + 3;
+        stream_type = 0x11;
+        return len > 3 ? len : 0;
+    }
+
+    //AC-3 and E-AC-3
+    if (p[0] == 0x0B && p[1] == 0x77)
+    {
+        int bsid = p[5] >> 3;
+        int fscod = p[4] >> 6;
+        if (bsid <= 10)
+        {
+            int frmsizecod = p[4] & 0x3F;
+            if (fscod == 3 || frmsizecod >= 38)
+            {
+                return 0;
+            }
+            int kbps = s_ac3_bitrate[frmsizecod >> 1];
+            int words = fscod == 0 ? kbps * 2 : (fscod == 1 ? kbps * 96000 / 44100 + (frmsizecod & 1) : kbps * 3);
+            stream_type = 0x81;
+            return words * 2;
+        }
+        if (bsid <= 16)
+        {
+            stream_type = 0x87;
+            return ((((p[2] & 0x07) << 8) | p[3]) + 1) * 2;
+        }
+        return 0;
+    }
+
+    //MPEG audio layer I, II and III
+    if (p[0] == 0xFF && (p[1] & 0xE0) == 0xE0)
+    {
+        int version = (p[1] >> 3) & 0x03;   //0 MPEG-2.5, 1 reserved, 2 MPEG-2, 3 MPEG-1
+        int layer = 4 - ((p[1] >> 1) & 0x03);
+        int bitrate_index = p[2] >> 4;
+        int sr_index = (p[2] >> 2) & 0x03;
+        int padding = (p[2] >> 1) & 0x01;
+        if (version == 1 || layer == 4 || bitrate_index == 0 || bitrate_index == 15 || sr_index == 3)
+        {
+            return 0;
+        }
+
+        bool lsf = version != 3;
+        int table = lsf ? (layer == 1 ? 3 : 4) : layer - 1;
+        int bitrate = s_mpa_bitrate[table][bitrate_index - 1] * 1000;
+        int samplerate = s_mpa_samplerate[sr_index] >> (version == 3 ? 0 : (version == 2 ? 1 : 2));
+        stream_type = lsf ? 0x04 : 0x03;
+        if (layer == 1)
+        {
+            return (12 * bitrate / samplerate + padding) * 4;
+        }
+        return (layer == 3 && lsf ? 72 : 144) * bitrate / samplerate + padding;
+    }
+
+    return 0;
+}
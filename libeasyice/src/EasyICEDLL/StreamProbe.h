@@ -0,0 +1,146 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "commondefs.h"
+#include "TsPacketInfo.h"
+#include <string.h>
+#include <vector>
+
+#define PROBE_PID_COUNT         8192
+
+//the probe may stop once this many packets are seen and every pes pid is decided
+#define PROBE_MIN_PACKETS       2048
+
+//a pid is decided at this confidence
+#define PROBE_CONFIDENT         90
+
+//es bytes kept from the first pes of each pid for the audio frame checks
+#define PROBE_ES_BYTES          4096
+
+//one elementary stream found by the probe
+typedef struct _PROBE_RESULT_T
+{
+    int pid;
+    int stream_type;    //as in a pmt: 0x02,0x1B,0x24,0x0F,0x11,0x81,0x87,0x03,0x06; -1 unknown
+    int confidence;     //0-100
+    BYTE stream_id;     //of the first pes
+    bool has_pcr;
+}PROBE_RESULT_T;
+
+/**
+ * Stream type detection for streams without psi. Every pid is classified in
+ * one pass over the packets:
+ *
+ * - video: the pes payload of each packet is searched for start codes, 16
+ *   positions at a time with SSE2, across packet boundaries. MPEG-2 is told
+ *   by its sequence, extension and picture headers, H.264 by sps (with a
+ *   known profile_idc), pps and slices, HEVC by vps, sps and pps with a two
+ *   byte nal unit header. The stream_id is not trusted, so video carried in
+ *   private streams is found as well.
+ * - audio: the first PROBE_ES_BYTES of the pes payload must hold a chain of
+ *   frames whose lengths point from one sync word to the next: ADTS and
+ *   LATM/LOAS AAC, AC-3, E-AC-3 and MPEG audio.
+ * - private data: private streams matching neither are reported as 0x06,
+ *   with a higher confidence for DVB subtitles and teletext.
+ *
+ * Pids without pes headers (psi, pcr only) are reported only if they carry
+ * a pcr, with stream_type -1.
+ */
+class CStreamProbe
+{
+public:
+    CStreamProbe();
+
+    /**
+     * @brief classify the pids of pData, which starts with a packet. Stops early
+     *        once PROBE_MIN_PACKETS are seen and every pes pid is decided
+     * @return the number of bytes looked at
+     */
+    int Probe(const BYTE* pData,int nLen,int nTsLen);
+
+    //one entry per pid with pes or pcr, by pid
+    const std::vector<PROBE_RESULT_T>& GetResults() const { return m_vecResult; }
+
+    //video pid with the highest confidence, -1 if none
+    int GetVideoPid(int& stream_type) const;
+
+    //pcr pid, the one in the video pid first; -1 if none
+    int GetPcrPid() const;
+
+private:
+    typedef struct _PID_STATE_T
+    {
+        _PID_STATE_T()
+        {
+            pid = -1;
+            bPes = false;
+            stream_id = 0;
+            bPcr = false;
+            bDecided = false;
+            nTail = 0;
+            memset(tail,0,sizeof(tail));
+            mpeg2_seq = mpeg2_ext = mpeg2_pic = 0;
+            avc_sps = avc_pps = avc_slice = avc_aud = 0;
+            hevc_vps = hevc_sps = hevc_pps = hevc_slice = 0;
+        }
+        int pid;
+        bool bPes;
+        BYTE stream_id;
+        bool bPcr;
+        bool bDecided;
+
+        //last bytes of the previous payload, a start code may cross packets
+        BYTE tail[4];
+        int nTail;
+
+        //start codes seen, by kind
+        int mpeg2_seq;
+        int mpeg2_ext;
+        int mpeg2_pic;
+        int avc_sps;
+        int avc_pps;
+        int avc_slice;
+        int avc_aud;
+        int hevc_vps;
+        int hevc_sps;
+        int hevc_pps;
+        int hevc_slice;
+
+        //es bytes from the first pes header on
+        std::vector<BYTE> es;
+    }PID_STATE_T;
+
+    void AddPacket(const TS_PACKET_INFO& info);
+
+    void ScanStartCodes(PID_STATE_T& st,const BYTE* p,int nLen);
+    void CountStartCode(PID_STATE_T& st,const BYTE* nal);
+
+    static bool HasVideoStartCodes(const PID_STATE_T& st);
+
+    void Classify(const PID_STATE_T& st,PROBE_RESULT_T& r) const;
+    static void ClassifyVideo(const PID_STATE_T& st,int& stream_type,int& confidence);
+    static void ClassifyAudio(const std::vector<BYTE>& es,int& stream_type,int& confidence);
+    static void ClassifyPrivate(const PID_STATE_T& st,int& stream_type,int& confidence);
+
+    //length of the audio frame starting at p and its stream_type, 0 if no valid header
+    static int AudioFrameLength(const BYTE* p,int nLen,int& stream_type);
+
+private:
+    std::vector<PID_STATE_T> m_vecState;
+
+    //state index by pid, -1 if the pid has none yet
+    std::vector<int> m_vecIndex;
+
+    std::vector<PROBE_RESULT_T> m_vecResult;
+};
@@ -21,6 +21,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <unistd.h>
 
 #include "CheckMediaInfo.h"
+#include "SyncScan.h"
 
 
 using namespace std;
@@ -33,30 +34,6 @@ extern bool g_check_part;
 
 
 
-static int TryToReSync(BYTE* pData,int nLength,int& nSycByte)
-{
-	nSycByte = 0;
-	int maxLength = nLength - 204*3;
-	if (maxLength < 204*3)
-		return -1;
-
-	for (int i = 0; i < maxLength; i++)
-	{
-		if(pData[i]==0x47&&pData[i+188]==0x47&&pData[i+188*2]==0x47&&pData[i+188*3]==0x47&&pData[i+188*4]==0x47)
-		{	
-			nSycByte = i;
-			return 188;
-		}
-		else if(pData[i]==0x47&&pData[i+204]==0x47&&pData[i+204*2]==0x47&&pData[i+204*3]==0x47&&pData[i+204*4]==0x47)
-		{
-			nSycByte = i;
-			return 204;
-		}
-	}
-	return -1;
-}
-
-
 int GetTsLength(const char* PathName,int& nSyncByte)
 {
 	nSyncByte = 0;
@@ -80,32 +57,13 @@ int GetTsLength(const char* PathName,int& nSyncByte)
 	//	delete [] pBuffer;
 	//	return ERROR_FILE_NOT_DATA;
 	//}
-	if(pBuffer[0]==0x47&&pBuffer[188]==0x47&&pBuffer[188*2]==0x47&&pBuffer[188*3]==0x47&&pBuffer[188*4]==0x47)
-			ret=188;
-	else if(pBuffer[0]==0x47&&pBuffer[204]==0x47&&pBuffer[204*2]==0x47&&pBuffer[204*3]==0x47&&pBuffer[204*4]==0x47)
-			ret=204;
-	else
-	{
-		//尝试重新同步
-			ret = TryToReSync(pBuffer,bufferLength,nSyncByte);
-	}
+	ret = DetectTsLength(pBuffer,(int)numread,nSyncByte);
 	delete [] pBuffer;
 	fclose(fp);
 	return ret;
 
 }
 
-static bool is_begin_with(const string& input,const string& key)
-{
-        if (input.find(key) ==string::npos)
-        {
-                return false;
-        }
-        return input.find(key) == 0;
-}
-
-
-
 static string format_ei_info( CMpegDec* pDec)
 {
 	if (g_bEnableDebug)
@@ -132,7 +90,7 @@ static string format_ei_info( CMpegDec* pDec)
 	std::vector<GOP_LIST>::iterator it = pi->gopList.begin();
 	for(; it != pi->gopList.end();++it)
 	{
-		if (!is_begin_with(it->gop,"IDR"))
+		if (!it->idr)
 		{
 			b_all_idr = false;
 		}
@@ -147,7 +105,7 @@ static string format_ei_info( CMpegDec* pDec)
 
 		if (g_bEnableDebug)
 		{
-			cerr <<it->gop<<endl;
+			cerr <<it->to_string(pi->gopRuns)<<endl;
 		}
 		gop_size_total +=  it->gop_size ;
 	}
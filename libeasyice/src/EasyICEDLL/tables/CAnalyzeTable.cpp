@@ -18,6 +18,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 tables::CAnalyzeTable::CAnalyzeTable()
 {
+	m_bSharedSections = false;
 	Init();
 }
 
@@ -28,6 +29,11 @@ tables::CAnalyzeTable::~CAnalyzeTable()
 
 void tables::CAnalyzeTable::PushBackTsPacket(CTsPacket* tsPacket)
 {
+	if (m_bSharedSections)
+	{
+		return;
+	}
+
 	int pid = tsPacket->Get_PID();
 
 
@@ -35,6 +41,29 @@ void tables::CAnalyzeTable::PushBackTsPacket(CTsPacket* tsPacket)
 	if (BinarySearch(&(m_vecPidFilterList[0]),pid,(int)m_vecPidFilterList.size()) != -1)	//ҵ
 	{
 		m_buildSection.AddPacket(tsPacket->m_pPacket,m_nTsLength);
+		if (pid == 0x0)
+		{
+			UpdatePmtPidList();
+		}
+	}
+}
+
+bool tables::CAnalyzeTable::IsTablePid(int pid)
+{
+	return BinarySearch(&(m_vecPidFilterList[0]),pid,(int)m_vecPidFilterList.size()) != -1;
+}
+
+void tables::CAnalyzeTable::OnSection(const SECTION_SPAN_T& section)
+{
+	if (!IsTablePid(section.pid))
+	{
+		return;
+	}
+
+	m_buildSection.OnSection(section);
+	if (section.pid == 0x0)
+	{
+		UpdatePmtPidList();
 	}
 }
 
@@ -74,11 +103,9 @@ int tables::CAnalyzeTable::ParseFindPAT(BYTE* pData, int nLength)
 	//ȽPATPMT PIDб
 	int rtn = -1;
 	CTsPacket tsPacket;
-	SECTION_BUFFER buf;
 	TABLES tables;
 	CBuildUpSection builder;
 
-	builder.SetSectionBuffer(&buf);
 	builder.SetTablesBuffer(&tables);
 
 	for (int i = 0; i < nLength; i += m_nTsLength)
@@ -114,12 +141,15 @@ void tables::CAnalyzeTable::Init()
 {
 	m_bPatParsed = false;
 	m_nTsLength = 188;
+	m_nPatSections = 0;
 
-	m_mapSectionData.clear();
 	m_tables.clear();
+	m_sectionLog.setHash.clear();
+	m_sectionLog.vecTables.clear();
+	m_buildSection.Reset();
+	m_buildSectionPat.Reset();
 	m_vecPidFilterList.clear();
 	InitPidFilterList();
-	m_buildSection.SetSectionBuffer(&m_mapSectionData);
 	m_buildSection.SetTablesBuffer(&m_tables);
 }
 
@@ -135,19 +165,49 @@ void tables::CAnalyzeTable::ParsePATForPMTPID(const PAT& pat)
 
 	for (it = vec_pat_list.begin(); it != vec_pat_list.end(); it++)
 	{
-		m_vecPidFilterList.push_back(it->network_pmt_PID);
-		if (it->program_number != 0)
+		if (find(m_vecPidFilterList.begin(),m_vecPidFilterList.end(),it->network_pmt_PID) == m_vecPidFilterList.end())
+		{
+			m_vecPidFilterList.push_back(it->network_pmt_PID);
+		}
+		if (it->program_number != 0
+			&& find(m_vecPmtPidList.begin(),m_vecPmtPidList.end(),it->network_pmt_PID) == m_vecPmtPidList.end())
 		{
 			m_vecPmtPidList.push_back(it->network_pmt_PID);
 		}
 	}
 }
 
+void tables::CAnalyzeTable::UpdatePmtPidList()
+{
+	if (m_tables.vecTabPAT.empty() || m_tables.vecTabPAT[0].size() <= m_nPatSections)
+	{
+		return;
+	}
+
+	//PATsection°汾ڱ׷
+	STU_SECTION_PAT& pat =  m_tables.vecTabPAT[0];
+	for (size_t i = m_nPatSections; i < pat.size(); i++)
+	{
+		ParsePATForPMTPID(pat[i]);
+	}
+	m_nPatSections = pat.size();
+
+	std::sort(m_vecPidFilterList.begin(),m_vecPidFilterList.end());
+}
+
 tables::TABLES* tables::CAnalyzeTable::GetTables()
 {
 	return &m_tables;
 }
 
+void tables::CAnalyzeTable::ReplaySectionLog(const SECTION_LOG& log)
+{
+	for (size_t i = 0; i < log.vecTables.size(); i++)
+	{
+		m_buildSection.ReplayTable(log.vecTables[i].first,log.vecTables[i].second);
+	}
+}
+
 void tables::CAnalyzeTable::SetNetworkPmtPidList(const vector<int>& vecPidList)
 {
 	vector<int>::const_iterator it = vecPidList.begin();
@@ -162,6 +222,11 @@ void tables::CAnalyzeTable::SetNetworkPmtPidList(const vector<int>& vecPidList)
 
 void tables::CAnalyzeTable::PushBackTsPacket2(BYTE* pPacket)
 {
+	if (m_bSharedSections)
+	{
+		return;
+	}
+
 	CTsPacket tsPacket;
 	if (!tsPacket.SetPacket(pPacket))
 	{
@@ -180,7 +245,6 @@ void tables::CAnalyzeTable::PushBackTsPacket2(BYTE* pPacket)
 		return;
 	}
 
-	m_buildSectionPat.SetSectionBuffer(&m_mapSectionData);
 	m_buildSectionPat.SetTablesBuffer(&m_tables);
 
 	m_buildSectionPat.AddPacket(pPacket,m_nTsLength);
@@ -190,16 +254,8 @@ void tables::CAnalyzeTable::PushBackTsPacket2(BYTE* pPacket)
 		return;
 	}
 
-	//Ѿ겢
-	STU_SECTION_PAT& pat =  m_tables.vecTabPAT[0];	//ΪֻһPAT
-	STU_SECTION_PAT::iterator it;
-	for (it = pat.begin(); it != pat.end(); it++)	//ÿsection
-	{
-		ParsePATForPMTPID(*it);
-	}
-
-	//ѸpidбС
-	std::sort(m_vecPidFilterList.begin(),m_vecPidFilterList.end());
+	//Ѿ겢꣬pidб
+	UpdatePmtPidList();
 	m_bPatParsed = true;
 
 }
@@ -24,7 +24,7 @@ namespace tables{
 /**
  * PSI/SI 
  */
-class CAnalyzeTable {
+class CAnalyzeTable : public ISectionConsumer {
 public:
 
     CAnalyzeTable();
@@ -52,10 +52,13 @@ public:
 	//ҪǰPATյһPATǰò
 	void PushBackTsPacket2(BYTE* pPacket);
 
+	//pidǷڹбУPushBackTsPacketǷᴦpidİ
+	bool IsTablePid(int pid);
+
     /**
      * ʼ
      * 1ڴ˳ʼPidб
-     * 2.ʼm_mapSectionData
+     * 2.section
      */
     void Init();
 
@@ -64,6 +67,28 @@ public:
 	//ȡõı
 	TABLES* GetTables();
 
+	//¼ıϵʱ
+	void EnableSectionLog() { m_buildSection.SetSectionLog(&m_sectionLog); }
+	const SECTION_LOG& GetSectionLog() const { return m_sectionLog; }
+
+	//EIT schedulepStoreٽTABLESpStoreɵͷţNULL洢
+	void SetEpgStore(CEpgStore* pStore) { m_buildSection.SetEpgStore(pStore); }
+
+	//¼˳½ָTABLES
+	void ReplaySectionLog(const SECTION_LOG& log);
+
+	//ȡϴεsectionİ汾仯
+	void TakeSectionChanges(vector<SECTION_CHANGE_T>& vecChange) { m_buildSection.GetSectionCache().TakeChanges(vecChange); }
+
+	/**
+	 * Ϊⲿõsection罻Clibtr101290::AddSectionConsumer
+	 * TR 101 290һsectionCRCУ顣˺PushBackTsPacket(2)ٴTS
+	 */
+	ISectionConsumer* UseSharedSections() { m_bSharedSections = true; return this; }
+
+	//ⲿõsectionбеPIDŽ
+	virtual void OnSection(const SECTION_SPAN_T& section);
+
 public:
 	vector<int> m_vecPmtPidList;
 
@@ -75,6 +100,9 @@ private:
 
 	inline void ParsePATForPMTPID(const PAT& pat);
 
+	//PATµsection汾ʱPMT PIDб
+	void UpdatePmtPidList();
+
 private:
 
     /**
@@ -86,12 +114,6 @@ private:
 
 	
 
-    /**
-     * pidSECTION_DATA
-     * sectionĻ 
-     */
-    SECTION_BUFFER m_mapSectionData;
-
 
     /**
      * zection  
@@ -113,6 +135,15 @@ private:
 	//PAT
 	CBuildUpSection m_buildSectionPat;
 
+	//ı
+	SECTION_LOG m_sectionLog;
+
+	//ѼбPAT section
+	size_t m_nPatSections;
+
+	//sectionⲿúOnSection
+	bool m_bSharedSections;
+
 };
 
 }
@@ -17,316 +17,130 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 tables::CBuildUpSection::CBuildUpSection()
 {
-
-}
-
-tables::CBuildUpSection::~CBuildUpSection()
-{
-
-}
-
-void tables::CBuildUpSection::AddPacket(BYTE* pPacket, int nLength)
-{
-
-	CTsPacket tsPacket;
-	if (!tsPacket.SetPacket(pPacket))
-	{
-		return; //sync byte error
-	}
-	int pid = tsPacket.Get_PID();
-	SECTION_BUFFER::iterator it = m_pmapSectionData->find(pid);
-	if (it == m_pmapSectionData->end())	//ûҵ
+	m_pTables = NULL;
+	m_pSectionLog = NULL;
+	m_pEpgStore = NULL;
+	m_assembler.AddConsumer(this);
+	//AddPacketĵѰPID
+	for (int pid = 0; pid < SECTION_PID_COUNT; pid++)
 	{
-		if ( !tsPacket.Get_payload_unit_start_indicator() )
-		{
-			return;
-		}
-		OnNotFindPid(pPacket,pid);
-	}
-	else	//ҵ
-	{
-		OnFindedPid(pPacket,pid);
+		m_assembler.AddPid(pid);
 	}
-	
+	m_vecSection.resize(1);
 }
 
-void tables::CBuildUpSection::AnalyzeTable(int table_id, const TABLE_SECTIONS& table_sections)
+tables::CBuildUpSection::~CBuildUpSection()
 {
 
-	//table_sectionsֻһ
-	m_analyzer.AnalyzeTable(table_id,table_sections,m_pTables);
 }
 
-void tables::CBuildUpSection::SetSectionBuffer(SECTION_BUFFER* p)
+void tables::CBuildUpSection::AddPacket(BYTE* pPacket, int nLength)
 {
-	m_pmapSectionData = p;
+	m_assembler.Push(pPacket);
 }
 
-void tables::CBuildUpSection::SetTablesBuffer(TABLES* p)
+void tables::CBuildUpSection::Reset()
 {
-	m_pTables = p;
+	m_assembler.Reset();
+	m_cache.Clear();
+	m_setFinished.clear();
 }
 
-void tables::CBuildUpSection::OnNotFindPid(BYTE* pPacket,int pid)
+void tables::CBuildUpSection::OnSection(const SECTION_SPAN_T& section)
 {
-	//
-	PID_SECTION_BUILDING pid_section_buiding;
-	TABLE_ID_SECTION table_id_section;
-	TABLE_SECTIONS section_data;
-	CParseSectionTogether tsTableHead;
-	SECTION section;
-	if (!tsTableHead.SetPacket(pPacket))
+	int table_id = section.pData[0];
+	int key = (section.pid << 8) | table_id;
+	if (!m_setFinished.empty() && m_setFinished.find(key) != m_setFinished.end())
 	{
-		 return;
+		return;
 	}
-	table_id_section.table_id = tsTableHead.Get_table_id();
-	section.section_length = tsTableHead.Get_section_length();
-	tsTableHead.GetData(section.vecData);
-	table_id_section.sections.push_back(section);
-
-	CheckTable(pPacket,table_id_section);
-	pid_section_buiding.pid_sections.push_back(table_id_section);
-	m_pmapSectionData->insert(SECTION_BUFFER::value_type(pid,pid_section_buiding));
 
-}
-
-void tables::CBuildUpSection::OnFindedPid(BYTE* pPacket,int pid)
-{
-	CTsPacket tsPacket;
-	CParseSectionTogether tsTableHead;
-	tsPacket.SetPacket(pPacket);
-	if (!tsTableHead.SetPacket(pPacket))
+	//CRCsection
+	if (!section.bValid)
 	{
 		return;
 	}
-	
-	PID_SECTION_BUILDING& cur_pid_section_building = (*m_pmapSectionData)[pid];
 
-	if (tsPacket.Get_payload_unit_start_indicator())
-	{
-		//һ±ĿʼsectionĿʼжǷѾд˱,Ƿ
-		int table_id = tsTableHead.Get_table_id();
-		PID_SECTIONS::iterator it;
-		bool bFinded = false;
-		int idx = 0;
-		for(it = cur_pid_section_building.pid_sections.begin(); it != cur_pid_section_building.pid_sections.end(); it++)
-		{
-			if (table_id == it->table_id)
-			{
-				bFinded = true;
-				////////////////////////////////////////////////
-				if ( !it->bFinish )
-				{
-					AddDataToSections(pPacket,it->sections);
-					cur_pid_section_building.curSectionIdx = idx;
-					CheckTable(pPacket,*it);
-				}
-				///////////////////////////////////////////////
-				//if ( !it->bFinish )
-				//{
-				//	//û꣬.һµsection
-				//	AddDataToSections(pPacket,it->sections);
-				//	cur_pid_section_building.curSectionIdx = idx;
-				//	CheckTable(pPacket,*it);
-				//}
-				//else
-				//{
-				//	//ﴦͬһPID˺ܶPMTߣİ汾и
-				//	//break;
-				//}
-			}
-			++idx;
-		}
-		if ( !bFinded )	//ûҵtable_id
-		{
-			//µ
-			AddNewTable(pPacket,cur_pid_section_building);
-			CheckTable(pPacket,cur_pid_section_building.pid_sections[cur_pid_section_building.curSectionIdx]);
-			//CheckTable(pPacket,(cur_pid_section_building.pid_sections[cur_pid_section_building.pid_sections.size() -1]);
-		}
-	
-	}
-	else
-	{
-		//һsection
+	SECTION& sec = m_vecSection[0];
 
-		if (AddDataToSections(pPacket,cur_pid_section_building.get_cur_table_id_section()->sections) != -1)
+	//EIT scheduleEPG洢(,TS,ҵ,table_id,section_number)ȥ
+	if (m_pEpgStore != NULL && CEpgStore::IsScheduleTable(table_id))
+	{
+		if (m_pEpgStore->AddSection(section.pData,section.nLength) != CEpgStore::SECTION_SAME && m_pSectionLog != NULL)
 		{
-			CheckTable(pPacket,*cur_pid_section_building.get_cur_table_id_section());
+			sec.section_length = section.nLength - 3;
+			sec.vecData.assign(section.pData,section.pData + section.nLength);
+			LogTable(table_id,m_vecSection);
 		}
+		return;
 	}
-}
 
-int tables::CBuildUpSection::AddDataToSections(BYTE* pPacket,TABLE_SECTIONS& sections)
-{
-	CTsPacket tsPacket;
-	tsPacket.SetPacket(pPacket);
-	if (tsPacket.Get_payload_unit_start_indicator())
+	//ظ͵section汾CRC䣬ֻȽϲٽ
+	if (m_cache.Update(section.pid,section.pData,section.nLength) == CSectionCache::SECTION_SAME)
 	{
-		//һµsection
-		CParseSectionTogether tsTableHead;
-		if (!tsTableHead.SetPacket(pPacket))
-		{
-			return 0;
-		}
-		SECTION section;
-		section.section_length = tsTableHead.Get_section_length();
-		tsTableHead.GetData(section.vecData);
-		sections.push_back(section);
+		return;
 	}
-	else
-	{
-		//һsection׷
-		//if (sections[sections.size() -1].section_length + 3 == sections[sections.size() -1].vecData.size())
-		//{
-		//	return -1;	//sectionѾ
-		//}
-
-		if (sections.empty())
-		{
-			return -1;
-		}
-
-		CParseSectionTogether tsTableHead;
-		if (!tsTableHead.SetPacket(pPacket))
-		{
-			return 0;
-		}
-		int need =  sections[sections.size() -1].section_length + 3 - sections[sections.size() -1].vecData.size();
-		if (need > tsTableHead.m_nAvailable)
-		{
-			need = tsTableHead.m_nAvailable;
-		}
-		Vec_P_Copy(sections[sections.size() -1].vecData,tsTableHead.m_pData, need);
 
-		//int len =  sections[sections.size() -1].section_length + 3 - sections[sections.size() -1].vecData.size();
-		//if (len > 184)
-		//{
-		//	len = 184;
-		//}
-		//Vec_P_Copy(sections[sections.size() -1].vecData,pPacket+4, len);
-	}
-	return 0;
-}
+	sec.section_length = section.nLength - 3;
+	sec.vecData.assign(section.pData,section.pData + section.nLength);
+	AnalyzeTable(table_id,m_vecSection);	//
 
-void tables::CBuildUpSection::Vec_P_Copy(vector<BYTE>& vecData,BYTE* pData,int nLength)
-{
-	if (nLength <=0)
+	if (table_id == 0x70 || table_id == 0x71 || table_id == 0x72 || table_id == 0x73 || table_id == 0x7E)
 	{
-		return;
+		//section ģTDT RST ST TOT--------and so DIT 
+		m_setFinished.insert(key);
 	}
-	
-	int size = (int) vecData.size();
-	vecData.resize(size + nLength);
-	memcpy(&vecData[size],pData,nLength);
 }
 
-void tables::CBuildUpSection::AddNewTable(BYTE* pPacket,PID_SECTION_BUILDING& pid_section_building)
+void tables::CBuildUpSection::AnalyzeTable(int table_id, const TABLE_SECTIONS& table_sections)
 {
-	CParseSectionTogether tsTableHead;
-	if (!tsTableHead.SetPacket(pPacket))
-	{
-		return;
-	}
-	TABLE_ID_SECTION table_id_section;
-
-	table_id_section.table_id = tsTableHead.Get_table_id();
-	SECTION section;
-	section.section_length = tsTableHead.Get_section_length();
-	tsTableHead.GetData(section.vecData);
-	table_id_section.sections.push_back(section);
-	/*if (section.section_length == section.vecData.size())
-	{
-		if (tsTableHead.Get_last_section_number() == tsTableHead.Get_section_number())
-		{
-			table_id_section.bFinish = true;
-		}
-	}*/
-	
-	pid_section_building.pid_sections.push_back(table_id_section);
-	pid_section_building.curSectionIdx = pid_section_building.pid_sections.size()-1;
 
+	//table_sectionsֻһ
+	m_analyzer.AnalyzeTable(table_id,table_sections,m_pTables);
+	LogTable(table_id,table_sections);
 }
 
-void tables::CBuildUpSection::CheckTable(BYTE* pPacket,TABLE_ID_SECTION& table_id_section)
+void tables::CBuildUpSection::ReplayTable(int table_id, const TABLE_SECTIONS& table_sections)
 {
-	TABLE_SECTIONS::const_iterator it = table_id_section.sections.begin();
-	for (; it != table_id_section.sections.end(); ++it)
-	{
-		if (it->vecData.size() < it->section_length+3 )
-		{
-			return;
-		}
-	}
-
-	AnalyzeTable(table_id_section.table_id,table_id_section.sections);	//
-	table_id_section.sections.clear();
-
-	
-	//check finish 
-	if (table_id_section.table_id == 0x70 || table_id_section.table_id == 0x71 || table_id_section.table_id == 0x72 
-		|| table_id_section.table_id == 0x73 || table_id_section.table_id == 0x7E)
-	{
-		//section ģTDT RST ST TOT--------and so DIT 
-		table_id_section.bFinish = true;
-	}
-
-	//ֻҪEITյһsectionΪfinish
-	if (table_id_section.table_id== 0x4E || table_id_section.table_id == 0x4F
-		|| (table_id_section.table_id >= 0x50 && table_id_section.table_id <= 0x5F)
-		|| (table_id_section.table_id >= 0x60 && table_id_section.table_id <= 0x6F) )
-	{
-		//eit
-		//table_id_section.bFinish = true;
-	}
-	else
+	if (m_pEpgStore != NULL && CEpgStore::IsScheduleTable(table_id))
 	{
-		CParseSectionTogether tsTableHead;
-		if (!tsTableHead.SetPacket(pPacket))
+		TABLE_SECTIONS::const_iterator it = table_sections.begin();
+		for (; it != table_sections.end(); ++it)
 		{
-			return;
-		}
-		if (tsTableHead.Get_last_section_number() == tsTableHead.Get_section_number())
-		{
-			//ᵼsection˳Ϊ120¶ʧsection0ע͵棬sectionЧӰ첻
-			//table_id_section.bFinish = true;
+			if (!it->vecData.empty())
+			{
+				m_pEpgStore->AddSection(&it->vecData[0],(int)it->vecData.size());
+			}
 		}
+		LogTable(table_id,table_sections);
+		return;
 	}
+	AnalyzeTable(table_id,table_sections);
+}
 
-	//
-
-
-	return;
-
-
-
-
-	if (table_id_section.sections[table_id_section.sections.size() -1].section_length+3 == table_id_section.sections[table_id_section.sections.size() -1].vecData.size())
+void tables::CBuildUpSection::LogTable(int table_id, const TABLE_SECTIONS& table_sections)
+{
+	if (m_pSectionLog != NULL)
 	{
-		CParseSectionTogether tsTableHead;
-		if (!tsTableHead.SetPacket(pPacket))
+		//ͬıظıTABLESֻ¼һΡFNV-1a
+		unsigned long long hash = 14695981039346656037ULL;
+		hash = (hash ^ (unsigned long long)table_id) * 1099511628211ULL;
+		TABLE_SECTIONS::const_iterator it = table_sections.begin();
+		for (; it != table_sections.end(); ++it)
 		{
-			return;
-		}
-		int table_id = tsTableHead.Get_table_id();
-		if (table_id == 0x70 || table_id == 0x71 || table_id == 0x72 || table_id == 0x73)
-		{
-			//section ģTDT RST ST TOT--------and so DIT 
-			table_id_section.bFinish = true;
-			AnalyzeTable(table_id_section.table_id,table_id_section.sections);	//
+			for (size_t i = 0; i < it->vecData.size(); i++)
+			{
+				hash = (hash ^ it->vecData[i]) * 1099511628211ULL;
+			}
 		}
-		else if ( tsTableHead.Get_last_section_number() == tsTableHead.Get_section_number() )
+		if (m_pSectionLog->setHash.insert(hash).second)
 		{
-			table_id_section.bFinish = true;
-			AnalyzeTable(table_id_section.table_id,table_id_section.sections);	//
-			
+			m_pSectionLog->vecTables.push_back(std::make_pair(table_id,table_sections));
 		}
 	}
-
 }
 
-//bool  tables::CBuildUpSection::is_table_sections_completed(TABLE_ID_SECTION& table_id_section)
-//{
-//
-//}
-
+void tables::CBuildUpSection::SetTablesBuffer(TABLES* p)
+{
+	m_pTables = p;
+}
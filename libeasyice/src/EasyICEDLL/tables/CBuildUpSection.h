@@ -16,9 +16,20 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #define CBUILDUPSECTION_H
 #include "section/CAnalyze.h"
 #include "TsPacket.h"
-#include "section/CParseSectionTogether.h"
+#include "SectionAssembler.h"
+#include "CSectionCache.h"
+#include "CEpgStore.h"
+#include <set>
 namespace tables{
-class CBuildUpSection {
+
+//Ĳͬݵı״γֵ˳ڶϵʱָTABLES
+typedef struct _SECTION_LOG
+{
+	std::set<unsigned long long> setHash;
+	std::vector<std::pair<int,TABLE_SECTIONS> > vecTables;	//table_id,sections
+}SECTION_LOG;
+
+class CBuildUpSection : public ISectionConsumer {
 public:
 
 		~CBuildUpSection();
@@ -27,19 +38,44 @@ public:
 
 		/**
          * PIDsection
-         * PIDsectionѾֱ꣬ӷ
+         * sectionOnSection
          */
         void AddPacket(BYTE* pPacket, int nLength);
 
-		 /**
-         * õsectionָ
-         */
-        void SetSectionBuffer(SECTION_BUFFER* p);
-
         /**
          * ýϵĻָ
          */
         void SetTablesBuffer(TABLES* p);
+
+		/**
+         * ѽļ¼NULL¼
+         */
+		void SetSectionLog(SECTION_LOG* p) { m_pSectionLog = p; }
+
+		/**
+         * EIT schedule(0x50-0x6F)Ĵ洢úЩsectionУٽTABLESNULL洢
+         */
+		void SetEpgStore(CEpgStore* p) { m_pEpgStore = p; }
+
+		/**
+         * ֱӽһõıڴӼ¼ָ
+         */
+		void ReplayTable(int table_id, const TABLE_SECTIONS& table_sections);
+
+		/**
+         * sectionİ汾CRC汾仯¼
+         */
+		CSectionCache& GetSectionCache() { return m_cache; }
+
+		/**
+         * section汾¼
+         */
+		void Reset();
+
+		/**
+         * һsectionCRCȷµĻб仯ĲŸƳ
+         */
+		virtual void OnSection(const SECTION_SPAN_T& section);
 private:
 
         /**
@@ -48,38 +84,44 @@ private:
         CAnalyze m_analyzer;
 
         /**
-         * pid,sections
-         * ÿpidõsection
+         * PIDsectionsectionĻѭʹ
          */
-        SECTION_BUFFER* m_pmapSectionData;
+        CSectionAssembler m_assembler;
 
         /**
          * 洢ĽϵıĻָ
          */
         TABLES* m_pTables;
 
-        /**
-         * sectionϣsection
-         * ĸݣɽദ
-         */
-        void AnalyzeTable(int table_id, const TABLE_SECTIONS& table_sections);
+		SECTION_LOG* m_pSectionLog;
 
-private:
-
-       inline void OnNotFindPid(BYTE* pPacket,int pid);
+		CEpgStore* m_pEpgStore;
 
-	   inline void OnFindedPid(BYTE* pPacket,int pid);
+		/**
+         * ѽsection汾CRCͬĲظ
+         */
+		CSectionCache m_cache;
 
-	   //sectionѾķ -1
-	   inline int AddDataToSections(BYTE* pPacket,TABLE_SECTIONS& sections);
+		/**
+         * ֻһεıTDT RST ST TOT DITpid<<8|table_id
+         */
+		std::set<int> m_setFinished;
 
-	   //vec׷
-	   inline void Vec_P_Copy(vector<BYTE>& vecData,BYTE* pData,int nLength);
+		/**
+         * sectionظʹÿη
+         */
+		TABLE_SECTIONS m_vecSection;
 
-	   inline void AddNewTable(BYTE* pPacket,PID_SECTION_BUILDING& pid_section_building);
+        /**
+         * sectionϣsection
+         * ĸݣɽദ
+         */
+        void AnalyzeTable(int table_id, const TABLE_SECTIONS& table_sections);
 
-	   //ĳǷ,ñʶ.pPacketpayloadΪ1 ts
-	   inline void CheckTable(BYTE* pPacket,TABLE_ID_SECTION& table_id_section);
+        /**
+         * ݲͬım_pSectionLog
+         */
+        void LogTable(int table_id, const TABLE_SECTIONS& table_sections);
 
 };
 
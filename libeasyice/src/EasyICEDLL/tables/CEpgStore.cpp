@@ -0,0 +1,340 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "commondefs.h"
+#include "CEpgStore.h"
+#include "CDescriptor.h"
+#include <algorithm>
+
+//links and colour of a std::map node, added to the value for the memory count
+#define EPG_MAP_NODE_BYTES 32
+
+//two bcd digits
+static inline unsigned int Bcd2(unsigned int v)
+{
+    return ((v >> 4) & 0x0F) * 10 + (v & 0x0F);
+}
+
+//24 bit bcd hhmmss to seconds
+static inline unsigned int BcdToSeconds(unsigned int v)
+{
+    return Bcd2(v >> 16) * 3600 + Bcd2(v >> 8) * 60 + Bcd2(v);
+}
+
+//modified julian date and 24 bit bcd time to UTC seconds since 1970 (MJD 40587)
+static inline unsigned int MjdToSeconds(unsigned int mjd,unsigned int utc)
+{
+    if (mjd < 40587)
+    {
+        return 0;
+    }
+    return (mjd - 40587) * 86400 + BcdToSeconds(utc);
+}
+
+tables::CEpgStore::CEpgStore(long long nMaxBytes)
+{
+    m_nMaxBytes = nMaxBytes;
+    m_nBytes = 0;
+    m_nEvents = 0;
+    m_nRepeated = 0;
+    m_nUpdated = 0;
+    m_nDropped = 0;
+    pthread_mutex_init(&m_mutex,NULL);
+}
+
+tables::CEpgStore::~CEpgStore()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+int tables::CEpgStore::AddSection(const BYTE* data,int nLength)
+{
+    //14 bytes of header and the crc_32
+    if (nLength < 18 || !IsScheduleTable(data[0]) || !(data[1] & 0x80))
+    {
+        return SECTION_INVALID;
+    }
+
+    int table_id = data[0];
+    unsigned long long service_id = (data[3] << 8) | data[4];
+    int version = (data[5] >> 1) & 0x1F;
+    int section_number = data[6];
+    unsigned long long transport_stream_id = (data[8] << 8) | data[9];
+    unsigned long long original_network_id = (data[10] << 8) | data[11];
+    const BYTE* p = data + nLength - 4;
+    unsigned int crc = ((unsigned int)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+
+    unsigned long long service_key = (original_network_id << 32) | (transport_stream_id << 16) | service_id;
+    unsigned long long section_key = (service_key << 16) | (table_id << 8) | section_number;
+
+    pthread_mutex_lock(&m_mutex);
+
+    int ret = SECTION_NEW;
+    std::map<unsigned long long,EPG_SECTION_T>::iterator it_sec = m_mapSection.find(section_key);
+    if (it_sec == m_mapSection.end())
+    {
+        EPG_SECTION_T section;
+        section.version = version;
+        section.crc = crc;
+        m_mapSection.insert(std::make_pair(section_key,section));
+        m_nBytes += sizeof(std::pair<const unsigned long long,EPG_SECTION_T>) + EPG_MAP_NODE_BYTES;
+    }
+    else if (it_sec->second.version == version && it_sec->second.crc == crc)
+    {
+        m_nRepeated++;
+        pthread_mutex_unlock(&m_mutex);
+        return SECTION_SAME;
+    }
+    else
+    {
+        it_sec->second.version = version;
+        it_sec->second.crc = crc;
+        m_nUpdated++;
+        ret = SECTION_CHANGED;
+    }
+
+    std::map<unsigned long long,EPG_SERVICE_T>::iterator it_srv = m_mapService.find(service_key);
+    if (it_srv == m_mapService.end())
+    {
+        EPG_SERVICE_T service;
+        service.nMaxDuration = 0;
+        it_srv = m_mapService.insert(std::make_pair(service_key,service)).first;
+        m_nBytes += sizeof(std::pair<const unsigned long long,EPG_SERVICE_T>) + EPG_MAP_NODE_BYTES;
+    }
+    EPG_SERVICE_T& service = it_srv->second;
+
+    if (ret == SECTION_CHANGED)
+    {
+        RemoveSectionEvents(service,table_id,section_number);
+    }
+
+    int pos = 14;
+    int end = nLength - 4;
+    while (pos + 12 <= end)
+    {
+        const BYTE* e = data + pos;
+        int descriptors_loop_length = ((e[10] & 0x0F) << 8) | e[11];
+        if (pos + 12 + descriptors_loop_length > end)
+        {
+            break;
+        }
+        pos += 12 + descriptors_loop_length;
+
+        if (m_nMaxBytes > 0 && m_nBytes + (long long)(sizeof(EPG_EVENT_T) + descriptors_loop_length) > m_nMaxBytes)
+        {
+            m_nDropped++;
+            continue;
+        }
+
+        EPG_EVENT_T event;
+        event.event_id = (e[0] << 8) | e[1];
+        event.start_time_MJD = (e[2] << 8) | e[3];
+        event.start_time_UTC = (e[4] << 16) | (e[5] << 8) | e[6];
+        event.duration = (e[7] << 16) | (e[8] << 8) | e[9];
+        event.running_status = e[10] >> 5;
+        event.free_CA_mode = (e[10] >> 4) & 0x01;
+        event.table_id = table_id;
+        event.section_number = section_number;
+        event.start = MjdToSeconds(event.start_time_MJD,event.start_time_UTC);
+        event.vecDescriptor.assign(e + 12,e + 12 + descriptors_loop_length);
+        InsertEvent(service,event);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+    return ret;
+}
+
+void tables::CEpgStore::RemoveSectionEvents(EPG_SERVICE_T& service,int table_id,int section_number)
+{
+    std::vector<EPG_EVENT_T>& vecEvent = service.vecEvent;
+    size_t n = 0;
+    for (size_t i = 0; i < vecEvent.size(); i++)
+    {
+        if (vecEvent[i].table_id == table_id && vecEvent[i].section_number == section_number)
+        {
+            m_nBytes -= EventBytes(vecEvent[i]);
+            m_nEvents--;
+            continue;
+        }
+        if (n != i)
+        {
+            vecEvent[n] = vecEvent[i];
+        }
+        n++;
+    }
+    vecEvent.resize(n);
+}
+
+void tables::CEpgStore::InsertEvent(EPG_SERVICE_T& service,const EPG_EVENT_T& event)
+{
+    std::vector<EPG_EVENT_T>& vecEvent = service.vecEvent;
+
+    //a schedule is mostly sent in order, the event goes to the end then
+    size_t pos = vecEvent.size();
+    if (pos > 0 && vecEvent[pos - 1].start >= event.start)
+    {
+        size_t lo = 0;
+        size_t hi = pos;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (vecEvent[mid].start < event.start)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        pos = lo;
+    }
+
+    unsigned int duration = BcdToSeconds(event.duration);
+    if (duration > service.nMaxDuration)
+    {
+        service.nMaxDuration = duration;
+    }
+
+    m_nBytes += EventBytes(event);
+    if (pos < vecEvent.size() && vecEvent[pos].start == event.start)
+    {
+        //the same start sent by another section, the last one wins
+        m_nBytes -= EventBytes(vecEvent[pos]);
+        vecEvent[pos] = event;
+        return;
+    }
+
+    vecEvent.insert(vecEvent.begin() + pos,event);
+    m_nEvents++;
+}
+
+int tables::CEpgStore::Query(int original_network_id,int transport_stream_id,int service_id,
+                             long long llBegin,long long llEnd,int nMaxEvents,Json::Value& root)
+{
+    //copied out under the lock, the descriptors are decoded after it is released
+    std::vector<std::pair<unsigned long long,EPG_EVENT_T> > vecFound;
+    bool bTruncated = false;
+
+    unsigned long long lo = 0;
+    unsigned long long hi = 1ULL << 48;
+    if (original_network_id >= 0)
+    {
+        lo = (unsigned long long)original_network_id << 32;
+        hi = lo + (1ULL << 32);
+        if (transport_stream_id >= 0)
+        {
+            lo |= (unsigned long long)transport_stream_id << 16;
+            hi = lo + (1ULL << 16);
+            if (service_id >= 0)
+            {
+                lo |= service_id;
+                hi = lo + 1;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    std::map<unsigned long long,EPG_SERVICE_T>::iterator it = m_mapService.lower_bound(lo);
+    for (; it != m_mapService.end() && it->first < hi && !bTruncated; ++it)
+    {
+        if ((transport_stream_id >= 0 && (int)((it->first >> 16) & 0xFFFF) != transport_stream_id) ||
+            (service_id >= 0 && (int)(it->first & 0xFFFF) != service_id))
+        {
+            continue;
+        }
+
+        const std::vector<EPG_EVENT_T>& vecEvent = it->second.vecEvent;
+        long long llFrom = llBegin - it->second.nMaxDuration;
+        size_t lo_evt = 0;
+        size_t hi_evt = vecEvent.size();
+        while (lo_evt < hi_evt)
+        {
+            size_t mid = (lo_evt + hi_evt) / 2;
+            if ((long long)vecEvent[mid].start < llFrom)
+            {
+                lo_evt = mid + 1;
+            }
+            else
+            {
+                hi_evt = mid;
+            }
+        }
+
+        for (size_t i = lo_evt; i < vecEvent.size(); i++)
+        {
+            const EPG_EVENT_T& event = vecEvent[i];
+            if (llEnd > 0 && (long long)event.start >= llEnd)
+            {
+                break;
+            }
+            if ((long long)event.start + BcdToSeconds(event.duration) <= llBegin)
+            {
+                continue;
+            }
+            if (nMaxEvents > 0 && (int)vecFound.size() >= nMaxEvents)
+            {
+                bTruncated = true;
+                break;
+            }
+            vecFound.push_back(std::make_pair(it->first,event));
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    Json::Value events(Json::arrayValue);
+    for (size_t i = 0; i < vecFound.size(); i++)
+    {
+        const EPG_EVENT_T& event = vecFound[i].second;
+        EIT_LIST2 e2;
+        e2.event_id = event.event_id;
+        e2.start_time_MJD = event.start_time_MJD;
+        e2.start_time_UTC = event.start_time_UTC;
+        e2.duration = event.duration;
+        e2.running_status = event.running_status;
+        e2.free_CA_mode = event.free_CA_mode;
+        e2.descriptors_loop_length = (u_int)event.vecDescriptor.size();
+        e2.vec_descriptor = event.vecDescriptor;
+        if (!e2.vec_descriptor.empty())
+        {
+            CDescriptor::GetInstancePtr()->DecodeDescriptor(e2.descriptors,&e2.vec_descriptor[0],(int)e2.vec_descriptor.size());
+        }
+
+        Json::Value item = e2.to_json();
+        item["original_network_id"] = (int)(vecFound[i].first >> 32);
+        item["transport_stream_id"] = (int)((vecFound[i].first >> 16) & 0xFFFF);
+        item["service_id"] = (int)(vecFound[i].first & 0xFFFF);
+        item["table_id"] = event.table_id;
+        item["start_time"] = (long long)event.start;
+        item["end_time"] = (long long)event.start + BcdToSeconds(event.duration);
+        events.append(item);
+    }
+
+    root["events"] = events;
+    root["count"] = (int)vecFound.size();
+    root["truncated"] = bTruncated;
+    return (int)vecFound.size();
+}
+
+void tables::CEpgStore::GetStats(EASYICE_EPG_STATS& stats)
+{
+    pthread_mutex_lock(&m_mutex);
+    stats.services = (int)m_mapService.size();
+    stats.events = m_nEvents;
+    stats.sections = (long long)m_mapSection.size();
+    stats.sections_repeated = m_nRepeated;
+    stats.sections_updated = m_nUpdated;
+    stats.events_dropped = m_nDropped;
+    stats.memory_bytes = m_nBytes;
+    stats.memory_limit = m_nMaxBytes > 0 ? m_nMaxBytes : 0;
+    pthread_mutex_unlock(&m_mutex);
+}
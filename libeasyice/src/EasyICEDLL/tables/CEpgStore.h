@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CEPGSTORE_H
+#define CEPGSTORE_H
+
+#include "tablesdefs.h"
+#include "sdkdefs.h"
+#include <pthread.h>
+#include <map>
+#include <vector>
+
+namespace tables{
+
+/**
+ * EIT schedule (table_id 0x50 - 0x6F) of a whole network, indexed by
+ * (original_network_id, transport_stream_id, service_id, start_time).
+ *
+ * Every event keeps its fixed fields and the raw descriptor loop, the
+ * descriptors are decoded only for the events a query returns. Sections
+ * are looked up by (original_network_id, transport_stream_id, service_id,
+ * table_id, section_number) before they are parsed: a carousel repeats the
+ * whole schedule every few seconds and a repetition with the same version
+ * and crc costs one map lookup. A new version of a section replaces the
+ * events it carried before.
+ *
+ * memory_bytes counts events, descriptors and both indexes. An event that
+ * would take it past the limit is dropped, its section is still indexed so
+ * the repetitions are not counted again: past the limit memory only grows
+ * by one index entry per distinct section.
+ *
+ * The store has its own lock, it may be queried while analysis adds to it.
+ */
+class CEpgStore
+{
+public:
+    enum
+    {
+        SECTION_NEW,
+        SECTION_SAME,
+        SECTION_CHANGED,
+        SECTION_INVALID
+    };
+
+    //nMaxBytes <= 0 means no limit
+    CEpgStore(long long nMaxBytes);
+    ~CEpgStore();
+
+    static bool IsScheduleTable(int table_id) { return table_id >= 0x50 && table_id <= 0x6F; }
+
+    //a complete schedule section with a correct crc, returns SECTION_xx
+    int AddSection(const BYTE* data,int nLength);
+
+    /**
+     * Events of the matching services that overlap [llBegin,llEnd), UTC seconds
+     * since 1970, ordered by (original_network_id, transport_stream_id,
+     * service_id, start_time). An id of -1 matches any, llEnd <= 0 means no
+     * end, nMaxEvents <= 0 no limit. Returns the number of events in root["events"]
+     */
+    int Query(int original_network_id,int transport_stream_id,int service_id,
+              long long llBegin,long long llEnd,int nMaxEvents,Json::Value& root);
+
+    void GetStats(EASYICE_EPG_STATS& stats);
+
+private:
+    typedef struct _EPG_EVENT_T
+    {
+        unsigned int start;             //UTC seconds since 1970, the index
+        unsigned int start_time_UTC;    //24 bit bcd as sent
+        unsigned int duration;          //24 bit bcd as sent
+        unsigned short start_time_MJD;
+        unsigned short event_id;
+        BYTE table_id;
+        BYTE section_number;
+        BYTE running_status;
+        BYTE free_CA_mode;
+        std::vector<BYTE> vecDescriptor;
+    }EPG_EVENT_T;
+
+    typedef struct _EPG_SERVICE_T
+    {
+        std::vector<EPG_EVENT_T> vecEvent;  //sorted by start
+        unsigned int nMaxDuration;          //seconds, to find events starting before a query range
+    }EPG_SERVICE_T;
+
+    typedef struct _EPG_SECTION_T
+    {
+        int version;
+        unsigned int crc;
+    }EPG_SECTION_T;
+
+    //erase the events a section carried before its new version
+    void RemoveSectionEvents(EPG_SERVICE_T& service,int table_id,int section_number);
+
+    //insert or replace the event with the same start
+    void InsertEvent(EPG_SERVICE_T& service,const EPG_EVENT_T& event);
+
+    static unsigned int EventBytes(const EPG_EVENT_T& event) { return (unsigned int)(sizeof(EPG_EVENT_T) + event.vecDescriptor.size()); }
+
+private:
+    long long m_nMaxBytes;
+    long long m_nBytes;
+    long long m_nEvents;
+
+    //original_network_id<<32 | transport_stream_id<<16 | service_id
+    std::map<unsigned long long,EPG_SERVICE_T> m_mapService;
+
+    //service key<<16 | table_id<<8 | section_number
+    std::map<unsigned long long,EPG_SECTION_T> m_mapSection;
+
+    long long m_nRepeated;
+    long long m_nUpdated;
+    long long m_nDropped;
+
+    pthread_mutex_t m_mutex;
+};
+
+}
+#endif //CEPGSTORE_H
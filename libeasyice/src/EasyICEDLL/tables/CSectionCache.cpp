@@ -0,0 +1,102 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "commondefs.h"
+#include "CSectionCache.h"
+#include "Crc32.h"
+
+tables::CSectionCache::CSectionCache()
+{
+
+}
+
+tables::CSectionCache::~CSectionCache()
+{
+
+}
+
+int tables::CSectionCache::Update(int pid,const BYTE* data,int nLength)
+{
+    if (nLength < 3)
+    {
+        return SECTION_NEW;
+    }
+
+    int table_id = data[0];
+    int extension = 0;
+    int section_number = 0;
+    int current_next = 1;
+    int version = -1;
+    unsigned int crc;
+
+    if ((data[1] & 0x80) && nLength >= 12)
+    {
+        extension = (data[3] << 8) | data[4];
+        version = (data[5] >> 1) & 0x1F;
+        current_next = data[5] & 0x01;
+        section_number = data[6];
+
+        const BYTE* p = data + nLength - 4;
+        crc = ((unsigned int)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    }
+    else
+    {
+        crc = Crc32Mpeg(data,nLength);
+    }
+
+    //a section announced for later (current_next_indicator 0) does not replace the current one
+    unsigned long long key = ((unsigned long long)pid << 33) | ((unsigned long long)table_id << 25)
+        | ((unsigned long long)extension << 9) | (section_number << 1) | current_next;
+
+    std::map<unsigned long long,SECTION_STATE_T>::iterator it = m_mapSection.find(key);
+    if (it == m_mapSection.end())
+    {
+        SECTION_STATE_T state;
+        state.version = version;
+        state.crc = crc;
+        m_mapSection.insert(std::make_pair(key,state));
+        return SECTION_NEW;
+    }
+
+    if (it->second.version == version && it->second.crc == crc)
+    {
+        return SECTION_SAME;
+    }
+
+    if (m_vecChange.size() < SECTION_CHANGE_MAX)
+    {
+        SECTION_CHANGE_T change;
+        change.pid = pid;
+        change.table_id = table_id;
+        change.extension = extension;
+        change.section_number = section_number;
+        change.old_version = it->second.version;
+        change.new_version = version;
+        m_vecChange.push_back(change);
+    }
+
+    it->second.version = version;
+    it->second.crc = crc;
+    return SECTION_CHANGED;
+}
+
+void tables::CSectionCache::Clear()
+{
+    m_mapSection.clear();
+    m_vecChange.clear();
+}
+
+void tables::CSectionCache::TakeChanges(std::vector<SECTION_CHANGE_T>& vecChange)
+{
+    vecChange.clear();
+    vecChange.swap(m_vecChange);
+}
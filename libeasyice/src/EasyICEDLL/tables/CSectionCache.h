@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CSECTIONCACHE_H
+#define CSECTIONCACHE_H
+
+#include "tablesdefs.h"
+#include <map>
+#include <vector>
+
+namespace tables{
+
+//changes kept until they are taken, later ones are dropped
+#define SECTION_CHANGE_MAX 1024
+
+//a section whose version_number or content changed since it was last seen
+typedef struct _SECTION_CHANGE_T
+{
+    int pid;
+    int table_id;
+    int extension;          //table_id_extension, 0 for short sections
+    int section_number;
+    int old_version;        //-1 for short sections, which have no version
+    int new_version;
+}SECTION_CHANGE_T;
+
+/**
+ * Last version and crc of every section seen, keyed by
+ * (pid, table_id, table_id_extension, section_number).
+ *
+ * Streams repeat their PSI/SI every few hundred milliseconds. A complete
+ * section is looked up here before it is decoded: when version and crc
+ * match the stored ones it is the same section again and is not parsed,
+ * otherwise it is new or changed and goes to the table parsers. Changes of
+ * a section already seen are recorded as SECTION_CHANGE_T.
+ *
+ * Short sections (section_syntax_indicator 0: TDT, RST, ST...) have neither
+ * version nor crc_32, the crc of their bytes is computed instead.
+ */
+class CSectionCache
+{
+public:
+    enum
+    {
+        SECTION_NEW,
+        SECTION_SAME,
+        SECTION_CHANGED
+    };
+
+    CSectionCache();
+    ~CSectionCache();
+
+    //look the section up and store its version and crc, returns SECTION_xx
+    int Update(int pid,const BYTE* data,int nLength);
+
+    void Clear();
+
+    //changes recorded since the last TakeChanges, in the order they were seen,
+    //at most SECTION_CHANGE_MAX
+    const std::vector<SECTION_CHANGE_T>& GetChanges() const { return m_vecChange; }
+    void TakeChanges(std::vector<SECTION_CHANGE_T>& vecChange);
+
+private:
+    typedef struct _SECTION_STATE_T
+    {
+        int version;
+        unsigned int crc;
+    }SECTION_STATE_T;
+
+    std::map<unsigned long long,SECTION_STATE_T> m_mapSection;
+    std::vector<SECTION_CHANGE_T> m_vecChange;
+};
+
+}
+#endif //CSECTIONCACHE_H
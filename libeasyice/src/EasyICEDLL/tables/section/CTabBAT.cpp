@@ -45,6 +45,28 @@ void tables::CTabBAT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 		return;
 	}
 
+	//еsection°汾ݱ仯滻ΪµġظsectionsectionʱѾˣĶµĻб仯
+	if (tabBAT[0].current_next_indicator == 1)
+	{
+		vector<STU_SECTION_BAT>::iterator it_cur = tables->vecTabBAT.begin();
+		for (; it_cur != tables->vecTabBAT.end(); ++it_cur)
+		{
+			STU_SECTION_BAT::iterator it_sec = it_cur->begin();
+			for (; it_sec != it_cur->end(); ++it_sec)
+			{
+				if (it_sec->table_id == tabBAT[0].table_id && it_sec->bouquet_id == tabBAT[0].bouquet_id && it_sec->section_number == tabBAT[0].section_number)
+				{
+					if (it_sec->version_number != tabBAT[0].version_number || it_sec->crc != tabBAT[0].crc)
+					{
+						*it_sec = tabBAT.front();
+						DecodeDescriptors(*it_sec);
+					}
+					return;
+				}
+			}
+		}
+	}
+
 	bool bfinded_tableid = false;
 	vector<STU_SECTION_BAT>::iterator it_tab = tables->vecTabBAT.begin();
 	for (; it_tab != tables->vecTabBAT.end(); ++it_tab)
@@ -84,7 +106,7 @@ void tables::CTabBAT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 			}
 		}
 		
-		//Ҫͬ汾Ŵע͡ݲ汾
+		//ûеsection룬section°汾滻
 		if ((it_tab->begin()->table_id == tabBAT.begin()->table_id )&& ( !b_section_num_exist ||!b_bouquet_id_exist/*|| !b_version_num_exist*/ ))
 		{
 			
@@ -109,22 +131,22 @@ void tables::CTabBAT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_BAT&
 	//һsection,push_backtabBAT
 	BAT t;
 	BAT_LIST2  t2;
-	int        len1,len2;
-	u_char* b = (u_char*)&vecData[0];
-
-	t.table_id 					= b[0];
-	t.section_syntax_indicator	= CBit::getBits (b, 0, 8, 1);
-	t.reserved_1 				= CBit::getBits (b, 0, 9, 1);
-	t.reserved_2 				= CBit::getBits (b, 0, 10, 2);
-	t.section_length			= CBit::getBits (b, 0, 12, 12);
-	t.bouquet_id				= CBit::getBits (b, 0, 24, 16);
-	t.reserved_3 				= CBit::getBits (b, 0, 40, 2);
-	t.version_number 			= CBit::getBits (b, 0, 42, 5);
-	t.current_next_indicator	= CBit::getBits (b, 0, 47, 1);
-	t.section_number 			= CBit::getBits (b, 0, 48, 8);
-	t.last_section_number 		= CBit::getBits (b, 0, 56, 8);
-	t.reserved_4	 			= CBit::getBits (b, 0, 64, 4);
-	t.bouquet_descriptors_length = CBit::getBits (b, 0, 68, 12);
+	int        len1;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	t.table_id 					= bs.GetBits(8);
+	t.section_syntax_indicator	= bs.GetBits(1);
+	t.reserved_1 				= bs.GetBits(1);
+	t.reserved_2 				= bs.GetBits(2);
+	t.section_length			= bs.GetBits(12);
+	t.bouquet_id				= bs.GetBits(16);
+	t.reserved_3 				= bs.GetBits(2);
+	t.version_number 			= bs.GetBits(5);
+	t.current_next_indicator	= bs.GetBits(1);
+	t.section_number 			= bs.GetBits(8);
+	t.last_section_number 		= bs.GetBits(8);
+	t.reserved_4	 			= bs.GetBits(4);
+	t.bouquet_descriptors_length = bs.GetBits(12);
 
 	if (t.table_id != 0x04A) 
 	{
@@ -132,64 +154,25 @@ void tables::CTabBAT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_BAT&
 	}
 
 	len1 = t.section_length - 10;
-	b   += 10;
+	len1 -= ReadDescriptors(bs,t.bouquet_descriptors_length,t.vec_descriptor);
 
-	len2 = t.bouquet_descriptors_length;
+	t.reserved_5	 		 = bs.GetBits(4);
+	t.transport_stream_loop_length	 = bs.GetBits(12);
 
-	//t.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-	if (len2>0)
+	while (len1 > 4 && !bs.Overrun())
 	{
-		t.vec_descriptor.resize(len2);
-		memcpy(&t.vec_descriptor[0],b,len2);
-	}
-	while (len2 > 0)
-	{
-		int x = 1;
+		t2.transport_stream_id	 = bs.GetBits(16);
+		t2.original_network_id	 = bs.GetBits(16);
+		t2.reserved_1		 = bs.GetBits(4);
+		t2.transport_descriptors_length = bs.GetBits(12);
 
-		//x = descriptor (b, DVB_SI);
-		//t.vec_descriptor.push_back(*b);
-		len2 -= x;
-		b += x;
-		len1 -= x;
-	}
-
-	t.reserved_5	 		 = CBit::getBits (b, 0, 0, 4);
-	t.transport_stream_loop_length	 = CBit::getBits (b, 0, 4, 12);
-
-	b += 2;
-
-	while (len1 > 4)
-	{
-		t2.transport_stream_id	 = CBit::getBits (b, 0,  0,  16);
-		t2.original_network_id	 = CBit::getBits (b, 0, 16,  16);
-		t2.reserved_1		 = CBit::getBits (b, 0, 32,   4);
-		t2.transport_descriptors_length = CBit::getBits (b, 0, 36,  12);
-
-		b    += 6;
 		len1 -= 6;
-		len2  = t2.transport_descriptors_length;
-
-		//t2.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-		if (len2>0)
-		{
-			t2.vec_descriptor.resize(len2);
-			memcpy(&t2.vec_descriptor[0],b,len2);
-		}
-		while (len2 > 0)
-		{
-			int x = 1;
-
-			//x = descriptor (b, DVB_SI);
-			//t2.vec_descriptor.push_back(*b);
-			len2 -= x;
-			b    += x;
-			len1 -= x;
-		}
+		len1 -= ReadDescriptors(bs,t2.transport_descriptors_length,t2.vec_descriptor);
 
 		t.vec_bat_list2.push_back(t2);
 	} // while len1
 
-	t.crc		 		 = CBit::getBits (b, 0, 0, 32);
+	t.crc		 		 = bs.GetBits(32);
 
 	tabBAT.push_back(t);
 }
@@ -102,50 +102,31 @@ void tables::CTabCAT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_CAT&
 	//һsection,push_backtabCAT
 	CAT  c;
 	int  len1;
-	u_char* b = (u_char*)&vecData[0];
-
-	c.table_id 			 = b[0];
-	c.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	c.reserved_1 			 = CBit::getBits (b, 0, 10, 2);
-	c.section_length		 = CBit::getBits (b, 0, 12, 12);
-	c.reserved_2 			 = CBit::getBits (b, 0, 24, 18);
-	c.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	c.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	c.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	c.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
+	CBitReader bs(&vecData[0],vecData.size());
+
+	c.table_id 			 = bs.GetBits(8);
+	c.section_syntax_indicator	 = bs.GetBits(1);
+	bs.SkipBits(1);
+	c.reserved_1 			 = bs.GetBits(2);
+	c.section_length		 = bs.GetBits(12);
+	c.reserved_2 			 = bs.GetBits(18);
+	c.version_number 		 = bs.GetBits(5);
+	c.current_next_indicator	 = bs.GetBits(1);
+	c.section_number 		 = bs.GetBits(8);
+	c.last_section_number 		 = bs.GetBits(8);
 
 	if (c.table_id != 0x01)
 	{
 		return;
 	}
 
-	// buffer + header, len = len - header - CRC
 	// Descriptor ISO 13818 - 2.6.1
-
-
 	// - header - CRC
 	len1 = c.section_length - 5;
-	b  += 8;
-
-	//c.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len1-4);
-	if (len1-4 > 0)
-	{
-		c.vec_descriptor.resize(len1-4);
-		memcpy(&c.vec_descriptor[0],b,len1-4);
-	}
 
-	while (len1 > 4)
-	{
-		int i = 1;
-
-		//i     =  descriptor (b, MPEG);
-//		c.vec_descriptor.push_back(*b);
-		len1 -= i;
-		b    += i;
-
-	}
+	ReadDescriptors(bs,len1-4,c.vec_descriptor);
 	
-	c.CRC 		 = CBit::getBits (b, 0, 0, 32);
+	c.CRC 		 = bs.GetBits(32);
 
 	tabCAT.push_back(c);
 }
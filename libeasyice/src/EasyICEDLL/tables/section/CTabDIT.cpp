@@ -71,15 +71,15 @@ void tables::CTabDIT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 void tables::CTabDIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_DIT& tabDIT)
 {
 	DIT        d;
-	u_char* b = (u_char*)&vecData[0];
-
-	d.table_id 			 = b[0];
-	d.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	d.reserved_1 			 = CBit::getBits (b, 0, 9, 1);
-	d.reserved_2 			 = CBit::getBits (b, 0, 10, 2);
-	d.section_length		 = CBit::getBits (b, 0, 12, 12);
-	d.transition_flag		 = CBit::getBits (b, 0, 24, 1);
-	d.reserved_3 			 = CBit::getBits (b, 0, 25, 7);
+	CBitReader bs(&vecData[0],vecData.size());
+
+	d.table_id 			 = bs.GetBits(8);
+	d.section_syntax_indicator	 = bs.GetBits(1);
+	d.reserved_1 			 = bs.GetBits(1);
+	d.reserved_2 			 = bs.GetBits(2);
+	d.section_length		 = bs.GetBits(12);
+	d.transition_flag		 = bs.GetBits(1);
+	d.reserved_3 			 = bs.GetBits(7);
 
 	if (d.table_id != 0x7E)
 	{
@@ -48,6 +48,28 @@ void tables::CTabEIT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 		return;
 	}
 
+	//еsection°汾ݱ仯滻ΪµġظsectionsectionʱѾˣĶµĻб仯
+	if (tabEIT[0].current_next_indicator == 1)
+	{
+		vector<STU_SECTION_EIT>::iterator it_cur = tables->vecTabEIT.begin();
+		for (; it_cur != tables->vecTabEIT.end(); ++it_cur)
+		{
+			STU_SECTION_EIT::iterator it_sec = it_cur->begin();
+			for (; it_sec != it_cur->end(); ++it_sec)
+			{
+				if (it_sec->table_id == tabEIT[0].table_id && it_sec->service_id == tabEIT[0].service_id && it_sec->transport_stream_id == tabEIT[0].transport_stream_id && it_sec->original_network_id == tabEIT[0].original_network_id && it_sec->section_number == tabEIT[0].section_number)
+				{
+					if (it_sec->version_number != tabEIT[0].version_number || it_sec->crc != tabEIT[0].crc)
+					{
+						*it_sec = tabEIT.front();
+						DecodeDescriptors(*it_sec);
+					}
+					return;
+				}
+			}
+		}
+	}
+
 	bool bfinded_tableid = false;
 	vector<STU_SECTION_EIT>::iterator it_tab = tables->vecTabEIT.begin();
 	for (; it_tab != tables->vecTabEIT.end(); ++it_tab)
@@ -106,7 +128,7 @@ void tables::CTabEIT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 			}
 		}
 		
-		//Ϊ˱ͬ汾ŵıԲͬ汾ŵֻһ
+		//ûеsection룬section°汾滻
 		if ((it_tab->begin()->table_id == tabEIT.begin()->table_id )&& ( !b_service_id_exist || !b_section_num_exist ||!b_transport_stream_id_exist
 			||!b_original_network_id_exist /*||!b_version_num_exist*/))
 		{
@@ -131,24 +153,24 @@ void tables::CTabEIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_EIT&
 {
 	EIT        e;
 	EIT_LIST2  e2;
-	int        len1,len2;
-	u_char* b = (u_char*)&vecData[0];
-
-	e.table_id 			 = b[0];
-	e.section_syntax_indicator	 = CBit::getBits (b, 0,  8,  1);
-	e.reserved_1 			 = CBit::getBits (b, 0,  9,  1);
-	e.reserved_2 			 = CBit::getBits (b, 0, 10,  2);
-	e.section_length		 = CBit::getBits (b, 0, 12, 12);
-	e.service_id			 = CBit::getBits (b, 0, 24, 16);
-	e.reserved_3 			 = CBit::getBits (b, 0, 40,  2);
-	e.version_number 		 = CBit::getBits (b, 0, 42,  5);
-	e.current_next_indicator	 = CBit::getBits (b, 0, 47,  1);
-	e.section_number 		 = CBit::getBits (b, 0, 48,  8);
-	e.last_section_number 		 = CBit::getBits (b, 0, 56,  8);
-	e.transport_stream_id		 = CBit::getBits (b, 0, 64, 16);
-	e.original_network_id		 = CBit::getBits (b, 0, 80, 16);
-	e.segment_last_section_number	 = CBit::getBits (b, 0, 96,  8);
-	e.last_table_id		 = CBit::getBits (b, 0,104,  8);
+	int        len1;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	e.table_id 			 = bs.GetBits(8);
+	e.section_syntax_indicator	 = bs.GetBits(1);
+	e.reserved_1 			 = bs.GetBits(1);
+	e.reserved_2 			 = bs.GetBits(2);
+	e.section_length		 = bs.GetBits(12);
+	e.service_id			 = bs.GetBits(16);
+	e.reserved_3 			 = bs.GetBits(2);
+	e.version_number 		 = bs.GetBits(5);
+	e.current_next_indicator	 = bs.GetBits(1);
+	e.section_number 		 = bs.GetBits(8);
+	e.last_section_number 		 = bs.GetBits(8);
+	e.transport_stream_id		 = bs.GetBits(16);
+	e.original_network_id		 = bs.GetBits(16);
+	e.segment_last_section_number	 = bs.GetBits(8);
+	e.last_table_id		 = bs.GetBits(8);
 
 	if (   e.table_id != 0x4E && e.table_id != 0x4F
      && !(e.table_id >= 0x50 && e.table_id <= 0x6F) )
@@ -158,44 +180,26 @@ void tables::CTabEIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_EIT&
 
 	// - header data after length value
 	len1 = e.section_length - 11;
-	b   += 14;
 
-	while (len1 > 4) 
+	while (len1 > 4 && !bs.Overrun()) 
 	{
 
-		e2.event_id			 = CBit::getBits (b, 0,  0, 16);
-		e2.start_time_MJD		 = CBit::getBits (b, 0, 16, 16);
-		e2.start_time_UTC		 = CBit::getBits (b, 0, 32, 24);
-		e2.duration			 = CBit::getBits (b, 0, 56, 24);
-		e2.running_status		 = CBit::getBits (b, 0, 80, 3);
-		e2.free_CA_mode		 = CBit::getBits (b, 0, 83, 1);
-		e2.descriptors_loop_length	 = CBit::getBits (b, 0, 84, 12);
+		e2.event_id			 = bs.GetBits(16);
+		e2.start_time_MJD		 = bs.GetBits(16);
+		e2.start_time_UTC		 = bs.GetBits(24);
+		e2.duration			 = bs.GetBits(24);
+		e2.running_status		 = bs.GetBits(3);
+		e2.free_CA_mode		 = bs.GetBits(1);
+		e2.descriptors_loop_length	 = bs.GetBits(12);
 
-		b    += 12;
 		len1 -= (12 + e2.descriptors_loop_length);
-		len2 = e2.descriptors_loop_length;
-
-		//e2.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-		if (len2>0)
-		{
-			e2.vec_descriptor.resize(len2);
-			memcpy(&e2.vec_descriptor[0],b,len2);
-		}
-		while (len2 > 0 && len2 < (int)vecData.size())
-		{
-			int x = 1;
-
-			//x = descriptor (b, DVB_SI);
-//			e2.vec_descriptor.push_back(*b);
-			b    += x;
-			len2 -= x;
-		}
+		ReadDescriptors(bs,e2.descriptors_loop_length,e2.vec_descriptor);
 
 		e.vec_eit_list2.push_back(e2);
 
 	} // while len1
 
-	e.crc		 		 = CBit::getBits (b, 0, 0, 32);
+	e.crc		 		 = bs.GetBits(32);
 
 	tabEIT.push_back(e);
 }
@@ -45,6 +45,28 @@ void tables::CTabNIT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 		return;
 	}
 
+	//еsection°汾ݱ仯滻ΪµġظsectionsectionʱѾˣĶµĻб仯
+	if (tabNIT[0].current_next_indicator == 1)
+	{
+		vector<STU_SECTION_NIT>::iterator it_cur = tables->vecTabNIT.begin();
+		for (; it_cur != tables->vecTabNIT.end(); ++it_cur)
+		{
+			STU_SECTION_NIT::iterator it_sec = it_cur->begin();
+			for (; it_sec != it_cur->end(); ++it_sec)
+			{
+				if (it_sec->table_id == tabNIT[0].table_id && it_sec->network_id == tabNIT[0].network_id && it_sec->section_number == tabNIT[0].section_number)
+				{
+					if (it_sec->version_number != tabNIT[0].version_number || it_sec->CRC != tabNIT[0].CRC)
+					{
+						*it_sec = tabNIT.front();
+						DecodeDescriptors(*it_sec);
+					}
+					return;
+				}
+			}
+		}
+	}
+
 	bool bfinded_tableid = false;
 	vector<STU_SECTION_NIT>::iterator it_tab = tables->vecTabNIT.begin();
 	for (; it_tab != tables->vecTabNIT.end(); ++it_tab)
@@ -84,7 +106,7 @@ void tables::CTabNIT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 
 		}
 		
-		//Ҫͬ汾Ŵע͡ݲ汾
+		//ûеsection룬section°汾滻
 		if ((it_tab->begin()->table_id == tabNIT.begin()->table_id )&& ( !b_section_num_exist ||!b_network_id_exist /*|| !b_version_num_exist*/ ))
 		{
 			
@@ -108,22 +130,22 @@ void tables::CTabNIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_NIT&
 {
 	NIT        n;
 	NIT_TSL    nt;
-	int        l1,l2;
-	u_char* b = (u_char*)&vecData[0];
-
-	n.table_id 			 = b[0];
-	n.section_syntax_indicator	 = CBit::getBits (b, 0,  8, 1);
-	n.reserved_1 			 = CBit::getBits (b, 0,  9, 1);
-	n.reserved_2 			 = CBit::getBits (b, 0, 10, 2);
-	n.section_length		 = CBit::getBits (b, 0, 12, 12);
-	n.network_id			 = CBit::getBits (b, 0, 24, 16);
-	n.reserved_3 			 = CBit::getBits (b, 0, 40, 2);
-	n.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	n.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	n.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	n.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
-	n.reserved_4 			 = CBit::getBits (b, 0, 64, 4);
-	n.network_descriptor_length	 = CBit::getBits (b, 0, 68, 12);
+	int        l1;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	n.table_id 			 = bs.GetBits(8);
+	n.section_syntax_indicator	 = bs.GetBits(1);
+	n.reserved_1 			 = bs.GetBits(1);
+	n.reserved_2 			 = bs.GetBits(2);
+	n.section_length		 = bs.GetBits(12);
+	n.network_id			 = bs.GetBits(16);
+	n.reserved_3 			 = bs.GetBits(2);
+	n.version_number 		 = bs.GetBits(5);
+	n.current_next_indicator	 = bs.GetBits(1);
+	n.section_number 		 = bs.GetBits(8);
+	n.last_section_number 		 = bs.GetBits(8);
+	n.reserved_4 			 = bs.GetBits(4);
+	n.network_descriptor_length	 = bs.GetBits(12);
 
 	if (n.table_id != 0x40 && n.table_id != 0x41)
 	{
@@ -131,69 +153,32 @@ void tables::CTabNIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_NIT&
 	}
 	
 	 // get network descriptors
-	
-	l1 = n.network_descriptor_length;
-	b += 10;
-
-	//n.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,l1);
-	if (l1 > 0)
-	{
-		n.vec_descriptor.resize(l1);
-		memcpy(&n.vec_descriptor[0],b,l1);
-	}
-
-	while ( l1 > 0 )
-	{
-		int x = 1;
 
-		//x = descriptor (b, DVB_SI); 
-		//n.vec_descriptor.push_back(*b);
-		l1 -= x;
-		b += x;
-	}
+	ReadDescriptors(bs,n.network_descriptor_length,n.vec_descriptor);
 
 	 // get transport stream loop / descriptors...
 
-	n.reserved_5 			 = CBit::getBits (b, 0, 0, 4);
-	n.transport_stream_loop_length	 = CBit::getBits (b, 0, 4, 12);
+	n.reserved_5 			 = bs.GetBits(4);
+	n.transport_stream_loop_length	 = bs.GetBits(12);
 
 	l1 = n.transport_stream_loop_length;
-	b += 2;
 
-	while ( l1 > 0 )
+	while ( l1 > 0 && !bs.Overrun() )
 	{
-		nt.transport_stream_id	= CBit::getBits (b, 0,  0, 16);
-		nt.original_network_id	= CBit::getBits (b, 0, 16, 16);
-		nt.reserved_1		= CBit::getBits (b, 0, 32, 4);
-		nt.transport_descriptor_length	= CBit::getBits (b, 0, 36, 12);
+		nt.transport_stream_id	= bs.GetBits(16);
+		nt.original_network_id	= bs.GetBits(16);
+		nt.reserved_1		= bs.GetBits(4);
+		nt.transport_descriptor_length	= bs.GetBits(12);
 
 		// descriptor(s) 
 
-		b  += 6;
 		l1 -= 6;
-		l2  = nt.transport_descriptor_length;
-
-		//nt.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,l2);
-		if (l2 > 0)
-		{
-			nt.vec_descriptor.resize(l2);
-			memcpy(&nt.vec_descriptor[0],b,l2);
-		}
-		while (l2 > 0)
-		{
-			int x = 1;
-
-			//x = descriptor (b, DVB_SI);
-			//nt.vec_descriptor.push_back(*b);
-			b  += x;
-			l2 -= x;
-			l1 -= x;
-		}
+		l1 -= ReadDescriptors(bs,nt.transport_descriptor_length,nt.vec_descriptor);
 
 		n.vec_nit_tsl.push_back(nt);
 	} // !while l1
 	
-	n.CRC 			 = CBit::getBits (b, 0, 0, 32);
+	n.CRC 			 = bs.GetBits(32);
 
 	tabNIT.push_back(n);
 
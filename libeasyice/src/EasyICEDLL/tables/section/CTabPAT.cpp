@@ -100,18 +100,19 @@ void  tables::CTabPAT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_PAT&
 	PAT p;
 	PAT_LIST pl;
 	int n;
-	u_char* b = (u_char*)&vecData[0];
-
-	p.table_id 			 = b[0];
-	p.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	p.reserved_1 			 = CBit::getBits (b, 0, 10, 2);
-	p.section_length		 = CBit::getBits (b, 0, 12, 12);
-	p.transport_stream_id		 = CBit::getBits (b, 0, 24, 16);
-	p.reserved_2 			 = CBit::getBits (b, 0, 40, 2);
-	p.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	p.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	p.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	p.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
+	CBitReader bs(&vecData[0],vecData.size());
+
+	p.table_id 			 = bs.GetBits(8);
+	p.section_syntax_indicator	 = bs.GetBits(1);
+	bs.SkipBits(1);
+	p.reserved_1 			 = bs.GetBits(2);
+	p.section_length		 = bs.GetBits(12);
+	p.transport_stream_id		 = bs.GetBits(16);
+	p.reserved_2 			 = bs.GetBits(2);
+	p.version_number 		 = bs.GetBits(5);
+	p.current_next_indicator	 = bs.GetBits(1);
+	p.section_number 		 = bs.GetBits(8);
+	p.last_section_number 		 = bs.GetBits(8);
 
 	if (p.table_id != 0x00)
 	{
@@ -121,23 +122,19 @@ void  tables::CTabPAT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_PAT&
 	// PID list...
 	// n = section_length - CRC  - front bytes
 	// n = len / anzahl bytes pro pid angabe.
-	// Buffer to start of List
 
 	n  = p.section_length - 5 - 4;
 
-	b = b + 8;
-
-	for (; n>=4; n=n-4)
+	for (; n>=4 && !bs.Overrun(); n=n-4)
 	{
-		pl.program_number	 = CBit::getBits (b, 0, 0, 16);
-		pl.reserved		 = CBit::getBits (b, 0, 16, 3);
-		pl.network_pmt_PID	 = CBit::getBits (b, 0, 19, 13);
-		b += 4;
+		pl.program_number	 = bs.GetBits(16);
+		pl.reserved		 = bs.GetBits(3);
+		pl.network_pmt_PID	 = bs.GetBits(13);
 
 		p.vec_pat_list.push_back(pl);
 	}
 
-	 p.CRC = CBit::getBits (b,0,0,32);
+	 p.CRC = bs.GetBits(32);
 
 	 tabPAT.push_back(p);
 }
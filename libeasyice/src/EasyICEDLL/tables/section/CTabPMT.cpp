@@ -42,6 +42,23 @@ void tables::CTabPMT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 		return;
 	}
 
+	//Ŀеsection°汾ݱ仯滻ΪµġظsectionsectionʱѾˣĶµĻб仯
+	map<int,STU_SECTION_PMT>::iterator it_prog = tables->mapTabPMT.find(tabPMT[0].program_number);
+	if (it_prog != tables->mapTabPMT.end() && tabPMT[0].current_next_indicator == 1)
+	{
+		STU_SECTION_PMT::iterator it_sec = it_prog->second.begin();
+		for (; it_sec != it_prog->second.end(); ++it_sec)
+		{
+			if (it_sec->section_number == tabPMT[0].section_number &&
+				(it_sec->version_number != tabPMT[0].version_number || it_sec->crc != tabPMT[0].crc))
+			{
+				*it_sec = tabPMT.front();
+				DecodeDescriptors(*it_sec);
+				return;
+			}
+		}
+	}
+
 	bool bfinded_tableid = false;
 	map<int,STU_SECTION_PMT>::iterator it_tab = tables->mapTabPMT.begin();
 	for (; it_tab != tables->mapTabPMT.end(); ++it_tab)
@@ -118,24 +135,24 @@ void tables::CTabPMT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_PMT&
 {
 	PMT        p;
 	PMT_LIST2  p2;
-	int        len1,len2;
-	u_char* b = (u_char*)&vecData[0];
-
-	p.table_id 			 = b[0];
-	p.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	p.b_null			 = CBit::getBits (b, 0, 9, 1);
-	p.reserved_1 			 = CBit::getBits (b, 0, 10, 2);
-	p.section_length		 = CBit::getBits (b, 0, 12, 12);
-	p.program_number		 = CBit::getBits (b, 0, 24, 16);
-	p.reserved_2 			 = CBit::getBits (b, 0, 40, 2);
-	p.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	p.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	p.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	p.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
-	p.reserved_3	 		 = CBit::getBits (b, 0, 64, 3);
-	p.pcr_pid	 		 = CBit::getBits (b, 0, 67, 13);
-	p.reserved_4	 		 = CBit::getBits (b, 0, 80, 4);
-	p.program_info_length 		 = CBit::getBits (b, 0, 84, 12);
+	int        len1;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	p.table_id 			 = bs.GetBits(8);
+	p.section_syntax_indicator	 = bs.GetBits(1);
+	p.b_null			 = bs.GetBits(1);
+	p.reserved_1 			 = bs.GetBits(2);
+	p.section_length		 = bs.GetBits(12);
+	p.program_number		 = bs.GetBits(16);
+	p.reserved_2 			 = bs.GetBits(2);
+	p.version_number 		 = bs.GetBits(5);
+	p.current_next_indicator	 = bs.GetBits(1);
+	p.section_number 		 = bs.GetBits(8);
+	p.last_section_number 		 = bs.GetBits(8);
+	p.reserved_3	 		 = bs.GetBits(3);
+	p.pcr_pid	 		 = bs.GetBits(13);
+	p.reserved_4	 		 = bs.GetBits(4);
+	p.program_info_length 		 = bs.GetBits(12);
 
 	if (p.table_id != 0x02)
 	{
@@ -143,61 +160,24 @@ void tables::CTabPMT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_PMT&
 	}
 
 	len1 = p.section_length - 9;
-	b   += 9 + 3;
-
-	len2 = p.program_info_length;
-
-	//p.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-	if (len2>0)
-	{
-		p.vec_descriptor.resize(len2);
-		memcpy(&p.vec_descriptor[0],b,len2);
-	}
-	while (len2 > 0)
-	{
-		int x = 1;
+	len1 -= ReadDescriptors(bs,p.program_info_length,p.vec_descriptor);
 
-		//x = descriptor (b, DVB_SI);
-		//p.vec_descriptor.push_back(*b);
-		len2 -= x;
-		b += x;
-		len1 -= x;
-	}
-
-	while (len1 > 4)
+	while (len1 > 4 && !bs.Overrun())
 	{
 
-		p2.stream_type		 = CBit::getBits (b, 0,  0,  8);
-		p2.reserved_1		 = CBit::getBits (b, 0,  8,  3);
-		p2.elementary_PID		 = CBit::getBits (b, 0, 11, 13);
-		p2.reserved_2		 = CBit::getBits (b, 0, 24,  4);
-		p2.ES_info_length		 = CBit::getBits (b, 0, 28, 12);
+		p2.stream_type		 = bs.GetBits(8);
+		p2.reserved_1		 = bs.GetBits(3);
+		p2.elementary_PID		 = bs.GetBits(13);
+		p2.reserved_2		 = bs.GetBits(4);
+		p2.ES_info_length		 = bs.GetBits(12);
 
-		b    += 5;
 		len1 -= 5;
-		len2 = p2.ES_info_length;
-
-		//p2.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-		if (len2>0)
-		{
-			p2.vec_descriptor.resize(len2);
-			memcpy(&p2.vec_descriptor[0],b,len2);
-		}
-		while (len2 > 0)
-		{
-			int x = 1;
-
-			//x = descriptor (b, DVB_SI);
-			//p2.vec_descriptor.push_back(*b);
-			len2 -= x;
-			len1 -= x;
-			b += x;
-		}
+		len1 -= ReadDescriptors(bs,p2.ES_info_length,p2.vec_descriptor);
 		
 		p.vec_pmt_list2.push_back(p2);
 	} // while len1
 
-	p.crc		 		 = CBit::getBits (b, 0, 0, 32);
+	p.crc		 		 = bs.GetBits(32);
 
 	tabPMT.push_back(p);
 }
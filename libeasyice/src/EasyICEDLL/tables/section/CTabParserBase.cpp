@@ -31,4 +31,22 @@ void tables::CTabParserBase::Parse(const TABLE_SECTIONS& table_sections, TABLES*
 
 }
 
-
+int tables::CTabParserBase::ReadDescriptors(CBitReader& bs,int len,vector<BYTE>& vec)
+{
+	if (len <= 0)
+	{
+		return 0;
+	}
+
+	size_t n = len;
+	if (n > bs.BytesLeft())
+	{
+		n = bs.BytesLeft();
+	}
+	if (n > 0)
+	{
+		vec.assign(bs.Pointer(),bs.Pointer() + n);
+	}
+	bs.SkipBytes(len);
+	return len;
+}
@@ -16,7 +16,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #define CTABPARSERBASE_H
 
 #include "tablesdefs.h"
-#include "CBit.h"
+#include "BitReader.h"
 #include "../CDescriptor.h"
 
 namespace tables{
@@ -40,6 +40,15 @@ public:
 
         CTabParserBase();
 
+protected:
+
+		/**
+		 * bsǰλȡlenֽڵݴvec,Щֽ
+		 * Խʱֻʣ,bsΪ״̬
+		 * len(len<=0ʱ0),ڵ߿ۼѭ
+		 */
+		static int ReadDescriptors(CBitReader& bs,int len,vector<BYTE>& vec);
+
 };
 
 }
@@ -66,13 +66,13 @@ void tables::CTabRST::ParseSection(const vector<BYTE>& vecData,STU_SECTION_RST&
 	RST        r;
 	RST_LIST2  r2;
 	int        len1;
-	u_char* b = (u_char*)&vecData[0];
+	CBitReader bs(&vecData[0],vecData.size());
 
-	r.table_id 			 = b[0];
-	r.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	r.reserved_1 			 = CBit::getBits (b, 0, 9, 1);
-	r.reserved_2 			 = CBit::getBits (b, 0, 10, 2);
-	r.section_length		 = CBit::getBits (b, 0, 12, 12);
+	r.table_id 			 = bs.GetBits(8);
+	r.section_syntax_indicator	 = bs.GetBits(1);
+	r.reserved_1 			 = bs.GetBits(1);
+	r.reserved_2 			 = bs.GetBits(2);
+	r.section_length		 = bs.GetBits(12);
 
 	if (r.table_id != 0x71)
 	{
@@ -80,19 +80,17 @@ void tables::CTabRST::ParseSection(const vector<BYTE>& vecData,STU_SECTION_RST&
 	}
 
 	len1 = r.section_length - 3;
-	b   += 3;
 
-	while (len1 > 0)
+	while (len1 > 0 && !bs.Overrun())
 	{
 
-		r2.transport_stream_id	 = CBit::getBits (b, 0,  0,  16);
-		r2.original_network_id	 = CBit::getBits (b, 0, 16,  16);
-		r2.service_id		 = CBit::getBits (b, 0, 32,  16);
-		r2.event_id			 = CBit::getBits (b, 0, 48,  16);
-		r2.reserved_1		 = CBit::getBits (b, 0, 64,   5);
-		r2.running_status		 = CBit::getBits (b, 0, 69,   3);
+		r2.transport_stream_id	 = bs.GetBits(16);
+		r2.original_network_id	 = bs.GetBits(16);
+		r2.service_id		 = bs.GetBits(16);
+		r2.event_id			 = bs.GetBits(16);
+		r2.reserved_1		 = bs.GetBits(5);
+		r2.running_status		 = bs.GetBits(3);
 
-		b    += 9;
 		len1 -= 9;
 
 		r.vec_rst_list2.push_back(r2);
@@ -46,6 +46,28 @@ void tables::CTabSDT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 		return;
 	}
 
+	//еsection°汾ݱ仯滻ΪµġظsectionsectionʱѾˣĶµĻб仯
+	if (tabSDT[0].current_next_indicator == 1)
+	{
+		vector<STU_SECTION_SDT>::iterator it_cur = tables->vecTabSDT.begin();
+		for (; it_cur != tables->vecTabSDT.end(); ++it_cur)
+		{
+			STU_SECTION_SDT::iterator it_sec = it_cur->begin();
+			for (; it_sec != it_cur->end(); ++it_sec)
+			{
+				if (it_sec->table_id == tabSDT[0].table_id && it_sec->transport_stream_id == tabSDT[0].transport_stream_id && it_sec->original_network_id == tabSDT[0].original_network_id && it_sec->section_number == tabSDT[0].section_number)
+				{
+					if (it_sec->version_number != tabSDT[0].version_number || it_sec->CRC != tabSDT[0].CRC)
+					{
+						*it_sec = tabSDT.front();
+						DecodeDescriptors(*it_sec);
+					}
+					return;
+				}
+			}
+		}
+	}
+
 	bool bfinded_tableid = false;
 	vector<STU_SECTION_SDT>::iterator it_tab = tables->vecTabSDT.begin();
 	for (; it_tab != tables->vecTabSDT.end(); ++it_tab)
@@ -95,7 +117,7 @@ void tables::CTabSDT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 			}
 		}
 		
-		//Ҫͬ汾Ŵע͡ݲ汾
+		//ûеsection룬section°汾滻
 		if ((it_tab->begin()->table_id == tabSDT.begin()->table_id )&& ( !b_section_num_exist ||!b_transport_stream_id_exist ||!b_original_network_id_exist /*|| !b_version_num_exist*/ ))
 		{
 			
@@ -119,22 +141,22 @@ void tables::CTabSDT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_SDT&
 {
 	SDT      s;
 	SDT_LIST s2;
-	int      len1,len2;
-	u_char* b = (u_char*)&vecData[0];
-
-	s.table_id 			 = b[0];
-	s.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	s.reserved_1 			 = CBit::getBits (b, 0, 9, 1);
-	s.reserved_2 			 = CBit::getBits (b, 0, 10, 2);
-	s.section_length		 = CBit::getBits (b, 0, 12, 12);
-	s.transport_stream_id		 = CBit::getBits (b, 0, 24, 16);
-	s.reserved_3 			 = CBit::getBits (b, 0, 40, 2);
-	s.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	s.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	s.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	s.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
-	s.original_network_id		 = CBit::getBits (b, 0, 64, 16);
-	s.reserved_4 			 = CBit::getBits (b, 0, 80, 8);
+	int      len1;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	s.table_id 			 = bs.GetBits(8);
+	s.section_syntax_indicator	 = bs.GetBits(1);
+	s.reserved_1 			 = bs.GetBits(1);
+	s.reserved_2 			 = bs.GetBits(2);
+	s.section_length		 = bs.GetBits(12);
+	s.transport_stream_id		 = bs.GetBits(16);
+	s.reserved_3 			 = bs.GetBits(2);
+	s.version_number 		 = bs.GetBits(5);
+	s.current_next_indicator	 = bs.GetBits(1);
+	s.section_number 		 = bs.GetBits(8);
+	s.last_section_number 		 = bs.GetBits(8);
+	s.original_network_id		 = bs.GetBits(16);
+	s.reserved_4 			 = bs.GetBits(8);
 
 	if (s.table_id != 0x42 && s.table_id != 0x46)
 	{
@@ -143,45 +165,26 @@ void tables::CTabSDT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_SDT&
 
 	//  len = len - header - CRC
 	len1 = s.section_length - 11 - 4;
-	b   += 11;
 
-	while (len1 > 0 )
+	while (len1 > 0 && !bs.Overrun())
 	{
 
-		s2.service_id		= CBit::getBits (b, 0,  0, 16);
-		s2.reserved_1		= CBit::getBits (b, 0, 16, 6);
-		s2.EIT_schedule_flag		= CBit::getBits (b, 0, 22, 1);
-		s2.EIT_present_following_flag= CBit::getBits (b, 0, 23, 1);
-		s2.running_status		= CBit::getBits (b, 0, 24, 3);
-		s2.free_CA_mode		= CBit::getBits (b, 0, 27, 1);
-		s2.descriptors_loop_length	= CBit::getBits (b, 0, 28, 12);
+		s2.service_id		= bs.GetBits(16);
+		s2.reserved_1		= bs.GetBits(6);
+		s2.EIT_schedule_flag		= bs.GetBits(1);
+		s2.EIT_present_following_flag= bs.GetBits(1);
+		s2.running_status		= bs.GetBits(3);
+		s2.free_CA_mode		= bs.GetBits(1);
+		s2.descriptors_loop_length	= bs.GetBits(12);
 
-		b    += 5;
 		len1 -= 5;
-		len2  = s2.descriptors_loop_length;
-
-		//s2.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-		if (len2 > 0)
-		{
-			s2.vec_descriptor.resize(len2);
-			memcpy(&s2.vec_descriptor[0],b,len2);
-		}
-		while (len2 > 0)
-		{
-			int x = 1;
-
-			//x = descriptor (b, DVB_SI);
-			//s2.vec_descriptor.push_back(*b);
-			len2 -= x;
-			b    += x;
-			len1 -= x;
-		}
+		len1 -= ReadDescriptors(bs,s2.descriptors_loop_length,s2.vec_descriptor);
 
 		s.vec_sdt_list.push_back(s2);
 
 	}// while len1
 
-	s.CRC = CBit::getBits (b,0,0,32);
+	s.CRC = bs.GetBits(32);
 
 	tabSDT.push_back(s);
 }
@@ -103,22 +103,22 @@ void tables::CTabSIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_SIT&
 {
 	SIT        s;
 	SIT_LIST2  s2;
-	int        len1,len2;
-	u_char* b = (u_char*)&vecData[0];
-
-	s.table_id 			 = b[0];
-	s.section_syntax_indicator	 = CBit::getBits (b, 0,  8,  1);
-	s.reserved_1 			 = CBit::getBits (b, 0,  9,  1);
-	s.reserved_2 			 = CBit::getBits (b, 0, 10,  2);
-	s.section_length		 = CBit::getBits (b, 0, 12, 12);
-	s.reserved_3 			 = CBit::getBits (b, 0, 24, 16);
-	s.reserved_4 			 = CBit::getBits (b, 0, 40,  2);
-	s.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	s.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	s.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	s.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
-	s.reserved_5	 		 = CBit::getBits (b, 0, 64, 4);
-	s.transmission_info_loop_length = CBit::getBits (b, 0, 68, 12);
+	int        len1;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	s.table_id 			 = bs.GetBits(8);
+	s.section_syntax_indicator	 = bs.GetBits(1);
+	s.reserved_1 			 = bs.GetBits(1);
+	s.reserved_2 			 = bs.GetBits(2);
+	s.section_length		 = bs.GetBits(12);
+	s.reserved_3 			 = bs.GetBits(16);
+	s.reserved_4 			 = bs.GetBits(2);
+	s.version_number 		 = bs.GetBits(5);
+	s.current_next_indicator	 = bs.GetBits(1);
+	s.section_number 		 = bs.GetBits(8);
+	s.last_section_number 		 = bs.GetBits(8);
+	s.reserved_5	 		 = bs.GetBits(4);
+	s.transmission_info_loop_length = bs.GetBits(12);
 
 	if (s.table_id != 0x7F)
 	{
@@ -127,62 +127,24 @@ void tables::CTabSIT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_SIT&
 
 	// - header data after length value
 	len1 = s.section_length - 7;
-	b   += 10;
+	len1 -= ReadDescriptors(bs,s.transmission_info_loop_length,s.vec_descriptor);
 
-	len2 = s.transmission_info_loop_length;
-
-	//s.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-	if (len2>0)
-	{
-		s.vec_descriptor.resize(len2);
-		memcpy(&s.vec_descriptor[0],b,len2);
-	}
-	while (len2 > 0)
-	{
-		int x = 1;
-
-		//x = descriptor (b, DVB_SI);
-		//s.vec_descriptor.push_back(*b);
-		len2 -= x;
-		b += x;
-		len1 -= x;
-	}
-
-	while (len1 > 4)
+	while (len1 > 4 && !bs.Overrun())
 	{
 
-		s2.service_id		 = CBit::getBits (b, 0,  0, 16);
-		s2.reserved_1		 = CBit::getBits (b, 0, 16,  1);
-		s2.running_status		 = CBit::getBits (b, 0, 17,  3);
-		s2.service_loop_length	 = CBit::getBits (b, 0, 20, 12);
+		s2.service_id		 = bs.GetBits(16);
+		s2.reserved_1		 = bs.GetBits(1);
+		s2.running_status		 = bs.GetBits(3);
+		s2.service_loop_length	 = bs.GetBits(12);
 
-		b    += 4;
 		len1 -= 4;
-
-		len2 = s2.service_loop_length;
-
-		//s2.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len2);
-		if (len2>0)
-		{
-			s2.vec_descriptor.resize(len2);
-			memcpy(&s2.vec_descriptor[0],b,len2);
-		}
-		while (len2 > 0)
-		{
-			int x = 1;
-
-			//x = descriptor (b, DVB_SI);
-			//s2.vec_descriptor.push_back(*b);
-			len2 -= x;
-			b += x;
-			len1 -= x;
-		}
+		len1 -= ReadDescriptors(bs,s2.service_loop_length,s2.vec_descriptor);
 	
 		s.vec_sit_list2.push_back(s2);
 
 	} // while len1
 
-	s.crc		 		 = CBit::getBits (b, 0, 0, 32);
+	s.crc		 		 = bs.GetBits(32);
 
 	tabSIT.push_back(s);
 }
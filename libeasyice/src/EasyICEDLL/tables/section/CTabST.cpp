@@ -72,32 +72,20 @@ void tables::CTabST::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables)
 void tables::CTabST::ParseSection(const vector<BYTE>& vecData,STU_SECTION_ST& tabST)
 {
 	ST s;
-	u_char* b = (u_char*)&vecData[0];
+	CBitReader bs(&vecData[0],vecData.size());
 
-	s.table_id 			 = b[0];
-	s.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	s.reserved_1 			 = CBit::getBits (b, 0, 9, 1);
-	s.reserved_2 			 = CBit::getBits (b, 0, 10, 2);
-	s.section_length		 = CBit::getBits (b, 0, 12, 12);
+	s.table_id 			 = bs.GetBits(8);
+	s.section_syntax_indicator	 = bs.GetBits(1);
+	s.reserved_1 			 = bs.GetBits(1);
+	s.reserved_2 			 = bs.GetBits(2);
+	s.section_length		 = bs.GetBits(12);
 
 	if (s.table_id != 0x72)
 	{
 		return;
 	}
-	
-	b += 3;
 
-	/*
-	for (int i = 0; i < s.section_length; i++)
-	{
-		s.vec_databytes.push_back(*b);
-		b++;
-	}*/
-	if (s.section_length > 0)
-	{
-		s.vec_databytes.resize(s.section_length);
-		memcpy(&s.vec_databytes[0],b,s.section_length);
-	}
+	ReadDescriptors(bs,s.section_length,s.vec_databytes);
 
 	tabST.push_back(s);
 }
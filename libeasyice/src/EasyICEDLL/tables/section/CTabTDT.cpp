@@ -72,15 +72,15 @@ void tables::CTabTDT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 void tables::CTabTDT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_TDT& tabTDT)
 {
 	TDT t;
-	u_char* b = (u_char*)&vecData[0];
-
-	t.table_id = b[0];
-	t.section_syntax_indicator		= CBit::getBits (b, 0, 8, 1);
-	t.reserved_future_use			= CBit::getBits (b, 0, 9, 1);
-	t.reserved						= CBit::getBits (b, 0, 10, 2);
-	t.section_length				= CBit::getBits (b, 0, 12, 12);
-	t.UTC_time_MJD					= CBit::getBits (b, 0, 24, 16);
-	t.UTC_time_UTC					= CBit::getBits (b, 0, 40, 24);
+	CBitReader bs(&vecData[0],vecData.size());
+
+	t.table_id = bs.GetBits(8);
+	t.section_syntax_indicator		= bs.GetBits(1);
+	t.reserved_future_use			= bs.GetBits(1);
+	t.reserved						= bs.GetBits(2);
+	t.section_length				= bs.GetBits(12);
+	t.UTC_time_MJD					= bs.GetBits(16);
+	t.UTC_time_UTC					= bs.GetBits(24);
 
 	if (t.table_id != 0x70)
 	{
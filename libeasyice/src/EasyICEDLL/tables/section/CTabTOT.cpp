@@ -74,45 +74,26 @@ void tables::CTabTOT::Parse(const TABLE_SECTIONS& table_sections, TABLES* tables
 void tables::CTabTOT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_TOT& tabTOT)
 {
 	TOT t;
-	u_char* b = (u_char*)&vecData[0];
-	int len1;
-
-	t.table_id = b[0];
-	t.section_syntax_indicator		= CBit::getBits (b, 0, 8, 1);
-	t.reserved_future_use			= CBit::getBits (b, 0, 9, 1);
-	t.reserved						= CBit::getBits (b, 0, 10, 2);
-	t.section_length				= CBit::getBits (b, 0, 12, 12);
-	t.UTC_time_MJD					= CBit::getBits (b, 0, 24, 16);
-	t.UTC_time_UTC					= CBit::getBits (b, 0, 40, 24);
-	t.reserved2						= CBit::getBits (b, 0, 64, 4);
-	t.descriptors_loop_length				= CBit::getBits (b, 0, 68, 12);
+	CBitReader bs(&vecData[0],vecData.size());
+
+	t.table_id = bs.GetBits(8);
+	t.section_syntax_indicator		= bs.GetBits(1);
+	t.reserved_future_use			= bs.GetBits(1);
+	t.reserved						= bs.GetBits(2);
+	t.section_length				= bs.GetBits(12);
+	t.UTC_time_MJD					= bs.GetBits(16);
+	t.UTC_time_UTC					= bs.GetBits(24);
+	t.reserved2						= bs.GetBits(4);
+	t.descriptors_loop_length				= bs.GetBits(12);
 
 	if (t.table_id != 0x73)
 	{
 		return;
 	}
 
-	len1 = t.descriptors_loop_length;
-	b += 10;
+	ReadDescriptors(bs,t.descriptors_loop_length,t.vec_descriptor);
 
-	//t.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len1);
-	if (len1 >0)
-	{
-		t.vec_descriptor.resize(len1);
-		memcpy(&t.vec_descriptor[0],b,len1);
-	}
-
-	while (len1 > 0)
-	{
-		int x = 1;
-
-		//x = descriptor (b, DVB_SI);
-		//t.vec_descriptor.push_back(*b);
-		len1 -= x;
-		b    += x;
-	}
-
-	t.CRC_32						= CBit::getBits (b, 0, 0, 32);
+	t.CRC_32						= bs.GetBits(32);
 
 	tabTOT.push_back(t);
 }
@@ -101,20 +101,19 @@ void tables::CTabTSDT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_TSDT
 {
 	TSDT   t;
 	int	len1;
-	u_char* b = (u_char*)&vecData[0];
-
-	t.table_id 			 = b[0];
-	t.section_syntax_indicator	 = CBit::getBits (b, 0, 8, 1);
-	t.reserved_1 			 = CBit::getBits (b, 0, 9, 1);
-	t.reserved_2 			 = CBit::getBits (b, 0, 10, 2);
-	t.section_length		 = CBit::getBits (b, 0, 12, 12);
-	t.reserved_3 			 = CBit::getBits (b, 0, 24, 18);
-	t.version_number 		 = CBit::getBits (b, 0, 42, 5);
-	t.current_next_indicator	 = CBit::getBits (b, 0, 47, 1);
-	t.section_number 		 = CBit::getBits (b, 0, 48, 8);
-	t.last_section_number 		 = CBit::getBits (b, 0, 56, 8);
-
-	b   += 8;
+	CBitReader bs(&vecData[0],vecData.size());
+
+	t.table_id 			 = bs.GetBits(8);
+	t.section_syntax_indicator	 = bs.GetBits(1);
+	t.reserved_1 			 = bs.GetBits(1);
+	t.reserved_2 			 = bs.GetBits(2);
+	t.section_length		 = bs.GetBits(12);
+	t.reserved_3 			 = bs.GetBits(18);
+	t.version_number 		 = bs.GetBits(5);
+	t.current_next_indicator	 = bs.GetBits(1);
+	t.section_number 		 = bs.GetBits(8);
+	t.last_section_number 		 = bs.GetBits(8);
+
 	len1 = t.section_length - 5;
 
 	if (t.table_id != 0x03)
@@ -122,24 +121,9 @@ void tables::CTabTSDT::ParseSection(const vector<BYTE>& vecData,STU_SECTION_TSDT
 		return;
 	}
 
-	//t.descriptors = CDescriptor::GetInstancePtr()->DecodeDescriptor(b,len1-4);
-	if (len1-4 > 0)
-	{
-		t.vec_descriptor.resize(len1-4);
-		memcpy(&t.vec_descriptor[0],b,len1-4);
-	}
-
-	while (len1 > 4)
-	{
-		int x = 1;
-
-		//x = descriptor (b, MPEG);
-		//t.vec_descriptor.push_back(*b);
-		b   += x;
-		len1 -= x;
-	}
+	ReadDescriptors(bs,len1-4,t.vec_descriptor);
 
-	t.crc		 = CBit::getBits (b, 0, 0, 32);
+	t.crc		 = bs.GetBits(32);
 
 	tabTSDT.push_back(t);
 }
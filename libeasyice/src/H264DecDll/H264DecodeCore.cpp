@@ -12,6 +12,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 //#include "StdAfx.h"
 #include "H264DecodeCore.h"
+//JM ͷļѾ jmdec.h е
+#define TSPACKET_WITHOUT_JMDEC
 #include "TsPacket.h"
 
 extern "C"
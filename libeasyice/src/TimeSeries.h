@@ -0,0 +1,370 @@
+/*
+MIT License
+
+Copyright  (c) 2009-2019 easyice
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+
+//how samples are folded once a series is limited to a number of samples
+typedef enum
+{
+    SERIES_DECIMATE_AVG,    //average of the window, at the position of its first sample
+    SERIES_DECIMATE_MIN,    //smallest sample of the window
+    SERIES_DECIMATE_MAX     //largest sample of the window
+}SERIES_DECIMATE_MODE;
+
+//samples per chunk, memory grows by this step
+#define SERIES_CHUNK_SIZE 4096
+
+/**
+ * Append-only series of samples ordered by packet position, stored by columns
+ * in chunks.
+ *
+ * A chunk keeps its first sample in full, the others as a 32-bit pos offset
+ * and a value encoded by CODEC against the first sample (a 32-bit delta for
+ * timestamps), so a timestamp takes 8 bytes instead of 16. A sample that
+ * doesn't fit starts a new chunk.
+ *
+ * With SetDecimation(mode,n) the series never holds more than n samples: when
+ * it is full, neighbouring samples are folded in pairs and the number of input
+ * samples per stored sample doubles, so memory stays flat whatever the length
+ * of the input. The window being filled is reported as the last sample.
+ * Without it every sample is kept as pushed.
+ *
+ * push_back, size and operator[] follow std::vector, items are returned by
+ * value.
+ *
+ * CODEC provides:
+ *   typedef ... STORED;
+ *   static bool Encode(const T& base,const T& item,STORED& out);
+ *   static void Decode(const T& base,const STORED& in,T& out);
+ *   static double Value(const T& item);
+ *   static void SetValue(T& item,double value);
+ * and T has a pos member.
+ */
+template <class T,class CODEC>
+class CTimeSeries
+{
+public:
+    typedef T value_type;
+
+    CTimeSeries()
+    {
+        m_nSize = 0;
+        m_mode = SERIES_DECIMATE_AVG;
+        m_nMaxSamples = 0;
+        m_nWindow = 1;
+        m_nPending = 0;
+        m_fPendingSum = 0;
+        m_pendingFirst = T();
+        m_pendingMin = T();
+        m_pendingMax = T();
+    }
+
+    //nMaxSamples 0 keeps every sample
+    void SetDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples)
+    {
+        m_mode = mode;
+        m_nMaxSamples = nMaxSamples < 2 ? 0 : nMaxSamples;
+    }
+
+    //drop the samples, keep the decimation
+    void clear()
+    {
+        m_vecChunks.clear();
+        m_nSize = 0;
+        m_nWindow = 1;
+        m_nPending = 0;
+        m_pendingFirst = T();
+        m_pendingMin = T();
+        m_pendingMax = T();
+    }
+
+    size_t size() const { return m_nSize + (m_nPending > 0 ? 1 : 0); }
+
+    bool empty() const { return size() == 0; }
+
+    //input samples folded into one stored sample
+    size_t GetWindow() const { return m_nWindow; }
+
+    void push_back(const T& item)
+    {
+        if (m_nMaxSamples == 0 || m_nWindow == 1)
+        {
+            Append(item);
+            if (m_nMaxSamples != 0 && m_nSize >= m_nMaxSamples)
+            {
+                Compact();
+            }
+            return;
+        }
+
+        double value = CODEC::Value(item);
+        if (m_nPending == 0)
+        {
+            m_pendingFirst = item;
+            m_pendingMin = item;
+            m_pendingMax = item;
+            m_fPendingSum = 0;
+        }
+        else if (value < CODEC::Value(m_pendingMin))
+        {
+            m_pendingMin = item;
+        }
+        else if (value > CODEC::Value(m_pendingMax))
+        {
+            m_pendingMax = item;
+        }
+        m_fPendingSum += value;
+
+        if (++m_nPending == m_nWindow)
+        {
+            Append(PendingItem());
+            m_nPending = 0;
+            if (m_nSize >= m_nMaxSamples)
+            {
+                Compact();
+            }
+        }
+    }
+
+    T operator[](size_t i) const
+    {
+        if (i == m_nSize)
+        {
+            return PendingItem();
+        }
+        const CHUNK& chunk = m_vecChunks[FindChunk(i)];
+        return GetItem(chunk,i - chunk.first);
+    }
+
+    //index of the first sample with pos >= llPos, size() if none
+    size_t LowerBound(long long llPos) const
+    {
+        size_t lo = 0;
+        size_t hi = m_vecChunks.size();
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            const CHUNK& chunk = m_vecChunks[mid];
+            if ((long long)chunk.base.pos + chunk.pos.back() < llPos)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == m_vecChunks.size())
+        {
+            return m_nSize;
+        }
+
+        const CHUNK& chunk = m_vecChunks[lo];
+        size_t i = 0;
+        size_t n = chunk.pos.size();
+        while (i < n)
+        {
+            size_t mid = (i + n) / 2;
+            if ((long long)chunk.base.pos + chunk.pos[mid] < llPos)
+                i = mid + 1;
+            else
+                n = mid;
+        }
+        return chunk.first + i;
+    }
+
+    //samples with llStart <= pos < llEnd
+    void GetRangeByPos(long long llStart,long long llEnd,std::vector<T>& out) const
+    {
+        for (size_t i = LowerBound(llStart); i < size(); i++)
+        {
+            T item = (*this)[i];
+            if ((long long)item.pos >= llEnd)
+            {
+                break;
+            }
+            out.push_back(item);
+        }
+    }
+
+    //samples with fMin <= value <= fMax, values are not ordered so chunks
+    //are skipped by their bounds
+    void GetRangeByValue(double fMin,double fMax,std::vector<T>& out) const
+    {
+        for (size_t c = 0; c < m_vecChunks.size(); c++)
+        {
+            const CHUNK& chunk = m_vecChunks[c];
+            if (chunk.fMax < fMin || chunk.fMin > fMax)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < chunk.pos.size(); i++)
+            {
+                T item = GetItem(chunk,i);
+                double value = CODEC::Value(item);
+                if (value >= fMin && value <= fMax)
+                {
+                    out.push_back(item);
+                }
+            }
+        }
+        if (m_nPending > 0)
+        {
+            T item = PendingItem();
+            double value = CODEC::Value(item);
+            if (value >= fMin && value <= fMax)
+            {
+                out.push_back(item);
+            }
+        }
+    }
+
+private:
+    typedef typename CODEC::STORED STORED;
+
+    typedef struct _CHUNK
+    {
+        size_t first;                   //index of base in the series
+        T base;
+        double fMin;
+        double fMax;
+        std::vector<unsigned int> pos;  //pos - base.pos
+        std::vector<STORED> value;
+    }CHUNK;
+
+    T GetItem(const CHUNK& chunk,size_t i) const
+    {
+        T item = chunk.base;
+        item.pos = chunk.base.pos + chunk.pos[i];
+        CODEC::Decode(chunk.base,chunk.value[i],item);
+        return item;
+    }
+
+    size_t FindChunk(size_t i) const
+    {
+        size_t lo = 0;
+        size_t hi = m_vecChunks.size() - 1;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi + 1) / 2;
+            if (m_vecChunks[mid].first <= i)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        return lo;
+    }
+
+    void Append(const T& item)
+    {
+        STORED stored;
+        long long llOffset = 0;
+        CHUNK* chunk = m_vecChunks.empty() ? NULL : &m_vecChunks.back();
+        if (chunk != NULL)
+        {
+            llOffset = (long long)item.pos - (long long)chunk->base.pos;
+        }
+        if (chunk == NULL || chunk->pos.size() >= SERIES_CHUNK_SIZE ||
+            llOffset < 0 || llOffset > 0xFFFFFFFFLL ||
+            !CODEC::Encode(chunk->base,item,stored))
+        {
+            m_vecChunks.push_back(CHUNK());
+            chunk = &m_vecChunks.back();
+            chunk->first = m_nSize;
+            chunk->base = item;
+            chunk->fMin = CODEC::Value(item);
+            chunk->fMax = chunk->fMin;
+            chunk->pos.reserve(SERIES_CHUNK_SIZE);
+            chunk->value.reserve(SERIES_CHUNK_SIZE);
+            llOffset = 0;
+            CODEC::Encode(item,item,stored);
+        }
+
+        double value = CODEC::Value(item);
+        if (value < chunk->fMin)
+            chunk->fMin = value;
+        if (value > chunk->fMax)
+            chunk->fMax = value;
+        chunk->pos.push_back((unsigned int)llOffset);
+        chunk->value.push_back(stored);
+        m_nSize++;
+    }
+
+    T PendingItem() const
+    {
+        if (m_mode == SERIES_DECIMATE_MIN)
+            return m_pendingMin;
+        if (m_mode == SERIES_DECIMATE_MAX)
+            return m_pendingMax;
+
+        T item = m_pendingFirst;
+        if (m_nPending > 1)
+        {
+            CODEC::SetValue(item,m_fPendingSum / m_nPending);
+        }
+        return item;
+    }
+
+    //fold the stored samples in pairs, the window doubles
+    void Compact()
+    {
+        std::vector<T> vecItems;
+        vecItems.reserve(m_nSize / 2 + 1);
+        for (size_t i = 0; i < m_nSize; i += 2)
+        {
+            T a = (*this)[i];
+            if (i + 1 == m_nSize)
+            {
+                vecItems.push_back(a);
+                break;
+            }
+            T b = (*this)[i + 1];
+            double va = CODEC::Value(a);
+            double vb = CODEC::Value(b);
+            if (m_mode == SERIES_DECIMATE_MIN)
+            {
+                vecItems.push_back(vb < va ? b : a);
+            }
+            else if (m_mode == SERIES_DECIMATE_MAX)
+            {
+                vecItems.push_back(vb > va ? b : a);
+            }
+            else
+            {
+                CODEC::SetValue(a,(va + vb) / 2);
+                vecItems.push_back(a);
+            }
+        }
+
+        m_vecChunks.clear();
+        m_nSize = 0;
+        for (size_t i = 0; i < vecItems.size(); i++)
+        {
+            Append(vecItems[i]);
+        }
+        m_nWindow *= 2;
+    }
+
+private:
+    std::vector<CHUNK> m_vecChunks;
+    size_t m_nSize;
+
+    SERIES_DECIMATE_MODE m_mode;
+    size_t m_nMaxSamples;
+    size_t m_nWindow;
+
+    //the window being filled
+    size_t m_nPending;
+    T m_pendingFirst;
+    T m_pendingMin;
+    T m_pendingMax;
+    double m_fPendingSum;
+};
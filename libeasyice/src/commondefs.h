@@ -21,6 +21,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <iostream>
 #include "ztypes.h"
 #include "json/json.h"
+#include "TimeSeries.h"
 
 //ڴɵݴСMSG_PACKET_LISTṹ
 #define PACKET_LIST_FILE_MAPPING_SIZE					1000*1000
@@ -248,7 +249,10 @@ typedef enum _FRAME_TYPE
     FRAME_SP,
     FRAME_SI,
     FRAME_UNKNOWN,
-    FRAME_NULL
+    FRAME_NULL,
+    //HEVCCRA,BLA֡
+    FRAME_CRA,
+    FRAME_BLA
 }FRAME_TYPE;
 
 typedef enum
@@ -265,12 +269,15 @@ typedef struct _PARSED_FRAME_INFO
         bNewPicture = false;
         bNewSlice = false;
         FrameType = FRAME_NULL;
+        structure = STRUCTURE_FRAME;
+        temporal_id = 0;
     }
 
     bool bNewSlice;
     bool bNewPicture;	//µ֡
     FRAME_TYPE FrameType;
     int structure;                     //!< Identify picture structure type
+    int temporal_id;	//HEVC TemporalIdΪ0
 }PARSED_FRAME_INFO;
 
 
@@ -499,30 +506,149 @@ typedef struct _TIMESTAMP
 	}
 }TIMESTAMP;
 
+//ʱ׵32λֵ洢
+typedef struct _TIMESTAMP_CODEC
+{
+    typedef int STORED;
+
+    static bool Encode(const TIMESTAMP& base,const TIMESTAMP& item,int& out)
+    {
+        long long delta = item.timestamp - base.timestamp;
+        if (delta < -0x7FFFFFFFLL || delta > 0x7FFFFFFFLL)
+        {
+            return false;
+        }
+        out = (int)delta;
+        return true;
+    }
+    static void Decode(const TIMESTAMP& base,const int& in,TIMESTAMP& out) { out.timestamp = base.timestamp + in; }
+    static double Value(const TIMESTAMP& item) { return (double)item.timestamp; }
+    static void SetValue(TIMESTAMP& item,double value) { item.timestamp = (long long)(value < 0 ? value - 0.5 : value + 0.5); }
+}TIMESTAMP_CODEC;
+
+//λ÷ֿ顢ʽ洢ʱУӿvectorͬ
+typedef CTimeSeries<TIMESTAMP,TIMESTAMP_CODEC> TIMESTAMP_SERIES;
+
+//һ·ƵĻȻʱ
+typedef struct _ES_TIMESTAMPS
+{
+    int pid;
+    int stream_type;
+
+    //PTS
+    TIMESTAMP_SERIES vecPts;
+
+    //PTS - PCR
+    TIMESTAMP_SERIES vecPtsSub;
+
+	void SetDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples) {
+		vecPts.SetDecimation(mode,nMaxSamples);
+		vecPtsSub.SetDecimation(mode,nMaxSamples);
+	}
+
+	void clear() {
+		vecPts.clear();
+		vecPtsSub.clear();
+	}
+
+	Json::Value to_json() {
+		Json::Value root;
+		root["pid"] = pid;
+		root["stream_type"] = stream_type;
+
+		Json::Value ptsArray;
+		for (size_t i = 0; i < vecPts.size(); i++) {
+			ptsArray.append(vecPts[i].to_json());
+		}
+		root["Pts"] = ptsArray;
+
+		Json::Value ptsSubArray;
+		for (size_t i = 0; i < vecPtsSub.size(); i++) {
+			ptsSubArray.append(vecPtsSub[i].to_json());
+		}
+		root["PtsSub"] = ptsSubArray;
+		return root;
+	}
+}ES_TIMESTAMPS;
+
 //һ·ĿĸʱϢ
 typedef struct _PROGRAM_TIMESTAMPS
 {
+	_PROGRAM_TIMESTAMPS()
+	{
+		decimateMode = SERIES_DECIMATE_AVG;
+		nMaxSamples = 0;
+	}
+
     //ƵPTS
-    std::vector<TIMESTAMP> vecVpts;
+    TIMESTAMP_SERIES vecVpts;
+
+    //һ·ƵPTS
+    TIMESTAMP_SERIES vecApts;
 
-    //ƵPTS <pid,timestamps>
-    std::vector<TIMESTAMP> vecApts;
-    //std::map<int,std::vector<TIMESTAMP>> mapApts;
+    //·ƵĻȻʱ <pid,timestamps>
+    std::map<int,ES_TIMESTAMPS> mapEs;
 
     //DTS
-    std::vector<TIMESTAMP> vecDts;
+    TIMESTAMP_SERIES vecDts;
 
     //PCR
-    std::vector<TIMESTAMP> vecPcr;
+    TIMESTAMP_SERIES vecPcr;
 
     //PTS - PCR
-    std::vector<TIMESTAMP> vecPtsSub;
+    TIMESTAMP_SERIES vecPtsSub;
 
     //DTS - PCR
-    std::vector<TIMESTAMP> vecDtsSub;
+    TIMESTAMP_SERIES vecDtsSub;
 
     //PTS - PCR Audio
-    std::vector<TIMESTAMP> vecAPtsSub;
+    TIMESTAMP_SERIES vecAPtsSub;
+
+    //ϲã֮Ļ
+    SERIES_DECIMATE_MODE decimateMode;
+    size_t nMaxSamples;
+
+	//ȡpidĻʱûʱǰϲü롣صclearȻЧ
+	ES_TIMESTAMPS& AddEs(int pid,int stream_type) {
+		std::map<int,ES_TIMESTAMPS>::iterator it = mapEs.find(pid);
+		if (it == mapEs.end()) {
+			it = mapEs.insert(std::map<int,ES_TIMESTAMPS>::value_type(pid,ES_TIMESTAMPS())).first;
+			it->second.pid = pid;
+			it->second.SetDecimation(decimateMode,nMaxSamples);
+		}
+		it->second.stream_type = stream_type;
+		return it->second;
+	}
+
+	//ÿеmodeϲnMaxSamplesΪ0ʱȫ
+	void SetDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples) {
+		this->decimateMode = mode;
+		this->nMaxSamples = nMaxSamples;
+		for (std::map<int,ES_TIMESTAMPS>::iterator it = mapEs.begin(); it != mapEs.end(); ++it) {
+			it->second.SetDecimation(mode,nMaxSamples);
+		}
+		vecVpts.SetDecimation(mode,nMaxSamples);
+		vecApts.SetDecimation(mode,nMaxSamples);
+		vecDts.SetDecimation(mode,nMaxSamples);
+		vecPcr.SetDecimation(mode,nMaxSamples);
+		vecPtsSub.SetDecimation(mode,nMaxSamples);
+		vecDtsSub.SetDecimation(mode,nMaxSamples);
+		vecAPtsSub.SetDecimation(mode,nMaxSamples);
+	}
+
+	//գϲ
+	void clear() {
+		vecVpts.clear();
+		vecApts.clear();
+		vecDts.clear();
+		vecPcr.clear();
+		vecPtsSub.clear();
+		vecDtsSub.clear();
+		vecAPtsSub.clear();
+		for (std::map<int,ES_TIMESTAMPS>::iterator it = mapEs.begin(); it != mapEs.end(); ++it) {
+			it->second.clear();
+		}
+	}
 
 	Json::Value to_json() {
 		Json::Value root;
@@ -565,32 +691,135 @@ typedef struct _PROGRAM_TIMESTAMPS
 
 		Json::Value aptsSubArray;
 		for (size_t i = 0; i < vecAPtsSub.size(); i++) {
-			aptsArray.append(vecAPtsSub[i].to_json());
+			aptsSubArray.append(vecAPtsSub[i].to_json());
 		}
 		root["APtsSub"] = aptsSubArray;
 
+		Json::Value esArray;
+		for (std::map<int,ES_TIMESTAMPS>::iterator it = mapEs.begin(); it != mapEs.end(); ++it) {
+			esArray.append(it->second.to_json());
+		}
+		root["Es"] = esArray;
+
 		return root;
 	}
 }PROGRAM_TIMESTAMPS;
 
-//GOPs
-typedef struct _GOP_LIST
+//GOP֡γ̣һֽΪһͬ͵֡4λΪFRAME_TYPE4λΪ֡-1
+typedef std::vector<BYTE> GOP_RUNS;
+
+#define GOP_RUN_TYPE(r)		((FRAME_TYPE)((r) >> 4))
+#define GOP_RUN_COUNT(r)	(((r) & 0x0F) + 1)
+#define GOP_RUN_MAX			16
+
+//γĩβһ֡
+inline void GopRunsAppend(GOP_RUNS& runs,FRAME_TYPE type)
+{
+    if (!runs.empty() && GOP_RUN_TYPE(runs.back()) == type && GOP_RUN_COUNT(runs.back()) < GOP_RUN_MAX)
+    {
+        runs.back()++;
+        return;
+    }
+    runs.push_back((BYTE)(type << 4));
+}
+
+//ȥγ̿ͷnFrames֡
+inline void GopRunsDropFront(GOP_RUNS& runs,int nFrames)
+{
+    size_t i = 0;
+    while (i < runs.size() && nFrames >= GOP_RUN_COUNT(runs[i]))
+    {
+        nFrames -= GOP_RUN_COUNT(runs[i]);
+        i++;
+    }
+    runs.erase(runs.begin(),runs.begin() + i);
+    if (!runs.empty() && nFrames > 0)
+    {
+        runs[0] -= nFrames;
+    }
+}
+
+//ԭַʽ"IBBPBBP","IDR-PBB"
+inline std::string GopRunsToString(const BYTE* runs,size_t nRuns)
 {
     std::string gop;
+    for (size_t i = 0; i < nRuns; i++)
+    {
+        const char* s = "";
+        switch (GOP_RUN_TYPE(runs[i]))
+        {
+        case FRAME_I: s = "I"; break;
+        case FRAME_P: s = "P"; break;
+        case FRAME_B: s = "B"; break;
+        case FRAME_IDR: s = "IDR-"; break;
+        case FRAME_SP: s = "-SP-"; break;
+        case FRAME_SI: s = "-SI-"; break;
+        case FRAME_CRA: s = "CRA-"; break;
+        case FRAME_BLA: s = "BLA-"; break;
+        default: break;
+        }
+        for (int j = 0; j < GOP_RUN_COUNT(runs[i]); j++)
+        {
+            gop += s;
+        }
+    }
+    return gop;
+}
+
+//GOPs֡γ̴PROGRAM_INFO::gopRunsУjsonʱתΪַ
+typedef struct _GOP_LIST
+{
+    //(һGOPʼ)ͿʼλõİID
     unsigned long long pos;
+    unsigned long long start_pos;
     int gop_size;
     int gop_bytes;
-
-	Json::Value to_json() {
+    //֡PESpts27MHzûʱΪ-1
+    long long pts;
+    //IDR֡ʼ
+    bool idr;
+    //γgopRunsеλü
+    unsigned int run_offset;
+    unsigned int run_count;
+
+	//͵֡
+	int CountOf(const GOP_RUNS& runs,FRAME_TYPE type) const {
+		int n = 0;
+		for (unsigned int i = run_offset; i < run_offset + run_count; i++) {
+			if (GOP_RUN_TYPE(runs[i]) == type) {
+				n += GOP_RUN_COUNT(runs[i]);
+			}
+		}
+		return n;
+	}
+	std::string to_string(const GOP_RUNS& runs) const {
+		return run_count > 0 ? GopRunsToString(&runs[run_offset],run_count) : std::string();
+	}
+	Json::Value to_json(const GOP_RUNS& runs) {
         Json::Value root;
-		root["gop"] = gop;
+		root["gop"] = to_string(runs);
 		root["pos"] = pos;
+		root["start_pos"] = start_pos;
 		root["gop_size"] = gop_size;
 		root["gop_bytes"] = gop_bytes;
+		root["pts"] = pts;
+		root["idr"] = idr;
 	    return root;
 	}
 }GOP_LIST;
 
+//δGOPֶβзʱƴӷֶα߽紦GOP
+typedef struct _GOP_STATE
+{
+    _GOP_STATE()
+    {
+        memset(&gl,0,sizeof(gl));
+        gl.pts = -1;
+    }
+    GOP_LIST gl;
+    GOP_RUNS runs;
+}GOP_STATE;
+
 //Rates
 typedef struct _RATE_LIST
 {
@@ -606,13 +835,188 @@ typedef struct _RATE_LIST
 	}
 }RATE_LIST;
 
+//ԭ洢
+typedef struct _RATE_CODEC
+{
+    typedef double STORED;
+
+    static bool Encode(const RATE_LIST& base,const RATE_LIST& item,double& out) { out = item.rate; return true; }
+    static void Decode(const RATE_LIST& base,const double& in,RATE_LIST& out) { out.rate = in; }
+    static double Value(const RATE_LIST& item) { return item.rate; }
+    static void SetValue(RATE_LIST& item,double value) { item.rate = value; }
+}RATE_CODEC;
+
+typedef CTimeSeries<RATE_LIST,RATE_CODEC> RATE_SERIES;
+
+//֡СֱͼͰkͰΪС[2^k,2^(k+1))ֽڵ֡
+#define FRAME_SIZE_HIST_BINS	32
+
+//֡ͳƵ֡I,P,B,IDR,
+#define FRAME_STATS_TYPES		5
+
+//һ֡͵ĴСֲ
+typedef struct _FRAME_TYPE_STATS
+{
+    long long count;
+    long long bytes;
+    int min_size;
+    int max_size;
+    long long hist[FRAME_SIZE_HIST_BINS];
+	Json::Value to_json() {
+		Json::Value root;
+		root["count"] = count;
+		root["bytes"] = bytes;
+		root["min_size"] = min_size;
+		root["max_size"] = max_size;
+		root["avg_size"] = count > 0 ? (double)bytes / count : 0;
+		Json::Value histArray;
+		for (int i = 0; i < FRAME_SIZE_HIST_BINS; i++) {
+			histArray.append(hist[i]);
+		}
+		root["hist"] = histArray;
+		return root;
+	}
+}FRAME_TYPE_STATS;
+
+//Ƶ֡Сʷֵͳƣ֡СΪPESصֽΪDTS110뻬
+typedef struct _FRAME_STATS
+{
+    _FRAME_STATS()
+    {
+        pid = -1;
+        clear();
+    }
+    int pid;
+    long long frames;
+    long long bytes;
+    //򱻽ضϵ֡
+    long long incomplete;
+    //֡DTS֮ͣ90kHzʱ
+    long long duration;
+    //ֵʣbpsһ֡İIDδʱΪ0
+    double peak_rate_1s;
+    unsigned long long peak_pos_1s;
+    double peak_rate_10s;
+    unsigned long long peak_pos_10s;
+    FRAME_TYPE_STATS types[FRAME_STATS_TYPES];
+
+	static int TypeIndex(FRAME_TYPE type) {
+		switch (type) {
+		case FRAME_I: return 0;
+		case FRAME_CRA: return 0;
+		case FRAME_BLA: return 0;
+		case FRAME_P: return 1;
+		case FRAME_B: return 2;
+		case FRAME_IDR: return 3;
+		default: return 4;
+		}
+	}
+	//ͳƣpid
+	void clear() {
+		frames = 0;
+		bytes = 0;
+		incomplete = 0;
+		duration = 0;
+		peak_rate_1s = 0;
+		peak_pos_1s = 0;
+		peak_rate_10s = 0;
+		peak_pos_10s = 0;
+		memset(types,0,sizeof(types));
+	}
+	//һεͳƣIDȥllShift
+	void Merge(const _FRAME_STATS& src,long long llShift) {
+		if (pid < 0) {
+			pid = src.pid;
+		}
+		frames += src.frames;
+		bytes += src.bytes;
+		incomplete += src.incomplete;
+		duration += src.duration;
+		if (src.peak_rate_1s > peak_rate_1s) {
+			peak_rate_1s = src.peak_rate_1s;
+			peak_pos_1s = src.peak_pos_1s - llShift;
+		}
+		if (src.peak_rate_10s > peak_rate_10s) {
+			peak_rate_10s = src.peak_rate_10s;
+			peak_pos_10s = src.peak_pos_10s - llShift;
+		}
+		for (int i = 0; i < FRAME_STATS_TYPES; i++) {
+			FRAME_TYPE_STATS& t = types[i];
+			const FRAME_TYPE_STATS& s = src.types[i];
+			if (s.count == 0) {
+				continue;
+			}
+			if (t.count == 0 || s.min_size < t.min_size) {
+				t.min_size = s.min_size;
+			}
+			if (s.max_size > t.max_size) {
+				t.max_size = s.max_size;
+			}
+			t.count += s.count;
+			t.bytes += s.bytes;
+			for (int j = 0; j < FRAME_SIZE_HIST_BINS; j++) {
+				t.hist[j] += s.hist[j];
+			}
+		}
+	}
+	Json::Value to_json() {
+		static const char* names[FRAME_STATS_TYPES] = { "I", "P", "B", "IDR", "other" };
+		Json::Value root;
+		root["pid"] = pid;
+		root["frames"] = frames;
+		root["bytes"] = bytes;
+		root["incomplete"] = incomplete;
+		root["avg_rate"] = duration > 0 ? bytes * 8.0 * 90000 / duration : 0;
+		root["peak_rate_1s"] = peak_rate_1s;
+		root["peak_pos_1s"] = peak_pos_1s;
+		root["peak_rate_10s"] = peak_rate_10s;
+		root["peak_pos_10s"] = peak_pos_10s;
+		Json::Value typesObj;
+		for (int i = 0; i < FRAME_STATS_TYPES; i++) {
+			if (types[i].count > 0) {
+				typesObj[names[i]] = types[i].to_json();
+			}
+		}
+		root["types"] = typesObj;
+		return root;
+	}
+}FRAME_STATS;
+
 //һ·ĿϢ
 typedef struct _PROGRAM_INFO
 {
     //ʱϢ
     PROGRAM_TIMESTAMPS tts;
     std::vector<GOP_LIST> gopList;
-    std::vector<RATE_LIST> rateList;
+    //GOP֡γ
+    GOP_RUNS gopRuns;
+    RATE_SERIES rateList;
+    FRAME_STATS frameStats;
+
+	void SetDecimation(SERIES_DECIMATE_MODE mode,size_t nMaxSamples) {
+		tts.SetDecimation(mode,nMaxSamples);
+		rateList.SetDecimation(mode,nMaxSamples);
+	}
+
+	//գϲ
+	void clear() {
+		tts.clear();
+		gopList.clear();
+		gopRuns.clear();
+		rateList.clear();
+		frameStats.clear();
+	}
+
+	//һGOP֡ΪrunsʼnRunsγ̣IDȥllShift
+	void AddGop(const GOP_LIST& gop,const BYTE* runs,size_t nRuns,long long llShift) {
+		GOP_LIST gl = gop;
+		gl.pos -= llShift;
+		gl.start_pos -= llShift;
+		gl.run_offset = (unsigned int)gopRuns.size();
+		gl.run_count = (unsigned int)nRuns;
+		gopRuns.insert(gopRuns.end(),runs,runs + nRuns);
+		gopList.push_back(gl);
+	}
 
 	Json::Value to_json() {
 		Json::Value root;
@@ -620,7 +1024,7 @@ typedef struct _PROGRAM_INFO
 
 		Json::Value gopArray;
 		for (size_t i = 0; i< gopList.size(); i++) {
-			gopArray.append(gopList[i].to_json());
+			gopArray.append(gopList[i].to_json(gopRuns));
 		}
 		root["gop_list"] = gopArray;
 
@@ -629,6 +1033,7 @@ typedef struct _PROGRAM_INFO
 			rateArray.append(rateList[i].to_json());
 		}
 		root["rate_list"] = rateArray;
+		root["frame_stats"] = frameStats.to_json();
 
 		return root;
 	}
@@ -785,6 +1190,27 @@ typedef struct _PCR_INFO_T
 typedef std::list<PCR_INFO_T> LST_PCR_INFO_T;
 
 
+//ʵʱһ·һPTS
+typedef struct _ES_PTS_INFO_T
+{
+    long long llPts;//90kHz
+    long long llPts_Sub;//ms PTS - ĿһPCRûPCRʱΪ-1
+    long long llPts_interval;//ms
+    long long llTime;//us
+
+    Json::Value to_json() {
+        Json::Value root;
+        root["llPts"] = llPts;
+        root["llPts_Sub"] = llPts_Sub;
+        root["llPts_interval"] = llPts_interval;
+        root["llTime"] = llTime;
+        return root;
+    }
+}ES_PTS_INFO_T;
+
+typedef std::list<ES_PTS_INFO_T> LST_ES_PTS_INFO_T;
+
+
 typedef struct _RATE_INFO_T
 {
     double fRate;// bit/s
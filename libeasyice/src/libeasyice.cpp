@@ -19,6 +19,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "EasyICEDLL/FileAnalysis.h"
 #include "EasyICEDLL/EiLog.h"
 #include "EasyICEDLL/LiveAnalysis.h"
+#include "EasyICEDLL/BatchAnalysis.h"
+#include "EasyICEDLL/tables/CEpgStore.h"
 #include "HlsAnalysis.h"
 
 static char* log_buffer = NULL;
@@ -57,6 +59,21 @@ static void DemoLogCb(int level,const char* module,const char* sInfo,void *pApp)
    // lpthis->m_EditLogger.AddText(log_buffer);
 }
 
+//每次分析前按 epg_memory_limit 新建 EIT schedule 存储，上次分析的存储在此释放
+static void NewEpgStore(EASYICE* handle)
+{
+    delete (tables::CEpgStore*)handle->epg_handle;
+    handle->epg_handle = NULL;
+    if (handle->epg_memory_limit > 0)
+    {
+        handle->epg_handle = new tables::CEpgStore((long long)handle->epg_memory_limit * 1024 * 1024);
+    }
+    else if (handle->epg_memory_limit < 0)
+    {
+        handle->epg_handle = new tables::CEpgStore(0);
+    }
+}
+
 void easyice_global_init()
 {
     log_buffer = new char[LOG_BUFFER_SIZE];
@@ -83,6 +100,9 @@ EASYICE* easyice_init()
     p->udplive_probe_buf_size = 3850240;
     p->udplive_cb_update_interval= 1000000; //1s
     p->udplive_calctsrate_interval_ms = 1000;//1s
+    p->file_threads = 1;
+    p->file_read_depth = 2;
+    p->file_read_block_size = 32*1024*1024;
     //memset(p->mrl,0,sizeof(p->mrl));
     //p->b_file_check_park = 0;
     //p->progress_cb_func = NULL;
@@ -108,6 +128,8 @@ void easyice_cleanup(EASYICE* handle)
         delete p;
         
     }
+    delete (tables::CEpgStore*)handle->epg_handle;
+    delete [] handle->epg_query_result;
     delete handle;
 }
 
@@ -173,6 +195,39 @@ static int setopt(EASYICE* handle,EASYICEopt option,va_list param)
         case EASYICEOPT_HLS_DATA:
             handle->hls_cb_data= va_arg(param, void *);
             break;
+        case EASYICEOPT_FILE_THREADS:
+            handle->file_threads = va_arg(param, int);
+            break;
+        case EASYICEOPT_FILE_READ_DEPTH:
+            handle->file_read_depth = va_arg(param, int);
+            break;
+        case EASYICEOPT_FILE_READ_BLOCK_SIZE:
+            handle->file_read_block_size = va_arg(param, int);
+            break;
+        case EASYICEOPT_FILE_TS_MAX_SAMPLES:
+            handle->file_ts_max_samples = va_arg(param, int);
+            break;
+        case EASYICEOPT_FILE_TS_DECIMATION:
+            handle->file_ts_decimation = va_arg(param, int);
+            break;
+        case EASYICEOPT_FILE_CHECKPOINT:
+            handle->file_checkpoint = va_arg(param, int);
+            break;
+        case EASYICEOPT_BATCH_THREADS:
+            handle->batch_threads = va_arg(param, int);
+            break;
+        case EASYICEOPT_BATCH_FUNCTION:
+            handle->batch_cb_func = va_arg(param, void *);
+            break;
+        case EASYICEOPT_BATCH_DATA:
+            handle->batch_cb_data = va_arg(param, void *);
+            break;
+        case EASYICEOPT_EPG_MEMORY_LIMIT:
+            handle->epg_memory_limit = va_arg(param, int);
+            break;
+        case EASYICEOPT_FILE_DROP_CACHE:
+            handle->file_drop_cache = va_arg(param, int);
+            break;
         default:
             break;
     }
@@ -206,12 +261,14 @@ EASYICEcode easyice_process(EASYICE* handle)
     if (strncasecmp(handle->mrl,support_protocals[PROTOCAL_FILE].ptr,support_protocals[PROTOCAL_FILE].len) == 0)
     {
         memmove(handle->mrl,handle->mrl+support_protocals[PROTOCAL_FILE].len,strlen(handle->mrl)+1-support_protocals[PROTOCAL_FILE].len);
+        NewEpgStore(handle);
         FileAnalysis* p = new FileAnalysis();
         p->OpenMRL(handle);
         delete p;
     }
     else if (strncasecmp(handle->mrl,support_protocals[PROTOCAL_UDP].ptr,support_protocals[PROTOCAL_UDP].len) == 0)
     {
+        NewEpgStore(handle);
         CLiveAnalysis* p = new CLiveAnalysis();
         handle->udplive_handle = p;
         p->OpenMRL(handle);
@@ -230,6 +287,17 @@ EASYICEcode easyice_process(EASYICE* handle)
     return EASYICECODE_OK;
 }
 
+EASYICEcode easyice_process_batch(EASYICE* handle,const char** mrls,int count)
+{
+    ei_log(LV_DEBUG,"libeasyice","api called: easyice_process_batch,%d files",count);
+    //所有文件存入同一个存储，按 original_network_id, transport_stream_id 区分
+    NewEpgStore(handle);
+    CBatchAnalysis* p = new CBatchAnalysis();
+    int ret = p->Run(handle,mrls,count,handle->batch_result);
+    delete p;
+    return ret == 0 ? EASYICECODE_OK : EASYICECODE_ERROR;
+}
+
 int easyice_getinfo(EASYICE* handle,EASYICEinfo info,void* val)
 {
     ei_log(LV_DEBUG,"libeasyice","api called: easyice_getinfo");
@@ -243,6 +311,42 @@ int easyice_getinfo(EASYICE* handle,EASYICEinfo info,void* val)
                 *phbd = &(handle->bufferduration);
                 break;
             }
+        case EASYICEINFO_BATCH_RESULT:
+            {
+                EASYICE_BATCH_RESULT** pbr = (EASYICE_BATCH_RESULT**)val;
+                *pbr = &(handle->batch_result);
+                break;
+            }
+        case EASYICEINFO_EPG_QUERY:
+            {
+                EASYICE_EPG_QUERY* pq = (EASYICE_EPG_QUERY*)val;
+                tables::CEpgStore* pStore = (tables::CEpgStore*)handle->epg_handle;
+                if (pStore == NULL)
+                {
+                    return EASYICECODE_ERROR;
+                }
+                Json::Value root;
+                pq->count = pStore->Query(pq->original_network_id,pq->transport_stream_id,pq->service_id,
+                                          pq->start_time,pq->end_time,pq->max_events,root);
+                string out = root.toStyledString();
+                delete [] handle->epg_query_result;
+                handle->epg_query_result = new char[out.size() + 1];
+                memcpy(handle->epg_query_result,out.c_str(),out.size() + 1);
+                pq->json = handle->epg_query_result;
+                break;
+            }
+        case EASYICEINFO_EPG_STATS:
+            {
+                tables::CEpgStore* pStore = (tables::CEpgStore*)handle->epg_handle;
+                if (pStore == NULL)
+                {
+                    return EASYICECODE_ERROR;
+                }
+                pStore->GetStats(handle->epg_stats);
+                EASYICE_EPG_STATS** pes = (EASYICE_EPG_STATS**)val;
+                *pes = &(handle->epg_stats);
+                break;
+            }
         default:
             break;
     }
@@ -23,6 +23,9 @@ typedef void (*easyice_progress_callback)(int pct,void *pApp);
 typedef enum _EASYICEinfo
 {
     EASYICEINFO_HLS_BUFFERDURATION,
+    EASYICEINFO_BATCH_RESULT,
+    EASYICEINFO_EPG_QUERY,
+    EASYICEINFO_EPG_STATS,
     EASYICEINFO_UNKNOWN
 }EASYICEinfo;
 
@@ -33,6 +36,53 @@ typedef struct _HlsBufferDuration
 }HlsBufferDuration;
 
 
+//批量分析，一个文件的结果及到目前为止的汇总
+typedef struct _EASYICE_BATCH_RESULT
+{
+    const char* mrl;
+    int index;//position in the list passed to easyice_process_batch
+    int ret;//0 ok, -1 failed or stopped
+    long long bytes;//file size
+    double seconds;//analysis time of this file
+
+    int files_total;
+    int files_done;//failed ones included
+    int files_failed;
+    long long bytes_done;
+    double elapsed;//seconds since the batch started
+    double mbps;//bytes_done / elapsed, MB/s
+}EASYICE_BATCH_RESULT;
+
+//批量分析回调，每个文件完成时由分析它的线程调用，不会同时调用。返回非0停止整个批量分析
+typedef int (*easyice_batch_callback)(const EASYICE_BATCH_RESULT* result,void *pApp);
+
+//EIT schedule 查询，按 original_network_id, transport_stream_id, service_id, start_time 排序返回
+typedef struct _EASYICE_EPG_QUERY
+{
+    int original_network_id;//-1 means any
+    int transport_stream_id;//-1 means any
+    int service_id;//-1 means any
+    long long start_time;//UTC seconds since 1970, events ending after it
+    long long end_time;//UTC seconds since 1970, events starting before it, 0 means no end
+    int max_events;//0 means no limit
+
+    int count;//out: number of events
+    const char* json;//out: {"events":[...],"count":n,"truncated":bool}, valid until the next query or easyice_cleanup
+}EASYICE_EPG_QUERY;
+
+//EIT schedule 存储的统计
+typedef struct _EASYICE_EPG_STATS
+{
+    int services;
+    long long events;
+    long long sections;//schedule sections indexed
+    long long sections_repeated;//dropped as a repetition of an indexed section
+    long long sections_updated;//indexed section sent again with a new version or content
+    long long events_dropped;//not stored because the memory limit was reached
+    long long memory_bytes;
+    long long memory_limit;//0 when the store has no limit
+}EASYICE_EPG_STATS;
+
 typedef struct _EASYICE
 {
     char mrl[1024];
@@ -57,6 +107,24 @@ typedef struct _EASYICE
     void *hls_cb_func;
     void *hls_cb_data;
     HlsBufferDuration bufferduration;
+
+    int file_threads;//used for file analysis, number of ranges analyzed in parallel, <= 1 means single thread
+    int file_read_depth;//used for file analysis, number of blocks read ahead by a reader thread, 0 means read in the analysis thread
+    int file_read_block_size;//used for file analysis, size of a read block (bytes)
+    int file_ts_max_samples;//used for file analysis, max samples kept per timestamp/rate list of a program, 0 means keep all
+    int file_ts_decimation;//used for file analysis, how samples are folded over the limit: 0 average, 1 min, 2 max
+    int file_checkpoint;//used for file analysis, 1 saves the results to <mrl>.checkpoint and resumes from it when the file has grown, 0 off
+    int file_drop_cache;//used for file analysis, 1 drops the pages already analyzed from the page cache (also for other readers of the file), 0 keeps them
+
+    int batch_threads;//used for batch analysis, files analyzed at the same time, 0 means one per cpu
+    void *batch_cb_func;
+    void *batch_cb_data;
+    EASYICE_BATCH_RESULT batch_result;//aggregate of the last batch, see EASYICEINFO_BATCH_RESULT
+
+    int epg_memory_limit;//used for file, batch and udplive analysis, MB kept for the EIT schedule store, -1 means a store without limit, 0 means no store: schedule EITs are written to .psi.json
+    void* epg_handle;
+    EASYICE_EPG_STATS epg_stats;//see EASYICEINFO_EPG_STATS
+    char* epg_query_result;
 }EASYICE;
 
 typedef enum _EASYICEcode
@@ -80,6 +148,17 @@ typedef enum _EASYICEopt
     EASYICEOPT_UDPLIVE_LOCAL_IP, 
     EASYICEOPT_HLS_FUNCTION,
     EASYICEOPT_HLS_DATA,
+    EASYICEOPT_FILE_THREADS,
+    EASYICEOPT_FILE_READ_DEPTH,
+    EASYICEOPT_FILE_READ_BLOCK_SIZE,
+    EASYICEOPT_FILE_TS_MAX_SAMPLES,
+    EASYICEOPT_FILE_TS_DECIMATION,
+    EASYICEOPT_FILE_CHECKPOINT,
+    EASYICEOPT_BATCH_THREADS,
+    EASYICEOPT_BATCH_FUNCTION,
+    EASYICEOPT_BATCH_DATA,
+    EASYICEOPT_EPG_MEMORY_LIMIT,
+    EASYICEOPT_FILE_DROP_CACHE,
     EASYICEOPT_UNKNOWN
 }EASYICEopt;
 
@@ -115,11 +194,13 @@ typedef enum _UDPLIVE_CALLBACK_TYPE
    UDPLIVE_CALLBACK_MEDIAFINO, //只调用一次
    UDPLIVE_CALLBACK_FFPROBE, //只调用一次
    UDPLIVE_CALLBACK_PIDS,
-   UDPLIVE_CALLBACK_PSI,//只调用一次
+   UDPLIVE_CALLBACK_PSI,//采样结束时调用一次，之后PSI/SI表版本更新时再次调用
    UDPLIVE_CALLBACK_TR101290,
    UDPLIVE_CALLBACK_PCR,
    UDPLIVE_CALLBACK_RATE,
    UDPLIVE_CALLBACK_PROGRAM_INFO_BRIEF,
+   UDPLIVE_CALLBACK_ES_PTS, //各节目音频，字幕等基本流的PTS
+   UDPLIVE_CALLBACK_FRAME_STATS, //各节目视频的帧大小与峰值码率
    UDPLIVE_CALLBACK_UNKNOW
 }UDPLIVE_CALLBACK_TYPE;
 
@@ -1075,21 +1075,6 @@ namespace tables{
 		}
     }TABLES;
 
-    //
-    //typedef struct _SECTION_DATA
-    //{
-    //	_SECTION_DATA() : bFinish(false){}
-    //
-    //   vector<vector<BYTE>> vecSections;
-    //
-    //   //last_section_numberжǷѾ
-    //   bool bFinish;
-    //}SECTION_DATA;
-    //׼ֱ֧汾Ÿµ
-    //ͬһpid£һ֮ǰΪݳ
-
-
-
     //һsection
     typedef struct _SECTION
     {
@@ -1100,43 +1085,6 @@ namespace tables{
 
     typedef vector<SECTION> TABLE_SECTIONS;
 
-    //ĳsection,һı
-    typedef struct _TABLE_ID_SECTION
-    {
-        _TABLE_ID_SECTION() : bFinish(false){}
-        int table_id;
-        bool bFinish;	//last_section_numberжǷѾꡣȫЧ̫漰
-        TABLE_SECTIONS sections;
-    }TABLE_ID_SECTION;
-
-
-    //ĳһpidsection.
-    //һpidܻ.PMTĶҲŵ
-    typedef vector<TABLE_ID_SECTION> PID_SECTIONS;
-
-    typedef struct _PID_SECTION_BUILDING
-    {
-        _PID_SECTION_BUILDING()
-        {
-            curSectionIdx = 0;
-        }
-
-        TABLE_ID_SECTION* get_cur_table_id_section()
-        {
-            if (pid_sections.empty())
-            {
-                return NULL;
-            }
-            return &pid_sections[curSectionIdx];
-        }
-        int curSectionIdx;
-        PID_SECTIONS pid_sections;
-    }PID_SECTION_BUILDING;
-
-
-    //pidsection Ļ
-    typedef map<int,PID_SECTION_BUILDING> SECTION_BUFFER;
-
     typedef struct _TREAM_TYPE_DES
     {
         u_int    from;          /* e.g. from id 1  */
@@ -102,22 +102,25 @@ void CTsAnalysis::OnRecvSegment(BYTE* pData,int nLen,const string& url)
 
 	//开始各项分析
 	
-	CTsPacket tspacket;
-	for (int i = 0; i < nLen; i+=188)
+	//整个分片的包头解析一次，再批量交给各模块
+	vector<TS_PACKET_INFO> vecInfo(nLen / 188);
+	for (int k = 0; k < (int)vecInfo.size(); k++)
 	{
-		tspacket.SetPacket(pData+i);
-		int pid = tspacket.Get_PID();
+		TS_PACKET_INFO& info = vecInfo[k];
+		ParseTsPacketInfo(pData+k*188,info);
 
 		//is have null packet?
-		if (pid == 0x1FFF && !m_bReportedNullPkt)
+		if (info.sync && info.pid == 0x1FFF && !m_bReportedNullPkt)
 		{
 			m_pMsgMgr->HlsPostMessage(EM_HRT_DIAGNOSIS_HASNULLPKT,("warning"),("ts"),(""));
 			m_bReportedNullPkt = true;
 		}
+	}
 
-		m_pTrcore->AddPacket(pData+i);
-		//m_pMpegdec->LiveProcessPacket2(pData+i);
-		m_pMpegdec->LiveProcessPacket(pData+i);
+	if (!vecInfo.empty())
+	{
+		m_pTrcore->AddPackets(&vecInfo[0],(int)vecInfo.size());
+		m_pMpegdec->LiveProcessPackets(&vecInfo[0],(int)vecInfo.size());
 	}
 
 	if (!IsStartWithPatPmt(pData,nLen,url))
@@ -13,7 +13,6 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Demux.h"
 #include "global.h"
 #include "TrCore.h"
-#include "csysclock.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,9 +26,10 @@ CDemux::CDemux(CTrCore* pParent)
 	m_pParent = pParent;
 
 	m_pPsiCk = new CPsiCheck(pParent);
-	m_h_dvbpsi_pat = dvbpsi_AttachPAT(DumpPAT, this);
+	m_pParent->GetSectionAssembler()->AddConsumer(this);
+	m_nPatVersion = -1;
 	m_bDemuxFinish = false;
-	m_nUsedPcrPid = -1;
+	m_pClock = NULL;
 	m_pOldOccurTime = new long long[8192];
 	m_pKnownPid = new bool[8192];
 	
@@ -60,203 +60,251 @@ CDemux::~CDemux()
 	vector<PROGRAM_INFO>::iterator it = m_vecDemuxInfoBuf.begin();
 	for (;it != m_vecDemuxInfoBuf.end(); ++it)
 	{
-		delete it->pCalcPcrN1;
+		delete it->pClock;
 	}
+}
+
 
-	dvbpsi_DetachPAT(m_h_dvbpsi_pat);
 
+void CDemux::OnSection(const SECTION_SPAN_T& section)
+{
+	m_pPsiCk->OnSection(section);
+
+	//PAT PMTֻCRCȷҵǰЧĳsection
+	const BYTE* p = section.pData;
+	if (!section.bValid || !(p[1] & 0x80) || section.nLength < 12 || !(p[5] & 0x01))
+	{
+		return;
+	}
 
-	map<int,PMTINFO>::iterator itmap = m_mapPmtmInfo.begin();
-	for (; itmap != m_mapPmtmInfo.end(); ++itmap)
+	if (section.pid == 0 && p[0] == 0x00)
 	{
-		dvbpsi_DetachPMT(itmap->second.handle);
+		DecodePAT(section);
+	}
+	else if (p[0] == 0x02 && !m_bDemuxFinish)
+	{
+		DecodePMT(section);
 	}
 }
 
+void CDemux::DecodePAT(const SECTION_SPAN_T& section)
+{
+	const BYTE* p = section.pData;
+	int end = section.nLength - 4;
+	int version = (p[5] >> 1) & 0x1F;
+	int section_number = p[6];
+	int last_section_number = p[7];
+
+	//ÿ汾PATеPIDsectionsectionıҲҪ
+	CSectionAssembler* pSections = m_pParent->GetSectionAssembler();
+	for (int pos = 8; pos + 4 <= end; pos += 4)
+	{
+		pSections->AddPid(((p[pos+2] & 0x1F) << 8) | p[pos+3]);
+	}
 
+	//°汾ռsectionͬһ汾յsectionٴ
+	if (version != m_nPatVersion)
+	{
+		m_nPatVersion = version;
+		m_mapPatNext.clear();
+		m_setPatSection.clear();
+	}
+	else if (m_setPatSection.find(section_number) != m_setPatSection.end())
+	{
+		return;
+	}
+	m_setPatSection.insert(section_number);
 
-void CDemux::Demux(uint8_t* pPacket)
-{
+	for (int pos = 8; pos + 4 <= end; pos += 4)
+	{
+		int program_number = (p[pos] << 8) | p[pos+1];
+		int pid = ((p[pos+2] & 0x1F) << 8) | p[pos+3];
+		if (program_number != 0)	// 0 is nit
+		{
+			m_mapPatNext[program_number] = pid;
+		}
 
+		m_pKnownPid[pid] = true;
+		m_mapUnReferPid.erase(pid);
+	}
 
-	uint16_t i_pid = ((uint16_t)(pPacket[1] & 0x1f) << 8) + pPacket[2];
+	if ((int)m_setPatSection.size() == last_section_number + 1)
+	{
+		ApplyPat();
+	}
+}
 
-	if (m_mapPmtmInfo.empty())
+void CDemux::ApplyPat()
+{
+	//°汾лPMT PID˵ĽĿɾ
+	map<int,PMTINFO>::iterator it = m_mapPmtmInfo.begin();
+	while (it != m_mapPmtmInfo.end())
 	{
-		if(i_pid == 0x0)
+		map<int,int>::iterator it_next = m_mapPatNext.find(it->first);
+		if (it_next == m_mapPatNext.end() || it_next->second != it->second.pmt_pid)
 		{
-			dvbpsi_PushPacket(m_h_dvbpsi_pat, pPacket);
+			int program_number = it->first;
+			int pmt_pid = it->second.pmt_pid;
+			m_mapPmtmInfo.erase(it++);
+			RemoveProgram(program_number,pmt_pid);
+		}
+		else
+		{
+			++it;
 		}
-		return;
 	}
-	else	// pmt
+
+	//ĽĿȴPMTѽı
+	map<int,int>::iterator it_next = m_mapPatNext.begin();
+	for (; it_next != m_mapPatNext.end(); ++it_next)
 	{
-		map<int,PMTINFO>::iterator it = m_mapPmtmInfo.begin();
-		for (; it != m_mapPmtmInfo.end(); ++it)
+		if (m_mapPmtmInfo.find(it_next->first) == m_mapPmtmInfo.end())
 		{
-			if (it->second.pmt_pid == i_pid)
-			{
-				dvbpsi_PushPacket (it->second.handle,pPacket);
-			}
+			PMTINFO pmtinfo;
+			pmtinfo.pmt_pid = it_next->second;
+			m_mapPmtmInfo[it_next->first] = pmtinfo;
+
+			m_pPsiCk->AddPmtPid(it_next->second,it_next->first);
 		}
 	}
-	
 
-	//жǷ
-	map<int,PMTINFO>::iterator it = m_mapPmtmInfo.begin();
-	for (; it != m_mapPmtmInfo.end(); ++it)
+	m_bDemuxFinish = !m_mapPmtmInfo.empty();
+	for (it = m_mapPmtmInfo.begin(); it != m_mapPmtmInfo.end(); ++it)
 	{
 		if (!it->second.parsed)
 		{
-			//m_vecDemuxInfoBuf.clear();
-			return;
+			m_bDemuxFinish = false;
+			break;
 		}
 	}
-
-	
-
-	m_bDemuxFinish = true;
-
+	ei_log(LV_DEBUG,"libtr101290", "PAT version %d decode finish,program count:%d",m_nPatVersion,(int)m_mapPmtmInfo.size());
 }
 
-/*****************************************************************************
- * DumpPAT
- *****************************************************************************/
-void CDemux::DumpPAT(void* p_zero, dvbpsi_pat_t* p_pat)
+void CDemux::RemoveProgram(int program_number,int pmt_pid)
 {
-	CDemux * lpthis = (CDemux*) p_zero;
-	dvbpsi_pat_program_t* p_program = p_pat->p_first_program;
-	int count = 0;
-	while(p_program)
+	vector<PROGRAM_INFO>::iterator it = m_vecDemuxInfoBuf.begin();
+	while (it != m_vecDemuxInfoBuf.end())
 	{
-		count++;
-		if (p_program->i_number != 0)	// 0 is nit
+		if (it->nProgramNumber != program_number)
 		{
-			PMTINFO pmtinfo;
-			pmtinfo.pmt_pid = p_program->i_pid;
-			pmtinfo.handle = dvbpsi_AttachPMT(p_program->i_number, DumpPMT, p_zero);
-
-			lpthis->m_mapPmtmInfo[p_program->i_number] = pmtinfo;
-
-			lpthis->m_pPsiCk->AddPmtPid(p_program->i_pid,p_program->i_number);
-			
+			++it;
+			continue;
 		}
-		//else if (m_pCrcCkHds[p_program->i_pid] != NULL), newHadle....
-
-		lpthis->m_pKnownPid[p_program->i_pid] = true;
-		lpthis->m_mapUnReferPid.erase(p_program->i_pid);
-
-		p_program = p_program->p_next;
+		//ϵͳʱڵĽĿɾһPCRѡ
+		if (it->pClock == m_pClock)
+		{
+			m_pClock = NULL;
+			m_llFirstPcr = -1;
+		}
+		delete it->pClock;
+		it = m_vecDemuxInfoBuf.erase(it);
 	}
 
-	ei_log(LV_DEBUG,"libtr101290", "PAT decode finish,program count:%d",count);
-	dvbpsi_DeletePAT(p_pat);
-
+	//ĿõPMT PID
+	map<int,PMTINFO>::iterator it_pmt = m_mapPmtmInfo.begin();
+	for (; it_pmt != m_mapPmtmInfo.end(); ++it_pmt)
+	{
+		if (it_pmt->second.pmt_pid == pmt_pid)
+		{
+			return;
+		}
+	}
+	m_pPsiCk->RemovePmtPid(pmt_pid);
 }
 
-/*****************************************************************************
- * DumpPMT
- *****************************************************************************/
-void CDemux::DumpPMT(void* p_zero, dvbpsi_pmt_t* p_pmt)
+void CDemux::DecodePMT(const SECTION_SPAN_T& section)
 {
-	CDemux * lpthis = (CDemux*) p_zero;
-	dvbpsi_pmt_es_t* p_es = p_pmt->p_first_es;
-
-	ei_log(LV_DEBUG,"libtr101290","PMT decode info: program_number=0x%02x (%d) ",p_pmt->i_program_number,p_pmt->i_program_number);
-	ei_log( LV_DEBUG,"libtr101290", "PCR_PID=0x%x (%d)",p_pmt->i_pcr_pid, p_pmt->i_pcr_pid);
+	const BYTE* p = section.pData;
+	int program_number = (p[3] << 8) | p[4];
+	int pcr_pid = ((p[8] & 0x1F) << 8) | p[9];
 
-	map<int,PMTINFO>::iterator it = lpthis->m_mapPmtmInfo.find(p_pmt->i_program_number);
-	if (it == lpthis->m_mapPmtmInfo.end())
+	map<int,PMTINFO>::iterator it = m_mapPmtmInfo.find(program_number);
+	if (it == m_mapPmtmInfo.end() || it->second.pmt_pid != section.pid || it->second.parsed)
 		return;
 
-	lpthis->m_pKnownPid[p_pmt->i_pcr_pid] = true;
-	lpthis->m_mapUnReferPid.erase(p_pmt->i_pcr_pid);
+	ei_log(LV_DEBUG,"libtr101290","PMT decode info: program_number=0x%02x (%d) ",program_number,program_number);
+	ei_log( LV_DEBUG,"libtr101290", "PCR_PID=0x%x (%d)",pcr_pid, pcr_pid);
+
+	m_pKnownPid[pcr_pid] = true;
+	m_mapUnReferPid.erase(pcr_pid);
 
 	PROGRAM_INFO prog_info;
-	while(p_es != NULL)
+	int end = section.nLength - 4;
+	int pos = 12 + (((p[10] & 0x0F) << 8) | p[11]);
+	while (pos + 5 <= end)
 	{
-		ei_log(LV_DEBUG,"libtr101290","es_pid=0x%02x (%d)  stream_type=0x%x",p_es->i_pid, p_es->i_pid,p_es->i_type);
-
 		ES_INFO es_info;
-		es_info.pid = p_es->i_pid;
-		es_info.stream_type = p_es->i_type;
+		es_info.pid = ((p[pos+1] & 0x1F) << 8) | p[pos+2];
+		es_info.stream_type = p[pos];
+		ei_log(LV_DEBUG,"libtr101290","es_pid=0x%02x (%d)  stream_type=0x%x",es_info.pid, es_info.pid,es_info.stream_type);
+
 		prog_info.vecPayloadPid.push_back(es_info);
 
-		lpthis->m_pKnownPid[p_es->i_pid] = true;
-		lpthis->m_mapUnReferPid.erase(p_es->i_pid);
+		m_pKnownPid[es_info.pid] = true;
+		m_mapUnReferPid.erase(es_info.pid);
 
-		p_es = p_es->p_next;
+		pos += 5 + (((p[pos+3] & 0x0F) << 8) | p[pos+4]);
 	}
 
 
-	it->second.pcr_pid = p_pmt->i_pcr_pid;
-	prog_info.nPcrPid = p_pmt->i_pcr_pid;
+	it->second.pcr_pid = pcr_pid;
+	prog_info.nPcrPid = pcr_pid;
 	prog_info.nPmtPid = it->second.pmt_pid;
-	prog_info.pCalcPcrN1 = new CCalcPcrN1();
+	prog_info.nProgramNumber = program_number;
+	prog_info.pClock = new CClockRecovery();
 
 	it->second.parsed = true;
 
-	lpthis->m_vecDemuxInfoBuf.push_back(prog_info);
-	dvbpsi_DeletePMT(p_pmt);
-}
+	m_vecDemuxInfoBuf.push_back(prog_info);
 
-void CDemux::AddPacket(uint8_t* pPacket)
-{
-	//demux
-	if (!m_bDemuxFinish)
+	//жǷ
+	for (it = m_mapPmtmInfo.begin(); it != m_mapPmtmInfo.end(); ++it)
 	{
-		Demux(pPacket);
+		if (!it->second.parsed)
+		{
+			return;
+		}
 	}
-
-	UpdateClock(pPacket);
-
-	ProcessPacket(pPacket);
+	m_bDemuxFinish = true;
 }
 
-void CDemux::UpdateClock(uint8_t* pPacket)
+void CDemux::AddPacket(const TS_PACKET_INFO& info)
 {
-	CTsPacket tsPacket;
-	tsPacket.SetPacket(pPacket);
-	int pid = tsPacket.Get_PID();
+	//PSI/SIsectionõsectionOnSectionʹ
+	m_pParent->GetSectionAssembler()->Push(info.pPacket);
 
-	//find first eff pcr
-	if (m_nUsedPcrPid < 0)
-	{
-		vector<PROGRAM_INFO>::iterator it = m_vecDemuxInfoBuf.begin();
-		for (;it != m_vecDemuxInfoBuf.end(); ++it)
-		{
-			if (pid == it->nPcrPid && tsPacket.Get_PCR_flag())
-			{
-				m_nUsedPcrPid = pid;
-			}
-		}
-	}
+	UpdateClock(info);
+
+	ProcessPacket(info);
+}
 
-	if (m_nUsedPcrPid < 0)
+void CDemux::UpdateClock(const TS_PACKET_INFO& info)
+{
+	//find first eff pcrĿʱCheckPCR£ʱԼ
+	if (m_pClock != NULL || !info.pcr_flag)
 	{
 		return;
 	}
 
-	if (pid == m_nUsedPcrPid && tsPacket.Get_PCR_flag())
+	vector<PROGRAM_INFO>::iterator it = m_vecDemuxInfoBuf.begin();
+	for (;it != m_vecDemuxInfoBuf.end(); ++it)
 	{
-		//PCR
-		long long calcPCr = m_pParent->m_pSysClock->GetPcr();
-		long long curPcr = tsPacket.Get_PCR();
-		if ( calcPCr >= 0 && llabs( diff_pcr(calcPCr,curPcr))  > 270000 )
-		{
-			m_pParent->m_pSysClock->Reset(); //10msΪ
-		}
-
-		m_pParent->m_pSysClock->AddPcrPacket(curPcr);
-		if (m_llFirstPcr < 0) 
+		if (info.pid == it->nPcrPid)
 		{
-			m_llFirstPcr = curPcr;
+			m_pClock = it->pClock;
+			m_llFirstPcr = info.pcr;
+			return;
 		}
 	}
-	else
+}
+
+long long CDemux::GetCurTime() const
+{
+	if (m_pClock == NULL)
 	{
-		m_pParent->m_pSysClock->AddPayloadPacket();
+		return -1;
 	}
+	return m_pClock->TimeAt(m_pParent->GetOffset());
 }
 
 inline bool CDemux::IsPmtPid(int pid)
@@ -284,7 +332,7 @@ inline long long CDemux::CheckOccTime(int pid,long long llCurTime)
 	return interval;
 }
 
-bool CDemux::CheckEsPid(int pid,long long llCurTime,CTsPacket& tsPacket)
+bool CDemux::CheckEsPid(int pid,long long llCurTime,const TS_PACKET_INFO& info)
 {
 	bool bEsPid = false;
 	vector<PROGRAM_INFO>::iterator it = m_vecDemuxInfoBuf.begin();
@@ -322,8 +370,10 @@ bool CDemux::CheckEsPid(int pid,long long llCurTime,CTsPacket& tsPacket)
 
 				//check pts
 				long long pts;
-				long long calcPCr = m_pParent->m_pSysClock->GetPcr();
-				if (tsPacket.Get_PTS(pts) && ites->llPrevPts_occ >= 0)
+				long long calcPCr = llCurTime;
+				CTsPacket tsPacket;
+				tsPacket.SetPacket(info);
+				if (info.pusi && tsPacket.Get_PTS(pts) && ites->llPrevPts_occ >= 0)
 				{
 					m_pParent->Report(2,LV2_PTS_ERROR,pid,diff_pcr(calcPCr, ites->llPrevPts_occ),-1);
 					//Report(2,LV2_PTS_ERROR,pid,pts-ites->llPrevPts,-1);
@@ -339,42 +389,36 @@ bool CDemux::CheckEsPid(int pid,long long llCurTime,CTsPacket& tsPacket)
 	return bEsPid;
 }
 
-void CDemux::CheckPCR(int pid,CTsPacket& tsPacket)
+void CDemux::CheckPCR(int pid,const TS_PACKET_INFO& info)
 {
+	if (!info.pcr_flag)
+	{
+		return;
+	}
+
+	long long llOffset = m_pParent->GetOffset();
 	vector<PROGRAM_INFO>::iterator it = m_vecDemuxInfoBuf.begin();
 	for (;it != m_vecDemuxInfoBuf.end(); ++it)
 	{
-		if (pid == it->nPcrPid && tsPacket.Get_PCR_flag())
+		if (pid == it->nPcrPid)
 		{
-			long long pcr = tsPacket.Get_PCR();
-			
-			BYTE afLen;
-			BYTE* pAf = tsPacket.Get_adaptation_field(afLen);
-			int discontinuity_indicator = 0;
-			if (pAf != NULL)
-			{
-				if (tsPacket.Get_discontinuity_indicator(pAf)) discontinuity_indicator = 1;
-			}
+			long long pcr = info.pcr;
+			int discontinuity_indicator = info.discontinuity ? 1 : 0;
 
 			//check pcr it
-			long long pcr_prev = it->pCalcPcrN1->GetPcrPrev();
+			long long pcr_prev = it->pClock->GetLastPcr();
 			if (pcr_prev != -1)
 			{
-				m_pParent->Report(2,LV2_PCR_REPETITION_ERROR,pid, pcr - pcr_prev,discontinuity_indicator);
+				m_pParent->Report(2,LV2_PCR_REPETITION_ERROR,pid, CClockRecovery::DiffPcr(pcr,pcr_prev),discontinuity_indicator);
 			}
 
-			//check pcr ac
-			long long pcr_calc = it->pCalcPcrN1->GetPcr();
-			if (pcr_calc != -1)
+			//check pcr acʱӰֽƫֵȽ
+			if (it->pClock->IsLocked())
 			{
-				m_pParent->Report(2,LV2_PCR_ACCURACY_ERROR,pid, pcr - pcr_calc,-1);
+				m_pParent->Report(2,LV2_PCR_ACCURACY_ERROR,pid, CClockRecovery::DiffPcr(pcr,it->pClock->TimeAt(llOffset)),-1);
 			}
 
-			it->pCalcPcrN1->AddPcrPacket(pcr);
-		}
-		else
-		{
-			it->pCalcPcrN1->AddPayloadPacket();
+			it->pClock->AddPcr(llOffset,pcr,info.discontinuity);
 		}
 	}
 }
@@ -415,13 +459,13 @@ void CDemux::CheckUnreferPid(int pid,long long llCurTime)
 }
 
 
-void CDemux::ProcessPacket(uint8_t* pPacket)
+void CDemux::ProcessPacket(const TS_PACKET_INFO& info)
 {
 	CTsPacket tsPacket;
-	tsPacket.SetPacket(pPacket);
-	int pid = tsPacket.Get_PID();
+	tsPacket.SetPacket(info);
+	int pid = info.pid;
 
-	long long llCurTime = m_pParent->m_pSysClock->GetPcr();
+	long long llCurTime = GetCurTime();
 	long long interval;
 
 	bool bPsi = false;
@@ -446,7 +490,7 @@ void CDemux::ProcessPacket(uint8_t* pPacket)
 		}
 
 		//check scf
-		if (tsPacket.Get_transport_scrambling_control() != 0)
+		if (info.scrambling_control != 0)
 		{
 			m_pParent->Report(1,LV1_PAT_ERROR_SCF,0,-1,-1);
 		}
@@ -464,7 +508,7 @@ void CDemux::ProcessPacket(uint8_t* pPacket)
 		}
 
 		//check scf
-		if (tsPacket.Get_transport_scrambling_control() != 0)
+		if (info.scrambling_control != 0)
 		{
 			m_pParent->Report(1,LV1_PMT_ERROR_SCF,pid,-1,-1);
 		}
@@ -489,20 +533,14 @@ void CDemux::ProcessPacket(uint8_t* pPacket)
 	}
 
 
-	bool bEsPid = false;
 	//pid err and pts err
 	if (llCurTime > 0)
 	{
-		bEsPid = CheckEsPid(pid,llCurTime,tsPacket);
+		CheckEsPid(pid,llCurTime,info);
 	}
 
-	m_pPsiCk->AddPacket(pPacket,bEsPid,pid);
-	
-
-	
-
 	//check pcr error
-	CheckPCR(pid,tsPacket);
+	CheckPCR(pid,info);
 
 	if (!bPsi)
 	{
@@ -13,12 +13,15 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #ifndef CDEMUX_H
 #define CDEMUX_H
 
-#include "ccalcpcrn1.h"
+#include "ClockRecovery.h"
 #include "PsiCheck.h"
+#include "SectionAssembler.h"
 #include "tr101290_defs.h"
 #include "TsPacket.h"
+#include "TsPacketInfo.h"
 #include "config.h"
 #include <map>
+#include <set>
 #include <vector>
 
 
@@ -29,7 +32,7 @@ using namespace std;
 class CTrCore;
 
 ///@brief Demux and parse
-class CDemux
+class CDemux : public ISectionConsumer
 {
 // the structs define move to CDemux, avoid to redefine in comondefs.h in libeasyice of struct PROGRAM_INFO
 typedef struct _PMTINFO
@@ -42,7 +45,6 @@ typedef struct _PMTINFO
 	}
 	int pmt_pid;
 	int pcr_pid;
-	dvbpsi_handle handle;
 	bool parsed;
 }PMTINFO;
 
@@ -67,11 +69,14 @@ typedef struct _PROGRAM_INFO
 	{
 		nPcrPid = -1;
 		nPmtPid = -1;
-		pCalcPcrN1 = NULL;
+		nProgramNumber = -1;
+		pClock = NULL;
 	}
 	int nPcrPid;
 	int nPmtPid;
-	CCalcPcrN1* pCalcPcrN1;
+	int nProgramNumber;
+	//ĿϵͳʱӣֽƫΪλ
+	CClockRecovery* pClock;
 	std::vector<ES_INFO> vecPayloadPid;
 }PROGRAM_INFO;
 
@@ -80,45 +85,62 @@ public:
 	CDemux(CTrCore* pParent);
 	~CDemux();
 
-	void AddPacket(uint8_t* pPacket);
+	void AddPacket(const TS_PACKET_INFO& info);
 
 	//PATPMTǷ
 	bool IsDemuxFinish();
 
+	//ǰϵͳʱӣûPCRʱΪ-1
+	long long GetCurTime() const;
+
+	//CTrCoreõsectionPSI/SI飬ٴPAT PMTõĿPID
+	virtual void OnSection(const SECTION_SPAN_T& section);
+
 private:
-	void Demux(uint8_t* pPacket);
-	void ProcessPacket(uint8_t* pPacket);
-	void UpdateClock(uint8_t* pPacket);
+	void ProcessPacket(const TS_PACKET_INFO& info);
+	void UpdateClock(const TS_PACKET_INFO& info);
+
+	void DecodePAT(const SECTION_SPAN_T& section);
+
+	//һ汾PAT󣬰еĽĿm_mapPmtmInfo
+	void ApplyPat();
 
-	static void DumpPAT(void* p_zero, dvbpsi_pat_t* p_pat);
-	static void DumpPMT(void* p_zero, dvbpsi_pmt_t* p_pmt);
+	//ɾѲPATеĽĿ
+	void RemoveProgram(int program_number,int pmt_pid);
+	void DecodePMT(const SECTION_SPAN_T& section);
 
 private:
 	bool IsPmtPid(int pid);
 	long long CheckOccTime(int pid,long long llCurTime);
 
 	//check es pid err and pts err,return true if the pid is an es pid,otherwide return false
-	bool CheckEsPid(int pid,long long llCurTime,CTsPacket& tsPacket);
+	bool CheckEsPid(int pid,long long llCurTime,const TS_PACKET_INFO& info);
 
-	//check pcr error
-	void CheckPCR(int pid,CTsPacket& tsPacket);
+	//check pcr errorPCRĿʱ
+	void CheckPCR(int pid,const TS_PACKET_INFO& info);
 
 	//check LV3_UNREFERENCED_PID
 	void CheckUnreferPid(int pid,long long llCurTime);
 
 	void InitCrcCk();
 private:
-	dvbpsi_handle m_h_dvbpsi_pat;
-
 	CTrCore* m_pParent;
 
+	//ǰPATversion_number-1ΪûPAT
+	int m_nPatVersion;
+
+	//ڽյİ汾PATprogram_number pmt_pid
+	std::map<int,int> m_mapPatNext;
+
+	//˰汾յPAT section_number
+	std::set<int> m_setPatSection;
+
 	//PATPMTǷ
 	bool m_bDemuxFinish;
 
-	//ѡõһPCRΪϵͳʱ
-	int m_nUsedPcrPid;
+	//ѡõһPCRĽĿʱΪϵͳʱ
+	CClockRecovery* m_pClock;
 
-	//CCalcPcrN1 m_calcPcrN1;
 	CPsiCheck *m_pPsiCk;
 
 	long long m_llFirstPcr;
@@ -13,8 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "PsiCheck.h"
 #include "global.h"
 #include "TrCore.h"
-#include "csysclock.h"
-#include "CBit.h"
+#include "BitReader.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -47,20 +46,20 @@ CPsiCheck::CPsiCheck(CTrCore* pParent)
 {
 	m_pParent = pParent;
 
-	m_pAllCkHds = new dvbpsi_handle[8192];
 	m_pOldOccurTime = new long long[256];
 	
-	for (int i = 0; i < 8192; i++)
+	for (int i = 0; i < 256; i++)
 	{
-		m_pAllCkHds[i] = NULL;
-
-		if (i < 256)
-		{
-			m_pOldOccurTime[i] = -1;
-		}
+		m_pOldOccurTime[i] = -1;
 	}
 
-	InitAllCkHds();
+	CSectionAssembler* pSections = m_pParent->GetSectionAssembler();
+	pSections->AddPid(0);		//PAT
+	pSections->AddPid(1);		//CAT
+	pSections->AddPid(0x10);	//NIT
+	pSections->AddPid(0x11);	//SDT BAT ST
+	pSections->AddPid(0x12);	//EIT ST
+	pSections->AddPid(0x14);	//TOT TDT ST
 
 	m_bHaveEit_P = false;
 	m_bHaveEit_F = false;
@@ -70,63 +69,53 @@ CPsiCheck::CPsiCheck(CTrCore* pParent)
 
 CPsiCheck::~CPsiCheck()
 {
-	UnInitAllCkHds();
-	delete [] m_pAllCkHds;
 	delete [] m_pOldOccurTime;
 }
 
-void CPsiCheck::UnInitAllCkHds()
+void CPsiCheck::AddPmtPid(int pid,int program_num)
 {
-	//dvbpsi_DetachPAT(m_pAllCkHds[0]);
-	//m_pAllCkHds[0] = NULL;
-
-	//dvbpsi_DetachCAT(m_pAllCkHds[1]);
-	//m_pAllCkHds[1] = NULL;
-
-
-	//pmt
-	for (int i = 0; i < 8192; i++)
-	{
-		if (m_pAllCkHds[i] != NULL)
-		{
-			FreeHandle(m_pAllCkHds[i]);
-		}
-	}
+	m_setPmtPid.insert(pid);
+	m_pParent->GetSectionAssembler()->AddPid(pid);
 }
 
-void CPsiCheck::InitAllCkHds()
+void CPsiCheck::RemovePmtPid(int pid)
 {
-	m_pAllCkHds[0] = NewHandle();		//PAT
-	m_pAllCkHds[1] = NewHandle();		//CAT
-	m_pAllCkHds[0x10] = NewHandle();	//NIT
-	m_pAllCkHds[0x11] = NewHandle();	//SDT BAT ST
-	m_pAllCkHds[0x12] = NewHandle();	//EIT ST
-	m_pAllCkHds[0x14] = NewHandle();	//TOT TDT ST
-	
+	m_setPmtPid.erase(pid);
 }
 
-void CPsiCheck::AddPmtPid(int pid,int program_num)
+bool CPsiCheck::IsCheckPid(int pid) const
 {
-	//ܸPID
-	m_pAllCkHds[pid] = NewHandle();
+	switch (pid)
+	{
+	case 0:
+	case 1:
+	case 0x10:
+	case 0x11:
+	case 0x12:
+	case 0x14:
+		return true;
+	default:
+		return m_setPmtPid.find(pid) != m_setPmtPid.end();
+	}
 }
 
-void CPsiCheck::AddPacket(uint8_t* pPacket,bool bEs,int pid)
+void CPsiCheck::OnSection(const SECTION_SPAN_T& section)
 {
-	//if (pid == 0x12)
-	//{
-	//	m_bEitPFPacket = true;
-	//}
-
-	if (!bEs && m_pAllCkHds[pid] != NULL)
+	if (!IsCheckPid(section.pid))
 	{
-		//check psi
-		PushPacket(m_pAllCkHds[pid],pPacket,pid);
+		return;
 	}
 
-	//check eit PF error
-	//CheckEitPF(pid);
-
+	//ST(0x72)ݿֵ
+	if (section.pData[0] != 0x72 && section.bValid)
+	{
+		OnRecvNewSection(section);
+	}
+	else
+	{
+		//report error here
+		OnCrcError(section.pData[0],section.pid);
+	}
 }
 
 void CPsiCheck::CheckPrevEitPF(int pid)
@@ -198,20 +187,24 @@ void CPsiCheck::OnCrcError(uint8_t table_id,int pid)
 	}
 }
 
-void CPsiCheck::OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid)
+void CPsiCheck::OnRecvNewSection(const SECTION_SPAN_T& section)
 {
-	long long llCurTime = m_pParent->m_pSysClock->GetPcr();
+	int pid = section.pid;
+	int table_id = section.pData[0];
+	//sectionsection_numberΪ0
+	int section_number = (section.pData[1] & 0x80) ? section.pData[6] : 0;
+	long long llCurTime = m_pParent->GetCurTime();
 
 	//check timeout
-	if (llCurTime != -1 && m_pOldOccurTime[p_section->i_table_id] != -1)
+	if (llCurTime != -1 && m_pOldOccurTime[table_id] != -1)
 	{
 		ERROR_NAME_T emName;
-		long long interval = diff_pcr(llCurTime, m_pOldOccurTime[p_section->i_table_id]) /*/ 27000*/;
+		long long interval = diff_pcr(llCurTime, m_pOldOccurTime[table_id]) /*/ 27000*/;
 
 		//2015-2-11 ȥi_numberжϣƺû,һᵼi_numberڵ2ʱûд³
-		//if (p_section->i_number == 1)	//EIT_PF_F
+		//if (section_number == 1)	//EIT_PF_F
 		//{
-		//	switch(p_section->i_table_id)
+		//	switch(table_id)
 		//	{
 		//	case 0x4E:
 		//		emName = LV3_PSI_INTERVAL_EIT_PF_ACT;
@@ -224,9 +217,9 @@ void CPsiCheck::OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid)
 		//		break;
 		//	}
 		//}
-		//else if (p_section->i_number == 0)
+		//else if (section_number == 0)
 		//{
-			switch(p_section->i_table_id)
+			switch(table_id)
 			{
 			case 0x00:
 				emName = LV3_PSI_INTERVAL_PAT;
@@ -287,9 +280,9 @@ void CPsiCheck::OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid)
 			
 //		} //!else if
 
-		if (p_section->i_table_id >= 0x50 && p_section->i_table_id <= 0x5F)
+		if (table_id >= 0x50 && table_id <= 0x5F)
 			emName = LV3_PSI_INTERVAL_EIT_SCHEDULE_ACT;
-		else if(p_section->i_table_id >= 0x60 && p_section->i_table_id <= 0x6F)
+		else if(table_id >= 0x60 && table_id <= 0x6F)
 			emName = LV3_PSI_INTERVAL_EIT_SCHEDULE_OTHER;
 
 		m_pParent->Report(3,emName,pid,interval,-1);
@@ -299,26 +292,26 @@ void CPsiCheck::OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid)
 	//check tid error
 	if (pid == 0x10) //nit tid error
 	{
-		if (p_section->i_table_id != 0x40 && p_section->i_table_id != 0x41 &&
-			 p_section->i_table_id != 0x72)
+		if (table_id != 0x40 && table_id != 0x41 &&
+			 table_id != 0x72)
 		{
 			m_pParent->Report(3,LV3_NIT_ERROR_TID,pid,-1,-1);
 		}
 	}	
 	else if (pid == 0x11) //sdt tid error
 	{
-		if (p_section->i_table_id != 0x42 && p_section->i_table_id != 0x46 &&
-			p_section->i_table_id != 0x4A && p_section->i_table_id != 0x72)
+		if (table_id != 0x42 && table_id != 0x46 &&
+			table_id != 0x4A && table_id != 0x72)
 		{
 			m_pParent->Report(3,LV3_SDT_ERROR_TID,pid,-1,-1);
 		}
 	}
 	else if (pid == 0x12) //eit tid error
 	{
-		if (p_section->i_table_id >= 0x4E && p_section->i_table_id <= 0x6F)
+		if (table_id >= 0x4E && table_id <= 0x6F)
 		{
 		}
-		else if (p_section->i_table_id == 0x72)
+		else if (table_id == 0x72)
 		{
 		}
 		else
@@ -328,30 +321,34 @@ void CPsiCheck::OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid)
 	}
 	else if (pid == 0x13) //rst tid error
 	{
-		if (p_section->i_table_id != 0x71 && p_section->i_table_id != 0x72)
+		if (table_id != 0x71 && table_id != 0x72)
 		{
 			m_pParent->Report(3,LV3_RST_ERROR_TID,pid,-1,-1);
 		}
 	}
 	else if (pid == 0x14) //tdt tid error
 	{
-		if (p_section->i_table_id != 0x70 && p_section->i_table_id != 0x72 &&
-			p_section->i_table_id != 0x73)
+		if (table_id != 0x70 && table_id != 0x72 &&
+			table_id != 0x73)
 		{
 			m_pParent->Report(3,LV3_TDT_ERROR_TID,pid,-1,-1);
 		}
 	}
 
 	//update PF
-	if (p_section->i_table_id == 0x4E || p_section->i_table_id == 0x4F)
+	if (table_id == 0x4E || table_id == 0x4F)
 	{
 		eit_section_t cur_eit_section;
-		cur_eit_section.i_service_id	 = CBit::getBits (p_section->p_data, 0, 24, 16);
-		cur_eit_section.i_version 		 = CBit::getBits (p_section->p_data, 0, 42,  5);
-		cur_eit_section.i_ts_id			 = CBit::getBits (p_section->p_data, 0, 64, 16);
-		cur_eit_section.i_network_id	 = CBit::getBits (p_section->p_data, 0, 80, 16);
-		cur_eit_section.i_number		 = p_section->i_number;
-		cur_eit_section.i_table_id		 = p_section->i_table_id;
+		CBitReader bs(section.pData,section.nLength);
+		bs.SkipBits(24);
+		cur_eit_section.i_service_id	 = bs.GetBits(16);
+		bs.SkipBits(2);
+		cur_eit_section.i_version 		 = bs.GetBits(5);
+		bs.SkipBits(17);
+		cur_eit_section.i_ts_id			 = bs.GetBits(16);
+		cur_eit_section.i_network_id	 = bs.GetBits(16);
+		cur_eit_section.i_number		 = section_number;
+		cur_eit_section.i_table_id		 = table_id;
 		if (m_bWaitFirstEitSection)
 		{
 			m_bWaitFirstEitSection = false;
@@ -372,312 +369,11 @@ void CPsiCheck::OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid)
 			}
 
 		}
-		UpdatePF(p_section->i_number );
+		UpdatePF(section_number );
 		m_PrevEitSection = cur_eit_section;
 
 	}
 
 
-	m_pOldOccurTime[p_section->i_table_id] = llCurTime;
-}
-
-
-/*****************************************************************************
- * dvbpsi_AttachPAT
- *****************************************************************************
- * Initialize a PAT decoder and return a handle on it.
- *****************************************************************************/
-dvbpsi_handle CPsiCheck::NewHandle(/*dvbpsi_pat_callback pf_callback,
-                               void* p_cb_data*/)
-{
-  dvbpsi_handle h_dvbpsi = (dvbpsi_decoder_t*)malloc(sizeof(dvbpsi_decoder_t));
-  //dvbpsi_pat_decoder_t* p_pat_decoder;
-
-  if(h_dvbpsi == NULL)
-    return NULL;
-
- /* p_pat_decoder = (dvbpsi_pat_decoder_t*)malloc(sizeof(dvbpsi_pat_decoder_t));
-
-  if(p_pat_decoder == NULL)
-  {
-    free(h_dvbpsi);
-    return NULL;
-  }*/
-
-  /* PSI decoder configuration */
-  //h_dvbpsi->pf_callback = &dvbpsi_GatherPATSections;
-  //h_dvbpsi->p_private_decoder = p_pat_decoder;
-  h_dvbpsi->i_section_max_size = 1024;
-  /* PSI decoder initial state */
-  h_dvbpsi->i_continuity_counter = 31;
-  h_dvbpsi->b_discontinuity = 1;
-  h_dvbpsi->p_current_section = NULL;
-
-  /* PAT decoder information */
-  //p_pat_decoder->pf_callback = pf_callback;
-  //p_pat_decoder->p_cb_data = p_cb_data;
-  /* PAT decoder initial state */
-  /*p_pat_decoder->b_current_valid = 0;
-  p_pat_decoder->p_building_pat = NULL;
-  for(unsigned int i = 0; i <= 255; i++)
-    p_pat_decoder->ap_sections[i] = NULL;*/
-
-  return h_dvbpsi;
+	m_pOldOccurTime[table_id] = llCurTime;
 }
-
-
-/*****************************************************************************
- * dvbpsi_DetachPAT
- *****************************************************************************
- * Close a PAT decoder. The handle isn't valid any more.
- *****************************************************************************/
-void CPsiCheck::FreeHandle(dvbpsi_handle h_dvbpsi)
-{
-  //dvbpsi_pat_decoder_t* p_pat_decoder
-  //                      = (dvbpsi_pat_decoder_t*)h_dvbpsi->p_private_decoder;
-
-  //free(p_pat_decoder->p_building_pat);
-
- /* for(unsigned int i = 0; i <= 255; i++)
-  {
-    if(p_pat_decoder->ap_sections[i])
-      free(p_pat_decoder->ap_sections[i]);
-  }*/
-
-  //free(h_dvbpsi->p_private_decoder);
-  if(h_dvbpsi->p_current_section)
-    dvbpsi_DeletePSISections(h_dvbpsi->p_current_section);
-  free(h_dvbpsi);
-}
-
-
-/*****************************************************************************
- * dvbpsi_PushPacket
- *****************************************************************************
- * Injection of a TS packet into a PSI decoder.
- *****************************************************************************/
-void CPsiCheck::PushPacket(dvbpsi_handle h_dvbpsi, uint8_t* p_data,int pid)
-{
-  uint8_t i_expected_counter;           /* Expected continuity counter */
-  dvbpsi_psi_section_t* p_section;      /* Current section */
-  uint8_t* p_payload_pos;               /* Where in the TS packet */
-  uint8_t* p_new_pos = NULL;            /* Beginning of the new section,
-                                           updated to NULL when the new
-                                           section is handled */
-  int i_available;                      /* Byte count available in the
-                                           packet */
-
-  /* TS start code */
-  if(p_data[0] != 0x47)
-  {
-    //DVBPSI_ERROR("PSI decoder", "not a TS packet");
-    return;
-  }
-
-  /* Continuity check */
-  i_expected_counter = (h_dvbpsi->i_continuity_counter + 1) & 0xf;
-  h_dvbpsi->i_continuity_counter = p_data[3] & 0xf;
-
-  if(i_expected_counter == ((h_dvbpsi->i_continuity_counter + 1) & 0xf)
-      && !h_dvbpsi->b_discontinuity)
-  {
-   /* DVBPSI_ERROR_ARG("PSI decoder",
-                     "TS duplicate (received %d, expected %d) for PID %d",
-                     h_dvbpsi->i_continuity_counter, i_expected_counter,
-                     ((uint16_t)(p_data[1] & 0x1f) << 8) | p_data[2]);*/
-    return;
-  }
-
-  if(i_expected_counter != h_dvbpsi->i_continuity_counter)
-  {
-    /*DVBPSI_ERROR_ARG("PSI decoder",
-                     "TS discontinuity (received %d, expected %d) for PID %d",
-                     h_dvbpsi->i_continuity_counter, i_expected_counter,
-                     ((uint16_t)(p_data[1] & 0x1f) << 8) | p_data[2]);*/
-    h_dvbpsi->b_discontinuity = 1;
-    if(h_dvbpsi->p_current_section)
-    {
-      dvbpsi_DeletePSISections(h_dvbpsi->p_current_section);
-      h_dvbpsi->p_current_section = NULL;
-    }
-  }
-
-  /* Return if no payload in the TS packet */
-  if(!(p_data[3] & 0x10))
-  {
-    return;
-  }
-
-  /* Skip the adaptation_field if present */
-  if(p_data[3] & 0x20)
-    p_payload_pos = p_data + 5 + p_data[4];
-  else
-    p_payload_pos = p_data + 4;
-
-  /* Unit start -> skip the pointer_field and a new section begins */
-  if(p_data[1] & 0x40)
-  {
-    p_new_pos = p_payload_pos + *p_payload_pos + 1;
-    p_payload_pos += 1;
-  }
-
-  p_section = h_dvbpsi->p_current_section;
-
-  /* If the psi decoder needs a begginning of section and a new section
-     begins in the packet then initialize the dvbpsi_psi_section_t structure */
-  if(p_section == NULL)
-  {
-    if(p_new_pos)
-    {
-      /* Allocation of the structure */
-      h_dvbpsi->p_current_section
-                        = p_section
-                        = dvbpsi_NewPSISection(h_dvbpsi->i_section_max_size);
-      /* Update the position in the packet */
-      p_payload_pos = p_new_pos;
-      /* New section is being handled */
-      p_new_pos = NULL;
-      /* Just need the header to know how long is the section */
-      h_dvbpsi->i_need = 3;
-      h_dvbpsi->b_complete_header = 0;
-    }
-    else
-    {
-      /* No new section => return */
-      return;
-    }
-  }
-
-  /* Remaining bytes in the payload */
-  i_available = 188 + p_data - p_payload_pos;
-
-  while(i_available > 0)
-  {
-    if(i_available >= h_dvbpsi->i_need)
-    {
-      /* There are enough bytes in this packet to complete the
-         header/section */
-      memcpy(p_section->p_payload_end, p_payload_pos, h_dvbpsi->i_need);
-      p_payload_pos += h_dvbpsi->i_need;
-      p_section->p_payload_end += h_dvbpsi->i_need;
-      i_available -= h_dvbpsi->i_need;
-
-      if(!h_dvbpsi->b_complete_header)
-      {
-        /* Header is complete */
-        h_dvbpsi->b_complete_header = 1;
-        /* Compute p_section->i_length and update h_dvbpsi->i_need */
-        h_dvbpsi->i_need = p_section->i_length
-                         =   ((uint16_t)(p_section->p_data[1] & 0xf)) << 8
-                           | p_section->p_data[2];
-        /* Check that the section isn't too long */
-        if(h_dvbpsi->i_need > h_dvbpsi->i_section_max_size - 3)
-        {
-//          DVBPSI_ERROR("PSI decoder", "PSI section too long");
-          dvbpsi_DeletePSISections(p_section);
-          h_dvbpsi->p_current_section = NULL;
-          /* If there is a new section not being handled then go forward
-             in the packet */
-          if(p_new_pos)
-          {
-            h_dvbpsi->p_current_section
-                        = p_section
-                        = dvbpsi_NewPSISection(h_dvbpsi->i_section_max_size);
-            p_payload_pos = p_new_pos;
-            p_new_pos = NULL;
-            h_dvbpsi->i_need = 3;
-            h_dvbpsi->b_complete_header = 0;
-            i_available = 188 + p_data - p_payload_pos;
-          }
-          else
-          {
-            i_available = 0;
-          }
-        }
-      }
-      else
-      {
-        /* PSI section is complete */
-        p_section->b_syntax_indicator = p_section->p_data[1] & 0x80;
-        p_section->b_private_indicator = p_section->p_data[1] & 0x40;
-        /* Update the end of the payload if CRC_32 is present */
-        if(p_section->b_syntax_indicator)
-          p_section->p_payload_end -= 4;
-
-
-        if(p_section->p_data[0] != 0x72 && dvbpsi_ValidPSISection(p_section))
-        {
-          /* PSI section is valid */
-          p_section->i_table_id = p_section->p_data[0];
-          if(p_section->b_syntax_indicator)
-          {
-            p_section->i_extension =   (p_section->p_data[3] << 8)
-                                     | p_section->p_data[4];
-            p_section->i_version = (p_section->p_data[5] & 0x3e) >> 1;
-            p_section->b_current_next = p_section->p_data[5] & 0x1;
-            p_section->i_number = p_section->p_data[6];
-            p_section->i_last_number = p_section->p_data[7];
-            p_section->p_payload_start = p_section->p_data + 8;
-          }
-          else
-          {
-            p_section->i_extension = 0;
-            p_section->i_version = 0;
-            p_section->b_current_next = 1;
-            p_section->i_number = 0;
-            p_section->i_last_number = 0;
-            p_section->p_payload_start = p_section->p_data + 3;
-          }
-
-		  OnRecvNewSection(p_section,pid);
-          //h_dvbpsi->pf_callback(h_dvbpsi, p_section);
-		  dvbpsi_DeletePSISections(p_section);
-          h_dvbpsi->p_current_section = NULL;
-        }
-        else
-        {
-          //report error here
-		  OnCrcError(p_section->p_data[0],pid);
-
-		   /* PSI section isn't valid => trash it */
-          dvbpsi_DeletePSISections(p_section);
-          h_dvbpsi->p_current_section = NULL;
-        }
-
-        /* A TS packet may contain any number of sections, only the first
-         * new one is flagged by the pointer_field. If the next payload
-         * byte isn't 0xff then a new section starts. */
-        if(p_new_pos == NULL && i_available && *p_payload_pos != 0xff)
-          p_new_pos = p_payload_pos;
-
-        /* If there is a new section not being handled then go forward
-           in the packet */
-        if(p_new_pos)
-        {
-          h_dvbpsi->p_current_section
-                        = p_section
-                        = dvbpsi_NewPSISection(h_dvbpsi->i_section_max_size);
-          p_payload_pos = p_new_pos;
-          p_new_pos = NULL;
-          h_dvbpsi->i_need = 3;
-          h_dvbpsi->b_complete_header = 0;
-          i_available = 188 + p_data - p_payload_pos;
-        }
-        else
-        {
-          i_available = 0;
-        }
-      }
-    }
-    else
-    {
-      /* There aren't enough bytes in this packet to complete the
-         header/section */
-      memcpy(p_section->p_payload_end, p_payload_pos, i_available);
-      p_section->p_payload_end += i_available;
-      h_dvbpsi->i_need -= i_available;
-      i_available = 0;
-    }
-  }
-}
-
@@ -16,6 +16,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 
 #include "config.h"
+#include "SectionAssembler.h"
+#include <set>
 
 
 class CTrCore;
@@ -35,25 +37,24 @@ public:
 	CPsiCheck(CTrCore* pParent);
 	~CPsiCheck();
 
-	void AddPacket(uint8_t* pPacket,bool bEs,int pid);
+	//CTrCoreõsectionֻPAT CAT NIT SDT EIT TDTPMTPID
+	void OnSection(const SECTION_SPAN_T& section);
 
 	void AddPmtPid(int pid,int program_num);
-private:
-	dvbpsi_handle NewHandle();
-	void FreeHandle(dvbpsi_handle h_dvbpsi);
-	void PushPacket(dvbpsi_handle h_dvbpsi, uint8_t* p_data,int pid);
 
-	void InitAllCkHds();
-	void UnInitAllCkHds();
+	//PAT°汾веPMT PIDټ
+	void RemovePmtPid(int pid);
+private:
+	bool IsCheckPid(int pid) const;
 
 private:
 	void OnCrcError(uint8_t table_id,int pid);
-	void OnRecvNewSection(dvbpsi_psi_section_t * p_section,int pid);
+	void OnRecvNewSection(const SECTION_SPAN_T& section);
 	void CheckPrevEitPF(int pid);
 	void UpdatePF(int section_number);
 private:
-	//±ΪPIDΪ handle
-	dvbpsi_handle* m_pAllCkHds;
+	//PATеPMT PID
+	std::set<int> m_setPmtPid;
 
 	//±Ϊtable_idΪʱ
 	long long* m_pOldOccurTime;
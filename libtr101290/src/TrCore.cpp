@@ -15,7 +15,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Demux.h"
 #include "tspacket.h"
 #include "global.h"
-#include "csysclock.h"
+#include "SyncScan.h"
 #include <string.h>
 
 using namespace tr101290;
@@ -47,7 +47,6 @@ CTrCore::CTrCore(void)
 	m_bPrevPktSync = true;
 
 	m_pDemuxer = new CDemux(this);
-	m_pSysClock = new CSysClock();
 }
 
 CTrCore::~CTrCore(void)
@@ -60,9 +59,6 @@ CTrCore::~CTrCore(void)
 	delete [] m_pCC;
 
 	delete m_pDemuxer;
-
-	delete m_pSysClock;
-
 }
 
 
@@ -121,27 +117,38 @@ int CTrCore::TryToReSync()
 	else
 		loop = m_nBufferPos - m_nTslen*5;
 
-	for (int i = 0; i < loop; i++)
+	int i = FindSyncLattice(m_pBuffer,loop,m_nTslen,5);
+	if (i < 0)
 	{
-		if(m_pBuffer[i]==0x47&&m_pBuffer[i+m_nTslen]==0x47&&m_pBuffer[i+m_nTslen*2]==0x47
-			&&m_pBuffer[i+m_nTslen*3]==0x47&&m_pBuffer[i+m_nTslen*4]==0x47)
-		{
-			if (i > 0)
-			{
-				memmove(m_pBuffer,m_pBuffer+i,m_nBufferPos-i);
-				m_nBufferPos -= i;
-				m_llOffset += i;
-			}
-			
-			return 1;
-		}
+		return -1;
+	}
 
+	if (i > 0)
+	{
+		memmove(m_pBuffer,m_pBuffer+i,m_nBufferPos-i);
+		m_nBufferPos -= i;
+		m_llOffset += i;
 	}
-	return -1;
+	return 1;
 }
 
-void CTrCore::AddPacket(BYTE* pPacket)
+void CTrCore::AddPacket(BYTE* pPacket,const TS_PACKET_INFO* pInfo)
 {
+	//ͬһΪʱֱӴߵݣٿڲ
+	if (m_bSynced && m_bPrevPktSync && m_nBufferPos == 0 && *pPacket == 0x47)
+	{
+		if (pInfo != NULL)
+		{
+			ProcessPacket(*pInfo);
+		}
+		else
+		{
+			ProcessPacket(pPacket);
+		}
+		m_llOffset+=m_nTslen;
+		return;
+	}
+
 	if (m_nBufferPos + m_nTslen >= BUFFER_SIZE)
 	{
 		memmove(m_pBuffer,m_pBuffer+m_nBufferPos-m_nTslen*5,m_nTslen*5);
@@ -231,30 +238,56 @@ void CTrCore::AddPacket(BYTE* pPacket)
 	
 }
 
+void CTrCore::AddPackets(const TS_PACKET_INFO* pInfo,int nCount)
+{
+	for (int i = 0; i < nCount; i++)
+	{
+		if (i + TS_PREFETCH_DISTANCE < nCount)
+		{
+			TS_PREFETCH(&m_pCC[pInfo[i+TS_PREFETCH_DISTANCE].pid & 0x1FFF]);
+		}
+
+		const TS_PACKET_INFO& info = pInfo[i];
+		if (m_bSynced && m_bPrevPktSync && m_nBufferPos == 0 && info.sync)
+		{
+			ProcessPacket(info);
+			m_llOffset+=m_nTslen;
+		}
+		else
+		{
+			//ͬʧ򻺳вݣ̴
+			AddPacket(info.pPacket,&info);
+		}
+	}
+}
+
 void CTrCore::ProcessPacket(BYTE* pPacket)
 {
-	CTsPacket tsPacket;
-	tsPacket.SetPacket(pPacket);
-	int pid = tsPacket.Get_PID();
+	TS_PACKET_INFO info;
+	ParseTsPacketInfo(pPacket,info);
+	ProcessPacket(info);
+}
+
+void CTrCore::ProcessPacket(const TS_PACKET_INFO& info)
+{
+	int pid = info.pid;
 	
 	//check cc
 	bool bcontinue = true;
-	int cc = tsPacket.Get_continuity_counter();
+	int cc = info.cc;
 
 	if (pid != 0x1FFF && m_pCC[pid] >= 0)
 	{
 		if ((m_pCC[pid]+1) % 0x10 != cc)	bcontinue = false;
 	}
-	if (pid != 0x1FFF  && m_pCC[pid] >= 0 && (tsPacket.Get_adaptation_field_control() & 0x1) == 0)
+	if (pid != 0x1FFF  && m_pCC[pid] >= 0 && (info.afc & 0x1) == 0)
 	{
 		if ((m_pCC[pid]) % 0x10 == cc)	bcontinue = true;
 		else	bcontinue = false;
 	}
-	BYTE afLen;
-	BYTE* pAf = tsPacket.Get_adaptation_field(afLen);
-	if (pAf != NULL)
+	if (info.discontinuity)
 	{
-		if (tsPacket.Get_discontinuity_indicator(pAf)) bcontinue = true;
+		bcontinue = true;
 	}
 	if (!bcontinue)
 	{
@@ -264,7 +297,7 @@ void CTrCore::ProcessPacket(BYTE* pPacket)
 
 
 	//LV2_TRANSPORT_ERROR
-	if (tsPacket.Get_transport_error_indicator())
+	if (info.tei)
 	{
 		Report(1,LV2_TRANSPORT_ERROR,m_llOffset,pid,-1,-1);
 	}
@@ -278,7 +311,7 @@ void CTrCore::ProcessPacket(BYTE* pPacket)
 	}
 
 	//other
-	m_pDemuxer->AddPacket(pPacket);
+	m_pDemuxer->AddPacket(info);
 }
 
 void CTrCore::Report(int level,ERROR_NAME_T errName,long long llOffset,int pid,long long llVal,double fVal)
@@ -307,3 +340,17 @@ bool CTrCore::IsDemuxFinish()
 	return m_pDemuxer->IsDemuxFinish();
 }
 
+void CTrCore::AddSectionConsumer(ISectionConsumer* pConsumer)
+{
+	m_sections.AddConsumer(pConsumer);
+	for (int pid = 0; pid <= 0x1F; pid++)
+	{
+		m_sections.AddPid(pid);
+	}
+}
+
+long long CTrCore::GetCurTime() const
+{
+	return m_pDemuxer->GetCurTime();
+}
+
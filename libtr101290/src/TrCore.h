@@ -13,11 +13,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #pragma once
 
 #include "tr101290_defs.h"
+#include "TsPacketInfo.h"
+#include "SectionAssembler.h"
 
 
 
 class CDemux;
-class CSysClock;
 class CTrCore
 {
 public:
@@ -38,8 +39,14 @@ public:
 
 	void SetReportCB(pfReportCB pCB,void* pApp);
 
-	//һõĺ
-	void AddPacket(BYTE* pPacket);
+	//һõĺpInfoΪԤİͷϢΪNULL
+	void AddPacket(BYTE* pPacket,const TS_PACKET_INFO* pInfo = NULL);
+
+	//nCountԤİͬʱڲֱӴ
+	void AddPackets(const TS_PACKET_INFO* pInfo,int nCount);
+
+	//õsectionͬʱpConsumer˺PID 0x00~0x1FPATеPIDsection
+	void AddSectionConsumer(ISectionConsumer* pConsumer);
 
 	//ⲿ
 	//void Report(int level,ERROR_NAME_T errName,int pid,long long llVal,double fVal);
@@ -48,6 +55,7 @@ private:
 
 	//ͬ
 	void ProcessPacket(BYTE* pPacket);
+	void ProcessPacket(const TS_PACKET_INFO& info);
 
 	/**
 	 * @brief ͬ
@@ -75,6 +83,9 @@ private:
 	//for check cc
 	unsigned long long* m_pCC;
 private:
+	//PSI/SIPIDsectionCRC_32ֻУһΣCDemuxⲿʹ
+	CSectionAssembler m_sections;
+
 	CDemux* m_pDemuxer;
 
 //ǰȫֱ
@@ -88,6 +99,13 @@ private:
 public:
 	void Report(int level,ERROR_NAME_T errName,long long llOffset,int pid,long long llVal,double fVal);
 	void Report(int level,ERROR_NAME_T errName,int pid,long long llVal,double fVal);
-	CSysClock* m_pSysClock;
+
+	//ǰֽƫ
+	long long GetOffset() const { return m_llOffset; }
+
+	CSectionAssembler* GetSectionAssembler() { return &m_sections; }
+
+	//ǰϵͳʱӣûPCRʱΪ-1
+	long long GetCurTime() const;
 
 };
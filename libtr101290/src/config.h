@@ -17,13 +17,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "tr101290_defs.h"
 
-#include <dvbpsi/dvbpsi.h>
-#include <dvbpsi/psi.h>
-#include <dvbpsi/pat.h>
-#include <dvbpsi/descriptor.h>
-#include <dvbpsi/demux.h>
-#include <dvbpsi/pmt.h>
-#include <dvbpsi/eit.h>
+#include <stdint.h>
 
 
 
@@ -79,9 +79,19 @@ void Clibtr101290::SetEnable(bool *p)
 	m_pTrCore->SetEnable(p);
 }
 	
-void Clibtr101290::AddPacket(BYTE* pPacket)
+void Clibtr101290::AddPacket(BYTE* pPacket,const struct _TS_PACKET_INFO* pInfo)
 {
-	m_pTrCore->AddPacket(pPacket);
+	m_pTrCore->AddPacket(pPacket,pInfo);
+}
+
+void Clibtr101290::AddPackets(const struct _TS_PACKET_INFO* pInfo,int nCount)
+{
+	m_pTrCore->AddPackets(pInfo,nCount);
+}
+
+void Clibtr101290::AddSectionConsumer(ISectionConsumer* pConsumer)
+{
+	m_pTrCore->AddSectionConsumer(pConsumer);
 }
 
 bool Clibtr101290::IsDemuxFinish()
@@ -20,6 +20,17 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
  UDP 直播分析
  1.easyice_process函数会异步运行，调用方想要停止分析时，调用easyice_cleanup会终止分析并释放资源
+
+ 批量文件分析
+ 1.easyice_process_batch函数会阻塞运行，用 handle 的选项在 batch_threads 个线程上分析 mrls 中的文件，
+   每个文件完成时调用 EASYICEOPT_BATCH_FUNCTION，全部完成后汇总结果可由 EASYICEINFO_BATCH_RESULT 获取
+
+ EPG(EIT schedule)
+ 1.设置 EASYICEOPT_EPG_MEMORY_LIMIT 后，文件、批量和 UDP 直播分析把 EIT schedule(table_id 0x50-0x6F)存入按
+   original_network_id, transport_stream_id, service_id, start_time 索引的存储，不再写入 .psi.json。
+   值为存储的 MB 上限，-1 不限制。批量分析的所有文件存入同一个存储
+ 2.EASYICEINFO_EPG_QUERY 按 EASYICE_EPG_QUERY 查询一个时间范围的事件，EASYICEINFO_EPG_STATS 获取统计。
+   文件分析完成后或直播分析中都可查询，存储在下次 easyice_process 或 easyice_cleanup 时释放
  * */
 
 
@@ -38,6 +49,7 @@ extern int easyice_setopt( EASYICE* handle,EASYICEopt option, void* val);
 
 extern int easyice_getinfo(EASYICE* handle,EASYICEinfo info,void* val);
 extern EASYICEcode easyice_process(EASYICE* handle);
+extern EASYICEcode easyice_process_batch(EASYICE* handle,const char** mrls,int count);
 
 
 
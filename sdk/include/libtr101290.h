@@ -21,6 +21,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #define LIBTR101290_H
 
 #include "tr101290_defs.h"
+#include <stddef.h>
 
 
 
@@ -91,6 +92,8 @@ llVal()
 
 
 class CTrCore;
+class ISectionConsumer;
+struct _TS_PACKET_INFO;
 
 
 // Ǵ libtr101290.dll 
@@ -114,7 +117,16 @@ public:
 	void SetEnable(bool *p);
 
 	//һõĺ
-	void AddPacket(BYTE* pPacket);
+	//pInfoΪѽõİͷϢ(TsPacketInfo.h)ģ鹲ãΪNULLʱڲ
+	void AddPacket(BYTE* pPacket,const struct _TS_PACKET_INFO* pInfo = NULL);
+
+	//һδnCountһUDPݱһζȡݿ飬pInfoΪԤİͷϢ
+	//AddPacketͬ
+	void AddPackets(const struct _TS_PACKET_INFO* pInfo,int nCount);
+
+	//PSI/SIsectionòУCRC_32ͬʱpConsumer(SectionAssembler.h)
+	//ãһ顣PID 0x00~0x1FPATеPIDsection
+	void AddSectionConsumer(ISectionConsumer* pConsumer);
 private:
 	CTrCore* m_pTrCore;
 };